@@ -0,0 +1,350 @@
+#include "secret/Secrets.h"
+#include "utils/System.h"
+
+#include "../include/basis/SegmentedScan.h"
+#include "../include/basis/View.h"
+#include "../include/basis/Views.h"
+#include "conf/DbConf.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Shares the client's plaintext columns into a view on the servers. valid holds the plaintext $valid bits.
+static View shareView(std::vector<std::vector<int64_t> > &cols, std::vector<int64_t> &valid,
+                      std::vector<std::string> fieldNames, std::vector<int> fieldWidths, int task) {
+    std::string name = "t";
+    View v(name, fieldNames, fieldWidths);
+    for (size_t c = 0; c < cols.size(); c++) {
+        auto shares = Secrets::boolShare(cols[c], 2, fieldWidths[c], task);
+        if (Comm::isServer()) {
+            v._dataCols[c] = std::move(shares);
+        }
+    }
+    auto validShares = Secrets::boolShare(valid, 2, 1, task);
+    if (Comm::isServer()) {
+        v._dataCols[v.colNum() + View::PADDING_COL_OFFSET] = std::vector<int64_t>(validShares.size(), 0);
+        v._dataCols[v.colNum() + View::VALID_COL_OFFSET] = std::move(validShares);
+    }
+    return v;
+}
+
+// Opens every column of the view, $valid and $padding included, on the client
+static std::vector<std::vector<int64_t> > revealView(View &v, int task) {
+    std::vector<std::vector<int64_t> > cols(v._fieldNames.size());
+    for (size_t c = 0; c < cols.size(); c++) {
+        std::vector<int64_t> shares;
+        if (Comm::isServer()) {
+            shares = v._dataCols[c];
+        }
+        cols[c] = Secrets::boolReconstruct(shares, 2, v._fieldWidths[c], task);
+    }
+    return cols;
+}
+
+static void report(const std::string &name, int mismatch) {
+    if (mismatch == 0) {
+        Log::i("[View {} correctness] PASS", name);
+    } else {
+        Log::i("[View {} correctness] FAIL mismatches={}", name, mismatch);
+    }
+}
+
+// Compaction on more rows than one batch, with the valid rows spread over all batches
+static void testCompact(int n, int task) {
+    std::vector<std::vector<int64_t> > cols(2);
+    std::vector<int64_t> valid;
+    if (Comm::isClient()) {
+        cols[0].resize(n);
+        cols[1].resize(n);
+        valid.resize(n);
+        for (int i = 0; i < n; i++) {
+            cols[0][i] = i;
+            cols[1][i] = Math::randInt(0, 1000);
+            valid[i] = Math::randInt(0, 2) == 0;
+        }
+    }
+    View v = shareView(cols, valid, {"id", "v"}, {32, 16}, task);
+    if (Comm::isServer()) {
+        v.compact(0);
+    }
+    auto got = revealView(v, task);
+
+    if (Comm::isClient()) {
+        int mismatch = 0;
+        const int validIdx = static_cast<int>(got.size()) + View::VALID_COL_OFFSET;
+        size_t r = 0;
+        for (int i = 0; i < n; i++) {
+            if (!valid[i]) continue;
+            if (r >= got[0].size() || !got[validIdx][r] || got[0][r] != cols[0][i] || got[1][r] != cols[1][i]) {
+                mismatch++;
+                if (mismatch <= 10) {
+                    Log::e("MISMATCH compact row={}: expected id={} v={}", r, cols[0][i], cols[1][i]);
+                }
+            }
+            r++;
+        }
+        for (; r < got[0].size(); r++) {
+            if (got[validIdx][r]) {
+                mismatch++;
+                if (mismatch <= 10) {
+                    Log::e("MISMATCH compact row={}: expected an invalid row", r);
+                }
+            }
+        }
+        report("compact", mismatch);
+    }
+}
+
+// Shuffle sort on (k asc, v desc) with many duplicate keys, compared with a plaintext sort. The id column
+// tells equal keys apart, so the output must also be a permutation of the input rows.
+static void testShuffleSort(int n, int task) {
+    std::vector<std::vector<int64_t> > cols(3);
+    std::vector<int64_t> valid;
+    if (Comm::isClient()) {
+        for (auto &col: cols) col.resize(n);
+        valid.assign(n, 1);
+        for (int i = 0; i < n; i++) {
+            cols[0][i] = Math::randInt(0, 7);
+            cols[1][i] = Math::randInt(0, 3);
+            cols[2][i] = i;
+        }
+    }
+    View v = shareView(cols, valid, {"k", "v", "id"}, {8, 8, 32}, task);
+    if (Comm::isServer()) {
+        DbConf::SORT_METHOD = DbConf::SHUFFLE_SORT;
+        std::vector<std::string> orderFields = {"k", "v"};
+        std::vector<bool> ascendingOrders = {true, false};
+        v.sort(orderFields, ascendingOrders, 0);
+    }
+    auto got = revealView(v, task);
+
+    if (Comm::isClient()) {
+        std::vector<std::tuple<int64_t, int64_t, int64_t> > expected;
+        for (int i = 0; i < n; i++) {
+            expected.emplace_back(cols[0][i], -cols[1][i], cols[2][i]);
+        }
+        // Rows with equal keys may come out in any order
+        std::sort(expected.begin(), expected.end());
+        int mismatch = got[0].size() == static_cast<size_t>(n) ? 0 : 1;
+        std::vector<std::tuple<int64_t, int64_t, int64_t> > sorted;
+        for (size_t r = 0; r < got[0].size(); r++) {
+            sorted.emplace_back(got[0][r], -got[1][r], got[2][r]);
+            if (r > 0 && std::make_pair(got[0][r], -got[1][r]) < std::make_pair(got[0][r - 1], -got[1][r - 1])) {
+                mismatch++;
+                if (mismatch <= 10) {
+                    Log::e("MISMATCH shuffle sort row={}: ({}, {}) after ({}, {})", r, got[0][r], got[1][r],
+                           got[0][r - 1], got[1][r - 1]);
+                }
+            }
+        }
+        std::sort(sorted.begin(), sorted.end());
+        if (sorted != expected) {
+            mismatch++;
+            Log::e("MISMATCH shuffle sort: rows differ from the input rows");
+        }
+        report("shuffle sort", mismatch);
+    }
+}
+
+// Sort-merge join of a primary key view with n / 4 rows and a foreign key view with n rows, compared with a
+// plaintext join. Some rows on both sides are invalid, and some foreign keys match no primary key.
+static void testSortMergeJoin(int n, int task) {
+    const int m = std::max(1, n / 4);
+    std::vector<std::vector<int64_t> > cols0(2), cols1(2);
+    std::vector<int64_t> valid0, valid1;
+    if (Comm::isClient()) {
+        for (int i = 0; i < m; i++) {
+            cols0[0].push_back(3 * i + 1);
+            cols0[1].push_back(Math::randInt(0, 1000));
+            valid0.push_back(Math::randInt(0, 4) != 0);
+        }
+        std::shuffle(cols0[0].begin(), cols0[0].end(), std::mt19937(42));
+        for (int j = 0; j < n; j++) {
+            cols1[0].push_back(Math::randInt(0, 3 * m + 2));
+            cols1[1].push_back(Math::randInt(0, 1000));
+            valid1.push_back(Math::randInt(0, 4) != 0);
+        }
+    }
+    View v0 = shareView(cols0, valid0, {"pk", "a"}, {32, 16}, task);
+    View v1 = shareView(cols1, valid1, {"fk", "b"}, {32, 16}, task);
+    // The client only needs the widths of the joined columns to open them
+    std::vector<std::string> joinedNames = {"pk", "a", "fk", "b"};
+    std::vector<int> joinedWidths = {32, 16, 32, 16};
+    View joined(joinedNames, joinedWidths);
+    if (Comm::isServer()) {
+        // Precise joins take inputs without invalid rows, as after a precise filter
+        if (!DbConf::BASELINE_MODE && !DbConf::DISABLE_PRECISE_COMPACTION) {
+            v0.clearInvalidEntries(0);
+            v1.clearInvalidEntries(0);
+        }
+        std::string field0 = "pk", field1 = "fk";
+        joined = Views::sortMergeJoin(v0, v1, field0, field1, true, 0);
+    }
+    auto got = revealView(joined, task);
+
+    if (Comm::isClient()) {
+        std::vector<std::vector<int64_t> > expected, rows;
+        for (int j = 0; j < n; j++) {
+            if (!valid1[j]) continue;
+            for (int i = 0; i < m; i++) {
+                if (valid0[i] && cols0[0][i] == cols1[0][j]) {
+                    expected.push_back({cols0[0][i], cols0[1][i], cols1[0][j], cols1[1][j]});
+                }
+            }
+        }
+        const int validIdx = static_cast<int>(got.size()) + View::VALID_COL_OFFSET;
+        for (size_t r = 0; r < got[0].size(); r++) {
+            if (got[validIdx][r]) {
+                rows.push_back({got[0][r], got[1][r], got[2][r], got[3][r]});
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(rows.begin(), rows.end());
+        int mismatch = 0;
+        if (rows != expected) {
+            mismatch++;
+            Log::e("MISMATCH sort-merge join: {} valid rows, expected {}", rows.size(), expected.size());
+        }
+        report("sort-merge join", mismatch);
+    }
+}
+
+// Hash join of two n-row views with duplicate keys on both sides and some invalid rows, compared with a
+// plaintext equi-join. The buckets are joined concurrently unless their message tags do not fit together.
+static void testHashJoin(int n, int task) {
+    std::vector<std::vector<int64_t> > cols0(3), cols1(3);
+    std::vector<int64_t> valid0, valid1;
+    if (Comm::isClient()) {
+        for (int i = 0; i < n; i++) {
+            for (auto *cols: {&cols0, &cols1}) {
+                int64_t k = Math::randInt(0, n / 2);
+                (*cols)[0].push_back(k);
+                (*cols)[1].push_back(Math::randInt(0, 1000));
+                (*cols)[2].push_back(Views::hash(k));
+            }
+            valid0.push_back(Math::randInt(0, 4) != 0);
+            valid1.push_back(Math::randInt(0, 4) != 0);
+        }
+    }
+    const std::string tag = View::BUCKET_TAG_PREFIX + "k";
+    View v0 = shareView(cols0, valid0, {"k", "v", tag}, {32, 16, 32}, task);
+    View v1 = shareView(cols1, valid1, {"k", "v", tag}, {32, 16, 32}, task);
+    std::vector<std::string> joinedNames = {"k", "v", tag, "k", "v", tag};
+    std::vector<int> joinedWidths = {32, 16, 32, 32, 16, 32};
+    View joined(joinedNames, joinedWidths);
+    if (Comm::isServer()) {
+        if (!DbConf::BASELINE_MODE && !DbConf::DISABLE_PRECISE_COMPACTION) {
+            v0.clearInvalidEntries(0);
+            v1.clearInvalidEntries(0);
+        }
+        std::string field = "k";
+        joined = Views::hashJoin(v0, v1, field, field, true, 0);
+    }
+    auto got = revealView(joined, task);
+
+    if (Comm::isClient()) {
+        std::vector<std::vector<int64_t> > expected, rows;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (valid0[i] && valid1[j] && cols0[0][i] == cols1[0][j]) {
+                    expected.push_back({cols0[0][i], cols0[1][i], cols1[0][j], cols1[1][j]});
+                }
+            }
+        }
+        const int validIdx = static_cast<int>(got.size()) + View::VALID_COL_OFFSET;
+        for (size_t r = 0; r < got[0].size(); r++) {
+            if (got[validIdx][r]) {
+                rows.push_back({got[0][r], got[1][r], got[3][r], got[4][r]});
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(rows.begin(), rows.end());
+        int mismatch = 0;
+        if (rows != expected) {
+            mismatch++;
+            Log::e("MISMATCH hash join: {} valid rows, expected {}", rows.size(), expected.size());
+        }
+        report("hash join", mismatch);
+    }
+}
+
+// One segmented scan with SUM, MAX and MIN lanes over n rows, compared with a plaintext prefix scan of every
+// segment. Segments are short and random, and every few rows two heads in a row make a single-row segment.
+static void testSegmentedScan(int n, int task) {
+    std::vector<int64_t> heads, sums, maxs, mins;
+    if (Comm::isClient()) {
+        for (int i = 0; i < n; i++) {
+            heads.push_back(i == 0 || i % 7 == 3 || i % 7 == 4 || Math::randInt(0, 4) == 0);
+            sums.push_back(Math::randInt(-1000, 1000));
+            maxs.push_back(Math::randInt(0, 30000));
+            mins.push_back(Math::randInt(0, 30000));
+        }
+    }
+    auto headShares = Secrets::boolShare(heads, 2, 1, task);
+    auto sumShares = Secrets::arithShare(sums, 2, 64, task);
+    auto maxShares = Secrets::boolShare(maxs, 2, 16, task);
+    auto minShares = Secrets::boolShare(mins, 2, 16, task);
+    if (Comm::isServer()) {
+        SegmentedScan(headShares)
+                .add(&sumShares, SegmentedScan::SUM, 64)
+                .add(&maxShares, SegmentedScan::MAX, 16)
+                .add(&minShares, SegmentedScan::MIN, 16)
+                .execute(0);
+    }
+    auto gotSums = Secrets::arithReconstruct(sumShares, 2, 64, task);
+    auto gotMaxs = Secrets::boolReconstruct(maxShares, 2, 16, task);
+    auto gotMins = Secrets::boolReconstruct(minShares, 2, 16, task);
+
+    if (Comm::isClient()) {
+        int mismatch = 0;
+        int64_t sum = 0, max = 0, min = 0;
+        for (int i = 0; i < n; i++) {
+            if (heads[i]) {
+                sum = sums[i];
+                max = maxs[i];
+                min = mins[i];
+            } else {
+                sum += sums[i];
+                max = std::max(max, maxs[i]);
+                min = std::min(min, mins[i]);
+            }
+            if (gotSums[i] != sum || gotMaxs[i] != max || gotMins[i] != min) {
+                mismatch++;
+                if (mismatch <= 10) {
+                    Log::e("MISMATCH segmented scan row={}: expected ({}, {}, {}), got ({}, {}, {})", i, sum, max, min,
+                           gotSums[i], gotMaxs[i], gotMins[i]);
+                }
+            }
+        }
+        report("segmented scan n=" + std::to_string(n), mismatch);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    System::init(argc, argv);
+    DbConf::init();
+
+    const int task = System::nextTask();
+    // Several batches by default, with a partial one at the end
+    int rows = Conf::BATCH_SIZE > 0 ? 3 * Conf::BATCH_SIZE + Conf::BATCH_SIZE / 2 + 1 : 100;
+    if (Conf::_userParams.count("rows")) {
+        rows = std::stoi(Conf::_userParams["rows"]);
+    }
+    Log::ir(2, "View correctness: rows={}, batch_size={}", rows, Conf::BATCH_SIZE);
+
+    testCompact(rows, task);
+    testShuffleSort(rows, task);
+    testSortMergeJoin(rows, task);
+    testHashJoin(std::min(rows, 400), task);
+    testSegmentedScan(rows, task);
+    testSegmentedScan(13, task);
+
+    System::finalize();
+    return 0;
+}
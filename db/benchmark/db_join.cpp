@@ -21,6 +21,7 @@ int main(int argc, char *argv[]) {
     int rows = 5;
     int table_num = 3;
     bool hash = false;
+    bool sortMerge = false;
 
     if (Conf::_userParams.count("rows")) {
         rows = std::stoi(Conf::_userParams["rows"]);
@@ -38,7 +39,12 @@ int main(int argc, char *argv[]) {
         hash = (Conf::_userParams["hash"] == "true");
     }
 
-    Log::ir(2, "Join benchmark - Rows per table: {}, Table count: {}, Hash join: {}", rows, table_num, hash);
+    if (Conf::_userParams.count("sort_merge")) {
+        sortMerge = (Conf::_userParams["sort_merge"] == "true");
+    }
+
+    Log::ir(2, "Join benchmark - Rows per table: {}, Table count: {}, Hash join: {}, Sort-merge join: {}", rows,
+            table_num, hash, sortMerge);
 
     std::vector<std::vector<int64_t> > allShares(table_num);
     std::vector<std::vector<int64_t> > allTagShares(table_num);
@@ -89,7 +95,9 @@ int main(int argc, char *argv[]) {
         auto start = System::currentTimeMillis();
 
         for (int i = 1; i < table_num; i++) {
-            if (hash) {
+            if (sortMerge) {
+                joinResult = Views::sortMergeJoin(joinResult, views[i], joinField, joinField, false);
+            } else if (hash) {
                 joinResult = Views::hashJoin(joinResult, views[i], joinField, joinField, false);
             } else {
                 joinResult = Views::nestedLoopJoin(joinResult, views[i], joinField, joinField, false);
@@ -166,7 +166,8 @@ std::vector<int64_t> executeWhereInClause(View &diagnosis_view, View &cdiff_coho
 
     auto in_results = Views::in(diagnosis_pid_col, cdiff_cohort_pid_col,
                                 diagnosis_view._dataCols[diagnosis_view.colNum() + View::VALID_COL_OFFSET],
-                                cdiff_cohort_view._dataCols[cdiff_cohort_view.colNum() + View::VALID_COL_OFFSET]);
+                                cdiff_cohort_view._dataCols[cdiff_cohort_view.colNum() + View::VALID_COL_OFFSET],
+                                std::max(diagnosis_view._fieldWidths[0], cdiff_cohort_view._fieldWidths[0]));
 
     return in_results;
 }
@@ -286,7 +286,8 @@ std::vector<int64_t> executeExistsClause(View &filtered_orders, View &filtered_l
 
     auto exists_results = Views::in(orders_orderkey_col, lineitem_orderkey_col,
                                     filtered_orders._dataCols[filtered_orders.colNum() + View::VALID_COL_OFFSET],
-                                    filtered_lineitem._dataCols[filtered_lineitem.colNum() + View::VALID_COL_OFFSET]);
+                                    filtered_lineitem._dataCols[filtered_lineitem.colNum() + View::VALID_COL_OFFSET],
+                                    std::max(filtered_orders._fieldWidths[0], filtered_lineitem._fieldWidths[0]));
 
     return exists_results;
 }
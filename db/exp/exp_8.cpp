@@ -129,7 +129,9 @@ View createZerosCTE(View &customer_view, View &cnt_view, int tid) {
     auto &customer_valid = customer_view._dataCols[cust_valid_i];
     auto &cnt_valid = cnt_view._dataCols[cnt_valid_i];
 
-    std::vector<int64_t> in_mask = Views::in(customer_keys, cnt_keys, customer_valid, cnt_valid);
+    std::vector<int64_t> in_mask = Views::in(customer_keys, cnt_keys, customer_valid, cnt_valid,
+                                             std::max(customer_view._fieldWidths[cust_key_idx],
+                                                      cnt_view._fieldWidths[cnt_key_idx]));
 
     std::vector<int64_t> one_mask(in_mask.size(), (Comm::rank() == 1 ? 1 : 0));
     auto not_in_mask =
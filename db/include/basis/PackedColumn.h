@@ -0,0 +1,42 @@
+#ifndef PACKEDCOLUMN_H
+#define PACKEDCOLUMN_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Boolean shares of one table column, stored in the narrowest type that holds the column width:
+// one bit per value for 1-bit columns, then uint8_t, uint16_t, uint32_t, or int64_t for 64-bit columns.
+// Shares are truncated to the width when appended, which leaves them valid shares of the same values.
+class PackedColumn {
+public:
+    PackedColumn() = default;
+
+    explicit PackedColumn(int width);
+
+    void append(const int64_t *values, size_t count);
+
+    void reserve(size_t count);
+
+    [[nodiscard]] int64_t get(size_t i) const;
+
+    // Widens every share back to int64_t, the form the operators work on
+    [[nodiscard]] std::vector<int64_t> unpack() const;
+
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] size_t capacity() const;
+
+    [[nodiscard]] size_t bytes() const;
+
+private:
+    int _width = 64;
+    size_t _size = 0;
+    std::vector<uint64_t> _bits;
+    std::vector<uint8_t> _u8;
+    std::vector<uint16_t> _u16;
+    std::vector<uint32_t> _u32;
+    std::vector<int64_t> _i64;
+};
+
+
+#endif
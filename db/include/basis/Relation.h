@@ -0,0 +1,37 @@
+#ifndef SMPC_DATABASE_RELATION_H
+#define SMPC_DATABASE_RELATION_H
+#include <vector>
+
+#include <string>
+// Schema and working columns shared by stored tables and views
+class Relation {
+public:
+    inline static const std::string BUCKET_TAG_PREFIX = "$tag:";
+
+    virtual ~Relation() = default;
+
+    std::string _tableName;
+    std::vector<std::string> _fieldNames;
+    std::string _keyField;
+    std::vector<int> _fieldWidths;
+    // Working columns of a View, one int64_t share per row. A stored Table keeps them empty.
+    std::vector<std::vector<int64_t> > _dataCols;
+    int _maxWidth{};
+
+    inline static std::vector<int64_t> EMPTY_COL{};
+
+public:
+    Relation() = default;
+
+    explicit Relation(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths,
+                      std::string keyField);
+
+    [[nodiscard]] int colIndex(const std::string &colName) const;
+
+    [[nodiscard]] size_t colNum() const;
+
+    [[nodiscard]] virtual size_t rowNum() const;
+};
+
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SEGMENTEDSCAN_H
+#define SEGMENTEDSCAN_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Inclusive scan over secret-shared columns that restarts at every head row, so the last row of each
+// segment ends up holding the aggregate of the whole segment. The scan uses a work-efficient up/down
+// sweep. It takes about 2n secure combines in 2 log n levels, where a doubling scan takes n log n.
+// Each level is split into BATCH_SIZE chunks that run on the thread pool.
+class SegmentedScan {
+public:
+    enum CombineOp {
+        MAX,
+        MIN,
+        // Arithmetic 64-bit shares; counting is a SUM over ones
+        SUM,
+        FIRST,
+        LAST
+    };
+
+private:
+    struct Lane {
+        std::vector<int64_t> *_values;
+        CombineOp _op;
+        int _width;
+    };
+
+    std::vector<int64_t> _flags;
+    std::vector<int64_t> _arithFlags;
+    std::vector<Lane> _lanes;
+
+public:
+    // heads holds boolean shares of 1 on the first row of every segment
+    explicit SegmentedScan(const std::vector<int64_t> &heads);
+
+    // Scans values in place. SUM lanes hold arithmetic shares, all other lanes width-bit boolean shares.
+    SegmentedScan &add(std::vector<int64_t> *values, CombineOp op, int width);
+
+    // Levels run one after another, so every level reuses the tags from msgTagBase on
+    void execute(int msgTagBase);
+
+private:
+    [[nodiscard]] bool hasBoolLanes() const;
+
+    [[nodiscard]] bool hasArithLanes() const;
+
+    [[nodiscard]] int combineTagStride() const;
+
+    // Folds row k - d into row k for every k in rights, in place
+    void runLevel(const std::vector<size_t> &rights, size_t d, int msgTagBase);
+
+    void combine(const std::vector<size_t> &rights, size_t d, size_t start, size_t end, int msgTagBase);
+
+    void combineBool(const std::vector<size_t> &lefts, const std::vector<size_t> &rights, int msgTagBase);
+
+    void combineArith(const std::vector<size_t> &lefts, const std::vector<size_t> &rights, int msgTagBase);
+};
+
+
+#endif
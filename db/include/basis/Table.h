@@ -1,23 +1,16 @@
-
 #ifndef SMPC_DATABASE_TABLE_H
 #define SMPC_DATABASE_TABLE_H
 #include <vector>
 
+#include "PackedColumn.h"
+#include "Relation.h"
+
 #include <string>
-class Table {
+// A stored table. Inserted rows are kept at each column's own width and widened only when a query
+// selects them into a View.
+class Table : public Relation {
 public:
-    inline static const std::string BUCKET_TAG_PREFIX = "$tag:";
-
-    virtual ~Table() = default;
-
-    std::string _tableName;
-    std::vector<std::string> _fieldNames;
-    std::string _keyField;
-    std::vector<int> _fieldWidths;
-    std::vector<std::vector<int64_t> > _dataCols;
-    int _maxWidth{};
-
-    inline static std::vector<int64_t> EMPTY_COL{};
+    std::vector<PackedColumn> _packedCols;
 
 public:
     Table() = default;
@@ -26,11 +19,13 @@ public:
 
     bool insert(const std::vector<int64_t> &r);
 
-    [[nodiscard]] int colIndex(const std::string &colName) const;
+    // Appends rows given column by column: all rows of column 0, then of column 1, and so on
+    void insertColumns(const std::vector<int64_t> &colMajor, size_t rows);
 
-    [[nodiscard]] size_t colNum() const;
+    // Column i widened to int64_t shares
+    [[nodiscard]] std::vector<int64_t> column(size_t i) const;
 
-    [[nodiscard]] size_t rowNum() const;
+    [[nodiscard]] size_t rowNum() const override;
 };
 
 
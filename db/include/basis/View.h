@@ -1,12 +1,14 @@
 
 #ifndef VIEW_H
 #define VIEW_H
-#include "Table.h"
+#include "Relation.h"
+#include "SegmentedScan.h"
 
 
+#include <functional>
 #include <string>
 
-class View : public Table {
+class View : public Relation {
 public:
     static const int VALID_COL_OFFSET = -2;
     static const int PADDING_COL_OFFSET = -1;
@@ -45,6 +47,12 @@ public:
 
     int sortTagStride(const std::vector<std::string> &orderFields);
 
+    // Obliviously permutes the rows: each server routes a random permutation of its own through a
+    // Benes network of shared switches, so neither server knows the composed order.
+    void shuffle(int msgTagBase);
+
+    int shuffleTagStride();
+
     void filterAndConditions(std::vector<std::string> &fieldNames, std::vector<ComparatorType> &comparatorTypes,
                              std::vector<int64_t> &constShares, bool clear, int msgTagBase);
 
@@ -53,10 +61,19 @@ public:
 
     void clearInvalidEntries(int msgTagBase);
 
-    void clearInvalidEntries(bool doSort, int msgTagBase);
+    void clearInvalidEntries(bool doCompact, int msgTagBase);
 
     int clearInvalidEntriesTagStride();
 
+    static int clearInvalidEntriesTagStride(size_t rows);
+
+    // Moves the valid rows to the front without revealing which rows they were, keeping their order.
+    void compact(int msgTagBase);
+
+    int compactTagStride();
+
+    static int compactTagStride(size_t rows);
+
     void addRedundantCols();
 
     std::vector<int64_t> groupBy(const std::string &groupField, int msgTagBase);
@@ -90,7 +107,30 @@ public:
 
     int distinctTagStride();
 
+    // Splits [0, count) into BATCH_SIZE chunks run on the thread pool, chunk b using tag msgTagBase + stride * b.
+    // Runs a single chunk inline when multi-threading is off.
+    static void forEachBatch(size_t count, int stride, int msgTagBase,
+                             const std::function<void(size_t, size_t, int)> &work);
+
 private:
+    void compact(const std::vector<int64_t> &validArith, int msgTagBase);
+
+    static int compactDistWidth(size_t n);
+
+    void permuteRows(int owner, int msgTagBase);
+
+    [[nodiscard]] int shuffleSortKeyWidth(const std::vector<std::string> &orderFields) const;
+
+    void shuffleSort(const std::vector<std::string> &orderFields, const std::vector<bool> &ascendingOrders,
+                     int msgTagBase);
+
+    // Shares of "row xIdx[t] orders before row yIdx[t]" over all order fields, for t in [start, end).
+    // The per-field comparisons run side by side before being folded from the first field on.
+    std::vector<int64_t> lexicographicLess(const std::vector<int> &orderFieldIndices,
+                                           const std::vector<bool> &ascendingOrders,
+                                           const std::vector<int64_t> &xIdx, const std::vector<int64_t> &yIdx,
+                                           size_t start, size_t end, int msgTagBase);
+
     void bitonicSortSingleBatch(const std::string &orderField, bool ascendingOrder, int msgTagBase);
 
     void bitonicSortMultiBatches(const std::string &orderField, bool ascendingOrder, int msgTagBase);
@@ -120,33 +160,15 @@ private:
 
     std::vector<int64_t> groupByMultiBatches(const std::vector<std::string> &groupFields, int msgTagBase);
 
-    void countSingleBatch(std::vector<int64_t> &heads, std::string alias, int msgTagBase, std::string matchedTable,
-                          bool compress);
-
-    void countMultiBatches(std::vector<int64_t> &heads, std::string alias, int msgTagBase, std::string matchedTable,
-                           bool compress);
-
-    void maxSingleBatch(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase);
-
-    void maxMultiBatches(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase);
-
-    void minSingleBatch(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase);
-
-    void minMultiBatches(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase);
-
-    void minAndMaxSingleBatch(std::vector<int64_t> &heads,
-                              const std::string &minFieldName,
-                              const std::string &maxFieldName,
-                              std::string minAlias,
-                              std::string maxAlias,
-                              int msgTagBase);
+    // Scans every field with its op inside the groups given by heads and appends the results as outNames
+    void scanAggregate(std::vector<int64_t> &heads, const std::vector<std::string> &fieldNames,
+                       const std::vector<SegmentedScan::CombineOp> &ops, const std::vector<std::string> &outNames,
+                       int msgTagBase);
 
-    void minAndMaxMultiBatches(std::vector<int64_t> &heads,
-                               const std::string &minFieldName,
-                               const std::string &maxFieldName,
-                               std::string minAlias,
-                               std::string maxAlias,
-                               int msgTagBase);
+    // Appends the scanned aggregates and keeps only the last row of every group valid
+    void appendAggregates(std::vector<int64_t> &heads, const std::vector<std::string> &outNames,
+                          const std::vector<int> &outWidths, std::vector<std::vector<int64_t> > &aggregates,
+                          bool compress, int msgTagBase);
 };
 
 
@@ -1,9 +1,11 @@
 
 #ifndef VIEWS_H
 #define VIEWS_H
+#include "Table.h"
 #include "View.h"
 
 
+#include <functional>
 #include <string>
 
 class Views {
@@ -14,15 +16,36 @@ public:
 
     static View selectColumns(Table &t, std::vector<std::string> &fieldNames);
 
+    static View selectColumns(View &v, std::vector<std::string> &fieldNames);
+
     
     static View nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress);
 
     static View nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1);
 
+    static View nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                               int msgTagBase);
+
+    // Message tags used by nestedLoopJoin on inputs of rows0 and rows1 rows
+    static int nestedLoopJoinTagStride(size_t rows0, size_t rows1, bool compress);
+
     static View hashJoin(View &v0, View &v1, std::string &field0, std::string &field1);
 
     static View hashJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress);
 
+    static View hashJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                         int msgTagBase);
+
+    // Primary key / foreign key join: field0 must be unique among the valid rows of v0, which is not checked.
+    // Both inputs are sorted together once and each key row is copied onto its matches, so at most v0 + v1
+    // rows come out.
+    static View sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress);
+
+    static View sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1);
+
+    static View sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                              int msgTagBase);
+
     static View leftOuterJoin(View &v0, View &v1, std::string &field0, std::string &field1);
 
     static View leftOuterJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool doHashJoin, bool compress);
@@ -31,26 +54,22 @@ public:
 
     static int64_t hash(int64_t keyValue);
 
+    // Semi-join on width-bit keys: bit i is set when col1[i] appears in col2. Sorts both columns together
+    // once and scans the runs of equal keys, O((n + m) log^2 (n + m)) instead of comparing every pair.
     static std::vector<int64_t> in(std::vector<int64_t> &col1,
                                    std::vector<int64_t> &col2,
                                    std::vector<int64_t> &left_valid,
-                                   std::vector<int64_t> &right_valid);
+                                   std::vector<int64_t> &right_valid,
+                                   int width);
 
     static void revealAndPrint(View &v);
 
 private:
-    static std::vector<int64_t> inSingleBatch(std::vector<int64_t> &col1,
-                                              std::vector<int64_t> &col2,
-                                              std::vector<int64_t> &left_valid,
-                                              std::vector<int64_t> &right_valid);
-
-    static std::vector<int64_t> inMultiBatches(std::vector<int64_t> &col1,
-                                               std::vector<int64_t> &col2,
-                                               std::vector<int64_t> &left_valid,
-                                               std::vector<int64_t> &right_valid);
-
     static void addRedundantCols(View &v);
 
+    static View selectColumns(Relation &r, std::vector<std::string> &fieldNames,
+                              const std::function<std::vector<int64_t>(size_t)> &column);
+
     static std::vector<std::vector<std::vector<int64_t>>> butterflyPermutation(
         View &view,
         int tagColIndex,
@@ -64,7 +83,8 @@ private:
         View &v1,
         std::string &field0,
         std::string &field1,
-        bool compress
+        bool compress,
+        int msgTagBase
     );
 
     static int butterflyPermutationTagStride(View &v);
@@ -5,18 +5,36 @@
 #include "conf/Conf.h"
 #include "utils/Log.h"
 
+#include <stdexcept>
+
 class DbConf {
 public:
     inline static bool ENABLE_HASH_JOIN = true;
+    // Joins on the primary key of the left table use Views::sortMergeJoin. Off by default: keys are not
+    // checked for uniqueness on insert, and a duplicate key drops the matches of all but one of its rows.
+    inline static bool ENABLE_SORT_MERGE_JOIN = false;
     inline static int SHUFFLE_BUCKET_NUM = 32;
     inline static bool DISABLE_PRECISE_COMPACTION = true;
     inline static bool BASELINE_MODE = false;
     inline static bool NO_COMPACTION = false;
+    // Rows shared per round trip by INSERT and COPY
+    inline static int INSERT_CHUNK_ROWS = 1 << 16;
+
+    enum SortT {
+        BITONIC_SORT,
+        // Oblivious shuffle, then a quicksort that opens its comparisons
+        SHUFFLE_SORT
+    };
+
+    inline static SortT SORT_METHOD = BITONIC_SORT;
 
     static void init() {
         if (Conf::_userParams.count("enable_hash_join")) {
             ENABLE_HASH_JOIN = Conf::_userParams["enable_hash_join"] == "true";
         }
+        if (Conf::_userParams.count("enable_sort_merge_join")) {
+            ENABLE_SORT_MERGE_JOIN = Conf::_userParams["enable_sort_merge_join"] == "true";
+        }
         if (Conf::_userParams.count("shuffle_bucket_num")) {
             SHUFFLE_BUCKET_NUM = std::stoi(Conf::_userParams["shuffle_bucket_num"]);
         }
@@ -29,6 +47,22 @@ public:
         if (Conf::_userParams.count("disable_precise_compaction")) {
             DISABLE_PRECISE_COMPACTION = Conf::_userParams["disable_precise_compaction"] == "true";
         }
+        if (Conf::_userParams.count("insert_chunk_rows")) {
+            INSERT_CHUNK_ROWS = std::stoi(Conf::_userParams["insert_chunk_rows"]);
+            if (INSERT_CHUNK_ROWS <= 0) {
+                throw std::runtime_error("insert_chunk_rows must be positive.");
+            }
+        }
+        if (Conf::_userParams.count("sort_method")) {
+            const auto &method = Conf::_userParams["sort_method"];
+            if (method == "bitonic") {
+                SORT_METHOD = BITONIC_SORT;
+            } else if (method == "shuffle") {
+                SORT_METHOD = SHUFFLE_SORT;
+            } else {
+                throw std::runtime_error("Unknown sort_method value.");
+            }
+        }
 
         if (BASELINE_MODE) {
             NO_COMPACTION = true;
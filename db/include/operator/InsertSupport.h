@@ -1,16 +1,67 @@
-
 #ifndef INSERT_H
 #define INSERT_H
 #include <sstream>
+#include "../basis/Table.h"
 #include "../third_party/json.hpp"
+#include "../third_party/hsql/sql/InsertStatement.h"
 #include "../third_party/hsql/sql/SQLStatement.h"
 
+#include <string>
+#include <vector>
+
 
+// Every insert streams rows to the servers in column-major chunks of DbConf::INSERT_CHUNK_ROWS:
+// the client sends the chunk's row count, then shares the whole chunk with one Secrets::boolShare.
+// A row count of 0 ends the stream, and the servers acknowledge once.
 class InsertSupport {
 public:
     static bool clientInsert(std::ostringstream &resp, const hsql::SQLStatement *stmt);
 
+    // INSERT ... VALUES (...), (...), which the SQL parser only accepts with one row
+    static bool isMultiRowInsert(const std::string &command);
+
+    static bool clientMultiRowInsert(std::ostringstream &resp, const std::string &command);
+
+    // COPY table FROM 'file.csv' (read on the client). An optional header line names the columns.
+    static bool clientCopy(std::ostringstream &resp, const hsql::SQLStatement *stmt);
+
     static void serverInsert(nlohmann::basic_json<> j);
+
+private:
+    class RowStream {
+    public:
+        explicit RowStream(Table *table);
+
+        void add(const std::vector<int64_t> &row);
+
+        // Drops the rows not sent yet
+        void discard();
+
+        // Sends the remaining rows and the end of the stream, then waits for both servers
+        void finish();
+
+        [[nodiscard]] int64_t rows() const;
+
+    private:
+        void flush();
+
+        Table *_table;
+        std::vector<std::vector<int64_t> > _cols;
+        int64_t _rows = 0;
+    };
+
+    static Table *findTable(std::ostringstream &resp, const std::string &tableName);
+
+    // Validates the inserted columns. Empty names means all columns in table order.
+    static bool resolveColumns(std::ostringstream &resp, const Table *table, const std::vector<std::string> &names,
+                               std::vector<std::string> &cols);
+
+    // Checks widths and builds the full table row, including the bucket tag of the key
+    static bool buildRow(std::ostringstream &resp, const Table *table, const std::vector<std::string> &cols,
+                         const std::vector<int64_t> &values, std::vector<int64_t> &row);
+
+    static bool parseValues(std::ostringstream &resp, const hsql::InsertStatement *insertStmt,
+                            std::vector<int64_t> &values);
 };
 
 
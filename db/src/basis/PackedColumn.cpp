@@ -0,0 +1,111 @@
+#include "basis/PackedColumn.h"
+
+#include <algorithm>
+
+PackedColumn::PackedColumn(int width) : _width(width >= 1 && width <= 64 ? width : 64) {
+}
+
+void PackedColumn::append(const int64_t *values, size_t count) {
+    if (_width == 1) {
+        _bits.resize((_size + count + 63) / 64);
+        for (size_t i = 0; i < count; i++) {
+            size_t r = _size + i;
+            _bits[r / 64] |= static_cast<uint64_t>(values[i] & 1) << (r % 64);
+        }
+    } else if (_width <= 8) {
+        auto mask = static_cast<uint8_t>((1 << _width) - 1);
+        for (size_t i = 0; i < count; i++) {
+            _u8.push_back(static_cast<uint8_t>(values[i]) & mask);
+        }
+    } else if (_width <= 16) {
+        auto mask = static_cast<uint16_t>((1 << _width) - 1);
+        for (size_t i = 0; i < count; i++) {
+            _u16.push_back(static_cast<uint16_t>(values[i]) & mask);
+        }
+    } else if (_width <= 32) {
+        auto mask = static_cast<uint32_t>((1ULL << _width) - 1);
+        for (size_t i = 0; i < count; i++) {
+            _u32.push_back(static_cast<uint32_t>(values[i]) & mask);
+        }
+    } else {
+        uint64_t mask = _width == 64 ? ~0ULL : (1ULL << _width) - 1;
+        for (size_t i = 0; i < count; i++) {
+            _i64.push_back(static_cast<int64_t>(static_cast<uint64_t>(values[i]) & mask));
+        }
+    }
+    _size += count;
+}
+
+void PackedColumn::reserve(size_t count) {
+    if (_width == 1) {
+        _bits.reserve((count + 63) / 64);
+    } else if (_width <= 8) {
+        _u8.reserve(count);
+    } else if (_width <= 16) {
+        _u16.reserve(count);
+    } else if (_width <= 32) {
+        _u32.reserve(count);
+    } else {
+        _i64.reserve(count);
+    }
+}
+
+int64_t PackedColumn::get(size_t i) const {
+    if (_width == 1) {
+        return static_cast<int64_t>((_bits[i / 64] >> (i % 64)) & 1);
+    }
+    if (_width <= 8) {
+        return _u8[i];
+    }
+    if (_width <= 16) {
+        return _u16[i];
+    }
+    if (_width <= 32) {
+        return _u32[i];
+    }
+    return _i64[i];
+}
+
+std::vector<int64_t> PackedColumn::unpack() const {
+    if (_width > 32) {
+        return _i64;
+    }
+    std::vector<int64_t> out(_size);
+    if (_width == 1) {
+        for (size_t i = 0; i < _size; i++) {
+            out[i] = static_cast<int64_t>((_bits[i / 64] >> (i % 64)) & 1);
+        }
+    } else if (_width <= 8) {
+        std::copy(_u8.begin(), _u8.end(), out.begin());
+    } else if (_width <= 16) {
+        std::copy(_u16.begin(), _u16.end(), out.begin());
+    } else {
+        std::copy(_u32.begin(), _u32.end(), out.begin());
+    }
+    return out;
+}
+
+size_t PackedColumn::size() const {
+    return _size;
+}
+
+size_t PackedColumn::capacity() const {
+    if (_width == 1) {
+        return _bits.capacity() * 64;
+    }
+    if (_width <= 8) {
+        return _u8.capacity();
+    }
+    if (_width <= 16) {
+        return _u16.capacity();
+    }
+    if (_width <= 32) {
+        return _u32.capacity();
+    }
+    return _i64.capacity();
+}
+
+size_t PackedColumn::bytes() const {
+    return _bits.size() * sizeof(uint64_t) + _u8.size() + _u16.size() * sizeof(uint16_t) +
+           _u32.size() * sizeof(uint32_t) + _i64.size() * sizeof(int64_t);
+}
@@ -0,0 +1,45 @@
+
+#include <algorithm>
+#include <string>
+
+#include "../../include/basis/Relation.h"
+
+
+Relation::Relation(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths,
+                   std::string keyField) {
+    this->_tableName = tableName;
+    this->_fieldNames = fieldNames;
+    this->_fieldWidths = fieldWidths;
+    this->_keyField = keyField;
+
+    if (!this->_keyField.empty()) {
+        this->_fieldNames.push_back(BUCKET_TAG_PREFIX + _keyField);
+        this->_fieldWidths.push_back(32);
+    }
+
+    for (auto w: this->_fieldWidths) {
+        _maxWidth = std::max(w, _maxWidth);
+    }
+
+    _dataCols.resize(_fieldNames.size(), {});
+}
+
+int Relation::colIndex(const std::string &colName) const {
+    for (int i = 0; i < _dataCols.size(); i++) {
+        if (_fieldNames[i] == colName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t Relation::colNum() const {
+    return _dataCols.size();
+}
+
+size_t Relation::rowNum() const {
+    if (_dataCols.empty()) {
+        return 0;
+    }
+    return _dataCols[0].size();
+}
@@ -0,0 +1,248 @@
+#include "../../include/basis/SegmentedScan.h"
+
+#include <memory>
+#include <stdexcept>
+
+#include "../../include/basis/View.h"
+#include "comm/Comm.h"
+#include "compute/batch/arith/ArithMultiplyBatchOperator.h"
+#include "compute/batch/bool/BoolAndBatchOperator.h"
+#include "compute/batch/bool/BoolLessBatchOperator.h"
+#include "compute/batch/bool/BoolMutexBatchOperator.h"
+#include "compute/batch/bool/BoolRoundFusion.h"
+#include "compute/batch/bool/BoolToArithBatchOperator.h"
+#include "conf/Conf.h"
+
+SegmentedScan::SegmentedScan(const std::vector<int64_t> &heads) : _flags(heads) {
+}
+
+SegmentedScan &SegmentedScan::add(std::vector<int64_t> *values, CombineOp op, int width) {
+    if (values->size() != _flags.size()) {
+        throw std::runtime_error("Segmented scan column and head flags differ in size.");
+    }
+    _lanes.push_back({values, op, op == SUM ? 64 : width});
+    return *this;
+}
+
+bool SegmentedScan::hasBoolLanes() const {
+    for (auto &lane: _lanes) {
+        if (lane._op != SUM) return true;
+    }
+    return false;
+}
+
+bool SegmentedScan::hasArithLanes() const {
+    for (auto &lane: _lanes) {
+        if (lane._op == SUM) return true;
+    }
+    return false;
+}
+
+int SegmentedScan::combineTagStride() const {
+    int compares = 0, mutexes = 0;
+    for (auto &lane: _lanes) {
+        if (lane._op == MAX || lane._op == MIN) {
+            compares++;
+            mutexes++;
+        } else if (lane._op == FIRST) {
+            mutexes++;
+        }
+    }
+    int stride = compares * BoolLessBatchOperator::tagStride() + (compares + 1) * BoolAndBatchOperator::tagStride() +
+                 mutexes * BoolMutexBatchOperator::tagStride();
+    if (hasArithLanes()) {
+        stride += ArithMultiplyBatchOperator::tagStride(64);
+    }
+    return stride;
+}
+
+void SegmentedScan::execute(int msgTagBase) {
+    const size_t n = _flags.size();
+    if (Comm::isClient() || n <= 1 || _lanes.empty()) {
+        return;
+    }
+
+    if (hasArithLanes()) {
+        _arithFlags.resize(n);
+        View::forEachBatch(n, BoolToArithBatchOperator::tagStride(), msgTagBase, [&](size_t start, size_t end, int tag) {
+            std::vector<int64_t> part(_flags.begin() + static_cast<int64_t>(start),
+                                      _flags.begin() + static_cast<int64_t>(end));
+            auto arith = BoolToArithBatchOperator(&part, 1, 64, 0, tag,
+                                                  SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+            std::copy(arith.begin(), arith.end(), _arithFlags.begin() + static_cast<int64_t>(start));
+        });
+    }
+
+    // Up-sweep: row k with k + 1 a multiple of 2d gathers the rows (k - 2d, k]
+    size_t top = 1;
+    while (top * 2 <= n) top *= 2;
+    std::vector<size_t> rights;
+    for (size_t d = 1; d * 2 <= n; d <<= 1) {
+        rights.clear();
+        for (size_t k = 2 * d - 1; k < n; k += 2 * d) rights.push_back(k);
+        runLevel(rights, d, msgTagBase);
+    }
+
+    // Down-sweep: rows ending a full prefix pass it on to the partial block d rows further
+    for (size_t d = top >> 1; d > 0; d >>= 1) {
+        rights.clear();
+        for (size_t k = 3 * d - 1; k < n; k += 2 * d) rights.push_back(k);
+        runLevel(rights, d, msgTagBase);
+    }
+}
+
+void SegmentedScan::runLevel(const std::vector<size_t> &rights, size_t d, int msgTagBase) {
+    if (rights.empty()) {
+        return;
+    }
+    // Rows written in one level are never read in it, so the batches run side by side
+    View::forEachBatch(rights.size(), combineTagStride(), msgTagBase, [&](size_t start, size_t end, int tag) {
+        combine(rights, d, start, end, tag);
+    });
+}
+
+void SegmentedScan::combine(const std::vector<size_t> &rights, size_t d, size_t start, size_t end, int msgTagBase) {
+    std::vector<size_t> ls, rs(rights.begin() + static_cast<int64_t>(start),
+                               rights.begin() + static_cast<int64_t>(end));
+    ls.reserve(rs.size());
+    for (size_t k: rs) ls.push_back(k - d);
+
+    int tag = msgTagBase;
+    if (hasBoolLanes()) {
+        combineBool(ls, rs, tag);
+        tag += combineTagStride() - (hasArithLanes() ? ArithMultiplyBatchOperator::tagStride(64) : 0);
+    }
+    if (hasArithLanes()) {
+        combineArith(ls, rs, tag);
+    }
+}
+
+// (fl, vl) + (fr, vr) = (fl | fr, fr ? vr : vl op vr)
+void SegmentedScan::combineBool(const std::vector<size_t> &lefts, const std::vector<size_t> &rights, int msgTagBase) {
+    const size_t m = rights.size();
+    const size_t laneNum = _lanes.size();
+    const int64_t rank = Comm::rank();
+    int tag = msgTagBase;
+
+    std::vector<std::vector<int64_t> > lv(laneNum), rv(laneNum);
+    for (size_t i = 0; i < laneNum; ++i) {
+        if (_lanes[i]._op == SUM) continue;
+        auto &values = *_lanes[i]._values;
+        lv[i].resize(m);
+        rv[i].resize(m);
+        for (size_t t = 0; t < m; ++t) {
+            lv[i][t] = values[lefts[t]];
+            rv[i][t] = values[rights[t]];
+        }
+    }
+
+    // Whether the right value wins the comparison, for all MAX and MIN lanes at once
+    std::vector<std::unique_ptr<BoolLessBatchOperator> > lessOps(laneNum);
+    std::vector<FusableRounds *> fusable;
+    for (size_t i = 0; i < laneNum; ++i) {
+        if (_lanes[i]._op == MAX) {
+            lessOps[i] = std::make_unique<BoolLessBatchOperator>(&lv[i], &rv[i], _lanes[i]._width, 0, tag,
+                                                                 SecureOperator::NO_CLIENT_COMPUTE);
+        } else if (_lanes[i]._op == MIN) {
+            lessOps[i] = std::make_unique<BoolLessBatchOperator>(&rv[i], &lv[i], _lanes[i]._width, 0, tag,
+                                                                 SecureOperator::NO_CLIENT_COMPUTE);
+        } else {
+            continue;
+        }
+        fusable.push_back(lessOps[i].get());
+        tag += BoolLessBatchOperator::tagStride();
+    }
+    BoolRoundFusion::run(fusable);
+
+    // One round for the new flags, the selectors fr | (right wins) and the FIRST lanes
+    std::vector<int64_t> notLeftFlags(m), rightFlags(m), notRightFlags(m);
+    for (size_t t = 0; t < m; ++t) {
+        notLeftFlags[t] = _flags[lefts[t]] ^ rank;
+        rightFlags[t] = _flags[rights[t]];
+        notRightFlags[t] = rightFlags[t] ^ rank;
+    }
+    BoolRoundFusion fusion;
+    BoolAndBatchOperator flagsAnd(&notLeftFlags, &notRightFlags, 1, 0, tag, SecureOperator::NO_CLIENT_COMPUTE);
+    tag += BoolAndBatchOperator::tagStride();
+    fusion.add(&flagsAnd);
+
+    std::vector<std::vector<int64_t> > notWins(laneNum);
+    std::vector<std::unique_ptr<BoolAndBatchOperator> > selectAnds(laneNum);
+    std::vector<std::unique_ptr<BoolMutexBatchOperator> > mutexes(laneNum);
+    for (size_t i = 0; i < laneNum; ++i) {
+        if (lessOps[i]) {
+            notWins[i] = std::move(lessOps[i]->_zis);
+            for (auto &w: notWins[i]) w ^= rank;
+            selectAnds[i] = std::make_unique<BoolAndBatchOperator>(&notRightFlags, &notWins[i], 1, 0, tag,
+                                                                   SecureOperator::NO_CLIENT_COMPUTE);
+            tag += BoolAndBatchOperator::tagStride();
+            fusion.add(selectAnds[i].get());
+        } else if (_lanes[i]._op == FIRST) {
+            mutexes[i] = std::make_unique<BoolMutexBatchOperator>(&rv[i], &lv[i], &rightFlags, _lanes[i]._width, 0,
+                                                                  tag, SecureOperator::NO_CLIENT_COMPUTE);
+            tag += BoolMutexBatchOperator::tagStride();
+            fusion.add(mutexes[i].get());
+        }
+    }
+    fusion.execute();
+
+    // MAX and MIN lanes keep the right value when it starts a segment or wins
+    std::vector<std::vector<int64_t> > selects(laneNum);
+    BoolRoundFusion selectFusion;
+    for (size_t i = 0; i < laneNum; ++i) {
+        if (!selectAnds[i]) continue;
+        selects[i] = std::move(selectAnds[i]->_zis);
+        for (auto &s: selects[i]) s ^= rank;
+        mutexes[i] = std::make_unique<BoolMutexBatchOperator>(&rv[i], &lv[i], &selects[i], _lanes[i]._width, 0, tag,
+                                                              SecureOperator::NO_CLIENT_COMPUTE);
+        tag += BoolMutexBatchOperator::tagStride();
+        selectFusion.add(mutexes[i].get());
+    }
+    selectFusion.execute();
+
+    for (size_t i = 0; i < laneNum; ++i) {
+        if (_lanes[i]._op == SUM || _lanes[i]._op == LAST) continue;
+        auto &values = *_lanes[i]._values;
+        auto &out = mutexes[i]->_zis;
+        for (size_t t = 0; t < m; ++t) values[rights[t]] = out[t];
+    }
+    for (size_t t = 0; t < m; ++t) {
+        _flags[rights[t]] = flagsAnd._zis[t] ^ rank;
+    }
+}
+
+// (fl, vl) + (fr, vr) = (fl + fr - fl * fr, vr + vl * (1 - fr)) over arithmetic shares
+void SegmentedScan::combineArith(const std::vector<size_t> &lefts, const std::vector<size_t> &rights, int msgTagBase) {
+    const size_t m = rights.size();
+    const int64_t rank = Comm::rank();
+
+    std::vector<int64_t> xs, ys;
+    xs.reserve((_lanes.size() + 1) * m);
+    ys.reserve((_lanes.size() + 1) * m);
+    for (auto &lane: _lanes) {
+        if (lane._op != SUM) continue;
+        auto &values = *lane._values;
+        for (size_t t = 0; t < m; ++t) {
+            xs.push_back(values[lefts[t]]);
+            ys.push_back(rank - _arithFlags[rights[t]]);
+        }
+    }
+    for (size_t t = 0; t < m; ++t) {
+        xs.push_back(_arithFlags[lefts[t]]);
+        ys.push_back(_arithFlags[rights[t]]);
+    }
+    auto products = ArithMultiplyBatchOperator(&xs, &ys, 64, 0, msgTagBase,
+                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+
+    size_t offset = 0;
+    for (auto &lane: _lanes) {
+        if (lane._op != SUM) continue;
+        auto &values = *lane._values;
+        for (size_t t = 0; t < m; ++t) values[rights[t]] += products[offset + t];
+        offset += m;
+    }
+    for (size_t t = 0; t < m; ++t) {
+        const size_t l = lefts[t], r = rights[t];
+        _arithFlags[r] = _arithFlags[l] + _arithFlags[r] - products[offset + t];
+    }
+}
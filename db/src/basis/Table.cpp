@@ -11,22 +11,11 @@
 
 
 Table::Table(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths,
-             std::string keyField) {
-    this->_tableName = tableName;
-    this->_fieldNames = fieldNames;
-    this->_fieldWidths = fieldWidths;
-    this->_keyField = keyField;
-
-    if (!this->_keyField.empty()) {
-        this->_fieldNames.push_back(BUCKET_TAG_PREFIX + _keyField);
-        this->_fieldWidths.push_back(32);
+             std::string keyField) : Relation(tableName, fieldNames, fieldWidths, std::move(keyField)) {
+    _packedCols.reserve(_fieldWidths.size());
+    for (auto w: _fieldWidths) {
+        _packedCols.emplace_back(w);
     }
-
-    for (auto w: this->_fieldWidths) {
-        _maxWidth = std::max(w, _maxWidth);
-    }
-
-    _dataCols.resize(_fieldNames.size(), {});
 }
 
 bool Table::insert(const std::vector<int64_t> &r) {
@@ -36,27 +25,34 @@ bool Table::insert(const std::vector<int64_t> &r) {
             std::to_string(r.size()));
     }
     for (int i = 0; i < r.size(); i++) {
-        _dataCols[i].push_back(r[i]);
+        _packedCols[i].append(&r[i], 1);
     }
     return true;
 }
 
-int Table::colIndex(const std::string &colName) const {
-    for (int i = 0; i < _dataCols.size(); i++) {
-        if (_fieldNames[i] == colName) {
-            return i;
+void Table::insertColumns(const std::vector<int64_t> &colMajor, size_t rows) {
+    if (colMajor.size() != rows * colNum()) {
+        throw std::runtime_error(
+            "Table::insertColumns: expected " + std::to_string(rows * colNum()) + " values, got " +
+            std::to_string(colMajor.size()));
+    }
+    for (size_t i = 0; i < colNum(); i++) {
+        auto &col = _packedCols[i];
+        size_t needed = col.size() + rows;
+        if (needed > col.capacity()) {
+            col.reserve(std::max(needed, 2 * col.capacity()));
         }
+        col.append(colMajor.data() + i * rows, rows);
     }
-    return -1;
 }
 
-size_t Table::colNum() const {
-    return _dataCols.size();
+std::vector<int64_t> Table::column(size_t i) const {
+    return _packedCols[i].unpack();
 }
 
 size_t Table::rowNum() const {
-    if (_dataCols.empty()) {
+    if (_packedCols.empty()) {
         return 0;
     }
-    return _dataCols[0].size();
+    return _packedCols[0].size();
 }
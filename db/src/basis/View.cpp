@@ -1,17 +1,21 @@
 
 #include "../../include/basis/View.h"
 
+#include <functional>
+#include <memory>
 #include <numeric>
 
 #include "compute/batch/bool/BoolAndBatchOperator.h"
 #include "compute/batch/bool/BoolEqualBatchOperator.h"
 #include "compute/batch/bool/BoolLessBatchOperator.h"
 #include "compute/batch/bool/BoolMutexBatchOperator.h"
+#include "compute/batch/bool/BoolRoundFusion.h"
 #include "compute/batch/bool/BoolToArithBatchOperator.h"
 #include "compute/batch/arith/ArithMutexBatchOperator.h"
 #include "compute/batch/arith/ArithMultiplyBatchOperator.h"
 #include "parallel/ThreadPoolSupport.h"
 #include "secret/Secrets.h"
+#include "utils/Crypto.h"
 #include "utils/Log.h"
 #include "comm/Comm.h"
 
@@ -22,18 +26,18 @@
 #include "utils/StringUtils.h"
 
 View::View(std::vector<std::string> &fieldNames,
-           std::vector<int> &fieldWidths) : Table(
+           std::vector<int> &fieldWidths) : Relation(
     EMPTY_VIEW_NAME, fieldNames, fieldWidths, EMPTY_KEY_FIELD) {
     addRedundantCols();
 }
 
-View::View(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths) : Table(
+View::View(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths) : Relation(
     tableName, fieldNames, fieldWidths, EMPTY_KEY_FIELD) {
     addRedundantCols();
 }
 
 View::View(std::string &tableName, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths,
-           bool dummy) : Table(
+           bool dummy) : Relation(
     tableName, fieldNames, fieldWidths, EMPTY_KEY_FIELD) {
 }
 
@@ -92,6 +96,10 @@ void View::sort(const std::string &orderField, bool ascendingOrder, int msgTagBa
     if (n == 0) {
         return;
     }
+    if (DbConf::SORT_METHOD == DbConf::SHUFFLE_SORT && shuffleSortKeyWidth({orderField}) <= 64) {
+        shuffleSort({orderField}, {ascendingOrder}, msgTagBase);
+        return;
+    }
     bool isPowerOf2 = (n > 0) && ((n & (n - 1)) == 0);
     if (!isPowerOf2) {
         size_t nextPow2 = static_cast<size_t>(1) <<
@@ -270,26 +278,26 @@ std::vector<int64_t> View::groupBySingleBatch(const std::vector<std::string> &gr
 
     std::vector<int64_t> eq_all;
     if (n > 1) {
-        {
-            std::vector<int64_t> cur(n - 1), prv(n - 1);
+        // The per-field equalities are independent and share their AND rounds
+        std::vector<std::vector<int64_t> > cur(idx.size(), std::vector<int64_t>(n - 1));
+        std::vector<std::vector<int64_t> > prv(idx.size(), std::vector<int64_t>(n - 1));
+        std::vector<std::unique_ptr<BoolEqualBatchOperator> > equals;
+        std::vector<FusableRounds *> ops;
+        for (size_t k = 0; k < idx.size(); ++k) {
             for (size_t i = 1; i < n; ++i) {
-                cur[i - 1] = _dataCols[idx[0]][i];
-                prv[i - 1] = _dataCols[idx[0]][i - 1];
+                cur[k][i - 1] = _dataCols[idx[k]][i];
+                prv[k][i - 1] = _dataCols[idx[k]][i - 1];
             }
-            eq_all = BoolEqualBatchOperator(&cur, &prv, _fieldWidths[idx[0]],
-                                            0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+            equals.push_back(std::make_unique<BoolEqualBatchOperator>(&cur[k], &prv[k], _fieldWidths[idx[k]],
+                                                                      0, msgTagBase,
+                                                                      SecureOperator::NO_CLIENT_COMPUTE));
+            ops.push_back(equals.back().get());
         }
+        BoolRoundFusion::run(ops);
+
+        eq_all = std::move(equals[0]->_zis);
         for (size_t k = 1; k < idx.size(); ++k) {
-            std::vector<int64_t> cur(n - 1), prv(n - 1);
-            for (size_t i = 1; i < n; ++i) {
-                cur[i - 1] = _dataCols[idx[k]][i];
-                prv[i - 1] = _dataCols[idx[k]][i - 1];
-            }
-            auto eq_k = BoolEqualBatchOperator(&cur, &prv, _fieldWidths[idx[k]],
-                                               0, msgTagBase,
-                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            eq_all = BoolAndBatchOperator(&eq_all, &eq_k, 1,
+            eq_all = BoolAndBatchOperator(&eq_all, &equals[k]->_zis, 1,
                                           0, msgTagBase,
                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
         }
@@ -407,1064 +415,41 @@ std::vector<int64_t> View::groupByMultiBatches(const std::vector<std::string> &g
 
     if (!DbConf::DISABLE_PRECISE_COMPACTION) {
         groupHeads[0] = Comm::rank();
-        for (size_t i = 1; i < n; ++i) {
-            groupHeads[i] = (i - 1 < eq_all.size()) ? (eq_all[i - 1] ^ NOT_mask) : Comm::rank();
-        }
-    } else {
-        const int validColIndex = colNum() + VALID_COL_OFFSET;
-        auto &validCol = _dataCols[validColIndex];
-
-        groupHeads[0] = (n > 0 ? validCol[0] : 0);
-
-        if (n > 1) {
-            std::vector<int64_t> neq(eq_all.size());
-            for (size_t j = 0; j < eq_all.size(); ++j) neq[j] = eq_all[j] ^ NOT_mask;
-
-            std::vector<int64_t> valid_tail(eq_all.size());
-            for (size_t j = 0; j < eq_all.size(); ++j) valid_tail[j] = validCol[j + 1];
-
-            auto tail_heads = BoolAndBatchOperator(
-                &valid_tail, &neq, 1,
-                0, msgTagBase,
-                SecureOperator::NO_CLIENT_COMPUTE
-            ).execute()->_zis;
-
-            for (size_t i = 1; i < n; ++i) {
-                groupHeads[i] = tail_heads[i - 1];
-            }
-        }
-    }
-
-    return groupHeads;
-}
-
-void View::countSingleBatch(std::vector<int64_t> &heads, std::string alias, int msgTagBase, std::string matchedTable,
-                            bool compress) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const bool BASELINE = DbConf::BASELINE_MODE;
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const int validIdx = colNum() + VALID_COL_OFFSET;
-    const int64_t rank = Comm::rank();
-
-    std::vector<int64_t> bs_bool = heads;
-
-    if (BASELINE || APPROX_COMPACT) {
-        bs_bool = BoolAndBatchOperator(&bs_bool, &_dataCols[validIdx], 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    std::vector<int64_t> counts(n, 0);
-    if (BASELINE || APPROX_COMPACT) {
-        counts = _dataCols[validIdx];
-        if (!matchedTable.empty()) {
-            counts = BoolAndBatchOperator(&counts, &_dataCols[colIndex(OUTER_MATCH_PREFIX + matchedTable)], 1, 0,
-                                          msgTagBase, SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        }
-    } else {
-        for (size_t i = 0; i < n; ++i) {
-            counts[i] = rank;
-        }
-    }
-
-    auto counts_arith = BoolToArithBatchOperator(&counts, 64, 0, msgTagBase,
-                                                 SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-    auto bs_arith = BoolToArithBatchOperator(&bs_bool, 64, 0, msgTagBase,
-                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int m = static_cast<int>(n) - delta;
-        if (m <= 0) break;
-
-        std::vector<int64_t> propagate_mask(m);
-        for (int i = 0; i < m; ++i) {
-            propagate_mask[i] = rank - bs_arith[i + delta];
-        }
-
-        std::vector<int64_t> add_values(m);
-        for (int i = 0; i < m; ++i) {
-            add_values[i] = counts_arith[i];
-        }
-
-        auto increments = ArithMultiplyBatchOperator(&propagate_mask, &add_values, 64, 0, msgTagBase,
-                                                     SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        for (int i = 0; i < m; ++i) {
-            counts_arith[i + delta] += increments[i];
-        }
-
-        std::vector<int64_t> not_l(m), not_r(m);
-        for (int i = 0; i < m; ++i) {
-            not_l[i] = bs_bool[i] ^ rank;
-            not_r[i] = bs_bool[i + delta] ^ rank;
-        }
-        auto and_out = BoolAndBatchOperator(&not_l, &not_r, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (int i = 0; i < m; ++i) {
-            bs_bool[i + delta] = and_out[i] ^ rank;
-        }
-
-        bs_arith = BoolToArithBatchOperator(&bs_bool, 64, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    auto counts_bool = ArithToBoolBatchOperator(&counts_arith, 64, 0, msgTagBase,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) {
-        group_tails[i] = heads[i + 1];
-    }
-
-    if (BASELINE || APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) {
-            next_valid[i] = valid[i + 1];
-        }
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_next[i] = next_valid[i] ^ rank;
-        }
-        auto boundary = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_bd(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ rank;
-            not_bd[i] = boundary[i] ^ rank;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_bd, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) {
-            group_tails[i] = and_not[i] ^ rank;
-        }
-    } else {
-        group_tails[n - 1] = rank;
-    }
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, alias.empty() ? COUNT_COL_NAME : alias);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, 64);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(counts_bool));
-
-    const int newValidIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[newValidIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[newValidIdx] = std::move(new_valid);
-    } else if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[newValidIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[newValidIdx] = std::move(new_valid);
-        if (compress) {
-            clearInvalidEntries(msgTagBase);
-        }
-    } else {
-        _dataCols[newValidIdx] = std::move(group_tails);
-        if (compress) {
-            clearInvalidEntries(msgTagBase);
-        }
-    }
-}
-
-void View::countMultiBatches(std::vector<int64_t> &heads, std::string alias, int msgTagBase, std::string matchedTable,
-                             bool compress) {
-    size_t n = rowNum();
-    const int batchSize = Conf::BATCH_SIZE;
-    if (n == 0) return;
-    if (n <= static_cast<size_t>(batchSize)) {
-        countSingleBatch(heads, alias, msgTagBase, matchedTable, compress);
-        return;
-    }
-
-    const bool BASELINE = DbConf::BASELINE_MODE;
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const int validIdx = colNum() + VALID_COL_OFFSET;
-    const int64_t rank = Comm::rank();
-
-    std::vector<int64_t> bs_bool = heads;
-
-    if (BASELINE || APPROX_COMPACT) {
-        bs_bool = BoolAndBatchOperator(&bs_bool, &_dataCols[validIdx], 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    std::vector<int64_t> counts(n, 0);
-    if (BASELINE || APPROX_COMPACT) {
-        for (size_t i = 0; i < n; ++i) {
-            counts[i] = _dataCols[validIdx][i];
-        }
-    } else {
-        for (size_t i = 0; i < n; ++i) {
-            counts[i] = rank;
-        }
-    }
-
-    auto counts_arith = BoolToArithBatchOperator(&counts, 64, 0, msgTagBase,
-                                                 SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-    auto bs_arith = BoolToArithBatchOperator(&bs_bool, 64, 0, msgTagBase,
-                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-    const int mulStride = ArithMultiplyBatchOperator::tagStride(64);
-    const int andStride = BoolAndBatchOperator::tagStride();
-    const int b2aStride = BoolToArithBatchOperator::tagStride();
-    const int a2bStride = ArithToBoolBatchOperator::tagStride(64);
-    const int taskStride = mulStride + andStride + b2aStride;
-
-    int tagCursorBase = msgTagBase;
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int totalPairs = static_cast<int>(n) - delta;
-        if (totalPairs <= 0) break;
-
-        const int numBatches = (totalPairs + batchSize - 1) / batchSize;
-
-        using Triple = std::tuple<
-            std::vector<int64_t>,
-            std::vector<int64_t>,
-            std::vector<int64_t>
-        >;
-
-        std::vector<std::future<Triple> > futs(numBatches);
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-
-            const int baseTag = tagCursorBase + b * taskStride;
-            const int mulTag = baseTag;
-            const int andTag = baseTag + mulStride;
-            const int b2aTag = baseTag + mulStride + andStride;
-
-            futs[b] = ThreadPoolSupport::submit([=, &counts_arith, &bs_bool, &bs_arith]() -> Triple {
-                if (len <= 0) return Triple{{}, {}, {}};
-
-                std::vector<int64_t> propagate_mask(len);
-                for (int i = 0; i < len; ++i) {
-                    const int idx = start + i;
-                    propagate_mask[i] = rank - bs_arith[idx + delta];
-                }
-
-                std::vector<int64_t> add_values(len);
-                for (int i = 0; i < len; ++i) {
-                    const int idx = start + i;
-                    add_values[i] = counts_arith[idx];
-                }
-
-                auto increments = ArithMultiplyBatchOperator(&propagate_mask, &add_values, 64, 0, mulTag,
-                                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                std::vector<int64_t> not_left(len), not_right(len);
-                for (int i = 0; i < len; ++i) {
-                    const int idx = start + i;
-                    not_left[i] = bs_bool[idx] ^ rank;
-                    not_right[i] = bs_bool[idx + delta] ^ rank;
-                }
-                auto and_res = BoolAndBatchOperator(&not_left, &not_right, 1, 0, andTag,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                std::vector<int64_t> new_bs_bool(len);
-                for (int i = 0; i < len; ++i) {
-                    new_bs_bool[i] = and_res[i] ^ rank;
-                }
-
-                auto new_bs_arith = BoolToArithBatchOperator(&new_bs_bool, 64, 0, b2aTag,
-                                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                return Triple{std::move(increments), std::move(new_bs_bool), std::move(new_bs_arith)};
-            });
-        }
-
-        tagCursorBase += numBatches * taskStride;
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-            if (len <= 0) continue;
-
-            auto triple = futs[b].get();
-            auto &increments = std::get<0>(triple);
-            auto &new_b_bool = std::get<1>(triple);
-            auto &new_b_arith = std::get<2>(triple);
-
-            for (int i = 0; i < len; ++i) {
-                counts_arith[start + i + delta] += increments[i];
-                bs_bool[start + i + delta] = new_b_bool[i];
-                bs_arith[start + i + delta] = new_b_arith[i];
-            }
-        }
-    }
-
-    std::vector<int64_t> counts_bool; {
-        const int numBatches = (static_cast<int>(n) + batchSize - 1) / batchSize;
-        std::vector<std::future<std::vector<int64_t> > > futs(numBatches);
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, static_cast<int>(n));
-            const int len = end - start;
-
-            if (len <= 0) {
-                futs[b] = ThreadPoolSupport::submit([=]() { return std::vector<int64_t>(); });
-                continue;
-            }
-            auto slice = std::make_shared<std::vector<int64_t> >(counts_arith.begin() + start,
-                                                                 counts_arith.begin() + end);
-            const int tg = tagCursorBase + b * a2bStride;
-            futs[b] = ThreadPoolSupport::submit([slice, tg]() {
-                return ArithToBoolBatchOperator(slice.get(), 64, 0, tg,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            });
-        }
-        tagCursorBase += numBatches * a2bStride;
-
-        counts_bool.reserve(n);
-        for (int b = 0; b < numBatches; ++b) {
-            auto part = futs[b].get();
-            counts_bool.insert(counts_bool.end(), part.begin(), part.end());
-        }
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) {
-        group_tails[i] = heads[i + 1];
-    }
-
-    if (BASELINE || APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) {
-            next_valid[i] = valid[i + 1];
-        }
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_next[i] = next_valid[i] ^ rank;
-        }
-        auto boundary = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_bd(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ rank;
-            not_bd[i] = boundary[i] ^ rank;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_bd, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) {
-            group_tails[i] = and_not[i] ^ rank;
-        }
-    } else {
-        group_tails[n - 1] = rank;
-    }
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, alias.empty() ? COUNT_COL_NAME : alias);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, 64);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(counts_bool));
-
-    const int newValidIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[newValidIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[newValidIdx] = std::move(new_valid);
-    } else if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[newValidIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[newValidIdx] = std::move(new_valid);
-        if (compress) {
-            clearInvalidEntries(msgTagBase);
-        }
-    } else {
-        _dataCols[newValidIdx] = std::move(group_tails);
-        if (compress) {
-            clearInvalidEntries(msgTagBase);
-        }
-    }
-}
-
-void View::maxSingleBatch(std::vector<int64_t> &heads,
-                          const std::string &fieldName,
-                          std::string alias,
-                          int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int fieldIdx = colIndex(fieldName);
-    if (fieldIdx < 0) {
-        Log::e("Field '{}' not found for max operation", fieldName);
-        return;
-    }
-    const int bitlen = _fieldWidths[fieldIdx];
-
-    const bool BASELINE = DbConf::BASELINE_MODE;
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const bool PRECISE_COMPACT = !BASELINE && !APPROX_COMPACT;
-
-    std::vector<int64_t> &src = _dataCols[fieldIdx];
-    if (src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch: fieldData={}, heads={}, n={}", src.size(), heads.size(), n);
-        return;
-    }
-
-    std::vector<int64_t> vs = src;
-    std::vector<int64_t> bs_bool = heads;
-    const int64_t XOR_MASK = Comm::rank();
-
-    int validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE || APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-
-        bs_bool = BoolAndBatchOperator(&bs_bool, &valid, 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> zeros(n, 0);
-        vs = BoolMutexBatchOperator(&vs, &zeros, &valid, bitlen, 0, msgTagBase,
-                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int m = static_cast<int>(n) - delta;
-
-        std::vector<int64_t> left_vals(m), right_vals(m);
-        for (int i = 0; i < m; ++i) {
-            left_vals[i] = vs[i];
-            right_vals[i] = vs[i + delta];
-        }
-
-        if (BASELINE || APPROX_COMPACT) {
-            auto &valid = _dataCols[validIdx];
-            std::vector<int64_t> zeros(m, 0), left_valid(m), right_valid(m);
-            for (int i = 0; i < m; ++i) {
-                left_valid[i] = valid[i];
-                right_valid[i] = valid[i + delta];
-            }
-            left_vals = BoolMutexBatchOperator(&left_vals, &zeros, &left_valid, bitlen, 0, msgTagBase,
-                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            right_vals = BoolMutexBatchOperator(&right_vals, &zeros, &right_valid, bitlen, 0, msgTagBase,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        }
-
-        auto cmp = BoolLessBatchOperator(&left_vals, &right_vals, bitlen, 0, msgTagBase,
-                                         SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        auto cand = BoolMutexBatchOperator(&right_vals, &left_vals, &cmp, bitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> gate(m);
-        for (int i = 0; i < m; ++i) gate[i] = (bs_bool[i + delta] ^ XOR_MASK);
-        auto new_right = BoolMutexBatchOperator(&cand, &right_vals, &gate, bitlen, 0, msgTagBase,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        for (int i = 0; i < m; ++i) vs[i + delta] = new_right[i];
-
-        std::vector<int64_t> not_l(m), not_r(m);
-        for (int i = 0; i < m; ++i) {
-            not_l[i] = bs_bool[i] ^ XOR_MASK;
-            not_r[i] = bs_bool[i + delta] ^ XOR_MASK;
-        }
-        auto and_out = BoolAndBatchOperator(&not_l, &not_r, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (int i = 0; i < m; ++i) bs_bool[i + delta] = (and_out[i] ^ XOR_MASK);
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (PRECISE_COMPACT) {
-        group_tails[n - 1] = Comm::rank();
-    } else {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ XOR_MASK;
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ XOR_MASK;
-            not_lvt[i] = last_valid_tail[i] ^ XOR_MASK;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = (and_not[i] ^ XOR_MASK);
-    }
-
-    const std::string outName = alias.empty() ? ("max_" + fieldName) : alias;
-    _fieldNames.reserve(_fieldNames.size() + 1);
-    _fieldWidths.reserve(_fieldWidths.size() + 1);
-    _dataCols.reserve(_dataCols.size() + 1);
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, outName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, bitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, vs);
-
-    validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-    } else if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
-    }
-}
-
-void View::maxMultiBatches(std::vector<int64_t> &heads,
-                           const std::string &fieldName,
-                           std::string alias,
-                           int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int fieldIdx = colIndex(fieldName);
-    if (fieldIdx < 0) {
-        Log::e("Field '{}' not found for max operation", fieldName);
-        return;
-    }
-    const int bitlen = _fieldWidths[fieldIdx];
-
-    auto &src = _dataCols[fieldIdx];
-    if (src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch: fieldData={}, heads={}, n={}", src.size(), heads.size(), n);
-        return;
-    }
-
-    const int batchSize = Conf::BATCH_SIZE;
-    if (n <= static_cast<size_t>(batchSize)) {
-        maxSingleBatch(heads, fieldName, alias, msgTagBase);
-        return;
-    }
-
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const int64_t rank = Comm::rank();
-    const int validIdx = colNum() + VALID_COL_OFFSET;
-
-    std::vector<int64_t> bs_bool = heads;
-    std::vector<int64_t> vs = src;
-
-    if (APPROX_COMPACT) {
-        bs_bool = BoolAndBatchOperator(&bs_bool, &_dataCols[validIdx], 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> zeros(n, 0);
-        vs = BoolMutexBatchOperator(&vs, &zeros, &_dataCols[validIdx], bitlen, 0, msgTagBase,
-                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    const int lessStride = BoolLessBatchOperator::tagStride();
-    const int mutexStride = BoolMutexBatchOperator::tagStride();
-    const int andStride = BoolAndBatchOperator::tagStride();
-    const int taskStride = lessStride + mutexStride + mutexStride + andStride;
-
-    int tagCursorBase = msgTagBase;
-    const int64_t NOT_mask = rank;
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int totalPairs = static_cast<int>(n) - delta;
-        if (totalPairs <= 0) break;
-
-        const int numBatches = (totalPairs + batchSize - 1) / batchSize;
-
-        using Pair = std::pair<std::vector<int64_t>, std::vector<int64_t> >;
-
-        std::vector<std::future<Pair> > futs(numBatches);
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-
-            const int baseTag = tagCursorBase + b * taskStride;
-            const int lessTag = baseTag;
-            const int mtx1Tag = baseTag + lessStride;
-            const int mtx2Tag = mtx1Tag + mutexStride;
-            const int andTag = mtx2Tag + mutexStride;
-
-            futs[b] = ThreadPoolSupport::submit([=, &vs, &bs_bool]() -> Pair {
-                if (len <= 0) return Pair{{}, {}};
-
-                std::vector<int64_t> left_vals(len), right_vals(len);
-                for (int i = 0; i < len; ++i) {
-                    const int idxL = start + i;
-                    const int idxR = idxL + delta;
-                    left_vals[i] = vs[idxL];
-                    right_vals[i] = vs[idxR];
-                }
-
-                if (APPROX_COMPACT) {
-                    auto &valid = _dataCols[validIdx];
-                    std::vector<int64_t> zeros(len, 0), left_valid(len), right_valid(len);
-                    for (int i = 0; i < len; ++i) {
-                        left_valid[i] = valid[start + i];
-                        right_valid[i] = valid[start + i + delta];
-                    }
-                    left_vals = BoolMutexBatchOperator(&left_vals, &zeros, &left_valid, bitlen, 0, lessTag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    right_vals = BoolMutexBatchOperator(&right_vals, &zeros, &right_valid, bitlen, 0, lessTag,
-                                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                }
-
-                auto cmp = BoolLessBatchOperator(&left_vals, &right_vals, bitlen,
-                                                 0, lessTag,
-                                                 SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                auto cand = BoolMutexBatchOperator(&right_vals, &left_vals, &cmp,
-                                                   bitlen, 0, mtx1Tag,
-                                                   SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                std::vector<int64_t> not_bR(len);
-                for (int i = 0; i < len; ++i) {
-                    not_bR[i] = bs_bool[start + i + delta] ^ NOT_mask;
-                }
-                auto new_right = BoolMutexBatchOperator(&cand, &right_vals, &not_bR,
-                                                        bitlen, 0, mtx2Tag,
-                                                        SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                std::vector<int64_t> not_bL(len);
-                for (int i = 0; i < len; ++i) {
-                    not_bL[i] = bs_bool[start + i] ^ NOT_mask;
-                    not_bR[i] = bs_bool[start + i + delta] ^ NOT_mask;
-                }
-                auto and_out = BoolAndBatchOperator(&not_bL, &not_bR,
-                                                    1, 0, andTag,
-                                                    SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                std::vector<int64_t> new_b(len);
-                for (int i = 0; i < len; ++i) new_b[i] = and_out[i] ^ NOT_mask;
-
-                return Pair{std::move(new_right), std::move(new_b)};
-            });
-        }
-
-        tagCursorBase += numBatches * taskStride;
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-            if (len <= 0) continue;
-
-            auto pr = futs[b].get();
-            auto &new_right = pr.first;
-            auto &new_b = pr.second;
-
-            for (int i = 0; i < len; ++i) {
-                const int idxR = start + i + delta;
-                vs[idxR] = new_right[i];
-                bs_bool[idxR] = new_b[i];
-            }
-        }
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ rank;
-
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ rank;
-            not_lvt[i] = last_valid_tail[i] ^ rank;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = and_not[i] ^ rank;
-    } else {
-        group_tails[n - 1] = rank;
-    }
-
-    const std::string outName = alias.empty() ? ("max_" + fieldName) : alias;
-
-    _fieldNames.reserve(_fieldNames.size() + 1);
-    _fieldWidths.reserve(_fieldWidths.size() + 1);
-    _dataCols.reserve(_dataCols.size() + 1);
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, outName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, bitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(vs));
-
-    if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
-    }
-}
-
-void View::minSingleBatch(std::vector<int64_t> &heads,
-                          const std::string &fieldName,
-                          std::string alias,
-                          int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int fieldIdx = colIndex(fieldName);
-    if (fieldIdx < 0) {
-        Log::e("Field '{}' not found for min operation", fieldName);
-        return;
-    }
-    const int bitlen = _fieldWidths[fieldIdx];
-
-    const bool BASELINE = DbConf::BASELINE_MODE;
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const bool PRECISE_COMPACT = !BASELINE && !APPROX_COMPACT;
-
-    std::vector<int64_t> &src = _dataCols[fieldIdx];
-    if (src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch: fieldData={}, heads={}, n={}", src.size(), heads.size(), n);
-        return;
-    }
-
-    std::vector<int64_t> vs = src;
-    std::vector<int64_t> bs_bool = heads;
-    const int64_t XOR_MASK = Comm::rank();
-
-    int validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE || APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-
-        bs_bool = BoolAndBatchOperator(&bs_bool, &valid, 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> max_vals(n, (1LL << (bitlen - 1)) - 1);
-        vs = BoolMutexBatchOperator(&vs, &max_vals, &valid, bitlen, 0, msgTagBase,
-                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int m = static_cast<int>(n) - delta;
-
-        std::vector<int64_t> left_vals(m), right_vals(m);
-        for (int i = 0; i < m; ++i) {
-            left_vals[i] = vs[i];
-            right_vals[i] = vs[i + delta];
-        }
-
-        if (BASELINE || APPROX_COMPACT) {
-            auto &valid = _dataCols[validIdx];
-            std::vector<int64_t> max_vals(m, (1LL << (bitlen - 1)) - 1), left_valid(m), right_valid(m);
-            for (int i = 0; i < m; ++i) {
-                left_valid[i] = valid[i];
-                right_valid[i] = valid[i + delta];
-            }
-            left_vals = BoolMutexBatchOperator(&left_vals, &max_vals, &left_valid, bitlen, 0, msgTagBase,
-                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            right_vals = BoolMutexBatchOperator(&right_vals, &max_vals, &right_valid, bitlen, 0, msgTagBase,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        }
-
-        auto cmp = BoolLessBatchOperator(&left_vals, &right_vals, bitlen, 0, msgTagBase,
-                                         SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        auto cand = BoolMutexBatchOperator(&left_vals, &right_vals, &cmp, bitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> gate(m);
-        for (int i = 0; i < m; ++i) gate[i] = (bs_bool[i + delta] ^ XOR_MASK);
-        auto new_right = BoolMutexBatchOperator(&cand, &right_vals, &gate, bitlen, 0, msgTagBase,
-                                                SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        for (int i = 0; i < m; ++i) vs[i + delta] = new_right[i];
-
-        std::vector<int64_t> not_l(m), not_r(m);
-        for (int i = 0; i < m; ++i) {
-            not_l[i] = bs_bool[i] ^ XOR_MASK;
-            not_r[i] = bs_bool[i + delta] ^ XOR_MASK;
-        }
-        auto and_out = BoolAndBatchOperator(&not_l, &not_r, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (int i = 0; i < m; ++i) bs_bool[i + delta] = (and_out[i] ^ XOR_MASK);
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (PRECISE_COMPACT) {
-        group_tails[n - 1] = Comm::rank();
-    } else {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ XOR_MASK;
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ XOR_MASK;
-            not_lvt[i] = last_valid_tail[i] ^ XOR_MASK;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = (and_not[i] ^ XOR_MASK);
-    }
-
-    const std::string outName = alias.empty() ? ("min_" + fieldName) : alias;
-    _fieldNames.reserve(_fieldNames.size() + 1);
-    _fieldWidths.reserve(_fieldWidths.size() + 1);
-    _dataCols.reserve(_dataCols.size() + 1);
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, outName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, bitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, vs);
-
-    validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-    } else if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
-    }
-}
-
-void View::minMultiBatches(std::vector<int64_t> &heads,
-                           const std::string &fieldName,
-                           std::string alias,
-                           int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int fieldIdx = colIndex(fieldName);
-    if (fieldIdx < 0) {
-        Log::e("Field '{}' not found for min operation", fieldName);
-        return;
-    }
-    const int bitlen = _fieldWidths[fieldIdx];
-
-    auto &src = _dataCols[fieldIdx];
-    if (src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch: fieldData={}, heads={}, n={}", src.size(), heads.size(), n);
-        return;
-    }
-
-    const int batchSize = Conf::BATCH_SIZE;
-    if (n <= static_cast<size_t>(batchSize)) {
-        minSingleBatch(heads, fieldName, alias, msgTagBase);
-        return;
-    }
-
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const int64_t rank = Comm::rank();
-    int validIdx = colNum() + VALID_COL_OFFSET;
-
-    std::vector<int64_t> bs_bool = heads;
-    std::vector<int64_t> vs = src;
-
-    if (APPROX_COMPACT) {
-        bs_bool = BoolAndBatchOperator(&bs_bool, &_dataCols[validIdx], 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> max_vals(n, (1LL << (bitlen - 1)) - 1);
-        vs = BoolMutexBatchOperator(&vs, &max_vals, &_dataCols[validIdx], bitlen, 0, msgTagBase,
-                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    const int lessStride = BoolLessBatchOperator::tagStride();
-    const int mutexStride = BoolMutexBatchOperator::tagStride();
-    const int andStride = BoolAndBatchOperator::tagStride();
-    const int taskStride = lessStride + mutexStride + mutexStride + andStride;
-
-    int tagCursorBase = msgTagBase;
-    const int64_t NOT_mask = rank;
-
-    for (int delta = 1; delta < static_cast<int>(n); delta <<= 1) {
-        const int totalPairs = static_cast<int>(n) - delta;
-        if (totalPairs <= 0) break;
-
-        const int numBatches = (totalPairs + batchSize - 1) / batchSize;
-
-        using Pair = std::pair<std::vector<int64_t>, std::vector<int64_t> >;
-
-        std::vector<std::future<Pair> > futs(numBatches);
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-
-            const int baseTag = tagCursorBase + b * taskStride;
-            const int lessTag = baseTag;
-            const int mtx1Tag = baseTag + lessStride;
-            const int mtx2Tag = mtx1Tag + mutexStride;
-            const int andTag = mtx2Tag + mutexStride;
-
-            futs[b] = ThreadPoolSupport::submit([=, &vs, &bs_bool]() -> Pair {
-                if (len <= 0) return Pair{{}, {}};
-
-                std::vector<int64_t> left_vals(len), right_vals(len);
-                for (int i = 0; i < len; ++i) {
-                    const int idxL = start + i;
-                    const int idxR = idxL + delta;
-                    left_vals[i] = vs[idxL];
-                    right_vals[i] = vs[idxR];
-                }
-
-                if (APPROX_COMPACT) {
-                    auto &valid = _dataCols[validIdx];
-                    std::vector<int64_t> max_vals(len, (1LL << (bitlen - 1)) - 1), left_valid(len), right_valid(len);
-                    for (int i = 0; i < len; ++i) {
-                        left_valid[i] = valid[start + i];
-                        right_valid[i] = valid[start + i + delta];
-                    }
-                    left_vals = BoolMutexBatchOperator(&left_vals, &max_vals, &left_valid, bitlen, 0, lessTag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    right_vals = BoolMutexBatchOperator(&right_vals, &max_vals, &right_valid, bitlen, 0, lessTag,
-                                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                }
-
-                auto cmp = BoolLessBatchOperator(&left_vals, &right_vals, bitlen,
-                                                 0, lessTag,
-                                                 SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                auto cand = BoolMutexBatchOperator(&left_vals, &right_vals, &cmp,
-                                                   bitlen, 0, mtx1Tag,
-                                                   SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                std::vector<int64_t> not_bR(len);
-                for (int i = 0; i < len; ++i) {
-                    not_bR[i] = bs_bool[start + i + delta] ^ NOT_mask;
-                }
-                auto new_right = BoolMutexBatchOperator(&cand, &right_vals, &not_bR,
-                                                        bitlen, 0, mtx2Tag,
-                                                        SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                std::vector<int64_t> not_bL(len);
-                for (int i = 0; i < len; ++i) {
-                    not_bL[i] = bs_bool[start + i] ^ NOT_mask;
-                    not_bR[i] = bs_bool[start + i + delta] ^ NOT_mask;
-                }
-                auto and_out = BoolAndBatchOperator(&not_bL, &not_bR,
-                                                    1, 0, andTag,
-                                                    SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                std::vector<int64_t> new_b(len);
-                for (int i = 0; i < len; ++i) new_b[i] = and_out[i] ^ NOT_mask;
-
-                return Pair{std::move(new_right), std::move(new_b)};
-            });
-        }
-
-        tagCursorBase += numBatches * taskStride;
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-            if (len <= 0) continue;
-
-            auto pr = futs[b].get();
-            auto &new_right = pr.first;
-            auto &new_b = pr.second;
-
-            for (int i = 0; i < len; ++i) {
-                const int idxR = start + i + delta;
-                vs[idxR] = new_right[i];
-                bs_bool[idxR] = new_b[i];
-            }
-        }
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ rank;
-
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ rank;
-            not_lvt[i] = last_valid_tail[i] ^ rank;
+        for (size_t i = 1; i < n; ++i) {
+            groupHeads[i] = (i - 1 < eq_all.size()) ? (eq_all[i - 1] ^ NOT_mask) : Comm::rank();
         }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = and_not[i] ^ rank;
     } else {
-        group_tails[n - 1] = rank;
-    }
+        const int validColIndex = colNum() + VALID_COL_OFFSET;
+        auto &validCol = _dataCols[validColIndex];
 
-    const std::string outName = alias.empty() ? ("min_" + fieldName) : alias;
+        groupHeads[0] = (n > 0 ? validCol[0] : 0);
 
-    _fieldNames.reserve(_fieldNames.size() + 1);
-    _fieldWidths.reserve(_fieldWidths.size() + 1);
-    _dataCols.reserve(_dataCols.size() + 1);
+        if (n > 1) {
+            std::vector<int64_t> neq(eq_all.size());
+            for (size_t j = 0; j < eq_all.size(); ++j) neq[j] = eq_all[j] ^ NOT_mask;
 
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, outName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, bitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(vs));
+            std::vector<int64_t> valid_tail(eq_all.size());
+            for (size_t j = 0; j < eq_all.size(); ++j) valid_tail[j] = validCol[j + 1];
 
-    validIdx = colNum() + VALID_COL_OFFSET;
-    if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
+            auto tail_heads = BoolAndBatchOperator(
+                &valid_tail, &neq, 1,
+                0, msgTagBase,
+                SecureOperator::NO_CLIENT_COMPUTE
+            ).execute()->_zis;
+
+            for (size_t i = 1; i < n; ++i) {
+                groupHeads[i] = tail_heads[i - 1];
+            }
+        }
     }
+
+    return groupHeads;
 }
 
 int View::sortTagStride() {
-    return ((rowNum() / 2 + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE) * (colNum() - 1) *
-           BoolMutexBatchOperator::tagStride();
+    return std::max(shuffleTagStride(),
+                    static_cast<int>((rowNum() / 2 + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE) *
+                    static_cast<int>(colNum() - 1) * BoolMutexBatchOperator::tagStride());
 }
 
 void View::filterSingleBatch(std::vector<std::string> &fieldNames,
@@ -1755,18 +740,16 @@ void View::clearInvalidEntries(int msgTagBase) {
     clearInvalidEntries(true, msgTagBase);
 }
 
-void View::clearInvalidEntries(bool doSort, int msgTagBase) {
+void View::clearInvalidEntries(bool doCompact, int msgTagBase) {
     if (DbConf::BASELINE_MODE || DbConf::NO_COMPACTION) {
         return;
     }
-    if (doSort) {
-        sort(VALID_COL_NAME, false, msgTagBase);
-    }
-    int64_t sumShare = 0, sumShare1;
+    // Arithmetic shares of the valid bits give both the number of rows to keep and, for compaction,
+    // how far every row has to move
+    std::vector<int64_t> validArith;
     if (Conf::DISABLE_MULTI_THREAD || Conf::BATCH_SIZE <= 0) {
-        auto ta = BoolToArithBatchOperator(&_dataCols[_dataCols.size() + VALID_COL_OFFSET], 64, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        sumShare = std::accumulate(ta.begin(), ta.end(), 0ll);
+        validArith = BoolToArithBatchOperator(&_dataCols[_dataCols.size() + VALID_COL_OFFSET], 1, 64, 0, msgTagBase,
+                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
     } else {
         size_t batchSize = Conf::BATCH_SIZE;
         size_t n = rowNum();
@@ -1778,18 +761,21 @@ void View::clearInvalidEntries(bool doSort, int msgTagBase) {
                 auto &validCol = _dataCols[_dataCols.size() + VALID_COL_OFFSET];
                 std::vector part(validCol.begin() + batchSize * i,
                                  validCol.begin() + std::min(batchSize * (i + 1), n));
-                return BoolToArithBatchOperator(&part, 64, 0, msgTagBase + BoolToArithBatchOperator::tagStride() * i,
+                return BoolToArithBatchOperator(&part, 1, 64, 0, msgTagBase + BoolToArithBatchOperator::tagStride() * i,
                                                 SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
             });
         }
 
+        validArith.reserve(n);
         for (auto &f: futures) {
             auto temp = f.get();
-            for (auto e: temp) {
-                sumShare += e;
-            }
+            validArith.insert(validArith.end(), temp.begin(), temp.end());
         }
     }
+    if (doCompact) {
+        compact(validArith, msgTagBase);
+    }
+    int64_t sumShare = std::accumulate(validArith.begin(), validArith.end(), 0ll), sumShare1;
 
     if (DbConf::DISABLE_PRECISE_COMPACTION) {
         std::vector<int64_t> sv = {sumShare};
@@ -1842,9 +828,182 @@ void View::clearInvalidEntries(bool doSort, int msgTagBase) {
 }
 
 int View::clearInvalidEntriesTagStride() {
-    return std::max(sortTagStride(),
-                    static_cast<int>((rowNum() + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE) *
-                    BoolToArithBatchOperator::tagStride());
+    return clearInvalidEntriesTagStride(rowNum());
+}
+
+int View::clearInvalidEntriesTagStride(size_t rows) {
+    // Without batching the valid bits are converted in one go
+    size_t batchNum = Conf::BATCH_SIZE > 0 && !Conf::DISABLE_MULTI_THREAD
+                          ? (rows + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE
+                          : 1;
+    return std::max({
+        compactTagStride(rows),
+        static_cast<int>(std::max<size_t>(batchNum, 1)) * BoolToArithBatchOperator::tagStride(),
+        ArithToBoolBatchOperator::tagStride(64)
+    });
+}
+
+void View::compact(int msgTagBase) {
+    auto validArith = BoolToArithBatchOperator(&_dataCols[_dataCols.size() + VALID_COL_OFFSET], 1, 64, 0, msgTagBase,
+                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+    compact(validArith, msgTagBase);
+}
+
+void View::compact(const std::vector<int64_t> &validArith, int msgTagBase) {
+    const size_t n = rowNum();
+    if (n <= 1) {
+        return;
+    }
+    // Every valid row moves left by the number of invalid rows before it. Moving by the lowest bit of
+    // that distance first keeps rows from ever landing on each other, so log(n) shift-and-mux levels
+    // are enough and the valid rows keep their original order.
+    const int distWidth = compactDistWidth(n);
+    std::vector<int64_t> dists(n);
+    int64_t validBefore = 0;
+    for (size_t i = 0; i < n; i++) {
+        dists[i] = (Comm::rank() == 0 ? static_cast<int64_t>(i) : 0) - validBefore;
+        validBefore += validArith[i];
+    }
+
+    forEachBatch(n, ArithToBoolBatchOperator::tagStride(distWidth), msgTagBase, [&](size_t start, size_t end, int tag) {
+        std::vector part(dists.begin() + start, dists.begin() + end);
+        auto bools = ArithToBoolBatchOperator(&part, distWidth, 0, tag,
+                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        std::copy(bools.begin(), bools.end(), dists.begin() + start);
+    });
+
+    auto &validCol = _dataCols[colNum() + VALID_COL_OFFSET];
+    const int validIdx = static_cast<int>(colNum()) + VALID_COL_OFFSET;
+    // Data columns go through the mux with the distances in place of $valid. $padding is a public
+    // flag that is zero on every real row, so it stays where it is.
+    const int movedCols = static_cast<int>(colNum()) + PADDING_COL_OFFSET;
+    // Aggregations append 64-bit columns without touching _maxWidth, so take the widest moved column
+    int muxWidth = distWidth;
+    for (int c = 0; c < movedCols; c++) {
+        if (c != validIdx) {
+            muxWidth = std::max(muxWidth, _fieldWidths[c]);
+        }
+    }
+    const int stride = std::max(BoolAndBatchOperator::tagStride(), BoolMutexBatchOperator::tagStride());
+
+    for (int level = 0; level < distWidth; level++) {
+        const size_t shift = static_cast<size_t>(1) << level;
+        if (shift >= n) {
+            break;
+        }
+        const size_t m = n - shift;
+
+        // moves[t]: the row at shift + t is valid and moves to t on this level
+        std::vector<int64_t> moves(m);
+        forEachBatch(m, stride, msgTagBase, [&](size_t start, size_t end, int tag) {
+            std::vector<int64_t> valids(validCol.begin() + shift + start, validCol.begin() + shift + end);
+            std::vector<int64_t> bits;
+            bits.reserve(end - start);
+            for (size_t t = start; t < end; t++) {
+                bits.push_back((dists[shift + t] >> level) & 1);
+            }
+            auto zs = BoolAndBatchOperator(&valids, &bits, 1, 0, tag,
+                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+            std::copy(zs.begin(), zs.end(), moves.begin() + start);
+        });
+
+        // Batches run side by side and read rows that other batches overwrite, so every moved
+        // column is written to a copy and swapped in once the level is done
+        std::vector<int64_t> newDists(dists);
+        std::vector<std::vector<int64_t> > newCols(movedCols);
+        for (int c = 0; c < movedCols; c++) {
+            if (c != validIdx) {
+                newCols[c] = _dataCols[c];
+            }
+        }
+        forEachBatch(m, stride, msgTagBase, [&](size_t start, size_t end, int tag) {
+            const size_t cnt = end - start;
+            std::vector<int64_t> xs, ys, conds;
+            xs.reserve(cnt * movedCols);
+            ys.reserve(cnt * movedCols);
+            conds.reserve(cnt * movedCols);
+            for (int c = 0; c < movedCols; c++) {
+                auto &col = c == validIdx ? dists : _dataCols[c];
+                for (size_t t = start; t < end; t++) {
+                    xs.push_back(col[shift + t]);
+                    ys.push_back(col[t]);
+                    conds.push_back(moves[t]);
+                }
+            }
+            auto zs = BoolMutexBatchOperator(&xs, &ys, &conds, muxWidth, 0, tag,
+                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+            for (int c = 0; c < movedCols; c++) {
+                if (c == validIdx) {
+                    for (size_t t = 0; t < cnt; t++) {
+                        newDists[start + t] = Math::ring(zs[c * cnt + t], distWidth);
+                    }
+                    continue;
+                }
+                auto &col = newCols[c];
+                for (size_t t = 0; t < cnt; t++) {
+                    col[start + t] = Math::ring(zs[c * cnt + t], _fieldWidths[c]);
+                }
+            }
+        });
+        dists = std::move(newDists);
+        for (int c = 0; c < movedCols; c++) {
+            if (c != validIdx) {
+                _dataCols[c] = std::move(newCols[c]);
+            }
+        }
+
+        // A row that moved in takes a free slot and a row that moved out frees its own, so the new
+        // valid bit is a plain XOR of the two move flags
+        for (size_t k = 0; k < n; k++) {
+            int64_t in = k < m ? moves[k] : 0;
+            int64_t out = k >= shift ? moves[k - shift] : 0;
+            validCol[k] ^= in ^ out;
+        }
+    }
+}
+
+int View::compactTagStride() {
+    return compactTagStride(rowNum());
+}
+
+int View::compactTagStride(size_t n) {
+    size_t batchNum = Conf::BATCH_SIZE > 0 && !Conf::DISABLE_MULTI_THREAD
+                          ? (n + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE
+                          : 1;
+    return static_cast<int>(std::max<size_t>(batchNum, 1)) *
+           std::max({
+               ArithToBoolBatchOperator::tagStride(compactDistWidth(n)), BoolAndBatchOperator::tagStride(),
+               BoolMutexBatchOperator::tagStride()
+           });
+}
+
+void View::forEachBatch(size_t count, int stride, int msgTagBase,
+                        const std::function<void(size_t, size_t, int)> &work) {
+    const bool multiBatch = Conf::BATCH_SIZE > 0 && !Conf::DISABLE_MULTI_THREAD;
+    const size_t batchSize = multiBatch ? Conf::BATCH_SIZE : std::max<size_t>(count, 1);
+    const size_t batchNum = (count + batchSize - 1) / batchSize;
+    if (batchNum <= 1) {
+        work(0, count, msgTagBase);
+        return;
+    }
+    std::vector<std::future<void> > futures;
+    futures.reserve(batchNum);
+    for (size_t b = 0; b < batchNum; b++) {
+        futures.push_back(ThreadPoolSupport::submit([&, b] {
+            work(b * batchSize, std::min(count, (b + 1) * batchSize), msgTagBase + stride * static_cast<int>(b));
+        }));
+    }
+    for (auto &f: futures) {
+        f.wait();
+    }
+}
+
+int View::compactDistWidth(size_t n) {
+    int width = 1;
+    while (width < 63 && (static_cast<size_t>(1) << width) < n) {
+        width++;
+    }
+    return width;
 }
 
 void View::addRedundantCols() {
@@ -2025,477 +1184,50 @@ void View::bitonicSortMultiBatches(const std::string &orderField, bool ascending
                         }
                     }
 
-                    std::vector<std::future<void> > futures2;
-                    futures2.reserve(colNum() - 1);
-                    for (int c = 0; c < colNum() - 1; ++c) {
-                        futures2.push_back(ThreadPoolSupport::submit([&, b, c] {
-                            auto &col = _dataCols[c];
-                            std::vector<int64_t> subXs, subYs;
-                            if (_fieldNames[c] == orderField) {
-                                subXs = std::move(xs);
-                                subYs = std::move(ys);
-                            } else {
-                                subXs.reserve(cnt);
-                                subYs.reserve(cnt);
-                                for (int t = start; t < end; ++t) {
-                                    subXs.push_back(col[xIdx[t]]);
-                                    subYs.push_back(col[yIdx[t]]);
-                                }
-                            }
-
-                            auto copy = zs;
-                            auto zs2 = BoolMutexBatchOperator(&subXs, &subYs, &copy, _fieldWidths[c], 0,
-                                                              msgTagBase + tagStride * b +
-                                                              BoolMutexBatchOperator::tagStride() * c).execute()->
-                                    _zis;
-
-                            int64_t time = System::currentTimeMillis();
-                            for (int t = 0; t < cnt; ++t) {
-                                col[xIdx[start + t]] = zs2[t];
-                                col[yIdx[start + t]] = zs2[cnt + t];
-                            }
-                        }));
-                    }
-                    for (auto &f: futures2) {
-                        f.wait();
-                    }
-                }));
-            }
-            for (auto &f: futures) {
-                f.wait();
-            }
-        }
-    }
-}
-
-
-void View::minAndMaxSingleBatch(std::vector<int64_t> &heads,
-                                const std::string &minFieldName,
-                                const std::string &maxFieldName,
-                                std::string minAlias,
-                                std::string maxAlias,
-                                int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int minIdx = colIndex(minFieldName);
-    const int maxIdx = colIndex(maxFieldName);
-    if (minIdx < 0 || maxIdx < 0) {
-        Log::e("Field not found for minAndMax: min='{}' idx={}, max='{}' idx={}",
-               minFieldName, minIdx, maxFieldName, maxIdx);
-        return;
-    }
-
-    const int minBitlen = _fieldWidths[minIdx];
-    const int maxBitlen = _fieldWidths[maxIdx];
-
-    auto &min_src = _dataCols[minIdx];
-    auto &max_src = _dataCols[maxIdx];
-    if (min_src.size() != n || max_src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch in minAndMax: min={}, max={}, heads={}, n={}",
-               min_src.size(), max_src.size(), heads.size(), n);
-        return;
-    }
-
-    const bool BASELINE = DbConf::BASELINE_MODE;
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const bool PRECISE_COMPACT = !BASELINE && !APPROX_COMPACT;
-
-    std::vector<int64_t> min_vs = min_src;
-    std::vector<int64_t> max_vs = max_src;
-    std::vector<int64_t> bs_bool = heads;
-
-    const int64_t XOR_MASK = Comm::rank();
-
-    int validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE || APPROX_COMPACT) {
-        auto &valid = _dataCols[validIdx];
-
-        bs_bool = BoolAndBatchOperator(&bs_bool, &valid, 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> max_vals_min(n, (1LL << (minBitlen - 1)) - 1);
-        min_vs = BoolMutexBatchOperator(&min_vs, &max_vals_min, &valid, minBitlen, 0, msgTagBase,
-                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> min_vals_max(n, 0);
-        max_vs = BoolMutexBatchOperator(&max_vs, &min_vals_max, &valid, maxBitlen, 0, msgTagBase,
-                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    const int tag_off_less = BoolLessBatchOperator::tagStride();
-    const int tag_off_and = BoolAndBatchOperator::tagStride();
-    const int tag_off_mux = BoolMutexBatchOperator::tagStride();
-
-    for (int delta = 1, round = 0; delta < (int) n; delta <<= 1, ++round) {
-        const int m = (int) n - delta;
-        if (m <= 0) break;
-
-        std::vector<int64_t> min_L(m), min_R(m), max_L(m), max_R(m);
-        for (int i = 0; i < m; ++i) {
-            min_L[i] = min_vs[i];
-            min_R[i] = min_vs[i + delta];
-            max_L[i] = max_vs[i];
-            max_R[i] = max_vs[i + delta];
-        }
-
-        if (BASELINE || APPROX_COMPACT) {
-            auto &valid = _dataCols[validIdx];
-            std::vector<int64_t> max_vals_min(m, (1LL << (minBitlen - 1)) - 1), min_vals_max(m, 0);
-            std::vector<int64_t> left_valid(m), right_valid(m);
-            for (int i = 0; i < m; ++i) {
-                left_valid[i] = valid[i];
-                right_valid[i] = valid[i + delta];
-            }
-            min_L = BoolMutexBatchOperator(&min_L, &max_vals_min, &left_valid, minBitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            min_R = BoolMutexBatchOperator(&min_R, &max_vals_min, &right_valid, minBitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            max_L = BoolMutexBatchOperator(&max_L, &min_vals_max, &left_valid, maxBitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            max_R = BoolMutexBatchOperator(&max_R, &min_vals_max, &right_valid, maxBitlen, 0, msgTagBase,
-                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        }
-
-        auto less_min = BoolLessBatchOperator(&min_L, &min_R, minBitlen, 0,
-                                              msgTagBase + round * (2 * tag_off_less + tag_off_and + 4 * tag_off_mux),
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        auto less_max = BoolLessBatchOperator(&max_L, &max_R, maxBitlen, 0,
-                                              msgTagBase + round * (2 * tag_off_less + tag_off_and + 4 * tag_off_mux) +
-                                              tag_off_less,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        auto min_cand = BoolMutexBatchOperator(&min_L, &min_R, &less_min, minBitlen, 0,
-                                               msgTagBase + round * (2 * tag_off_less + tag_off_and + 4 * tag_off_mux) +
-                                               2 *
-                                               tag_off_less,
-                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        auto max_cand = BoolMutexBatchOperator(&max_R, &max_L, &less_max, maxBitlen, 0,
-                                               msgTagBase + round * (2 * tag_off_less + tag_off_and + 4 * tag_off_mux) +
-                                               2 *
-                                               tag_off_less + tag_off_mux,
-                                               SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> gate(m);
-        for (int i = 0; i < m; ++i) gate[i] = (bs_bool[i + delta] ^ XOR_MASK);
-
-        auto min_new_right = BoolMutexBatchOperator(&min_cand, &min_R, &gate, minBitlen, 0,
-                                                    msgTagBase + round * (
-                                                        2 * tag_off_less + tag_off_and + 4 * tag_off_mux)
-                                                    + 2 * tag_off_less + 2 * tag_off_mux,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        auto max_new_right = BoolMutexBatchOperator(&max_cand, &max_R, &gate, maxBitlen, 0,
-                                                    msgTagBase + round * (
-                                                        2 * tag_off_less + tag_off_and + 4 * tag_off_mux)
-                                                    + 2 * tag_off_less + 3 * tag_off_mux,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        for (int i = 0; i < m; ++i) {
-            min_vs[i + delta] = min_new_right[i];
-            max_vs[i + delta] = max_new_right[i];
-        }
-
-        std::vector<int64_t> not_l(m), not_r(m);
-        for (int i = 0; i < m; ++i) {
-            not_l[i] = bs_bool[i] ^ XOR_MASK;
-            not_r[i] = bs_bool[i + delta] ^ XOR_MASK;
-        }
-        auto and_out = BoolAndBatchOperator(&not_l, &not_r, 1, 0,
-                                            msgTagBase + round * (2 * tag_off_less + tag_off_and + 4 * tag_off_mux) + 2
-                                            *
-                                            tag_off_less + 4 * tag_off_mux,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (int i = 0; i < m; ++i) bs_bool[i + delta] = and_out[i] ^ XOR_MASK;
-    }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (PRECISE_COMPACT) {
-        group_tails[n - 1] = Comm::rank();
-    } else {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ XOR_MASK;
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ XOR_MASK;
-            not_lvt[i] = last_valid_tail[i] ^ XOR_MASK;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = (and_not[i] ^ XOR_MASK);
-    }
-
-    const std::string minOutName = minAlias.empty() ? ("min_" + minFieldName) : minAlias;
-    const std::string maxOutName = maxAlias.empty() ? ("max_" + maxFieldName) : maxAlias;
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, minOutName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, minBitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(min_vs));
-
-    _fieldNames.insert(_fieldNames.begin() + insertPos + 1, maxOutName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos + 1, maxBitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos + 1, std::move(max_vs));
-
-    validIdx = colNum() + VALID_COL_OFFSET;
-    if (BASELINE) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-    } else if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
-    }
-}
-
-void View::minAndMaxMultiBatches(std::vector<int64_t> &heads,
-                                 const std::string &minFieldName,
-                                 const std::string &maxFieldName,
-                                 std::string minAlias,
-                                 std::string maxAlias,
-                                 int msgTagBase) {
-    const size_t n = rowNum();
-    if (n == 0) return;
-
-    const int minIdx = colIndex(minFieldName);
-    const int maxIdx = colIndex(maxFieldName);
-    if (minIdx < 0 || maxIdx < 0) {
-        Log::e("Field not found for minAndMax: min='{}' idx={}, max='{}' idx={}",
-               minFieldName, minIdx, maxFieldName, maxIdx);
-        return;
-    }
-
-    const int minBitlen = _fieldWidths[minIdx];
-    const int maxBitlen = _fieldWidths[maxIdx];
-
-    auto &min_src = _dataCols[minIdx];
-    auto &max_src = _dataCols[maxIdx];
-    if (min_src.size() != n || max_src.size() != n || heads.size() != n) {
-        Log::e("Size mismatch in minAndMax multi: min={}, max={}, heads={}, n={}",
-               min_src.size(), max_src.size(), heads.size(), n);
-        return;
-    }
-
-    const int batchSize = Conf::BATCH_SIZE;
-    if (n <= (size_t) batchSize) {
-        minAndMaxSingleBatch(heads, minFieldName, maxFieldName, std::move(minAlias), std::move(maxAlias), msgTagBase);
-        return;
-    }
-
-    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
-    const bool PRECISE_COMPACT = !APPROX_COMPACT;
-
-    std::vector<int64_t> min_vs = min_src;
-    std::vector<int64_t> max_vs = max_src;
-    std::vector<int64_t> bs_bool = heads;
-    const int64_t NOT_mask = Comm::rank();
-
-    int validIdx = colNum() + VALID_COL_OFFSET;
-    if (APPROX_COMPACT) {
-        bs_bool = BoolAndBatchOperator(&bs_bool, &_dataCols[validIdx], 1, 0, msgTagBase,
-                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> max_vals_min(n, (1LL << (minBitlen - 1)) - 1);
-        min_vs = BoolMutexBatchOperator(&min_vs, &max_vals_min, &_dataCols[validIdx], minBitlen, 0, msgTagBase,
-                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> min_vals_max(n, 0);
-        max_vs = BoolMutexBatchOperator(&max_vs, &min_vals_max, &_dataCols[validIdx], maxBitlen, 0, msgTagBase,
-                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-    }
-
-    const int lessStride = BoolLessBatchOperator::tagStride();
-    const int mutexStride = BoolMutexBatchOperator::tagStride();
-    const int andStride = BoolAndBatchOperator::tagStride();
-    const int taskStride = 2 * lessStride + 4 * mutexStride + andStride;
-
-    int tagCursorBase = msgTagBase;
-
-    for (int delta = 1; delta < (int) n; delta <<= 1) {
-        const int totalPairs = (int) n - delta;
-        if (totalPairs <= 0) break;
-
-        const int numBatches = (totalPairs + batchSize - 1) / batchSize;
-
-        using Triple = std::tuple<std::vector<int64_t>, std::vector<int64_t>, std::vector<int64_t> >;
-        std::vector<std::future<Triple> > futs(numBatches);
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-            const int baseTag = tagCursorBase + b * taskStride;
-            const int minLessTag = baseTag;
-            const int maxLessTag = baseTag + lessStride;
-            const int minMtx1Tag = maxLessTag + lessStride;
-            const int maxMtx1Tag = minMtx1Tag + mutexStride;
-            const int minMtx2Tag = maxMtx1Tag + mutexStride;
-            const int maxMtx2Tag = minMtx2Tag + mutexStride;
-            const int andTag = maxMtx2Tag + mutexStride;
-
-            futs[b] = ThreadPoolSupport::submit([=, &min_vs, &max_vs, &bs_bool]() -> Triple {
-                if (len <= 0) return Triple{{}, {}, {}};
-
-                std::vector<int64_t> min_left(len), min_right(len);
-                std::vector<int64_t> max_left(len), max_right(len);
-                std::vector<int64_t> not_bL(len), not_bR(len);
-
-                for (int i = 0; i < len; ++i) {
-                    const int idxL = start + i;
-                    const int idxR = idxL + delta;
-                    min_left[i] = min_vs[idxL];
-                    min_right[i] = min_vs[idxR];
-                    max_left[i] = max_vs[idxL];
-                    max_right[i] = max_vs[idxR];
-                    not_bL[i] = bs_bool[idxL] ^ NOT_mask;
-                    not_bR[i] = bs_bool[idxR] ^ NOT_mask;
-                }
-
-                if (APPROX_COMPACT) {
-                    auto &valid = _dataCols[validIdx];
-                    std::vector<int64_t> max_vals_min(len, (1LL << (minBitlen - 1)) - 1), min_vals_max(len, 0);
-                    std::vector<int64_t> left_valid(len), right_valid(len);
-                    for (int i = 0; i < len; ++i) {
-                        left_valid[i] = valid[start + i];
-                        right_valid[i] = valid[start + i + delta];
-                    }
-                    min_left = BoolMutexBatchOperator(&min_left, &max_vals_min, &left_valid, minBitlen, 0, minLessTag,
-                                                      SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    min_right = BoolMutexBatchOperator(&min_right, &max_vals_min, &right_valid, minBitlen, 0,
-                                                       minLessTag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    max_left = BoolMutexBatchOperator(&max_left, &min_vals_max, &left_valid, maxBitlen, 0, maxLessTag,
-                                                      SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    max_right = BoolMutexBatchOperator(&max_right, &min_vals_max, &right_valid, maxBitlen, 0,
-                                                       maxLessTag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                }
-
-                auto min_cmp = BoolLessBatchOperator(&min_left, &min_right, minBitlen, 0,
-                                                     minLessTag, SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                auto max_cmp = BoolLessBatchOperator(&max_left, &max_right, maxBitlen, 0,
-                                                     maxLessTag, SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                auto min_cand = BoolMutexBatchOperator(&min_left, &min_right, &min_cmp,
-                                                       minBitlen, 0, minMtx1Tag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                auto max_cand = BoolMutexBatchOperator(&max_right, &max_left, &max_cmp,
-                                                       maxBitlen, 0, maxMtx1Tag,
-                                                       SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                auto min_new_right = BoolMutexBatchOperator(&min_cand, &min_right, &not_bR,
-                                                            minBitlen, 0, minMtx2Tag,
-                                                            SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                auto max_new_right = BoolMutexBatchOperator(&max_cand, &max_right, &not_bR,
-                                                            maxBitlen, 0, maxMtx2Tag,
-                                                            SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-
-                auto and_out = BoolAndBatchOperator(&not_bL, &not_bR, 1, 0, andTag,
-                                                    SecureOperator::NO_CLIENT_COMPUTE)
-                        .execute()->_zis;
-                std::vector<int64_t> new_b(len);
-                for (int i = 0; i < len; ++i) new_b[i] = and_out[i] ^ NOT_mask;
-
-                return Triple{std::move(min_new_right), std::move(max_new_right), std::move(new_b)};
-            });
-        }
-
-        tagCursorBase += numBatches * taskStride;
-
-        for (int b = 0; b < numBatches; ++b) {
-            const int start = b * batchSize;
-            const int end = std::min(start + batchSize, totalPairs);
-            const int len = end - start;
-            if (len <= 0) continue;
+                    std::vector<std::future<void> > futures2;
+                    futures2.reserve(colNum() - 1);
+                    for (int c = 0; c < colNum() - 1; ++c) {
+                        futures2.push_back(ThreadPoolSupport::submit([&, b, c] {
+                            auto &col = _dataCols[c];
+                            std::vector<int64_t> subXs, subYs;
+                            if (_fieldNames[c] == orderField) {
+                                subXs = std::move(xs);
+                                subYs = std::move(ys);
+                            } else {
+                                subXs.reserve(cnt);
+                                subYs.reserve(cnt);
+                                for (int t = start; t < end; ++t) {
+                                    subXs.push_back(col[xIdx[t]]);
+                                    subYs.push_back(col[yIdx[t]]);
+                                }
+                            }
 
-            auto triple = futs[b].get();
-            auto &min_new_right = std::get<0>(triple);
-            auto &max_new_right = std::get<1>(triple);
-            auto &new_b = std::get<2>(triple);
+                            auto copy = zs;
+                            auto zs2 = BoolMutexBatchOperator(&subXs, &subYs, &copy, _fieldWidths[c], 0,
+                                                              msgTagBase + tagStride * b +
+                                                              BoolMutexBatchOperator::tagStride() * c).execute()->
+                                    _zis;
 
-            for (int i = 0; i < len; ++i) {
-                const int idxR = start + i + delta;
-                min_vs[idxR] = min_new_right[i];
-                max_vs[idxR] = max_new_right[i];
-                bs_bool[idxR] = new_b[i];
+                            int64_t time = System::currentTimeMillis();
+                            for (int t = 0; t < cnt; ++t) {
+                                col[xIdx[start + t]] = zs2[t];
+                                col[yIdx[start + t]] = zs2[cnt + t];
+                            }
+                        }));
+                    }
+                    for (auto &f: futures2) {
+                        f.wait();
+                    }
+                }));
+            }
+            for (auto &f: futures) {
+                f.wait();
             }
         }
     }
-
-    std::vector<int64_t> group_tails(n);
-    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
-
-    if (PRECISE_COMPACT) {
-        group_tails[n - 1] = Comm::rank();
-    } else {
-        auto &valid = _dataCols[validIdx];
-        std::vector<int64_t> next_valid(n);
-        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
-        next_valid[n - 1] = 0;
-
-        std::vector<int64_t> not_next(n);
-        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ NOT_mask;
-
-        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
-                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-        std::vector<int64_t> not_gt(n), not_lvt(n);
-        for (size_t i = 0; i < n; ++i) {
-            not_gt[i] = group_tails[i] ^ NOT_mask;
-            not_lvt[i] = last_valid_tail[i] ^ NOT_mask;
-        }
-        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
-                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        for (size_t i = 0; i < n; ++i) group_tails[i] = and_not[i] ^ NOT_mask;
-    }
-
-    const std::string minOutName = minAlias.empty() ? ("min_" + minFieldName) : minAlias;
-    const std::string maxOutName = maxAlias.empty() ? ("max_" + maxFieldName) : maxAlias;
-
-    const int insertPos = colNum() - 2;
-    _fieldNames.insert(_fieldNames.begin() + insertPos, minOutName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos, minBitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos, std::move(min_vs));
-
-    _fieldNames.insert(_fieldNames.begin() + insertPos + 1, maxOutName);
-    _fieldWidths.insert(_fieldWidths.begin() + insertPos + 1, maxBitlen);
-    _dataCols.insert(_dataCols.begin() + insertPos + 1, std::move(max_vs));
-
-    validIdx = colNum() + VALID_COL_OFFSET;
-    if (APPROX_COMPACT) {
-        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
-                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-        _dataCols[validIdx] = std::move(new_valid);
-        clearInvalidEntries(msgTagBase);
-    } else {
-        _dataCols[validIdx] = std::move(group_tails);
-        clearInvalidEntries(msgTagBase);
-    }
 }
 
+
 std::vector<int64_t> View::groupBy(const std::string &groupField, int msgTagBase) {
     return groupBy(groupField, true, msgTagBase);
 }
@@ -2620,27 +1352,62 @@ void View::count(std::vector<std::string> &groupFields, std::vector<int64_t> &he
     _fieldNames = std::move(newFieldNames);
     _fieldWidths = std::move(newFieldWidths);
 
-    if (Conf::BATCH_SIZE <= 0 || Conf::DISABLE_MULTI_THREAD) {
-        countSingleBatch(heads, alias, msgTagBase, matchedTable, compress);
-    } else {
-        countMultiBatches(heads, alias, msgTagBase, matchedTable, compress);
+    const size_t n = rowNum();
+    if (n == 0) return;
+
+    const bool PRECISE_COMPACT = !DbConf::BASELINE_MODE && !DbConf::DISABLE_PRECISE_COMPACTION;
+    const int64_t rank = Comm::rank();
+    auto &valid = _dataCols[colNum() + VALID_COL_OFFSET];
+
+    // Invalid rows neither start a group nor add to its count
+    std::vector<int64_t> scanHeads = heads;
+    std::vector<int64_t> counts(n, rank);
+    if (!PRECISE_COMPACT) {
+        BoolRoundFusion fusion;
+        BoolAndBatchOperator headsAnd(&scanHeads, &valid, 1, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE);
+        fusion.add(&headsAnd);
+        std::unique_ptr<BoolAndBatchOperator> matchAnd;
+        if (!matchedTable.empty()) {
+            matchAnd = std::make_unique<BoolAndBatchOperator>(&valid, &_dataCols[colIndex(OUTER_MATCH_PREFIX + matchedTable)],
+                                                              1, 0, msgTagBase + BoolAndBatchOperator::tagStride(),
+                                                              SecureOperator::NO_CLIENT_COMPUTE);
+            fusion.add(matchAnd.get());
+        }
+        fusion.execute();
+        scanHeads = std::move(headsAnd._zis);
+        counts = matchAnd ? std::move(matchAnd->_zis) : valid;
     }
+
+    std::vector<int64_t> countsArith(n);
+    forEachBatch(n, BoolToArithBatchOperator::tagStride(), msgTagBase, [&](size_t start, size_t end, int tag) {
+        std::vector<int64_t> part(counts.begin() + static_cast<int64_t>(start), counts.begin() + static_cast<int64_t>(end));
+        auto arith = BoolToArithBatchOperator(&part, 1, 64, 0, tag, SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        std::copy(arith.begin(), arith.end(), countsArith.begin() + static_cast<int64_t>(start));
+    });
+
+    SegmentedScan(scanHeads).add(&countsArith, SegmentedScan::SUM, 64).execute(msgTagBase);
+
+    std::vector<int64_t> countsBool(n);
+    forEachBatch(n, ArithToBoolBatchOperator::tagStride(64), msgTagBase, [&](size_t start, size_t end, int tag) {
+        std::vector<int64_t> part(countsArith.begin() + static_cast<int64_t>(start),
+                                  countsArith.begin() + static_cast<int64_t>(end));
+        auto bools = ArithToBoolBatchOperator(&part, 64, 0, tag, SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        std::copy(bools.begin(), bools.end(), countsBool.begin() + static_cast<int64_t>(start));
+    });
+
+    std::vector<std::vector<int64_t> > aggregates;
+    aggregates.push_back(std::move(countsBool));
+    appendAggregates(heads, {alias.empty() ? COUNT_COL_NAME : alias}, {64}, aggregates, compress, msgTagBase);
 }
 
 void View::max(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase) {
-    if (Conf::BATCH_SIZE <= 0 || Conf::DISABLE_MULTI_THREAD) {
-        maxSingleBatch(heads, fieldName, alias, msgTagBase);
-    } else {
-        maxMultiBatches(heads, fieldName, alias, msgTagBase);
-    }
+    scanAggregate(heads, {fieldName}, {SegmentedScan::MAX}, {alias.empty() ? ("max_" + fieldName) : alias},
+                  msgTagBase);
 }
 
 void View::min(std::vector<int64_t> &heads, const std::string &fieldName, std::string alias, int msgTagBase) {
-    if (Conf::BATCH_SIZE <= 0 || Conf::DISABLE_MULTI_THREAD) {
-        minSingleBatch(heads, fieldName, alias, msgTagBase);
-    } else {
-        minMultiBatches(heads, fieldName, alias, msgTagBase);
-    }
+    scanAggregate(heads, {fieldName}, {SegmentedScan::MIN}, {alias.empty() ? ("min_" + fieldName) : alias},
+                  msgTagBase);
 }
 
 void View::minAndMax(std::vector<int64_t> &heads, const std::string &fieldName, std::string minAlias,
@@ -2654,10 +1421,119 @@ void View::minAndMax(std::vector<int64_t> &heads,
                      std::string minAlias,
                      std::string maxAlias,
                      int msgTagBase) {
-    if (Conf::DISABLE_MULTI_THREAD || Conf::BATCH_SIZE <= 0) {
-        minAndMaxSingleBatch(heads, minFieldName, maxFieldName, std::move(minAlias), std::move(maxAlias), msgTagBase);
+    scanAggregate(heads, {minFieldName, maxFieldName}, {SegmentedScan::MIN, SegmentedScan::MAX},
+                  {
+                      minAlias.empty() ? ("min_" + minFieldName) : minAlias,
+                      maxAlias.empty() ? ("max_" + maxFieldName) : maxAlias
+                  }, msgTagBase);
+}
+
+void View::scanAggregate(std::vector<int64_t> &heads, const std::vector<std::string> &fieldNames,
+                         const std::vector<SegmentedScan::CombineOp> &ops, const std::vector<std::string> &outNames,
+                         int msgTagBase) {
+    const size_t n = rowNum();
+    if (n == 0) return;
+
+    std::vector<int> indices, widths;
+    for (const auto &fieldName: fieldNames) {
+        const int idx = colIndex(fieldName);
+        if (idx < 0) {
+            Log::e("Field '{}' not found for aggregation", fieldName);
+            return;
+        }
+        indices.push_back(idx);
+        widths.push_back(_fieldWidths[idx]);
+    }
+    if (heads.size() != n) {
+        Log::e("Size mismatch: heads={}, n={}", heads.size(), n);
+        return;
+    }
+
+    std::vector<std::vector<int64_t> > aggregates;
+    for (int idx: indices) aggregates.push_back(_dataCols[idx]);
+    std::vector<int64_t> scanHeads = heads;
+
+    // Invalid rows neither start a group nor change its result, so they take the value neutral to the op
+    if (DbConf::BASELINE_MODE || DbConf::DISABLE_PRECISE_COMPACTION) {
+        auto &valid = _dataCols[colNum() + VALID_COL_OFFSET];
+        std::vector<std::vector<int64_t> > neutrals(ops.size());
+        std::vector<std::unique_ptr<BoolMutexBatchOperator> > mutexes(ops.size());
+        BoolRoundFusion fusion;
+        BoolAndBatchOperator headsAnd(&scanHeads, &valid, 1, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE);
+        fusion.add(&headsAnd);
+        int tag = msgTagBase + BoolAndBatchOperator::tagStride();
+        for (size_t i = 0; i < ops.size(); ++i) {
+            neutrals[i].assign(n, ops[i] == SegmentedScan::MIN ? (1LL << (widths[i] - 1)) - 1 : 0);
+            mutexes[i] = std::make_unique<BoolMutexBatchOperator>(&aggregates[i], &neutrals[i], &valid, widths[i], 0, tag,
+                                                                  SecureOperator::NO_CLIENT_COMPUTE);
+            tag += BoolMutexBatchOperator::tagStride();
+            fusion.add(mutexes[i].get());
+        }
+        fusion.execute();
+        scanHeads = std::move(headsAnd._zis);
+        for (size_t i = 0; i < ops.size(); ++i) aggregates[i] = std::move(mutexes[i]->_zis);
+    }
+
+    SegmentedScan scan(scanHeads);
+    for (size_t i = 0; i < ops.size(); ++i) scan.add(&aggregates[i], ops[i], widths[i]);
+    scan.execute(msgTagBase);
+
+    appendAggregates(heads, outNames, widths, aggregates, true, msgTagBase);
+}
+
+void View::appendAggregates(std::vector<int64_t> &heads, const std::vector<std::string> &outNames,
+                            const std::vector<int> &outWidths, std::vector<std::vector<int64_t> > &aggregates,
+                            bool compress, int msgTagBase) {
+    const size_t n = rowNum();
+    const bool BASELINE = DbConf::BASELINE_MODE;
+    const bool APPROX_COMPACT = DbConf::DISABLE_PRECISE_COMPACTION;
+    const int64_t XOR_MASK = Comm::rank();
+
+    // The last row of every group holds its aggregate
+    std::vector<int64_t> group_tails(n);
+    for (size_t i = 0; i + 1 < n; ++i) group_tails[i] = heads[i + 1];
+
+    int validIdx = colNum() + VALID_COL_OFFSET;
+    if (BASELINE || APPROX_COMPACT) {
+        auto &valid = _dataCols[validIdx];
+        std::vector<int64_t> next_valid(n);
+        for (size_t i = 0; i + 1 < n; ++i) next_valid[i] = valid[i + 1];
+        next_valid[n - 1] = 0;
+
+        std::vector<int64_t> not_next(n);
+        for (size_t i = 0; i < n; ++i) not_next[i] = next_valid[i] ^ XOR_MASK;
+        auto last_valid_tail = BoolAndBatchOperator(&valid, &not_next, 1, 0, msgTagBase,
+                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+
+        std::vector<int64_t> not_gt(n), not_lvt(n);
+        for (size_t i = 0; i < n; ++i) {
+            not_gt[i] = group_tails[i] ^ XOR_MASK;
+            not_lvt[i] = last_valid_tail[i] ^ XOR_MASK;
+        }
+        auto and_not = BoolAndBatchOperator(&not_gt, &not_lvt, 1, 0, msgTagBase,
+                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        for (size_t i = 0; i < n; ++i) group_tails[i] = (and_not[i] ^ XOR_MASK);
+    } else {
+        group_tails[n - 1] = XOR_MASK;
+    }
+
+    const int insertPos = colNum() - 2;
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        _fieldNames.insert(_fieldNames.begin() + insertPos + static_cast<int>(i), outNames[i]);
+        _fieldWidths.insert(_fieldWidths.begin() + insertPos + static_cast<int>(i), outWidths[i]);
+        _dataCols.insert(_dataCols.begin() + insertPos + static_cast<int>(i), std::move(aggregates[i]));
+    }
+
+    validIdx = colNum() + VALID_COL_OFFSET;
+    if (BASELINE || APPROX_COMPACT) {
+        auto new_valid = BoolAndBatchOperator(&_dataCols[validIdx], &group_tails, 1, 0, msgTagBase,
+                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        _dataCols[validIdx] = std::move(new_valid);
     } else {
-        minAndMaxMultiBatches(heads, minFieldName, maxFieldName, std::move(minAlias), std::move(maxAlias), msgTagBase);
+        _dataCols[validIdx] = std::move(group_tails);
+    }
+    if (compress && !BASELINE) {
+        clearInvalidEntries(msgTagBase);
     }
 }
 
@@ -2729,6 +1605,10 @@ void View::sort(const std::vector<std::string> &orderFields, const std::vector<b
     if (n == 0) {
         return;
     }
+    if (DbConf::SORT_METHOD == DbConf::SHUFFLE_SORT && shuffleSortKeyWidth(orderFields) <= 64) {
+        shuffleSort(orderFields, ascendingOrders, msgTagBase);
+        return;
+    }
 
     bool isPowerOf2 = (n > 0) && ((n & (n - 1)) == 0);
     if (!isPowerOf2) {
@@ -2774,7 +1654,291 @@ int View::sortTagStride(const std::vector<std::string> &orderFields) {
 
     int multi_col_factor = static_cast<int>(orderFields.size() * 2);
 
-    return base_stride * multi_col_factor;
+    return std::max(shuffleTagStride(), base_stride * multi_col_factor);
+}
+
+// Routes the permutation perm of the M = perm.size() rows at positions offset + t * 2^depth through the
+// Benes network over those rows. first[d][x] and last[d][x] tell whether the switch between positions x
+// and x + 2^d swaps on the way in and on the way out of depth d.
+static void routeBenes(size_t offset, int depth, const std::vector<size_t> &perm,
+                       std::vector<std::vector<int64_t> > &first, std::vector<std::vector<int64_t> > &last) {
+    const size_t m = perm.size();
+    if (m == 2) {
+        first[depth][offset] = perm[0] != 0;
+        return;
+    }
+
+    std::vector<size_t> inv(m);
+    for (size_t i = 0; i < m; i++) {
+        inv[perm[i]] = i;
+    }
+    // Looping algorithm: inputs sharing a switch and outputs sharing a switch go to different halves
+    std::vector<int> side(m, -1);
+    for (size_t start = 0; start < m; start += 2) {
+        size_t x = start;
+        int sub = 0;
+        while (side[x] < 0) {
+            side[x] = sub;
+            size_t y = inv[perm[x] ^ 1];
+            side[y] = 1 - sub;
+            x = y ^ 1;
+        }
+    }
+
+    std::vector<size_t> upper(m / 2), lower(m / 2);
+    for (size_t i = 0; i < m / 2; i++) {
+        size_t pos = offset + (2 * i << depth);
+        first[depth][pos] = side[2 * i];
+        size_t up = side[2 * i] == 0 ? 2 * i : 2 * i + 1;
+        upper[i] = perm[up] >> 1;
+        lower[i] = perm[up ^ 1] >> 1;
+        last[depth][pos] = side[inv[2 * i]];
+    }
+    routeBenes(offset, depth + 1, upper, first, last);
+    routeBenes(offset + (static_cast<size_t>(1) << depth), depth + 1, lower, first, last);
+}
+
+void View::shuffle(int msgTagBase) {
+    const size_t n = rowNum();
+    if (n <= 1) {
+        return;
+    }
+    size_t paddedN = 1;
+    while (paddedN < n) {
+        paddedN <<= 1;
+    }
+
+    // The network needs a power of two. Filler rows carry a shared flag through it and are dropped
+    // afterwards, which only tells at which random positions they ended up.
+    const int paddingIdx = static_cast<int>(colNum()) + PADDING_COL_OFFSET;
+    for (auto &col: _dataCols) {
+        col.resize(paddedN, 0);
+    }
+    auto &paddings = _dataCols[paddingIdx];
+    for (size_t i = 0; i < paddedN; i++) {
+        paddings[i] = Comm::rank() == 0 && i >= n;
+    }
+
+    permuteRows(0, msgTagBase);
+    permuteRows(1, msgTagBase);
+
+    if (paddedN > n) {
+        std::vector<int64_t> otherPaddings;
+        auto s = Comm::serverSendAsync(_dataCols[paddingIdx], 1, msgTagBase);
+        auto r = Comm::serverReceiveAsync(otherPaddings, static_cast<int>(paddedN), 1, msgTagBase);
+        Comm::wait(s);
+        Comm::wait(r);
+
+        std::vector<size_t> kept;
+        kept.reserve(n);
+        for (size_t i = 0; i < paddedN; i++) {
+            if ((_dataCols[paddingIdx][i] ^ otherPaddings[i]) == 0) {
+                kept.push_back(i);
+            }
+        }
+        for (auto &col: _dataCols) {
+            for (size_t i = 0; i < n; i++) {
+                col[i] = col[kept[i]];
+            }
+            col.resize(n);
+        }
+    }
+    _dataCols[paddingIdx].assign(n, 0);
+}
+
+void View::permuteRows(int owner, int msgTagBase) {
+    const size_t n = rowNum();
+    int depths = 0;
+    while ((static_cast<size_t>(1) << depths) < n) {
+        depths++;
+    }
+
+    // Only the owner knows its permutation. Its switch bits are its shares of the control bits and
+    // the other server holds zeros.
+    std::vector<std::vector<int64_t> > first(depths, std::vector<int64_t>(n)), last(depths, std::vector<int64_t>(n));
+    if (Comm::rank() == owner) {
+        // The shuffle sort opens its comparisons, so the permutation is only as secret as this draw. Fisher-Yates
+        // takes its indices from the CSPRNG and rejects the words below 2^64 mod bound so that each index is
+        // equally likely.
+        std::vector<int64_t> words(n);
+        size_t used = words.size();
+        auto below = [&](uint64_t bound) {
+            const uint64_t threshold = (0 - bound) % bound;
+            uint64_t r;
+            do {
+                if (used == words.size()) {
+                    Crypto::randomFill(words.data(), words.size());
+                    used = 0;
+                }
+                r = static_cast<uint64_t>(words[used++]);
+            } while (r < threshold);
+            return static_cast<size_t>(r % bound);
+        };
+        std::vector<size_t> perm(n);
+        std::iota(perm.begin(), perm.end(), 0);
+        for (size_t i = n - 1; i > 0; i--) {
+            std::swap(perm[i], perm[below(i + 1)]);
+        }
+        routeBenes(0, 0, perm, first, last);
+    }
+
+    int width = 1;
+    for (int w: _fieldWidths) {
+        width = std::max(width, w);
+    }
+    const int cols = static_cast<int>(colNum());
+
+    auto applyLayer = [&](int depth, const std::vector<int64_t> &swaps) {
+        const size_t shift = static_cast<size_t>(1) << depth;
+        const size_t low = shift - 1;
+        forEachBatch(n / 2, BoolMutexBatchOperator::tagStride(), msgTagBase, [&](size_t start, size_t end, int tag) {
+            const size_t cnt = end - start;
+            std::vector<size_t> positions;
+            positions.reserve(cnt);
+            for (size_t t = start; t < end; t++) {
+                positions.push_back(((t & ~low) << 1) | (t & low));
+            }
+            std::vector<int64_t> xs, ys, conds;
+            xs.reserve(cnt * cols);
+            ys.reserve(cnt * cols);
+            conds.reserve(cnt * cols);
+            for (int c = 0; c < cols; c++) {
+                auto &col = _dataCols[c];
+                for (size_t pos: positions) {
+                    xs.push_back(col[pos + shift]);
+                    ys.push_back(col[pos]);
+                    conds.push_back(swaps[pos]);
+                }
+            }
+            auto zs = BoolMutexBatchOperator(&xs, &ys, &conds, width, 0, tag).execute()->_zis;
+            const size_t half = cnt * cols;
+            for (int c = 0; c < cols; c++) {
+                auto &col = _dataCols[c];
+                for (size_t t = 0; t < cnt; t++) {
+                    col[positions[t]] = Math::ring(zs[c * cnt + t], _fieldWidths[c]);
+                    col[positions[t] + shift] = Math::ring(zs[half + c * cnt + t], _fieldWidths[c]);
+                }
+            }
+        });
+    };
+
+    for (int d = 0; d < depths; d++) {
+        applyLayer(d, first[d]);
+    }
+    for (int d = depths - 2; d >= 0; d--) {
+        applyLayer(d, last[d]);
+    }
+}
+
+int View::shuffleSortKeyWidth(const std::vector<std::string> &orderFields) const {
+    int width = 0;
+    for (const auto &f: orderFields) {
+        width += _fieldWidths[colIndex(f)];
+    }
+    return width;
+}
+
+void View::shuffleSort(const std::vector<std::string> &orderFields, const std::vector<bool> &ascendingOrders,
+                       int msgTagBase) {
+    shuffle(msgTagBase);
+    const size_t n = rowNum();
+    if (n <= 1) {
+        return;
+    }
+
+    // All order fields packed into one key so a single comparison is lexicographic. Descending fields
+    // are complemented.
+    const int keyWidth = shuffleSortKeyWidth(orderFields);
+    std::vector<int64_t> keys(n, 0);
+    for (size_t f = 0; f < orderFields.size(); f++) {
+        const int idx = colIndex(orderFields[f]);
+        const int w = _fieldWidths[idx];
+        const int64_t flip = !ascendingOrders[f] && Comm::rank() == 0 ? Math::ring(-1ll, w) : 0;
+        for (size_t i = 0; i < n; i++) {
+            int64_t shifted = w >= 64 ? 0 : static_cast<int64_t>(static_cast<uint64_t>(keys[i]) << w);
+            keys[i] = shifted | Math::ring(_dataCols[idx][i] ^ flip, w);
+        }
+    }
+
+    // Quicksort with every partitioning round batched over all segments. The rows are in random
+    // order now and ties are broken by that public position, so the opened comparisons only reveal
+    // a random permutation.
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<std::pair<size_t, size_t> > segments = {{0, n}};
+    while (!segments.empty()) {
+        std::vector<int64_t> xs, ys;
+        std::vector<bool> flipped;
+        for (auto [lo, hi]: segments) {
+            size_t pivot = order[lo];
+            for (size_t t = lo + 1; t < hi; t++) {
+                size_t e = order[t];
+                // e before pivot <=> key_e < key_p, or key_e == key_p and e < p, i.e. !(key_p < key_e)
+                bool flip = e < pivot;
+                xs.push_back(keys[flip ? pivot : e]);
+                ys.push_back(keys[flip ? e : pivot]);
+                flipped.push_back(flip);
+            }
+        }
+
+        const size_t cmpCount = xs.size();
+        std::vector<int64_t> lts(cmpCount);
+        forEachBatch(cmpCount, BoolLessBatchOperator::tagStride(), msgTagBase,
+                     [&](size_t start, size_t end, int tag) {
+                         std::vector<int64_t> subXs(xs.begin() + start, xs.begin() + end);
+                         std::vector<int64_t> subYs(ys.begin() + start, ys.begin() + end);
+                         auto zs = BoolLessBatchOperator(&subXs, &subYs, keyWidth, 0, tag,
+                                                         SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+                         std::copy(zs.begin(), zs.end(), lts.begin() + start);
+                     });
+
+        std::vector<int64_t> otherLts;
+        auto s = Comm::serverSendAsync(lts, 1, msgTagBase);
+        auto r = Comm::serverReceiveAsync(otherLts, static_cast<int>(cmpCount), 1, msgTagBase);
+        Comm::wait(s);
+        Comm::wait(r);
+
+        std::vector<std::pair<size_t, size_t> > next;
+        size_t cmp = 0;
+        for (auto [lo, hi]: segments) {
+            size_t pivot = order[lo];
+            std::vector<size_t> before, after;
+            for (size_t t = lo + 1; t < hi; t++, cmp++) {
+                bool less = ((lts[cmp] ^ otherLts[cmp]) & 1) ^ flipped[cmp];
+                (less ? before : after).push_back(order[t]);
+            }
+            size_t mid = lo + before.size();
+            std::copy(before.begin(), before.end(), order.begin() + lo);
+            order[mid] = pivot;
+            std::copy(after.begin(), after.end(), order.begin() + mid + 1);
+            if (before.size() > 1) {
+                next.emplace_back(lo, mid);
+            }
+            if (after.size() > 1) {
+                next.emplace_back(mid + 1, hi);
+            }
+        }
+        segments = std::move(next);
+    }
+
+    for (auto &col: _dataCols) {
+        std::vector<int64_t> sorted(n);
+        for (size_t i = 0; i < n; i++) {
+            sorted[i] = col[order[i]];
+        }
+        col = std::move(sorted);
+    }
+}
+
+int View::shuffleTagStride() {
+    if (DbConf::SORT_METHOD != DbConf::SHUFFLE_SORT) {
+        return 0;
+    }
+    size_t batchNum = Conf::BATCH_SIZE > 0 && !Conf::DISABLE_MULTI_THREAD
+                          ? (rowNum() + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE
+                          : 1;
+    return static_cast<int>(std::max<size_t>(batchNum, 1)) *
+           std::max(BoolMutexBatchOperator::tagStride(), BoolLessBatchOperator::tagStride());
 }
 
 void View::filterAndConditions(std::vector<std::string> &fieldNames, std::vector<ComparatorType> &comparatorTypes,
@@ -2786,6 +1950,63 @@ void View::filterAndConditions(std::vector<std::string> &fieldNames, std::vector
     }
 }
 
+std::vector<int64_t> View::lexicographicLess(const std::vector<int> &orderFieldIndices,
+                                             const std::vector<bool> &ascendingOrders,
+                                             const std::vector<int64_t> &xIdx, const std::vector<int64_t> &yIdx,
+                                             size_t start, size_t end, int msgTagBase) {
+    const size_t fieldCount = orderFieldIndices.size();
+    std::vector<std::vector<int64_t> > xs(fieldCount), ys(fieldCount);
+    for (size_t f = 0; f < fieldCount; f++) {
+        auto &col = _dataCols[orderFieldIndices[f]];
+        xs[f].reserve(end - start);
+        ys[f].reserve(end - start);
+        for (size_t t = start; t < end; t++) {
+            xs[f].push_back(col[xIdx[t]]);
+            ys[f].push_back(col[yIdx[t]]);
+        }
+    }
+
+    // No field depends on another, so every comparison and equality shares the same AND rounds.
+    // Equality of the last field is never needed.
+    std::vector<std::unique_ptr<BoolLessBatchOperator> > lesses;
+    std::vector<std::unique_ptr<BoolEqualBatchOperator> > equals;
+    std::vector<FusableRounds *> ops;
+    for (size_t f = 0; f < fieldCount; f++) {
+        int width = _fieldWidths[orderFieldIndices[f]];
+        lesses.push_back(ascendingOrders[f]
+                             ? std::make_unique<BoolLessBatchOperator>(&xs[f], &ys[f], width, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE)
+                             : std::make_unique<BoolLessBatchOperator>(&ys[f], &xs[f], width, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE));
+        ops.push_back(lesses.back().get());
+        if (f + 1 < fieldCount) {
+            equals.push_back(std::make_unique<BoolEqualBatchOperator>(&xs[f], &ys[f], width, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE));
+            ops.push_back(equals.back().get());
+        }
+    }
+    BoolRoundFusion::run(ops);
+
+    auto lts = std::move(lesses[0]->_zis);
+    if (fieldCount == 1) {
+        return lts;
+    }
+    auto eqs = std::move(equals[0]->_zis);
+    for (size_t f = 1; f < fieldCount; f++) {
+        BoolMutexBatchOperator ltsMutex(&lesses[f]->_zis, &lts, &eqs, 1, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE);
+        BoolRoundFusion fusion;
+        fusion.add(&ltsMutex);
+        std::unique_ptr<BoolAndBatchOperator> eqsAnd;
+        if (f + 1 < fieldCount) {
+            eqsAnd = std::make_unique<BoolAndBatchOperator>(&eqs, &equals[f]->_zis, 1, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE);
+            fusion.add(eqsAnd.get());
+        }
+        fusion.execute();
+        lts = std::move(ltsMutex._zis);
+        if (eqsAnd) {
+            eqs = std::move(eqsAnd->_zis);
+        }
+    }
+    return lts;
+}
+
 void View::bitonicSortSingleBatch(const std::vector<std::string> &orderFields, const std::vector<bool> &ascendingOrders,
                                   int msgTagBase) {
     auto n = _dataCols[0].size();
@@ -2834,56 +2055,8 @@ void View::bitonicSortSingleBatch(const std::vector<std::string> &orderFields, c
                 continue;
             }
 
-            std::vector<int64_t> xs, ys;
-            xs.reserve(comparingCount);
-            ys.reserve(comparingCount);
-            for (auto idx: xIdx) {
-                xs.push_back(_dataCols[orderFieldIndices[0]][idx]);
-            }
-            for (auto idx: yIdx) {
-                ys.push_back(_dataCols[orderFieldIndices[0]][idx]);
-            }
-
-            std::vector<int64_t> lts = ascendingOrders[0]
-                                           ? BoolLessBatchOperator(&xs, &ys, _fieldWidths[orderFieldIndices[0]], 0,
-                                                                   msgTagBase,
-                                                                   SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis
-                                           : BoolLessBatchOperator(&ys, &xs, _fieldWidths[orderFieldIndices[0]], 0,
-                                                                   msgTagBase,
-                                                                   SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            std::vector<int64_t> eqs = BoolEqualBatchOperator(&xs, &ys, _fieldWidths[orderFieldIndices[0]], 0,
-                                                              msgTagBase,
-                                                              SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-            for (int i = 1; i < orderFields.size(); i++) {
-                xs.clear();
-                ys.clear();
-                for (auto idx: xIdx) {
-                    xs.push_back(_dataCols[orderFieldIndices[i]][idx]);
-                }
-                for (auto idx: yIdx) {
-                    ys.push_back(_dataCols[orderFieldIndices[i]][idx]);
-                }
-                std::vector<int64_t> lts_i = ascendingOrders[i]
-                                                 ? BoolLessBatchOperator(
-                                                     &xs, &ys, _fieldWidths[orderFieldIndices[i]], 0,
-                                                     msgTagBase,
-                                                     SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis
-                                                 : BoolLessBatchOperator(
-                                                     &ys, &xs, _fieldWidths[orderFieldIndices[i]], 0,
-                                                     msgTagBase,
-                                                     SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                lts = BoolMutexBatchOperator(&lts_i, &lts, &eqs, 1, 0, msgTagBase,
-                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                std::vector<int64_t> eqs_i = BoolEqualBatchOperator(&xs, &ys, _fieldWidths[orderFieldIndices[i]], 0,
-                                                                    msgTagBase,
-                                                                    SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                eqs = BoolAndBatchOperator(&eqs, &eqs_i, 1, 0, msgTagBase, SecureOperator::NO_CLIENT_COMPUTE).execute()
-                        ->_zis;
-            }
-
+            auto lts = lexicographicLess(orderFieldIndices, ascendingOrders, xIdx, yIdx, 0, comparingCount,
+                                         msgTagBase);
 
             for (int i = 0; i < comparingCount; i++) {
                 if (!dirs[i]) {
@@ -2892,8 +2065,7 @@ void View::bitonicSortSingleBatch(const std::vector<std::string> &orderFields, c
             }
 
             size_t sz = comparingCount * colNum();
-            xs.clear();
-            ys.clear();
+            std::vector<int64_t> xs, ys;
             xs.reserve(sz);
             ys.reserve(sz);
 
@@ -2935,7 +2107,7 @@ void View::bitonicSortMultiBatches(const std::vector<std::string> &orderFields,
     for (int k = 2; k <= n; k <<= 1) {
         for (int j = k >> 1; j > 0; j >>= 1) {
             size_t halfN = n / 2;
-            std::vector<int> xIdx, yIdx;
+            std::vector<int64_t> xIdx, yIdx;
             std::vector<bool> dirs;
             xIdx.reserve(halfN);
             yIdx.reserve(halfN);
@@ -2989,59 +2161,8 @@ void View::bitonicSortMultiBatches(const std::vector<std::string> &orderFields,
                     const int batchTagBase = msgTagBase + tagsPerBatch * b;
                     int currentTag = batchTagBase;
 
-                    std::vector<int64_t> xs, ys;
-                    xs.reserve(cnt);
-                    ys.reserve(cnt);
-
-                    for (int t = start; t < end; ++t) {
-                        xs.push_back(_dataCols[orderFieldIndices[0]][xIdx[t]]);
-                        ys.push_back(_dataCols[orderFieldIndices[0]][yIdx[t]]);
-                    }
-
-                    std::vector<int64_t> lts = ascendingOrders[0]
-                                                   ? BoolLessBatchOperator(
-                                                       &xs, &ys, _fieldWidths[orderFieldIndices[0]], 0,
-                                                       batchTagBase,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis
-                                                   : BoolLessBatchOperator(
-                                                       &ys, &xs, _fieldWidths[orderFieldIndices[0]], 0,
-                                                       batchTagBase,
-                                                       SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                    std::vector<int64_t> eqs = BoolEqualBatchOperator(&xs, &ys, _fieldWidths[orderFieldIndices[0]], 0,
-                                                                      batchTagBase,
-                                                                      SecureOperator::NO_CLIENT_COMPUTE).execute()->
-                            _zis;
-
-                    for (int col = 1; col < orderFields.size(); col++) {
-                        xs.clear();
-                        ys.clear();
-                        for (int t = start; t < end; ++t) {
-                            xs.push_back(_dataCols[orderFieldIndices[col]][xIdx[t]]);
-                            ys.push_back(_dataCols[orderFieldIndices[col]][yIdx[t]]);
-                        }
-
-                        std::vector<int64_t> lts_i = ascendingOrders[col]
-                                                         ? BoolLessBatchOperator(
-                                                             &xs, &ys, _fieldWidths[orderFieldIndices[col]], 0,
-                                                             batchTagBase,
-                                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis
-                                                         : BoolLessBatchOperator(
-                                                             &ys, &xs, _fieldWidths[orderFieldIndices[col]], 0,
-                                                             batchTagBase,
-                                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                        lts = BoolMutexBatchOperator(&lts_i, &lts, &eqs, 1, 0, batchTagBase,
-                                                     SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                        std::vector<int64_t> eqs_i = BoolEqualBatchOperator(
-                            &xs, &ys, _fieldWidths[orderFieldIndices[col]], 0,
-                            batchTagBase,
-                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-
-                        eqs = BoolAndBatchOperator(&eqs, &eqs_i, 1, 0, batchTagBase,
-                                                   SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
-                    }
+                    auto lts = lexicographicLess(orderFieldIndices, ascendingOrders, xIdx, yIdx, start, end,
+                                                 batchTagBase);
 
                     for (int t = 0; t < cnt; ++t) {
                         if (!dirs[start + t]) {
@@ -16,6 +16,7 @@
 #include "utils/Log.h"
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 
 #include <string>
 
@@ -23,9 +24,11 @@
 
 View Views::selectAll(Table &t) {
     View v(t._tableName, t._fieldNames, t._fieldWidths);
-    v._dataCols = t._dataCols;
-    v._dataCols.emplace_back(t._dataCols[0].size(), Comm::rank());
-    v._dataCols.emplace_back(t._dataCols[0].size());
+    for (size_t i = 0; i < t.colNum(); i++) {
+        v._dataCols[i] = t.column(i);
+    }
+    v._dataCols[v.colNum() + View::VALID_COL_OFFSET] = std::vector<int64_t>(t.rowNum(), Comm::rank());
+    v._dataCols[v.colNum() + View::PADDING_COL_OFFSET] = std::vector<int64_t>(t.rowNum(), 0);
     return v;
 }
 
@@ -36,13 +39,24 @@ View Views::selectAllWithFieldPrefix(Table &t) {
     }
 
     View v(t._tableName, fieldNames, t._fieldWidths);
-    v._dataCols = t._dataCols;
-    v._dataCols.emplace_back(t.rowNum(), Comm::rank());
-    v._dataCols.emplace_back(t.rowNum());
+    for (size_t i = 0; i < t.colNum(); i++) {
+        v._dataCols[i] = t.column(i);
+    }
+    v._dataCols[v.colNum() + View::VALID_COL_OFFSET] = std::vector<int64_t>(t.rowNum(), Comm::rank());
+    v._dataCols[v.colNum() + View::PADDING_COL_OFFSET] = std::vector<int64_t>(t.rowNum(), 0);
     return v;
 }
 
 View Views::selectColumns(Table &t, std::vector<std::string> &fieldNames) {
+    return selectColumns(t, fieldNames, [&t](size_t i) { return t.column(i); });
+}
+
+View Views::selectColumns(View &v, std::vector<std::string> &fieldNames) {
+    return selectColumns(v, fieldNames, [&v](size_t i) { return v._dataCols[i]; });
+}
+
+View Views::selectColumns(Relation &t, std::vector<std::string> &fieldNames,
+                          const std::function<std::vector<int64_t>(size_t)> &column) {
     std::vector<size_t> indices;
     indices.reserve(fieldNames.size());
     for (auto &name: fieldNames) {
@@ -58,13 +72,13 @@ View Views::selectColumns(Table &t, std::vector<std::string> &fieldNames) {
 
     View v(t._tableName, fieldNames, widths);
 
-    if (t._dataCols.empty()) {
+    if (t.colNum() == 0) {
         return v;
     }
 
     int colIndex = 0;
     for (auto idx: indices) {
-        v._dataCols[colIndex++] = t._dataCols[idx];
+        v._dataCols[colIndex++] = column(idx);
     }
 
     v._dataCols[v.colNum() + View::PADDING_COL_OFFSET] = std::vector<int64_t>(v.rowNum(), 0);
@@ -73,11 +87,12 @@ View Views::selectColumns(Table &t, std::vector<std::string> &fieldNames) {
     return v;
 }
 
-View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress) {
+// Output schema of an inner join: the fields of v0 then those of v1, each qualified by its table name
+static void joinedFields(View &v0, View &v1, std::vector<std::string> &fieldNames, std::vector<int> &fieldWidths) {
     const size_t effectiveFieldNum0 = v0.colNum() - 2;
     const size_t effectiveFieldNum1 = v1.colNum() - 2;
 
-    std::vector<std::string> fieldNames(effectiveFieldNum0 + effectiveFieldNum1);
+    fieldNames.resize(effectiveFieldNum0 + effectiveFieldNum1);
     std::string tableName0 = v0._tableName.empty() ? "$t0" : v0._tableName;
     std::string tableName1 = v1._tableName.empty() ? "$t1" : v1._tableName;
 
@@ -95,9 +110,23 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
         fieldNames[i + effectiveFieldNum0] = decorate(
             tableName1, v1._fieldNames[i]);
 
-    std::vector<int> fieldWidths(effectiveFieldNum0 + effectiveFieldNum1);
+    fieldWidths.resize(effectiveFieldNum0 + effectiveFieldNum1);
     for (size_t i = 0; i < effectiveFieldNum0; ++i) fieldWidths[i] = v0._fieldWidths[i];
     for (size_t i = 0; i < effectiveFieldNum1; ++i) fieldWidths[i + effectiveFieldNum0] = v1._fieldWidths[i];
+}
+
+View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress) {
+    return nestedLoopJoin(v0, v1, field0, field1, compress, 0);
+}
+
+View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                           int msgTagBase) {
+    const size_t effectiveFieldNum0 = v0.colNum() - 2;
+    const size_t effectiveFieldNum1 = v1.colNum() - 2;
+
+    std::vector<std::string> fieldNames;
+    std::vector<int> fieldWidths;
+    joinedFields(v0, v1, fieldNames, fieldWidths);
 
     View joined(fieldNames, fieldWidths);
     if (v0._dataCols.empty() || v1._dataCols.empty()) return joined;
@@ -162,7 +191,7 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
         }
 
         auto eqRes = BoolEqualBatchOperator(&cmp0, &cmp1, keyWidth,
-                                            0, 0,
+                                            0, msgTagBase,
                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
 
         std::vector<int64_t> outValid;
@@ -171,12 +200,12 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
         } else {
             auto pairValid = BoolAndBatchOperator(&bigLValid, &bigRValid, 1,
                                                   0,
-                                                  BoolEqualBatchOperator::tagStride(),
+                                                  msgTagBase + BoolEqualBatchOperator::tagStride(),
                                                   SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
             outValid = BoolAndBatchOperator(&eqRes, &pairValid, 1,
                                             0,
-                                            
-                                            BoolEqualBatchOperator::tagStride() + BoolAndBatchOperator::tagStride(),
+                                            msgTagBase + BoolEqualBatchOperator::tagStride() +
+                                            BoolAndBatchOperator::tagStride(),
                                             SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
         }
 
@@ -215,7 +244,7 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
                     }
                 }
 
-                const int baseTag = b * blockStride;
+                const int baseTag = msgTagBase + b * blockStride;
                 auto eqRes = BoolEqualBatchOperator(&cmp0, &cmp1, keyWidth,
                                                     0, baseTag,
                                                     SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
@@ -254,7 +283,7 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
     }
 
     if (compress && !BASELINE) {
-        joined.clearInvalidEntries(0);
+        joined.clearInvalidEntries(msgTagBase + nestedLoopJoinTagStride(rows0, rows1, false));
     }
 
     return joined;
@@ -264,6 +293,203 @@ View Views::nestedLoopJoin(View &v0, View &v1, std::string &field0, std::string
     return nestedLoopJoin(v0, v1, field0, field1, true);
 }
 
+int Views::nestedLoopJoinTagStride(size_t rows0, size_t rows1, bool compress) {
+    const size_t n = rows0 * rows1;
+    const int eqStride = BoolEqualBatchOperator::tagStride();
+    const int andStride = BoolAndBatchOperator::tagStride();
+    const int blockStride = eqStride + 2 * andStride;
+
+    int stride = blockStride;
+    if (!DbConf::BASELINE_MODE && Conf::BATCH_SIZE > 0 && !Conf::DISABLE_MULTI_THREAD) {
+        stride = static_cast<int>((n + Conf::BATCH_SIZE - 1) / Conf::BATCH_SIZE) * blockStride;
+    }
+    // Same condition as the compaction at the end of nestedLoopJoin
+    if (compress && !DbConf::BASELINE_MODE) {
+        stride += View::clearInvalidEntriesTagStride(n);
+    }
+    return stride;
+}
+
+View Views::sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress) {
+    return sortMergeJoin(v0, v1, field0, field1, compress, 0);
+}
+
+View Views::sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                          int msgTagBase) {
+    const size_t eff0 = v0.colNum() - 2;
+    const size_t eff1 = v1.colNum() - 2;
+
+    std::vector<std::string> fieldNames;
+    std::vector<int> fieldWidths;
+    joinedFields(v0, v1, fieldNames, fieldWidths);
+
+    View joined(fieldNames, fieldWidths);
+    if (v0._dataCols.empty() || v1._dataCols.empty()) return joined;
+
+    const size_t rows0 = v0.rowNum();
+    const size_t rows1 = v1.rowNum();
+    if (rows0 == 0 || rows1 == 0) return joined;
+
+    const int colIndex0 = v0.colIndex(field0);
+    const int colIndex1 = v1.colIndex(field1);
+    if (colIndex0 == -1 || colIndex1 == -1) return joined;
+
+    const int keyWidth = v0._fieldWidths[colIndex0];
+    const bool PRECISE = (!DbConf::BASELINE_MODE) && (!DbConf::DISABLE_PRECISE_COMPACTION);
+    const int64_t rankShare = Comm::rank();
+    const size_t total = rows0 + rows1;
+    const auto &valid0 = v0._dataCols[v0.colNum() + View::VALID_COL_OFFSET];
+    const auto &valid1 = v1._dataCols[v1.colNum() + View::VALID_COL_OFFSET];
+
+    int tag = msgTagBase;
+
+    // Fields of an invalid primary key row are zeroed so that they add nothing to the scan below
+    std::vector<std::vector<int64_t> > pkCols(eff0);
+    for (size_t c = 0; c < eff0; ++c) {
+        pkCols[c] = v0._dataCols[c];
+    }
+    if (!PRECISE) {
+        int width0 = 1;
+        for (size_t c = 0; c < eff0; ++c) width0 = std::max(width0, v0._fieldWidths[c]);
+
+        std::vector<int64_t> xs, masks;
+        xs.reserve(eff0 * rows0);
+        masks.reserve(eff0 * rows0);
+        for (size_t c = 0; c < eff0; ++c) {
+            xs.insert(xs.end(), pkCols[c].begin(), pkCols[c].end());
+            for (size_t i = 0; i < rows0; ++i) masks.push_back(Math::ring(-(valid0[i] & 1), width0));
+        }
+        auto masked = BoolAndBatchOperator(&xs, &masks, width0, 0, tag,
+                                           SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        tag += BoolAndBatchOperator::tagStride();
+        for (size_t c = 0; c < eff0; ++c) {
+            std::copy(masked.begin() + static_cast<int64_t>(c * rows0),
+                      masked.begin() + static_cast<int64_t>((c + 1) * rows0), pkCols[c].begin());
+        }
+    }
+
+    // Union of both sides. The primary key row has side 0 and leads the run of rows sharing its key.
+    const std::string keyName = "$key", sideName = "$side", hitName = "$hit";
+    std::vector<std::string> unionNames = fieldNames;
+    std::vector<int> unionWidths = fieldWidths;
+    unionNames.insert(unionNames.end(), {keyName, sideName, hitName});
+    unionWidths.insert(unionWidths.end(), {keyWidth, 1, 1});
+    View u(unionNames, unionWidths);
+
+    const size_t payloadNum = eff0 + eff1;
+    const size_t keyIdx = payloadNum, sideIdx = payloadNum + 1, hitIdx = payloadNum + 2;
+    for (size_t c = 0; c < eff0; ++c) {
+        auto &col = u._dataCols[c];
+        col = std::move(pkCols[c]);
+        col.resize(total, 0);
+    }
+    for (size_t c = 0; c < eff1; ++c) {
+        auto &col = u._dataCols[eff0 + c];
+        col.reserve(total);
+        col.assign(rows0, 0);
+        col.insert(col.end(), v1._dataCols[c].begin(), v1._dataCols[c].end());
+    }
+    auto &keys = u._dataCols[keyIdx];
+    auto &sides = u._dataCols[sideIdx];
+    auto &hits = u._dataCols[hitIdx];
+    auto &unionValid = u._dataCols[u.colNum() + View::VALID_COL_OFFSET];
+    keys.reserve(total);
+    sides.reserve(total);
+    hits.reserve(total);
+    unionValid.reserve(total);
+    for (size_t i = 0; i < rows0; ++i) {
+        keys.push_back(Math::ring(v0._dataCols[colIndex0][i], keyWidth));
+        sides.push_back(0);
+        hits.push_back(PRECISE ? rankShare : valid0[i]);
+        unionValid.push_back(0);
+    }
+    for (size_t j = 0; j < rows1; ++j) {
+        keys.push_back(Math::ring(v1._dataCols[colIndex1][j], keyWidth));
+        sides.push_back(rankShare);
+        hits.push_back(0);
+        unionValid.push_back(PRECISE ? rankShare : valid1[j]);
+    }
+    u._dataCols[u.colNum() + View::PADDING_COL_OFFSET].assign(total, 0);
+
+    const std::vector<std::string> orderFields = {keyName, sideName};
+    const int sortStride = u.sortTagStride(orderFields);
+    u.sort(orderFields, {true, true}, tag);
+    tag += sortStride;
+
+    std::vector<int64_t> same(total, 0);
+    if (total > 1) {
+        std::vector<int64_t> prevKeys(keys.begin(), keys.end() - 1), nextKeys(keys.begin() + 1, keys.end());
+        auto eqs = BoolEqualBatchOperator(&nextKeys, &prevKeys, keyWidth, 0, tag,
+                                          SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        tag += BoolEqualBatchOperator::tagStride();
+        std::copy(eqs.begin(), eqs.end(), same.begin() + 1);
+    }
+
+    // Segmented prefix XOR over the fields of v0 and the hit bit. Each run holds at most one valid primary
+    // key row and it comes first, so the XOR copies that row onto every foreign key row behind it.
+    std::vector<size_t> scanCols;
+    scanCols.reserve(eff0 + 1);
+    int scanWidth = 1;
+    for (size_t c = 0; c < eff0; ++c) {
+        scanCols.push_back(c);
+        scanWidth = std::max(scanWidth, u._fieldWidths[c]);
+    }
+    scanCols.push_back(hitIdx);
+
+    const int andStride = BoolAndBatchOperator::tagStride();
+    for (size_t d = 1; d < total; d <<= 1) {
+        const size_t cnt = total - d;
+        std::vector<int64_t> xs, ys;
+        xs.reserve((scanCols.size() + 1) * cnt);
+        ys.reserve((scanCols.size() + 1) * cnt);
+        for (size_t c: scanCols) {
+            const auto &col = u._dataCols[c];
+            for (size_t k = d; k < total; ++k) {
+                xs.push_back(col[k - d]);
+                ys.push_back(Math::ring(-(same[k] & 1), scanWidth));
+            }
+        }
+        for (size_t k = d; k < total; ++k) {
+            xs.push_back(same[k]);
+            ys.push_back(same[k - d]);
+        }
+        auto res = BoolAndBatchOperator(&xs, &ys, scanWidth, 0, tag,
+                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        tag += andStride;
+
+        for (size_t s = 0; s < scanCols.size(); ++s) {
+            auto &col = u._dataCols[scanCols[s]];
+            for (size_t t = 0; t < cnt; ++t) {
+                col[d + t] ^= res[s * cnt + t];
+            }
+        }
+        for (size_t t = 0; t < cnt; ++t) {
+            same[d + t] = res[scanCols.size() * cnt + t];
+        }
+    }
+
+    // Only foreign key rows carry a valid bit, and they are kept when a primary key row reached them
+    auto outValid = BoolAndBatchOperator(&unionValid, &hits, 1, 0, tag,
+                                         SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+    tag += andStride;
+
+    for (size_t c = 0; c < payloadNum; ++c) {
+        joined._dataCols[c] = std::move(u._dataCols[c]);
+    }
+    joined._dataCols[joined.colNum() + View::VALID_COL_OFFSET] = std::move(outValid);
+    joined._dataCols[joined.colNum() + View::PADDING_COL_OFFSET].assign(total, 0);
+
+    if (compress && !DbConf::BASELINE_MODE) {
+        joined.clearInvalidEntries(tag);
+    }
+
+    return joined;
+}
+
+View Views::sortMergeJoin(View &v0, View &v1, std::string &field0, std::string &field1) {
+    return sortMergeJoin(v0, v1, field0, field1, true);
+}
+
 std::vector<std::vector<std::vector<int64_t> > > Views::butterflyPermutation(
     View &view,
     int tagColIndex,
@@ -462,70 +688,90 @@ View Views::performBucketJoins(
     View &v1,
     std::string &field0,
     std::string &field1,
-    bool compress
+    bool compress,
+    int msgTagBase
 ) {
     const size_t numBuckets = buckets0.size();
-    bool firstResult = true;
-    View result;
 
+    std::vector<std::string> fieldNames;
+    std::vector<int> fieldWidths;
+    joinedFields(v0, v1, fieldNames, fieldWidths);
+    View result(fieldNames, fieldWidths);
+
+    // Buckets are independent, so they are joined concurrently, each inside its own range of message tags
+    std::vector<size_t> joinable;
+    std::vector<int> tagBases;
+    int64_t nextTag = msgTagBase;
+    int64_t maxStride = 0;
     for (size_t b = 0; b < numBuckets; ++b) {
         if (buckets0[b].empty() || buckets1[b].empty() ||
             buckets0[b][0].empty() || buckets1[b][0].empty()) {
             continue;
         }
+        joinable.push_back(b);
+        tagBases.push_back(static_cast<int>(nextTag));
+        int64_t stride = nestedLoopJoinTagStride(buckets0[b][0].size(), buckets1[b][0].size(), compress);
+        nextTag += stride;
+        maxStride = std::max(maxStride, stride);
+    }
 
-        std::vector<std::string> names0 = v0._fieldNames;
-        std::vector<int> widths0 = v0._fieldWidths;
+    // buildTag keeps only the low 32 - TASK_TAG_BITS bits of a message tag. When the ranges of all buckets do
+    // not fit in them, the buckets run one after another and each reuses the range from msgTagBase.
+    const int64_t msgTagSpace = 1LL << (32 - Conf::TASK_TAG_BITS);
+    if (msgTagBase + maxStride > msgTagSpace) {
+        throw std::runtime_error("Bucket join needs more message tags than task_tag_bits leaves.");
+    }
+    const bool concurrent = nextTag <= msgTagSpace;
+    if (!concurrent) {
+        std::fill(tagBases.begin(), tagBases.end(), msgTagBase);
+    }
+
+    auto joinBucket = [&](size_t i) {
+        const size_t b = joinable[i];
         View left(v0._tableName, v0._fieldNames, v0._fieldWidths, false);
-        left._dataCols = buckets0[b];
+        left._dataCols = std::move(buckets0[b]);
         left._dataCols.emplace_back(left.rowNum(), 0);
 
-        std::vector<std::string> names1 = v1._fieldNames;
-        std::vector<int> widths1 = v1._fieldWidths;
         View right(v1._tableName, v1._fieldNames, v1._fieldWidths, false);
-        right._dataCols = buckets1[b];
+        right._dataCols = std::move(buckets1[b]);
         right._dataCols.emplace_back(right.rowNum(), 0);
 
-        View joined = nestedLoopJoin(left, right, field0, field1, compress);
+        return nestedLoopJoin(left, right, field0, field1, compress, tagBases[i]);
+    };
 
-        if (joined._dataCols.empty() || joined._dataCols[0].empty()) {
-            continue;
+    std::vector<View> joined(joinable.size());
+    if (concurrent) {
+        std::vector<std::future<View> > futures(joinable.size());
+        for (size_t i = 0; i < joinable.size(); ++i) {
+            futures[i] = ThreadPoolSupport::submit([&joinBucket, i]() {
+                return joinBucket(i);
+            });
         }
-
-        if (firstResult) {
-            result = joined;
-            firstResult = false;
-        } else {
-            for (size_t col = 0; col < result._dataCols.size(); ++col) {
-                result._dataCols[col].insert(result._dataCols[col].end(),
-                                             joined._dataCols[col].begin(),
-                                             joined._dataCols[col].end());
-            }
+        for (size_t i = 0; i < joinable.size(); ++i) {
+            joined[i] = futures[i].get();
+        }
+    } else {
+        for (size_t i = 0; i < joinable.size(); ++i) {
+            joined[i] = joinBucket(i);
         }
     }
 
-    if (firstResult) {
-        std::vector<std::string> fieldNames;
-        std::vector<int> fieldWidths;
-        size_t eff0 = v0.colNum() - 2;
-        size_t eff1 = v1.colNum() - 2;
-
-        fieldNames.reserve(eff0 + eff1);
-        fieldWidths.reserve(eff0 + eff1);
-
-        std::string t0 = v0._tableName.empty() ? "$t0" : v0._tableName;
-        std::string t1 = v1._tableName.empty() ? "$t1" : v1._tableName;
+    std::vector<size_t> offsets(joinable.size() + 1, 0);
+    for (size_t i = 0; i < joinable.size(); ++i) {
+        offsets[i + 1] = offsets[i] + joined[i].rowNum();
+    }
 
-        for (size_t i = 0; i < eff0; ++i) {
-            fieldNames.emplace_back(t0 + "." + v0._fieldNames[i]);
-            fieldWidths.emplace_back(v0._fieldWidths[i]);
-        }
-        for (size_t i = 0; i < eff1; ++i) {
-            fieldNames.emplace_back(t1 + "." + v1._fieldNames[i]);
-            fieldWidths.emplace_back(v1._fieldWidths[i]);
+    const size_t totalRows = offsets.back();
+    for (size_t col = 0; col < result._dataCols.size(); ++col) {
+        auto &dst = result._dataCols[col];
+        dst.resize(totalRows);
+        for (size_t i = 0; i < joined.size(); ++i) {
+            if (joined[i]._dataCols.empty()) {
+                continue;
+            }
+            const auto &src = joined[i]._dataCols[col];
+            std::copy(src.begin(), src.end(), dst.begin() + static_cast<int64_t>(offsets[i]));
         }
-
-        result = View(fieldNames, fieldWidths);
     }
 
     return result;
@@ -542,8 +788,13 @@ View Views::hashJoin(View &v0, View &v1, std::string &field0, std::string &field
 }
 
 View Views::hashJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress) {
+    return hashJoin(v0, v1, field0, field1, compress, 0);
+}
+
+View Views::hashJoin(View &v0, View &v1, std::string &field0, std::string &field1, bool compress,
+                     int msgTagBase) {
     if (DbConf::BASELINE_MODE) {
-        return nestedLoopJoin(v0, v1, field0, field1);
+        return nestedLoopJoin(v0, v1, field0, field1, true, msgTagBase);
     }
 
     int numBuckets = DbConf::SHUFFLE_BUCKET_NUM;
@@ -565,12 +816,12 @@ View Views::hashJoin(View &v0, View &v1, std::string &field0, std::string &field
     }
 
     if (tagColIndex0 == -1 || tagColIndex1 == -1) {
-        return nestedLoopJoin(v0, v1, field0, field1, compress);
+        return nestedLoopJoin(v0, v1, field0, field1, compress, msgTagBase);
     }
 
     std::vector<std::vector<std::vector<int64_t> > > buckets0, buckets1;
-    buckets0 = butterflyPermutation(v0, tagColIndex0, 0);
-    buckets1 = butterflyPermutation(v1, tagColIndex1, 0);
+    buckets0 = butterflyPermutation(v0, tagColIndex0, msgTagBase);
+    buckets1 = butterflyPermutation(v1, tagColIndex1, msgTagBase);
 
     for (int i = 0; i < numBuckets; i++) {
         if (!buckets0[i].empty() && !buckets1[i].empty() &&
@@ -578,7 +829,7 @@ View Views::hashJoin(View &v0, View &v1, std::string &field0, std::string &field
         }
     }
 
-    auto result = performBucketJoins(buckets0, buckets1, v0, v1, field0, field1, compress);
+    auto result = performBucketJoins(buckets0, buckets1, v0, v1, field0, field1, compress, msgTagBase);
 
     return result;
 }
@@ -612,7 +863,8 @@ View Views::leftOuterJoin(View &v0, View &v1, std::string &field0, std::string &
             in(const_cast<std::vector<int64_t> &>(left_keys),
                const_cast<std::vector<int64_t> &>(right_keys),
                const_cast<std::vector<int64_t> &>(v0._dataCols[v0_valid_idx]),
-               const_cast<std::vector<int64_t> &>(v1._dataCols[v1_valid_idx]));
+               const_cast<std::vector<int64_t> &>(v1._dataCols[v1_valid_idx]),
+               std::max(v0._fieldWidths[k0], v1._fieldWidths[k1]));
 
     const size_t eff0 = v0.colNum() - 2;
     const size_t eff1 = v1.colNum() - 2;
@@ -692,17 +944,6 @@ int64_t Views::hash(int64_t keyValue) {
     return (keyValue * 31 + 17) % DbConf::SHUFFLE_BUCKET_NUM;
 }
 
-std::vector<int64_t> Views::in(std::vector<int64_t> &col1,
-                               std::vector<int64_t> &col2,
-                               std::vector<int64_t> &left_valid,
-                               std::vector<int64_t> &right_valid) {
-    if (Conf::BATCH_SIZE <= 0 || Conf::DISABLE_MULTI_THREAD) {
-        return inSingleBatch(col1, col2, left_valid, right_valid);
-    } else {
-        return inMultiBatches(col1, col2, left_valid, right_valid);
-    }
-}
-
 static std::string makeBorder(const std::vector<size_t> &w) {
     std::ostringstream oss;
     oss << '+';
@@ -786,317 +1027,127 @@ void Views::revealAndPrint(View &v) {
     Log::i("\n{}", out.str());
 }
 
-std::vector<int64_t> Views::inSingleBatch(std::vector<int64_t> &col1,
-                                          std::vector<int64_t> &col2,
-                                          std::vector<int64_t> &left_valid,
-                                          std::vector<int64_t> &right_valid) {
+std::vector<int64_t> Views::in(std::vector<int64_t> &col1,
+                               std::vector<int64_t> &col2,
+                               std::vector<int64_t> &left_valid,
+                               std::vector<int64_t> &right_valid,
+                               int width) {
     const size_t n = col1.size();
     const size_t m = col2.size();
     std::vector<int64_t> result(n, 0);
-    if (n == 0 || m == 0) return result;
+    if (n == 0 || m == 0 || Comm::isClient()) return result;
 
     const int64_t rankShare = Comm::rank();
-
     const bool PRECISE = (!DbConf::BASELINE_MODE) && (!DbConf::DISABLE_PRECISE_COMPACTION);
-
-    size_t cols = m;
-    int L = 0;
-    while (cols > 1) {
-        cols = cols / 2 + (cols & 1);
-        ++L;
+    const bool useRightValid = !PRECISE && right_valid.size() == m;
+    const bool useLeftValid = !PRECISE && left_valid.size() == n;
+    if (!PRECISE && !useRightValid) {
+        Log::e("in: right_valid size mismatch: got {}, expect {}", right_valid.size(), m);
     }
-
-    const int eqStride = BoolEqualBatchOperator::tagStride();
-    const int andStride = BoolAndBatchOperator::tagStride();
-    const int tagStride = std::max(eqStride, andStride);
-
-    std::vector<int64_t> bigLeft(n * m), bigRight(n * m);
-    for (size_t i = 0; i < n; ++i) {
-        std::fill_n(bigLeft.begin() + i * m, m, col1[i]);
-        std::copy(col2.begin(), col2.end(), bigRight.begin() + i * m);
+    if (!PRECISE && !useLeftValid) {
+        Log::e("in: left_valid size mismatch: got {}, expect {}", left_valid.size(), n);
     }
-    auto equal_all = BoolEqualBatchOperator(&bigLeft, &bigRight,
-                                            64, 0,
-                                            0,
-                                            SecureOperator::NO_CLIENT_COMPUTE)
-            .execute()->_zis;
 
-    if (!PRECISE) {
-        if (right_valid.size() != m) {
-            Log::e("inSingleBatch: right_valid size mismatch: got {}, expect {}", right_valid.size(), m);
-        } else {
-            std::vector<int64_t> bigRightValid(n * m);
-            for (size_t i = 0; i < n; ++i) {
-                std::copy(right_valid.begin(), right_valid.end(),
-                          bigRightValid.begin() + i * m);
-            }
-            equal_all = BoolAndBatchOperator(&equal_all, &bigRightValid,
-                                             1, 0,
-                                             (L + 1) * tagStride,
-                                             SecureOperator::NO_CLIENT_COMPUTE)
-                    .execute()->_zis;
-        }
+    const size_t total = n + m;
+    int idxWidth = 1;
+    while ((static_cast<size_t>(1) << idxWidth) < total) {
+        ++idxWidth;
     }
 
-    for (auto &b: equal_all) b ^= rankShare;
-    std::vector<int64_t> cur = std::move(equal_all);
+    // Both sides in one view. Rows of col2 have side 0 so they sort before the col1 rows with the same key,
+    // and only they can start a hit.
+    std::vector<std::string> fieldNames = {"$key", "$side", "$idx", "$hit"};
+    std::vector<int> fieldWidths = {width, 1, idxWidth, 1};
+    View u(fieldNames, fieldWidths);
+    auto &keys = u._dataCols[0];
+    auto &sides = u._dataCols[1];
+    auto &indices = u._dataCols[2];
+    auto &hits = u._dataCols[3];
+    keys.reserve(total);
+    sides.reserve(total);
+    indices.reserve(total);
+    hits.reserve(total);
+    for (size_t j = 0; j < m; ++j) {
+        keys.push_back(Math::ring(col2[j], width));
+        sides.push_back(0);
+        indices.push_back(rankShare * static_cast<int64_t>(n + j));
+        hits.push_back(useRightValid ? right_valid[j] : rankShare);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(Math::ring(col1[i], width));
+        sides.push_back(rankShare);
+        indices.push_back(rankShare * static_cast<int64_t>(i));
+        hits.push_back(0);
+    }
+    u._dataCols[u.colNum() + View::VALID_COL_OFFSET].assign(total, rankShare);
+    u._dataCols[u.colNum() + View::PADDING_COL_OFFSET].assign(total, 0);
 
-    cols = m;
-    int round = 0;
-    std::vector<int64_t> andLeft, andRight, next;
+    int tag = 0;
+    const std::vector<std::string> orderFields = {"$key", "$side"};
+    const int sortStride = u.sortTagStride(orderFields);
+    u.sort(orderFields, {true, true}, tag);
+    tag += sortStride;
 
-    while (cols > 1) {
-        const size_t pairsPerRow = cols / 2;
-        const bool hasOdd = (cols & 1);
-        const size_t totalPairs = n * pairsPerRow;
+    // same[k] says rows k - d .. k share a key. Each scan step doubles d and ORs in the hit from d rows up,
+    // so after log(n + m) steps every row knows whether its run of equal keys holds a hit before it.
+    std::vector<int64_t> prevKeys(keys.begin(), keys.end() - 1), nextKeys(keys.begin() + 1, keys.end());
+    auto eqs = BoolEqualBatchOperator(&nextKeys, &prevKeys, width, 0, tag,
+                                      SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+    tag += BoolEqualBatchOperator::tagStride();
 
-        andLeft.resize(totalPairs);
-        andRight.resize(totalPairs);
+    std::vector<int64_t> same(total, 0);
+    std::copy(eqs.begin(), eqs.end(), same.begin() + 1);
 
-        size_t w = 0;
-        for (size_t i = 0; i < n; ++i) {
-            const size_t base = i * cols;
-            for (size_t p = 0; p < pairsPerRow; ++p) {
-                andLeft[w] = cur[base + 2 * p];
-                andRight[w] = cur[base + 2 * p + 1];
-                ++w;
-            }
+    const int andStride = BoolAndBatchOperator::tagStride();
+    for (size_t d = 1; d < total; d <<= 1) {
+        const size_t cnt = total - d;
+        std::vector<int64_t> xs, ys;
+        xs.reserve(2 * cnt);
+        ys.reserve(2 * cnt);
+        for (size_t k = d; k < total; ++k) {
+            xs.push_back(same[k]);
+            ys.push_back(hits[k - d]);
         }
-
-        auto andOut = BoolAndBatchOperator(&andLeft, &andRight,
-                                           1, 0,
-                                           (round + 1) * tagStride,
-                                           SecureOperator::NO_CLIENT_COMPUTE)
-                .execute()->_zis;
-
-        next.resize(n * (pairsPerRow + (hasOdd ? 1 : 0)));
-        w = 0;
-        for (size_t i = 0; i < n; ++i) {
-            const size_t nextBase = i * (pairsPerRow + (hasOdd ? 1 : 0));
-            for (size_t p = 0; p < pairsPerRow; ++p) {
-                next[nextBase + p] = andOut[w++];
-            }
-            if (hasOdd) next[nextBase + pairsPerRow] = cur[i * cols + (cols - 1)];
+        for (size_t k = d; k < total; ++k) {
+            xs.push_back(same[k]);
+            ys.push_back(same[k - d]);
         }
+        auto carried = BoolAndBatchOperator(&xs, &ys, 1, 0, tag,
+                                            SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        tag += andStride;
 
-        cur.swap(next);
-        cols = pairsPerRow + (hasOdd ? 1 : 0);
-        ++round;
-    }
-
-    for (size_t i = 0; i < n; ++i) result[i] = cur[i] ^ rankShare;
-
-    if (!PRECISE) {
-        if (left_valid.size() != n) {
-            Log::e("inSingleBatch: left_valid size mismatch: got {}, expect {}", left_valid.size(), n);
-        } else {
-            result = BoolAndBatchOperator(&result, &left_valid,
-                                          1, 0,
-                                          (L + 2) * tagStride,
-                                          SecureOperator::NO_CLIENT_COMPUTE)
-                    .execute()->_zis;
+        // hit | carried as !(!hit & !carried)
+        std::vector<int64_t> notHits(cnt), notCarried(cnt);
+        for (size_t t = 0; t < cnt; ++t) {
+            notHits[t] = hits[d + t] ^ rankShare;
+            notCarried[t] = carried[t] ^ rankShare;
         }
-    }
-
-    return result;
-}
-
-std::vector<int64_t> Views::inMultiBatches(std::vector<int64_t> &col1,
-                                           std::vector<int64_t> &col2,
-                                           std::vector<int64_t> &left_valid,
-                                           std::vector<int64_t> &right_valid) {
-    std::vector<int64_t> result(col1.size(), 0);
-    const size_t n = col1.size();
-    const size_t m = col2.size();
-    if (n == 0 || m == 0) return result;
-
-    const int64_t rankShare = Comm::rank();
-    const size_t totalSize = n * m;
-    const int batchSize = Conf::BATCH_SIZE;
-    const int numBatches = (totalSize + batchSize - 1) / batchSize;
-
-    const bool PRECISE = (!DbConf::BASELINE_MODE) && (!DbConf::DISABLE_PRECISE_COMPACTION);
-
-    size_t cols = m;
-    int reduceRounds = 0;
-    while (cols > 1) {
-        cols = cols / 2 + (cols & 1);
-        ++reduceRounds;
-    }
-
-    const int equalTagStride = BoolEqualBatchOperator::tagStride();
-    const int andTagStride = BoolAndBatchOperator::tagStride();
-
-    std::vector<std::future<std::vector<int64_t> > > equalFutures(numBatches);
-
-    for (int b = 0; b < numBatches; ++b) {
-        equalFutures[b] = ThreadPoolSupport::submit([&, b]() {
-            const size_t start = static_cast<size_t>(b) * batchSize;
-            const size_t end = std::min(totalSize, start + batchSize);
-            const size_t cnt = end - start;
-
-            std::vector<int64_t> batchLeft(cnt), batchRight(cnt);
-
-            for (size_t idx = start; idx < end; ++idx) {
-                const size_t i = idx / m;
-                const size_t j = idx % m;
-                batchLeft[idx - start] = col1[i];
-                batchRight[idx - start] = col2[j];
-            }
-
-            const int eqTag = b * (equalTagStride + (PRECISE ? 0 : andTagStride));
-            auto eqRes = BoolEqualBatchOperator(&batchLeft, &batchRight,
-                                                64, 0,
-                                                eqTag,
-                                                SecureOperator::NO_CLIENT_COMPUTE)
-                    .execute()->_zis;
-
-            if (!PRECISE) {
-                if (right_valid.size() == m) {
-                    std::vector<int64_t> rv(cnt);
-                    for (size_t idx = start; idx < end; ++idx) {
-                        const size_t j = idx % m;
-                        rv[idx - start] = right_valid[j];
-                    }
-                    const int andTag = eqTag + equalTagStride;
-                    eqRes = BoolAndBatchOperator(&eqRes, &rv,
-                                                 1, 0,
-                                                 andTag,
-                                                 SecureOperator::NO_CLIENT_COMPUTE)
-                            .execute()->_zis;
-                } else {
-                    Log::e("inMultiBatches: right_valid size mismatch: got {}, expect {}", right_valid.size(), m);
-                }
-            }
-
-            for (auto &bit: eqRes) bit ^= rankShare;
-            return eqRes;
-        });
-    }
-
-    std::vector<int64_t> cur;
-    cur.reserve(totalSize);
-    for (auto &f: equalFutures) {
-        auto part = f.get();
-        cur.insert(cur.end(), part.begin(), part.end());
-    }
-
-    size_t curCols = m;
-    int round = 0;
-
-    while (curCols > 1) {
-        const size_t pairsPerRow = curCols / 2;
-        const bool hasOdd = (curCols & 1);
-        const size_t totalPairs = n * pairsPerRow;
-
-        if (totalPairs == 0) break;
-
-        if (totalPairs <= static_cast<size_t>(batchSize)) {
-            std::vector<int64_t> andLeft(totalPairs), andRight(totalPairs);
-
-            size_t w = 0;
-            for (size_t i = 0; i < n; ++i) {
-                const size_t base = i * curCols;
-                for (size_t p = 0; p < pairsPerRow; ++p) {
-                    andLeft[w] = cur[base + 2 * p];
-                    andRight[w] = cur[base + 2 * p + 1];
-                    ++w;
-                }
-            }
-
-            const int andBaseTag = numBatches * (equalTagStride + (PRECISE ? 0 : andTagStride))
-                                   + round * andTagStride;
-            auto andOut = BoolAndBatchOperator(&andLeft, &andRight,
-                                               1, 0,
-                                               andBaseTag,
-                                               SecureOperator::NO_CLIENT_COMPUTE)
-                    .execute()->_zis;
-
-            std::vector<int64_t> next(n * (pairsPerRow + (hasOdd ? 1 : 0)));
-            w = 0;
-            for (size_t i = 0; i < n; ++i) {
-                const size_t nextBase = i * (pairsPerRow + (hasOdd ? 1 : 0));
-                for (size_t p = 0; p < pairsPerRow; ++p) {
-                    next[nextBase + p] = andOut[w++];
-                }
-                if (hasOdd) {
-                    next[nextBase + pairsPerRow] = cur[i * curCols + (curCols - 1)];
-                }
-            }
-            cur.swap(next);
-        } else {
-            const int andBatches = (totalPairs + batchSize - 1) / batchSize;
-            std::vector<std::future<std::vector<int64_t> > > andFuts(andBatches);
-
-            for (int b = 0; b < andBatches; ++b) {
-                andFuts[b] = ThreadPoolSupport::submit([&, b, round]() {
-                    const size_t start = static_cast<size_t>(b) * batchSize;
-                    const size_t end = std::min(totalPairs, start + batchSize);
-                    const size_t cnt = end - start;
-
-                    std::vector<int64_t> andLeft(cnt), andRight(cnt);
-
-                    size_t globalPairIdx = start;
-                    for (size_t t = 0; t < cnt; ++t, ++globalPairIdx) {
-                        size_t row = globalPairIdx / pairsPerRow;
-                        size_t p = globalPairIdx % pairsPerRow;
-                        const size_t base = row * curCols;
-                        andLeft[t] = cur[base + 2 * p];
-                        andRight[t] = cur[base + 2 * p + 1];
-                    }
+        auto ors = BoolAndBatchOperator(&notHits, &notCarried, 1, 0, tag,
+                                        SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
+        tag += andStride;
 
-                    const int andTag = numBatches * (equalTagStride + (PRECISE ? 0 : andTagStride))
-                                       + round * andTagStride
-                                       + b * andTagStride;
-                    return BoolAndBatchOperator(&andLeft, &andRight,
-                                                1, 0,
-                                                andTag,
-                                                SecureOperator::NO_CLIENT_COMPUTE)
-                            .execute()->_zis;
-                });
-            }
-
-            std::vector<int64_t> andOut;
-            andOut.reserve(totalPairs);
-            for (auto &f: andFuts) {
-                auto part = f.get();
-                andOut.insert(andOut.end(), part.begin(), part.end());
-            }
-
-            std::vector<int64_t> next(n * (pairsPerRow + (hasOdd ? 1 : 0)));
-            size_t w = 0;
-            for (size_t i = 0; i < n; ++i) {
-                const size_t nextBase = i * (pairsPerRow + (hasOdd ? 1 : 0));
-                for (size_t p = 0; p < pairsPerRow; ++p) {
-                    next[nextBase + p] = andOut[w++];
-                }
-                if (hasOdd) {
-                    next[nextBase + pairsPerRow] = cur[i * curCols + (curCols - 1)];
-                }
-            }
-            cur.swap(next);
+        for (size_t t = 0; t < cnt; ++t) {
+            hits[d + t] = ors[t] ^ rankShare;
+            same[d + t] = carried[cnt + t];
         }
-
-        curCols = pairsPerRow + (hasOdd ? 1 : 0);
-        ++round;
     }
 
-    result.resize(n);
-    for (size_t i = 0; i < n; ++i) result[i] = cur[i] ^ rankShare;
-
-    if (!PRECISE) {
-        if (left_valid.size() == n) {
-            const int finalMaskTag =
-                    numBatches * (equalTagStride + andTagStride)
-                    + reduceRounds * andTagStride;
-            result = BoolAndBatchOperator(&result, &left_valid,
-                                          1, 0,
-                                          finalMaskTag,
-                                          SecureOperator::NO_CLIENT_COMPUTE)
-                    .execute()->_zis;
-        } else {
-            Log::e("inMultiBatches: left_valid size mismatch: got {}, expect {}", left_valid.size(), n);
-        }
+    // Sorting on the original index puts the col1 rows back in order in front
+    std::vector<std::string> backNames = {"$idx", "$hit"};
+    std::vector<int> backWidths = {idxWidth, 1};
+    View back(backNames, backWidths);
+    back._dataCols[0] = std::move(indices);
+    back._dataCols[1] = std::move(hits);
+    back._dataCols[back.colNum() + View::VALID_COL_OFFSET].assign(total, rankShare);
+    back._dataCols[back.colNum() + View::PADDING_COL_OFFSET].assign(total, 0);
+    back.sort("$idx", true, tag);
+    tag += back.sortTagStride();
+
+    std::copy(back._dataCols[1].begin(), back._dataCols[1].begin() + static_cast<int64_t>(n), result.begin());
+
+    if (useLeftValid) {
+        result = BoolAndBatchOperator(&result, &left_valid, 1, 0, tag,
+                                      SecureOperator::NO_CLIENT_COMPUTE).execute()->_zis;
     }
 
     return result;
@@ -200,6 +200,11 @@ void SystemManager::clientExecute(const std::string &command) {
         goto over;
     }
 
+    if (InsertSupport::isMultiRowInsert(command)) {
+        InsertSupport::clientMultiRowInsert(resp, command);
+        goto over;
+    }
+
     if (!result.isValid()) {
         resp << "Failed. " << result.errorMsg() << std::endl;
         goto over;
@@ -220,6 +225,10 @@ void SystemManager::clientExecute(const std::string &command) {
                 if (!InsertSupport::clientInsert(resp, stmt)) goto over;
                 break;
             }
+            case hsql::kStmtImport: {
+                if (!InsertSupport::clientCopy(resp, stmt)) goto over;
+                break;
+            }
             case hsql::kStmtSelect: {
                 if (!SelectSupport::clientSelect(resp, stmt)) goto over;
                 break;
@@ -33,7 +33,7 @@ bool CreateSupport::clientCreateTable(std::ostringstream &resp, const hsql::SQLS
                 resp << "Failed. Only primary key constraint supported." << std::endl;
                 return false;
             }
-            keyField = *column->name;
+            keyField = column->name;
         }
 
         int type;
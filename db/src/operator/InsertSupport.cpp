@@ -1,46 +1,185 @@
-
 #include "operator/InsertSupport.h"
 
 #include <sstream>
+#include "../third_party/hsql/SQLParser.h"
+#include "../third_party/hsql/sql/ImportStatement.h"
 #include "../third_party/hsql/sql/InsertStatement.h"
 
 #include "basis/Table.h"
 #include "basis/View.h"
 #include "basis/Views.h"
 #include "comm/Comm.h"
+#include "conf/DbConf.h"
 #include "dbms/SystemManager.h"
 #include "secret/Secrets.h"
 #include "utils/Log.h"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
 #include <string>
-bool InsertSupport::clientInsert(std::ostringstream &resp, const hsql::SQLStatement *stmt) {
+#include <strings.h>
+
+namespace {
+    std::string trim(const std::string &s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        if (b == std::string::npos) {
+            return "";
+        }
+        size_t e = s.find_last_not_of(" \t\r");
+        return s.substr(b, e - b + 1);
+    }
+
+    bool parseInt(const std::string &s, int64_t &v) {
+        const char *end = s.data() + s.size();
+        auto [p, ec] = std::from_chars(s.data(), end, v);
+        return ec == std::errc() && p == end;
+    }
+
+    std::vector<std::string> splitCsv(const std::string &line) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(trim(field));
+        }
+        if (!line.empty() && line.back() == ',') {
+            fields.emplace_back();
+        }
+        return fields;
+    }
+
+    // Position right after the VALUES keyword of INSERT INTO <table> [(<columns>)] VALUES ..., or npos. Matched as
+    // a whole token in that place, so a table or column named like "myvalues" is not taken for it.
+    size_t valuesEnd(const std::string &command) {
+        size_t p = 0;
+        auto skipSpaces = [&]() {
+            while (p < command.size() && std::isspace(static_cast<unsigned char>(command[p]))) {
+                p++;
+            }
+        };
+        auto word = [&]() {
+            skipSpaces();
+            size_t b = p;
+            while (p < command.size() && !std::isspace(static_cast<unsigned char>(command[p])) && command[p] != '(') {
+                p++;
+            }
+            return command.substr(b, p - b);
+        };
+        if (strcasecmp(word().c_str(), "insert") != 0 || strcasecmp(word().c_str(), "into") != 0 || word().empty()) {
+            return std::string::npos;
+        }
+        skipSpaces();
+        if (p < command.size() && command[p] == '(') {
+            p = command.find(')', p);
+            if (p == std::string::npos) {
+                return p;
+            }
+            p++;
+        }
+        return strcasecmp(word().c_str(), "values") == 0 ? p : std::string::npos;
+    }
+
+    // Top-level "(...)" groups after VALUES
+    std::vector<std::string> splitTuples(const std::string &command, size_t from) {
+        std::vector<std::string> tuples;
+        int depth = 0;
+        size_t start = 0;
+        for (size_t i = from; i < command.size(); i++) {
+            if (command[i] == '(') {
+                if (depth++ == 0) {
+                    start = i;
+                }
+            } else if (command[i] == ')' && depth > 0 && --depth == 0) {
+                tuples.push_back(command.substr(start, i - start + 1));
+            }
+        }
+        return tuples;
+    }
+}
+
+InsertSupport::RowStream::RowStream(Table *table) : _table(table) {
+    json j;
+    j["type"] = SystemManager::getCommandPrefix(SystemManager::INSERT);
+    j["name"] = table->_tableName;
+    std::string m = j.dump();
+    Comm::send(m, 0, 0);
+    Comm::send(m, 1, 0);
+    _cols.resize(table->colNum());
+}
+
+void InsertSupport::RowStream::add(const std::vector<int64_t> &row) {
+    for (size_t c = 0; c < row.size(); c++) {
+        _cols[c].push_back(row[c]);
+    }
+    if (static_cast<int64_t>(_cols[0].size()) >= DbConf::INSERT_CHUNK_ROWS) {
+        flush();
+    }
+}
+
+void InsertSupport::RowStream::discard() {
+    for (auto &col: _cols) {
+        col.clear();
+    }
+}
+
+void InsertSupport::RowStream::flush() {
+    auto n = static_cast<int64_t>(_cols[0].size());
+    if (n == 0) {
+        return;
+    }
+    std::vector<int64_t> chunk;
+    chunk.reserve(n * _cols.size());
+    for (auto &col: _cols) {
+        chunk.insert(chunk.end(), col.begin(), col.end());
+        col.clear();
+    }
+    Comm::send(n, 64, 0, 0);
+    Comm::send(n, 64, 1, 0);
+    Secrets::boolShare(chunk, 2, _table->_maxWidth, 0);
+    _rows += n;
+}
+
+void InsertSupport::RowStream::finish() {
+    flush();
+    const int64_t end = 0;
+    Comm::send(end, 64, 0, 0);
+    Comm::send(end, 64, 1, 0);
+
     int64_t done;
-    const auto *insertStmt = dynamic_cast<const hsql::InsertStatement *>(stmt);
+    Comm::receive(done, 1, 0, 0);
+    Comm::receive(done, 1, 1, 0);
+}
 
-    std::string tableName = insertStmt->tableName;
+int64_t InsertSupport::RowStream::rows() const {
+    return _rows;
+}
+
+Table *InsertSupport::findTable(std::ostringstream &resp, const std::string &tableName) {
     Table *table = SystemManager::getInstance()._currentDatabase->getTable(tableName);
     if (!table) {
         resp << "Failed. Table `" + tableName + "` does not exist." << std::endl;
-        return false;
     }
-    const auto fieldNames = table->_fieldNames;
-
-    const auto columns = insertStmt->columns;
-    const auto values = insertStmt->values;
-    std::vector<std::string> cols;
+    return table;
+}
 
-    std::string keyField = table->_keyField;
+bool InsertSupport::resolveColumns(std::ostringstream &resp, const Table *table, const std::vector<std::string> &names,
+                                   std::vector<std::string> &cols) {
+    const auto &fieldNames = table->_fieldNames;
+    const std::string &keyField = table->_keyField;
     bool containsKey = !keyField.empty();
-    if (!insertStmt->columns) {
-        for (auto n : table->_fieldNames) {
+    cols.clear();
+    if (names.empty()) {
+        for (auto &n: fieldNames) {
             if (n.find(View::BUCKET_TAG_PREFIX) == 0) {
                 continue;
             }
             cols.emplace_back(n);
         }
     } else {
-        for (auto c: *columns) {
+        for (auto &c: names) {
             if (!containsKey && c == keyField) {
                 containsKey = true;
             }
@@ -52,78 +191,244 @@ bool InsertSupport::clientInsert(std::ostringstream &resp, const hsql::SQLStatem
         resp << "Failed. Key field value needed." << std::endl;
         return false;
     }
-    if (cols.size() != values->size()) {
-        resp << "Failed. Unmatched parameter numbers." << std::endl;
-        return false;
-    }
-    for (auto &column : cols) {
+    for (auto &column: cols) {
         if (std::find(fieldNames.begin(), fieldNames.end(), column) == fieldNames.end()) {
             resp << "Failed. Unknown field name `" + column + "`." << std::endl;
             return false;
         }
     }
+    return true;
+}
 
-    json j;
-    j["type"] = SystemManager::getCommandPrefix(SystemManager::INSERT);
-    j["name"] = tableName;
-    std::string m = j.dump();
-    Comm::send(m, 0, 0);
-    Comm::send(m, 1, 0);
+bool InsertSupport::buildRow(std::ostringstream &resp, const Table *table, const std::vector<std::string> &cols,
+                             const std::vector<int64_t> &values, std::vector<int64_t> &row) {
+    const auto &fieldNames = table->_fieldNames;
+    if (cols.size() != values.size()) {
+        resp << "Failed. Unmatched parameter numbers." << std::endl;
+        return false;
+    }
 
-    std::vector<int64_t> parsedValues;
+    row.assign(table->colNum(), 0);
     int64_t keyValue = 0;
-    for (size_t i = 0; i < values->size(); ++i) {
-        const auto expr = (*values)[i];
-        int64_t v;
+    for (size_t i = 0; i < cols.size(); ++i) {
+        int64_t idx = std::distance(fieldNames.begin(), std::find(fieldNames.begin(), fieldNames.end(), cols[i]));
+        int type = table->_fieldWidths[idx];
+        int64_t v = values[i];
+        int64_t masked = v & ((1LL << type) - 1);
+        if (type < 64 && masked != v) {
+            resp << "Failed. Inserted parameters out of range." << std::endl;
+            return false;
+        }
+        row[idx] = v;
+        if (cols[i] == table->_keyField) {
+            keyValue = v;
+        }
+    }
+
+    int tagIdx = table->colIndex(View::BUCKET_TAG_PREFIX + table->_keyField);
+    if (tagIdx >= 0) {
+        row[tagIdx] = Views::hash(keyValue);
+    }
+    return true;
+}
 
+bool InsertSupport::parseValues(std::ostringstream &resp, const hsql::InsertStatement *insertStmt,
+                                std::vector<int64_t> &values) {
+    values.clear();
+    for (const auto *expr: *insertStmt->values) {
         if (expr->type == hsql::kExprLiteralInt) {
-            v = expr->ival;
-        } else if (expr->type == hsql::kExprOperator && expr->expr->type == hsql::kExprLiteralInt) {
-            if (expr->opType == hsql::kOpUnaryMinus) {
-                v = -expr->expr->ival;
-            }
+            values.push_back(expr->ival);
+        } else if (expr->type == hsql::kExprOperator && expr->expr->type == hsql::kExprLiteralInt &&
+                   expr->opType == hsql::kOpUnaryMinus) {
+            values.push_back(-expr->expr->ival);
         } else {
             resp << "Failed. Unsupported value type." << std::endl;
             return false;
         }
+    }
+    return true;
+}
 
-        int64_t idx = std::distance(fieldNames.begin(),
-                                    std::find(fieldNames.begin(), fieldNames.end(), cols[i]));
-        int type = table->_fieldWidths[idx];
-        int64_t masked = v & ((1LL << type) - 1);
-        if (type < 64 && masked != v) {
-            resp << "Failed. Inserted parameters out of range." << std::endl;
+bool InsertSupport::clientInsert(std::ostringstream &resp, const hsql::SQLStatement *stmt) {
+    const auto *insertStmt = dynamic_cast<const hsql::InsertStatement *>(stmt);
+
+    Table *table = findTable(resp, insertStmt->tableName);
+    if (!table) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    if (insertStmt->columns) {
+        for (auto c: *insertStmt->columns) {
+            names.emplace_back(c);
+        }
+    }
+    std::vector<std::string> cols;
+    std::vector<int64_t> values, row;
+    if (!resolveColumns(resp, table, names, cols) || !parseValues(resp, insertStmt, values) ||
+        !buildRow(resp, table, cols, values, row)) {
+        return false;
+    }
+
+    RowStream stream(table);
+    stream.add(row);
+    stream.finish();
+    resp << "OK. Record inserted into `" + table->_tableName + "`." << std::endl;
+
+    return true;
+}
+
+bool InsertSupport::isMultiRowInsert(const std::string &command) {
+    std::istringstream iss(command);
+    std::string word;
+    iss >> word;
+    if (strcasecmp(word.c_str(), "insert") != 0) {
+        return false;
+    }
+    size_t from = valuesEnd(command);
+    return from != std::string::npos && splitTuples(command, from).size() > 1;
+}
+
+bool InsertSupport::clientMultiRowInsert(std::ostringstream &resp, const std::string &command) {
+    size_t from = valuesEnd(command);
+    std::string prefix = command.substr(0, from);
+    auto tuples = splitTuples(command, from);
+
+    // Every tuple is parsed as its own single-row INSERT, and all rows are checked before any is sent
+    Table *table = nullptr;
+    std::vector<std::string> cols;
+    std::vector<std::vector<int64_t> > rows(tuples.size());
+    for (size_t t = 0; t < tuples.size(); t++) {
+        hsql::SQLParserResult result;
+        hsql::SQLParser::parse(prefix + " " + tuples[t] + ";", &result);
+        if (!result.isValid() || result.size() != 1 || result.getStatement(0)->type() != hsql::kStmtInsert) {
+            resp << "Failed. Row " << t + 1 << ": " << (result.isValid() ? "not an INSERT." : result.errorMsg())
+                    << std::endl;
             return false;
         }
-        parsedValues.emplace_back(v);
-        if (cols[i] == keyField) {
-            keyValue = v;
+        const auto *insertStmt = dynamic_cast<const hsql::InsertStatement *>(result.getStatement(0));
+        if (t == 0) {
+            table = findTable(resp, insertStmt->tableName);
+            if (!table) {
+                return false;
+            }
+            std::vector<std::string> names;
+            if (insertStmt->columns) {
+                for (auto c: *insertStmt->columns) {
+                    names.emplace_back(c);
+                }
+            }
+            if (!resolveColumns(resp, table, names, cols)) {
+                return false;
+            }
+        }
+        std::vector<int64_t> values;
+        if (!parseValues(resp, insertStmt, values) || !buildRow(resp, table, cols, values, rows[t])) {
+            return false;
         }
     }
 
-    cols.push_back(View::BUCKET_TAG_PREFIX + keyField);
-    parsedValues.emplace_back(Views::hash(keyValue));
+    RowStream stream(table);
+    for (auto &row: rows) {
+        stream.add(row);
+    }
+    stream.finish();
+    resp << "OK. " << stream.rows() << " records inserted into `" + table->_tableName + "`." << std::endl;
+    return true;
+}
+
+bool InsertSupport::clientCopy(std::ostringstream &resp, const hsql::SQLStatement *stmt) {
+    const auto *importStmt = dynamic_cast<const hsql::ImportStatement *>(stmt);
+    if (importStmt->type != hsql::kImportCSV && importStmt->type != hsql::kImportAuto) {
+        resp << "Failed. Only CSV files can be copied." << std::endl;
+        return false;
+    }
 
-    std::vector<int64_t> shareValues(table->colNum());
-    for (size_t i = 0; i < table->colNum(); ++i) {
-        const auto &find = std::find(cols.begin(), cols.end(), fieldNames[i]);
-        int64_t idx = std::distance(cols.begin(), find);
+    Table *table = findTable(resp, importStmt->tableName);
+    if (!table) {
+        return false;
+    }
 
-        int64_t v = find != cols.end() ? parsedValues[idx] : 0;
-        shareValues[i] = v;
+    std::ifstream in(importStmt->filePath);
+    if (!in) {
+        resp << "Failed. Cannot open `" << importStmt->filePath << "`." << std::endl;
+        return false;
     }
-    Secrets::boolShare(shareValues, 2, table->_maxWidth, 0);
 
-    Comm::receive(done, 1, 0, 0);
-    Comm::receive(done, 1, 1, 0);
-    resp << "OK. Record inserted into `" + tableName + "`." << std::endl;
+    // A first line that is not all integers is the header
+    std::string line;
+    int64_t lineNo = 0;
+    std::vector<std::string> names;
+    std::vector<std::string> first;
+    while (first.empty() && std::getline(in, line)) {
+        lineNo++;
+        if (!trim(line).empty()) {
+            first = splitCsv(line);
+        }
+    }
+    int64_t probe;
+    bool header = std::any_of(first.begin(), first.end(), [&](const std::string &f) { return !parseInt(f, probe); });
+    if (header) {
+        names = first;
+        first.clear();
+    }
+    std::vector<std::string> cols;
+    if (!resolveColumns(resp, table, names, cols)) {
+        return false;
+    }
+
+    // Rows are streamed as the file is read, so a bad line stops the copy after the chunks already sent
+    RowStream stream(table);
+    std::vector<int64_t> values, row;
+    std::ostringstream error;
+    auto addLine = [&](const std::vector<std::string> &fields) {
+        values.resize(fields.size());
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (!parseInt(fields[i], values[i])) {
+                error << "Failed. Bad value `" << fields[i] << "` on line " << lineNo << "." << std::endl;
+                return false;
+            }
+        }
+        std::ostringstream rowError;
+        if (!buildRow(rowError, table, cols, values, row)) {
+            error << rowError.str().substr(0, rowError.str().size() - 1) << " (line " << lineNo << ")" << std::endl;
+            return false;
+        }
+        stream.add(row);
+        return true;
+    };
+
+    bool ok = first.empty() || addLine(first);
+    while (ok && std::getline(in, line)) {
+        lineNo++;
+        if (!trim(line).empty()) {
+            ok = addLine(splitCsv(line));
+        }
+    }
+    if (!ok) {
+        // Drop the rows of the unfinished chunk, the earlier chunks are already on the servers
+        stream.discard();
+    }
+    stream.finish();
 
+    if (!ok) {
+        resp << error.str() << stream.rows() << " records were inserted before it." << std::endl;
+        return false;
+    }
+    resp << "OK. " << stream.rows() << " records copied into `" + table->_tableName + "`." << std::endl;
     return true;
 }
 
 void InsertSupport::serverInsert(nlohmann::basic_json<> j) {
     std::string tbName = j.at("name").get<std::string>();
     Table *table = SystemManager::getInstance()._currentDatabase->getTable(tbName);
-    auto record = Secrets::boolShare(Table::EMPTY_COL, 2, table->_maxWidth, 0);
-    table->insert(record);
+    while (true) {
+        int64_t rows;
+        Comm::receive(rows, 64, 2, 0);
+        if (rows == 0) {
+            break;
+        }
+        auto chunk = Secrets::boolShare(Table::EMPTY_COL, 2, table->_maxWidth, 0);
+        table->insertColumns(chunk, rows);
+    }
 }
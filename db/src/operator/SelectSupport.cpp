@@ -11,6 +11,7 @@
 #include "../third_party/hsql/sql/Table.h"
 #include "basis/Views.h"
 #include "comm/Comm.h"
+#include "conf/DbConf.h"
 #include "secret/Secrets.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
@@ -362,7 +363,14 @@ void SelectSupport::serverSelect(json js) {
             if (firstJoin) {
                 View leftView = tableViews[leftTableName];
                 View rightView = tableViews[rightTableName];
-                currentResult = Views::hashJoin(leftView, rightView, leftField, rightField);
+                Table *leftTable = SystemManager::getInstance()._currentDatabase->getTable(leftTableName);
+                bool leftKeyed = DbConf::ENABLE_SORT_MERGE_JOIN && !leftTable->_keyField.empty() &&
+                                 leftField == Views::getAliasColName(leftTableName, leftTable->_keyField);
+                if (leftKeyed) {
+                    currentResult = Views::sortMergeJoin(leftView, rightView, leftField, rightField);
+                } else {
+                    currentResult = Views::hashJoin(leftView, rightView, leftField, rightField);
+                }
                 tablesInResult.insert(leftTableName);
                 tablesInResult.insert(rightTableName);
                 firstJoin = false;
@@ -75,15 +75,12 @@ bool testBackground(std::string pmt, int width, std::vector<int64_t> &originsA,
             for (int b = 0; b < batch_num; ++b) {
                 int startIdx = b * batch_size;
                 int endIdx = std::min((b + 1) * batch_size, static_cast<int>(secretsA.size()));
-                std::shared_ptr<std::vector<BitwiseBmt> > bmtB = std::make_shared<std::vector<BitwiseBmt> >(
-                    IntermediateDataSupport::pollBitwiseBmts(
-                        BoolLessBatchOperator::bmtCount(endIdx - startIdx, width), 64));
-                futures[b] = ThreadPoolSupport::submit([&, b, bmtB, startIdx, endIdx] {
+                futures[b] = ThreadPoolSupport::submit([&, b, startIdx, endIdx] {
                     std::vector<int64_t> batchA(secretsA.begin() + startIdx, secretsA.begin() + endIdx);
                     std::vector<int64_t> batchB(secretsB.begin() + startIdx, secretsB.begin() + endIdx);
                     return BoolLessBatchOperator(&batchA, &batchB, width, task,
                                                  BoolLessBatchOperator::tagStride() * b,
-                                                 -1).setBmts(bmtB.get())->execute()->_zis;
+                                                 -1).execute()->_zis;
                 });
             }
             for (auto &f: futures) {
@@ -98,15 +95,12 @@ bool testBackground(std::string pmt, int width, std::vector<int64_t> &originsA,
             for (int b = 0; b < batch_num; ++b) {
                 int startIdx = b * batch_size;
                 int endIdx = std::min((b + 1) * batch_size, static_cast<int>(secretsA.size()));
-                std::shared_ptr<std::vector<BitwiseBmt> > bmtB = std::make_shared<std::vector<BitwiseBmt> >(
-                    IntermediateDataSupport::pollBitwiseBmts(
-                        BoolLessBatchOperator::bmtCount(endIdx - startIdx, width), 64));
-                futures[b] = ThreadPoolSupport::submit([&, b, bmtB, startIdx, endIdx] {
+                futures[b] = ThreadPoolSupport::submit([&, b, startIdx, endIdx] {
                     std::vector<int64_t> batchA(secretsA.begin() + startIdx, secretsA.begin() + endIdx);
                     std::vector<int64_t> batchB(secretsB.begin() + startIdx, secretsB.begin() + endIdx);
                     auto zsB = BoolLessBatchOperator(&batchB, &batchA, width, task,
                                                      BoolLessBatchOperator::tagStride() * b,
-                                                     -1).setBmts(bmtB.get())->execute()->_zis;
+                                                     -1).execute()->_zis;
                     for (auto &t: zsB) {
                         t = t ^ Comm::rank();
                     }
@@ -125,15 +119,12 @@ bool testBackground(std::string pmt, int width, std::vector<int64_t> &originsA,
             for (int b = 0; b < batch_num; ++b) {
                 int startIdx = b * batch_size;
                 int endIdx = std::min((b + 1) * batch_size, static_cast<int>(secretsA.size()));
-                std::shared_ptr<std::vector<BitwiseBmt> > bmtB = std::make_shared<std::vector<BitwiseBmt> >(
-                    IntermediateDataSupport::pollBitwiseBmts(
-                        BoolEqualBatchOperator::bmtCount(endIdx - startIdx, width), 64));
-                futures[b] = ThreadPoolSupport::submit([&, b, bmtB, startIdx, endIdx] {
+                futures[b] = ThreadPoolSupport::submit([&, b, startIdx, endIdx] {
                     std::vector<int64_t> batchA(secretsA.begin() + startIdx, secretsA.begin() + endIdx);
                     std::vector<int64_t> batchB(secretsB.begin() + startIdx, secretsB.begin() + endIdx);
                     return BoolEqualBatchOperator(&batchA, &batchB, width, task,
                                                   BoolEqualBatchOperator::tagStride() * b,
-                                                  -1).setBmts(bmtB.get())->execute()->_zis;
+                                                  -1).execute()->_zis;
                 });
             }
             for (auto &f: futures) {
@@ -148,15 +139,12 @@ bool testBackground(std::string pmt, int width, std::vector<int64_t> &originsA,
             for (int b = 0; b < batch_num; ++b) {
                 int startIdx = b * batch_size;
                 int endIdx = std::min((b + 1) * batch_size, static_cast<int>(secretsA.size()));
-                std::shared_ptr<std::vector<BitwiseBmt> > bmtB = std::make_shared<std::vector<BitwiseBmt> >(
-                    IntermediateDataSupport::pollBitwiseBmts(
-                        BoolEqualBatchOperator::bmtCount(endIdx - startIdx, width), 64));
-                futures[b] = ThreadPoolSupport::submit([&, b, bmtB, startIdx, endIdx] {
+                futures[b] = ThreadPoolSupport::submit([&, b, startIdx, endIdx] {
                     std::vector<int64_t> batchA(secretsA.begin() + startIdx, secretsA.begin() + endIdx);
                     std::vector<int64_t> batchB(secretsB.begin() + startIdx, secretsB.begin() + endIdx);
                     auto zsB = BoolEqualBatchOperator(&batchA, &batchB, width, task,
                                                       BoolEqualBatchOperator::tagStride() * b,
-                                                      -1).setBmts(bmtB.get())->execute()->_zis;
+                                                      -1).execute()->_zis;
                     for (auto &t: zsB) {
                         t = t ^ Comm::rank();
                     }
@@ -175,17 +163,14 @@ bool testBackground(std::string pmt, int width, std::vector<int64_t> &originsA,
             for (int b = 0; b < batch_num; ++b) {
                 int startIdx = b * batch_size;
                 int endIdx = std::min((b + 1) * batch_size, static_cast<int>(secretsA.size()));
-                std::shared_ptr<std::vector<BitwiseBmt> > bmtB = std::make_shared<std::vector<BitwiseBmt> >(
-                    IntermediateDataSupport::pollBitwiseBmts(
-                        BoolMutexBatchOperator::bmtCount(endIdx - startIdx, width), 64));
-                futures[b] = ThreadPoolSupport::submit([&, b, bmtB, startIdx, endIdx] {
+                futures[b] = ThreadPoolSupport::submit([&, b, startIdx, endIdx] {
                     std::vector<int64_t> batchA(secretsA.begin() + startIdx, secretsA.begin() + endIdx);
                     std::vector<int64_t> batchB(secretsB.begin() + startIdx, secretsB.begin() + endIdx);
                     std::vector<int64_t> batchC(secretConditions.begin() + startIdx,
                                                 secretConditions.begin() + endIdx);
                     return BoolMutexBatchOperator(&batchA, &batchB, &batchC, width, task,
                                                   BoolMutexBatchOperator::tagStride() * b,
-                                                  -1).setBmts(bmtB.get())->execute()->_zis;
+                                                  -1).execute()->_zis;
                 });
             }
             for (auto &f: futures) {
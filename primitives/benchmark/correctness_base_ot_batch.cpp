@@ -2,7 +2,9 @@
 // Created on 2026-02-17.
 //
 
+#include "conf/Conf.h"
 #include "ot/BaseOtBatchOperator.h"
+#include "ot/EcBaseOtBatchOperator.h"
 #include "utils/Log.h"
 #include "utils/StringUtils.h"
 #include "utils/System.h"
@@ -22,19 +24,16 @@ int main(int argc, char *argv[]) {
         choices.push_back(i % 2);
     }
 
-    // Test BaseOtBatchOperator
-    std::vector<int64_t> results = BaseOtBatchOperator(
-        0,
-        isSender ? &ss0 : nullptr,
-        isSender ? &ss1 : nullptr,
-        !isSender ? &choices : nullptr,
-        64,
-        1,
-        0
-    ).execute()->_results;
+    // Test the base OT selected by --base_ot
+    auto *ms0 = isSender ? &ss0 : nullptr;
+    auto *ms1 = isSender ? &ss1 : nullptr;
+    auto *cs = !isSender ? &choices : nullptr;
+    std::vector<int64_t> results = Conf::BASE_OT_TYPE == Conf::BASE_OT_EC
+                                       ? EcBaseOtBatchOperator(0, ms0, ms1, cs, 64, 1, 0).execute()->_results
+                                       : BaseOtBatchOperator(0, ms0, ms1, cs, 64, 1, 0).execute()->_results;
 
     if (Comm::rank() == 1) {
-        Log::i("BaseOtBatchOperator results: {}", StringUtils::vecToString(results));
+        Log::i("Base OT results: {}", StringUtils::vecToString(results));
 
         // Verify results
         for (int i = 0; i < 10; i++) {
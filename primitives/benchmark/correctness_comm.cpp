@@ -0,0 +1,112 @@
+#include "comm/Comm.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Round-trips every Comm call between the two servers and from the client. Run it with
+// --comm_type=mpi and --comm_type=tcp (optionally --enable_transfer_compression=true); without a
+// launcher, start three processes with --comm_type=tcp --party=0/1/2.
+int main(int argc, char **argv) {
+    System::init(argc, argv);
+
+    const int width = 13;
+    const int n = 10000;
+    int failures = 0;
+    auto check = [&failures](bool ok, const char *what) {
+        if (!ok) {
+            failures++;
+            Log::e("MISMATCH {}", what);
+        }
+    };
+
+    // Deterministic payloads so each side knows what the other one sent
+    auto payload = [](int from, int size) {
+        std::vector<int64_t> v(size);
+        for (int i = 0; i < size; i++) {
+            v[i] = Math::ring(static_cast<int64_t>(i) * 7919 + from * 104729, width);
+        }
+        return v;
+    };
+
+    if (Comm::isServer()) {
+        int self = Comm::rank();
+        int peer = 1 - self;
+
+        // Blocking exchange in opposite orders, so rank 1 receives before it sends
+        std::vector<int64_t> got;
+        if (self == 0) {
+            Comm::serverSend(payload(self, n), width, 1);
+            Comm::serverReceive(got, width, 1);
+        } else {
+            Comm::serverReceive(got, width, 1);
+            Comm::serverSend(payload(self, n), width, 1);
+        }
+        check(got == payload(peer, n), "blocking vector");
+
+        int64_t scalar = 0;
+        Comm::serverSend(static_cast<int64_t>(self + 42), width, 2);
+        Comm::serverReceive(scalar, width, 2);
+        check(scalar == peer + 42, "blocking scalar");
+
+        std::string str;
+        Comm::serverSend(std::string("from ") + std::to_string(self), 3);
+        Comm::serverReceive(str, 3);
+        check(str == "from " + std::to_string(peer), "blocking string");
+
+        // Receives posted in the reverse order of the sends, several frames per tag
+        std::vector<int64_t> a, b0, b1, empty;
+        std::string s;
+        int64_t x = 0;
+        auto r0 = Comm::serverReceiveAsync(b0, n, width, 11);
+        auto r1 = Comm::serverReceiveAsync(b1, n, width, 11);
+        auto r2 = Comm::serverReceiveAsync(a, 100, width, 10);
+        auto r3 = Comm::serverReceiveAsync(s, 5, 12);
+        auto r4 = Comm::serverReceiveAsync(x, width, 13);
+        auto r5 = Comm::serverReceiveAsync(empty, 0, width, 14);
+        // Async sends keep referring to their source until waited on
+        int64_t px = self;
+        std::string ps = "abcde";
+        auto pa = payload(self, 100), pb0 = payload(self + 2, n), pb1 = payload(self + 4, n), pe = payload(self, 0);
+        auto s0 = Comm::serverSendAsync(px, width, 13);
+        auto s1 = Comm::serverSendAsync(ps, 12);
+        auto s2 = Comm::serverSendAsync(pa, width, 10);
+        auto s3 = Comm::serverSendAsync(pb0, width, 11);
+        auto s4 = Comm::serverSendAsync(pb1, width, 11);
+        auto s5 = Comm::serverSendAsync(pe, width, 14);
+        for (auto *r: {r0, r1, r2, r3, r4, r5, s0, s1, s2, s3, s4, s5}) {
+            Comm::wait(r);
+        }
+        check(a == payload(peer, 100), "async vector");
+        check(b0 == payload(peer + 2, n) && b1 == payload(peer + 4, n), "async order per tag");
+        check(s == "abcde", "async string");
+        check(x == peer, "async scalar");
+        check(empty.empty(), "async empty vector");
+
+        std::vector<int64_t> fromClient;
+        Comm::receive(fromClient, width, 2, 20);
+        check(fromClient == payload(2 + self, 64), "client vector");
+        Comm::send(fromClient, width, 2, 21);
+    } else {
+        for (int server = 0; server < 2; server++) {
+            Comm::send(payload(2 + server, 64), width, server, 20);
+        }
+        for (int server = 0; server < 2; server++) {
+            std::vector<int64_t> echo;
+            Comm::receive(echo, width, server, 21);
+            check(echo == payload(2 + server, 64), "client echo");
+        }
+    }
+
+    if (failures == 0) {
+        Log::i("[Comm correctness] rank={} PASS", Comm::rank());
+    } else {
+        Log::i("[Comm correctness] rank={} FAIL mismatches={}", Comm::rank(), failures);
+    }
+
+    System::finalize();
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include "comm/Comm.h"
+#include "compute/batch/arith/ArithMultiplyBatchOperator.h"
+#include "compute/batch/arith/ArithToBoolBatchOperator.h"
+#include "compute/batch/bool/BoolAndBatchOperator.h"
+#include "compute/batch/bool/BoolEqualBatchOperator.h"
+#include "compute/batch/bool/BoolLessBatchOperator.h"
+#include "compute/batch/bool/BoolToArithBatchOperator.h"
+#include "conf/Conf.h"
+#include "parallel/ThreadPoolSupport.h"
+#include "secret/Secrets.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Plaintext-checked batch operators. Each case shares random client inputs, runs one operator on the
+// servers and compares the reconstructed outputs on the client. Pass --op=<name> to run a single case.
+
+// Compares on the client and prints one PASS/FAIL line per case
+static void check(const std::string &op, const std::string &params, const std::vector<int64_t> &expected,
+                  const std::vector<int64_t> &got) {
+    if (!Comm::isClient()) {
+        return;
+    }
+    int mismatch = expected.size() == got.size() ? 0 : 1;
+    for (size_t i = 0; i < expected.size() && i < got.size(); i++) {
+        if (expected[i] != got[i]) {
+            mismatch++;
+            if (mismatch <= 10) {
+                Log::e("MISMATCH {} {} i={}: expected={} got={}", op, params, i, expected[i], got[i]);
+            }
+        }
+    }
+    if (mismatch == 0) {
+        Log::i("[{} correctness] {} PASS", op, params);
+    } else {
+        Log::i("[{} correctness] {} FAIL mismatches={}", op, params, mismatch);
+    }
+}
+
+static std::vector<int64_t> randomInputs(int n, int width) {
+    std::vector<int64_t> xs;
+    if (Comm::isClient()) {
+        xs.resize(n);
+        for (int i = 0; i < n; i++) {
+            xs[i] = Math::ring(Math::randInt(), width);
+        }
+    }
+    return xs;
+}
+
+// Runs work on chunks of [0, n) concurrently on the thread pool, chunk b at msgTagOffset stride * b.
+// Which thread polls first differs between the servers, so this checks that triples still pair up.
+static std::vector<int64_t> splitAcrossPool(int n, int stride,
+                                            const std::function<std::vector<int64_t>(int, int, int)> &work) {
+    std::vector<int64_t> zs;
+    if (!Comm::isServer()) {
+        return zs;
+    }
+    const int chunks = 8;
+    const int chunkSize = (n + chunks - 1) / chunks;
+    std::vector<std::future<std::vector<int64_t> > > futures;
+    for (int b = 0; b * chunkSize < n; b++) {
+        futures.push_back(ThreadPoolSupport::submit([&, b] {
+            return work(b * chunkSize, std::min(n, (b + 1) * chunkSize), stride * b);
+        }));
+    }
+    for (auto &f: futures) {
+        auto part = f.get();
+        zs.insert(zs.end(), part.begin(), part.end());
+    }
+    return zs;
+}
+
+// Run with --bmt_method=bmt_background or bmt_pipeline to take triples from the queues
+static void boolAndThreads(int task) {
+    const int n = 4000;
+    for (int width: {1, 16, 64}) {
+        auto xs = randomInputs(n, width);
+        auto ys = randomInputs(n, width);
+        std::vector<int64_t> expected(xs.size());
+        for (size_t i = 0; i < xs.size(); i++) {
+            expected[i] = xs[i] & ys[i];
+        }
+        auto xShares = Secrets::boolShare(xs, 2, width, task);
+        auto yShares = Secrets::boolShare(ys, 2, width, task);
+
+        auto zs = splitAcrossPool(n, BoolAndBatchOperator::tagStride(), [&](int start, int end, int msgTagOffset) {
+            std::vector<int64_t> xPart(xShares.begin() + start, xShares.begin() + end);
+            std::vector<int64_t> yPart(yShares.begin() + start, yShares.begin() + end);
+            return BoolAndBatchOperator(&xPart, &yPart, width, task, msgTagOffset, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        });
+        check("BoolAnd threads", "width=" + std::to_string(width), expected,
+              Secrets::boolReconstruct(zs, 2, width, task));
+    }
+}
+
+static void boolEqual(int task) {
+    const int n = 100;
+    for (int width: {1, 3, 7, 16, 31, 64}) {
+        auto xs = randomInputs(n, width);
+        std::vector<int64_t> ys(xs.size()), expected(xs.size());
+        for (size_t i = 0; i < xs.size(); i++) {
+            // Every other pair is equal so both outcomes are covered
+            ys[i] = i % 2 == 0 ? xs[i] : Math::ring(xs[i] ^ (1ll << (i % width)), width);
+            expected[i] = xs[i] == ys[i];
+        }
+        auto xShares = Secrets::boolShare(xs, 2, width, task);
+        auto yShares = Secrets::boolShare(ys, 2, width, task);
+
+        std::vector<int64_t> zs;
+        if (Comm::isServer()) {
+            zs = BoolEqualBatchOperator(&xShares, &yShares, width, task, 0, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        }
+        check("BoolEqual", "width=" + std::to_string(width), expected, Secrets::boolReconstruct(zs, 2, 1, task));
+    }
+}
+
+// Widths that are not powers of two take the padded prefix tree. Values compare as int64, which is
+// unsigned below 64 bits.
+static void boolLess(int task) {
+    const int n = 100;
+    for (int width: {3, 8, 17, 33, 64}) {
+        auto xs = randomInputs(n, width);
+        auto ys = randomInputs(n, width);
+        std::vector<int64_t> expected(xs.size());
+        for (size_t i = 0; i < xs.size(); i++) {
+            // Equal pairs must come out false
+            if (i % 4 == 0) ys[i] = xs[i];
+            expected[i] = xs[i] < ys[i];
+        }
+        auto xShares = Secrets::boolShare(xs, 2, width, task);
+        auto yShares = Secrets::boolShare(ys, 2, width, task);
+
+        std::vector<int64_t> zs;
+        if (Comm::isServer()) {
+            zs = BoolLessBatchOperator(&xShares, &yShares, width, task, 0, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        }
+        check("BoolLess", "width=" + std::to_string(width), expected, Secrets::boolReconstruct(zs, 2, 1, task));
+    }
+}
+
+static void arithToBool(int task) {
+    const int n = 100;
+    for (int width: {1, 5, 8, 32, 64}) {
+        auto xs = randomInputs(n, width);
+        auto shares = Secrets::arithShare(xs, 2, width, task);
+
+        std::vector<int64_t> zs;
+        if (Comm::isServer()) {
+            zs = ArithToBoolBatchOperator(&shares, width, task, 0, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        }
+        check("ArithToBool", "width=" + std::to_string(width), xs, Secrets::boolReconstruct(zs, 2, width, task));
+    }
+}
+
+static void boolToArith(int task) {
+    const int n = 100;
+    // (input width, output width): full-width conversion and bit-to-ring lifting
+    for (auto [inputWidth, width]: std::vector<std::pair<int, int> >{{16, 16}, {64, 64}, {1, 64}, {4, 32}}) {
+        auto xs = randomInputs(n, inputWidth);
+        auto shares = Secrets::boolShare(xs, 2, inputWidth, task);
+
+        std::vector<int64_t> zs;
+        if (Comm::isServer()) {
+            zs = BoolToArithBatchOperator(&shares, inputWidth, width, task, 0, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        }
+        auto result = Secrets::arithReconstruct(zs, 2, width, task);
+        for (auto &r: result) r = Math::ring(r, width);
+        check("BoolToArith", "in=" + std::to_string(inputWidth) + " out=" + std::to_string(width), xs, result);
+    }
+}
+
+// Run with --bmt_method=bmt_background or bmt_pipeline and --disable_arith=false to take triples from the queues
+static void arithMultiply(int task) {
+    const int n = 3000;
+    for (int width: {8, 32, 64}) {
+        auto xs = randomInputs(n, width);
+        auto ys = randomInputs(n, width);
+        std::vector<int64_t> expected(xs.size());
+        for (size_t i = 0; i < xs.size(); i++) {
+            expected[i] = Math::ring(xs[i] * ys[i], width);
+        }
+        auto xShares = Secrets::arithShare(xs, 2, width, task);
+        auto yShares = Secrets::arithShare(ys, 2, width, task);
+
+        std::vector<int64_t> zs;
+        if (Comm::isServer()) {
+            zs = ArithMultiplyBatchOperator(&xShares, &yShares, width, task, 0, SecureOperator::NO_CLIENT_COMPUTE)
+                    .execute()->_zis;
+        }
+        auto result = Secrets::arithReconstruct(zs, 2, width, task);
+        for (auto &r: result) r = Math::ring(r, width);
+        check("ArithMultiply", "width=" + std::to_string(width), expected, result);
+    }
+}
+
+// Same as boolAndThreads for the arithmetic triple queues. Run with --disable_arith=false.
+static void arithMultiplyThreads(int task) {
+    const int n = 3000;
+    for (int width: {8, 64}) {
+        auto xs = randomInputs(n, width);
+        auto ys = randomInputs(n, width);
+        std::vector<int64_t> expected(xs.size());
+        for (size_t i = 0; i < xs.size(); i++) {
+            expected[i] = Math::ring(xs[i] * ys[i], width);
+        }
+        auto xShares = Secrets::arithShare(xs, 2, width, task);
+        auto yShares = Secrets::arithShare(ys, 2, width, task);
+
+        auto zs = splitAcrossPool(n, ArithMultiplyBatchOperator::tagStride(width),
+                                  [&](int start, int end, int msgTagOffset) {
+                                      std::vector<int64_t> xPart(xShares.begin() + start, xShares.begin() + end);
+                                      std::vector<int64_t> yPart(yShares.begin() + start, yShares.begin() + end);
+                                      return ArithMultiplyBatchOperator(&xPart, &yPart, width, task, msgTagOffset,
+                                                                        SecureOperator::NO_CLIENT_COMPUTE)
+                                              .execute()->_zis;
+                                  });
+        auto result = Secrets::arithReconstruct(zs, 2, width, task);
+        for (auto &r: result) r = Math::ring(r, width);
+        check("ArithMultiply threads", "width=" + std::to_string(width), expected, result);
+    }
+}
+
+int main(int argc, char **argv) {
+    System::init(argc, argv);
+
+    const int task = System::nextTask();
+    const std::vector<std::pair<std::string, void (*)(int)> > cases = {
+        {"bool_equal", boolEqual},
+        {"bool_less", boolLess},
+        {"arith_to_bool", arithToBool},
+        {"bool_to_arith", boolToArith},
+        {"arith_multiply", arithMultiply},
+        {"bool_and_threads", boolAndThreads},
+        {"arith_multiply_threads", arithMultiplyThreads},
+    };
+    for (auto &[name, run]: cases) {
+        if (Conf::_userParams.count("op") == 0 || Conf::_userParams["op"] == name) {
+            run(task);
+        }
+    }
+
+    System::finalize();
+    return 0;
+}
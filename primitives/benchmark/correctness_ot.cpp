@@ -2,8 +2,10 @@
 // Created by 杜建璋 on 26-1-17.
 //
 
+#include "conf/Conf.h"
 #include "ot/BaseOtBatchOperator.h"
 #include "ot/BaseOtOperator.h"
+#include "ot/EcBaseOtBatchOperator.h"
 #include "ot/RandOtBatchOperator.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
@@ -38,7 +40,9 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    auto results = BaseOtBatchOperator(0, &ss0, &ss1, &choices, 64, 1, 0).execute()->_results;
+    auto results = Conf::BASE_OT_TYPE == Conf::BASE_OT_EC
+                       ? EcBaseOtBatchOperator(0, &ss0, &ss1, &choices, 64, 1, 0).execute()->_results
+                       : BaseOtBatchOperator(0, &ss0, &ss1, &choices, 64, 1, 0).execute()->_results;
 
     // std::vector<int64_t> results;
     // for (int i = 0; i < 10; i++) {
@@ -0,0 +1,107 @@
+#include "accelerate/CpuFeatures.h"
+#include "accelerate/SimdSupport.h"
+#include "comm/Comm.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <cstdint>
+#include <vector>
+
+// Compares the dispatched kernels against plain loops. Run with --simd_level=... to check each
+// instruction set on the same machine.
+int main(int argc, char **argv) {
+    System::init(argc, argv);
+
+    if (Comm::isClient()) {
+        int failures = 0;
+        auto check = [&failures](bool ok, const char *what, int n) {
+            if (!ok) {
+                failures++;
+                Log::e("MISMATCH {} n={}", what, n);
+            }
+        };
+
+        // Odd sizes exercise the scalar tails
+        for (int n: {0, 1, 3, 8, 17, 100, 1001}) {
+            std::vector<int64_t> a(n), b(n), c(n), ef(2 * n);
+            for (int i = 0; i < n; i++) {
+                a[i] = Math::randInt();
+                b[i] = Math::randInt();
+                c[i] = Math::randInt();
+                ef[i] = Math::randInt();
+                ef[n + i] = Math::randInt();
+            }
+            int64_t k0 = Math::randInt(), k1 = Math::randInt(), k2 = Math::randInt();
+
+            std::vector<int64_t> x(n), y(n), z(n), s(n), d(n), xy(2 * n), x3(2 * n), zi(n);
+            int64_t ext = Comm::rank() ? -1ll : 0;
+            for (int i = 0; i < n; i++) {
+                x[i] = a[i] ^ b[i];
+                y[i] = a[i] & b[i];
+                z[i] = a[i] | b[i];
+                s[i] = ((a[i] & ~c[i]) | (b[i] & c[i])) ^ k0;
+                d[i] = (b[i] & ~1ll) | ((a[i] & 1) ^ Comm::rank());
+                xy[i] = a[i] ^ k0;
+                xy[n + i] = b[i] ^ k1;
+                x3[i] = a[i] ^ b[i] ^ c[i];
+                x3[n + i] = a[i] ^ c[i] ^ c[i];
+                zi[i] = (ext & ef[i] & ef[n + i]) ^ (ef[n + i] & k0) ^ (ef[i] & k1) ^ k2;
+            }
+
+            check(SimdSupport::xorV(a, b) == x, "xorV", n);
+            check(SimdSupport::andV(a, b) == y, "andV", n);
+            check(SimdSupport::orV(a, b) == z, "orV", n);
+            check(SimdSupport::xor2VC(a, b, k0, k1) == xy, "xor2VC", n);
+            check(SimdSupport::xor3(a.data(), b.data(), c.data(), n) == std::vector<int64_t>(x3.begin(), x3.begin() + n),
+                  "xor3", n);
+            check(SimdSupport::xor3Concat(a.data(), b.data(), c.data(), c.data(), n) == x3, "xor3Concat", n);
+            check(SimdSupport::computeZ(ef, k0, k1, k2) == zi, "computeZ", n);
+            check(SimdSupport::computeDiag(a, b) == d, "computeDiag", n);
+
+            std::vector<int64_t> sel(n), kv(n, k0);
+            SimdSupport::selectBits(sel.data(), a.data(), b.data(), c.data(), kv.data(), n);
+            check(sel == s, "selectBits", n);
+
+            std::vector<int64_t> bits(n), unpacked(n);
+            for (int i = 0; i < n; i++) {
+                bits[i] = a[i] & 1;
+            }
+            std::vector<uint8_t> packed(SimdSupport::packedBytes(n, 1));
+            SimdSupport::packBits(packed.data(), bits.data(), n, 1);
+            SimdSupport::unpackBits(unpacked.data(), packed.data(), n, 1);
+            check(unpacked == bits, "packBits/unpackBits", n);
+        }
+
+        U128 tile[128], expected[128]{};
+        for (int r = 0; r < 128; r++) {
+            tile[r] = {static_cast<uint64_t>(Math::randInt()), static_cast<uint64_t>(Math::randInt())};
+        }
+        for (int r = 0; r < 128; r++) {
+            for (int col = 0; col < 128; col++) {
+                uint64_t bit = col < 64 ? (tile[r].lo >> col) & 1 : (tile[r].hi >> (col - 64)) & 1;
+                if (r < 64) {
+                    expected[col].lo |= bit << r;
+                } else {
+                    expected[col].hi |= bit << (r - 64);
+                }
+            }
+        }
+        SimdSupport::transpose128x128(tile);
+        bool transposed = true;
+        for (int r = 0; r < 128; r++) {
+            transposed &= tile[r].lo == expected[r].lo && tile[r].hi == expected[r].hi;
+        }
+        check(transposed, "transpose128x128", 128);
+
+        const char *level = CpuFeatures::name(CpuFeatures::level());
+        if (failures == 0) {
+            Log::i("[SIMD correctness] level={} PASS", level);
+        } else {
+            Log::i("[SIMD correctness] level={} FAIL mismatches={}", level, failures);
+        }
+    }
+
+    System::finalize();
+    return 0;
+}
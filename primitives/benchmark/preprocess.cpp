@@ -0,0 +1,26 @@
+#include "comm/Comm.h"
+#include "conf/Conf.h"
+#include "intermediate/PreprocessingStore.h"
+#include "utils/Log.h"
+#include "utils/System.h"
+
+#include <string>
+
+// Offline phase for --bmt_method=bmt_offline. Writes <preprocess_path>.0 and .1 on the two servers:
+//   mpirun -np 3 preprocess --preprocess_path=/data/pp --bmts=<64-bit BMT words> --ots=<OTs per direction>
+// Online runs then pass the same --preprocess_path.
+int main(int argc, char **argv) {
+    System::init(argc, argv);
+
+    if (Conf::PREPROCESS_PATH.empty()) {
+        Log::e("--preprocess_path is required.");
+    } else {
+        auto param = [](const std::string &key) {
+            return Conf::_userParams.count(key) ? std::stoll(Conf::_userParams[key]) : 0;
+        };
+        PreprocessingStore::generate(Conf::PREPROCESS_PATH, param("bmts"), param("ots"), System::nextTask());
+    }
+
+    System::finalize();
+    return 0;
+}
@@ -0,0 +1,27 @@
+
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+
+class CpuFeatures {
+public:
+    enum Level {
+        SCALAR,
+        SSE2,
+        NEON,
+        AVX2,
+        AVX512
+    };
+
+    // Widest instruction set supported by the running CPU, capped by Conf::SIMD_LEVEL.
+    // Resolved once on first use, so it must not be queried before Conf::init.
+    static Level level();
+
+    static const char *name(Level level);
+
+private:
+    static Level detect();
+};
+
+
+#endif
@@ -10,6 +10,8 @@ class SimdSupport {
 public:
     static std::vector<int64_t> xorV(const std::vector<int64_t> &arr0, const std::vector<int64_t> &arr1);
 
+    static void xorV(int64_t *out, const int64_t *arr0, const int64_t *arr1, size_t num);
+
     static std::vector<int64_t> andV(const std::vector<int64_t> &arr0, const std::vector<int64_t> &arr1);
 
     static std::vector<int64_t> andVC(const std::vector<int64_t> &arr, int64_t constant);
@@ -53,6 +55,20 @@ public:
     // Select bits from y0 or y1 based on choice: result = (y0 & ~choice) | (y1 & choice)
     static void selectBits(int64_t* result, const int64_t* y0, const int64_t* y1,
                           const int64_t* choice, const int64_t* hashValues, size_t count);
+
+    // In-place transpose of a 128x128 bit matrix stored as 128 rows of U128
+    static void transpose128x128(U128 v[128]);
+
+    // ============== Bit packing for the wire format ==============
+
+    // Number of bytes needed to hold count values of width bits each
+    static size_t packedBytes(size_t count, int width);
+
+    // Pack the low width bits of each value into a little-endian bit stream of count * width bits
+    static void packBits(uint8_t* out, const int64_t* values, size_t count, int width);
+
+    // Inverse of packBits: every output value is zero-extended from width bits
+    static void unpackBits(int64_t* out, const uint8_t* packed, size_t count, int width);
 };
 
 
@@ -26,6 +26,15 @@ public:
             delete _yis;
         }
     }
+
+protected:
+    // Seed-compressed input sharing. The client sends server 0 only {count, 16-byte seed}, and server 0
+    // expands its share from the seed; server 1 receives the other share. The client uploads one share
+    // vector instead of two. xorShares picks boolean (v = s0 ^ s1) or arithmetic (v = s0 + s1) shares.
+    void sendSeededShares(const std::vector<int64_t> &values, bool xorShares, int clientRank);
+
+    // Server side of sendSeededShares, returns this server's shares
+    std::vector<int64_t> receiveSeededShares(int clientRank);
 };
 
 
@@ -32,6 +32,9 @@ public:
 
     virtual SecureOperator *reconstruct(int clientRank) = 0;
 
+    // MPI tag of message msgTag within task taskTag, for exchanges that do not run inside an operator
+    [[nodiscard]] static int buildTag(int taskTag, int msgTag);
+
 protected:
     [[nodiscard]] int64_t ring(int64_t raw) const;
 
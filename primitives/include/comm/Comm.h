@@ -78,6 +78,20 @@ public:
 
     static void wait(AbstractRequest *request);
 
+    // Wire codec used when transfer compression is enabled. A compressed vector is laid out as
+    // [uint32 count][count * width bits], a compressed scalar as ceil(width / 8) bytes.
+    static bool packable(int width);
+
+    static void packScalar(std::vector<uint8_t> &out, int64_t source, int width);
+
+    static int64_t unpackScalar(const uint8_t *packed, int width);
+
+    static void packVector(std::vector<uint8_t> &out, const std::vector<int64_t> &source, int width);
+
+    static void unpackVector(std::vector<int64_t> &target, const uint8_t *packed, size_t bytes, int width);
+
+    static size_t packedVectorBytes(size_t count, int width);
+
 protected:
     virtual int rank_() = 0;
 
@@ -5,6 +5,7 @@
 #include "item/MpiRequestWrapper.h"
 
 #include <string>
+#include <vector>
 
 class MpiComm : public Comm {
 public:
@@ -0,0 +1,95 @@
+#ifndef TCPCOMM_H
+#define TCPCOMM_H
+#include "./Comm.h"
+#include "item/TcpRequest.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Comm over plain TCP, for running without an MPI launcher. Every pair of parties keeps
+// Conf::TCP_STREAMS persistent connections; a frame is [int32 tag][uint32 length][payload] and
+// always goes over the stream picked by its tag, so frames of one tag stay in order. One reader
+// thread per stream drains the socket and matches frames to posted receives by (sender, tag).
+class TcpComm : public Comm {
+public:
+    static constexpr int PARTIES = 3;
+
+private:
+    struct Stream {
+        int _fd = -1;
+        std::mutex _sendMutex;
+    };
+
+    int _rank = -1;
+    // By peer rank, empty for this party
+    std::vector<std::vector<std::unique_ptr<Stream> > > _streams;
+    std::vector<std::thread> _readers;
+
+    std::mutex _mailMutex;
+    std::condition_variable _finished;
+    // Frames that arrived before their receive was posted, and receives still waiting for a frame.
+    // Both are FIFO per (sender, tag), the same non-overtaking order MPI gives.
+    std::map<std::pair<int, int>, std::deque<std::string> > _unexpected;
+    std::map<std::pair<int, int>, std::deque<std::shared_ptr<TcpRequest::Slot> > > _posted;
+    // Streams per peer that have delivered their closing frame
+    std::vector<int> _closed;
+    bool _lost = false;
+
+public:
+    int rank_() override;
+
+    void init_(int argc, char **argv) override;
+
+    void finalize_() override;
+
+    bool isServer_() override;
+
+    bool isClient_() override;
+
+    void send_(int64_t source, int width, int receiverRank, int tag) override;
+
+    void send_(const std::vector<int64_t> &source, int width, int receiverRank, int tag) override;
+
+    void send_(const std::string &source, int receiverRank, int tag) override;
+
+    void receive_(int64_t &source, int width, int senderRank, int tag) override;
+
+    void receive_(std::vector<int64_t> &source, int width, int senderRank, int tag) override;
+
+    void receive_(std::string &target, int senderRank, int tag) override;
+
+    TcpRequest *sendAsync_(const std::vector<int64_t> &source, int width, int receiverRank, int tag) override;
+
+    TcpRequest *sendAsync_(const int64_t &source, int width, int receiverRank, int tag) override;
+
+    TcpRequest *sendAsync_(const std::string &source, int receiverRank, int tag) override;
+
+    TcpRequest *receiveAsync_(int64_t &target, int width, int senderRank, int tag) override;
+
+    TcpRequest *receiveAsync_(std::vector<int64_t> &target, int count, int width, int senderRank, int tag) override;
+
+    TcpRequest *receiveAsync_(std::string &target, int length, int senderRank, int tag) override;
+
+private:
+    Stream &streamFor(int peer, int tag);
+
+    void sendFrame(int receiverRank, int tag, const void *data, size_t length);
+
+    std::shared_ptr<TcpRequest::Slot> post(int senderRank, int tag);
+
+    void deliver(int senderRank, int tag, std::string &&data);
+
+    void readLoop(int peer, int fd);
+
+    void fail();
+};
+
+
+#endif
@@ -9,6 +9,9 @@ public:
     virtual ~AbstractRequest() = default;
 
     virtual void wait() = 0;
+
+    // Non-blocking completion check. Once it returns true, wait() returns immediately.
+    virtual bool test() = 0;
 };
 
 
@@ -1,4 +1,3 @@
-
 #ifndef MPIREQUEST_H
 #define MPIREQUEST_H
 #include <cstdint>
@@ -15,52 +14,34 @@ public:
     int64_t *_targetInt{};
     std::vector<int64_t> *_targetIntVec{};
 
+    // SCALAR/VECTOR: the payload travels bit-packed in _packed and is unpacked into the target on wait()
     enum Mode {
-        INT1, INT8, INT16, INT32, VEC1, VEC8, VEC16, VEC32, NO_CALLBACK
+        SCALAR, VECTOR, NO_CALLBACK
     };
 
     Mode _mode = NO_CALLBACK;
+    int _width{};
 
-    bool *_si1{};
-    int8_t *_si8{};
-    int16_t *_si16{};
-    int32_t *_si32{};
-    bool *_sv1{};
-    std::vector<int8_t> *_sv8{};
-    std::vector<int16_t> *_sv16{};
-    std::vector<int32_t> *_sv32{};
-
-    bool _int1{};
-    int8_t _int8{};
-    int16_t _int16{};
-    int32_t _int32{};
-
-    bool *_vec1{};
-    int _vec1Size{};
-    std::vector<int8_t> _vec8;
-    std::vector<int16_t> _vec16;
-    std::vector<int32_t> _vec32;
+    // Owns the packed send/receive buffer until the request completes
+    std::vector<uint8_t> _packed;
 
     MPI_Request *_r = new MPI_Request();
 
+    bool _completed = false;
+
 public:
     explicit MpiRequestWrapper(bool recv);
-    
-    ~MpiRequestWrapper() {
+
+    ~MpiRequestWrapper() override {
         delete _r;
-        
-        if (_si1) delete _si1;
-        if (_si8) delete _si8;
-        if (_si16) delete _si16;
-        if (_si32) delete _si32;
-        if (_sv1) delete[] _sv1;
-        if (_sv8) delete _sv8;
-        if (_sv16) delete _sv16;
-        if (_sv32) delete _sv32;
-        if (_vec1) delete[] _vec1;
     }
 
     void wait() override;
+
+    bool test() override;
+
+private:
+    void complete();
 };
 
 
@@ -0,0 +1,57 @@
+#ifndef TCPREQUEST_H
+#define TCPREQUEST_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AbstractRequest.h"
+
+
+class TcpRequest : public AbstractRequest {
+public:
+    // Where the receiver thread of TcpComm drops the frame matched to a posted receive
+    struct Slot {
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::string _data;
+        // Set once _data is filled, or once the connection is lost with _failed set
+        std::atomic_bool _done = false;
+        bool _failed = false;
+    };
+
+    enum Mode {
+        SCALAR, VECTOR, STRING, NO_CALLBACK
+    };
+
+    Mode _mode = NO_CALLBACK;
+    int _width{};
+
+    int64_t *_targetInt{};
+    std::vector<int64_t> *_targetIntVec{};
+    std::string *_targetStr{};
+
+    // Null for sends, which are written out before the request is handed back
+    std::shared_ptr<Slot> _slot;
+
+    bool _completed = false;
+
+public:
+    TcpRequest() = default;
+
+    explicit TcpRequest(std::shared_ptr<Slot> slot);
+
+    void wait() override;
+
+    bool test() override;
+
+private:
+    void complete();
+};
+
+
+
+#endif
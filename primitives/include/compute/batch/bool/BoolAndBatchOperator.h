@@ -11,6 +11,11 @@ private:
     std::vector<int64_t> *_conds_i{};
     bool _doWithConditions{};
 
+    // Held between prepare() and finish()
+    std::vector<BitwiseBmt> _heldBmts;
+    int _bc{};
+    std::vector<int64_t> _efi;
+
 public:
     inline static std::atomic_int64_t _totalTime = 0;
 
@@ -29,10 +34,20 @@ public:
 
     static int bmtCount(int num, int width);
 
+    // The two halves of execute() around the e/f exchange, for BoolRoundFusion. prepare() takes the BMTs
+    // and masks the inputs, finish() takes the other server's openings and fills _zis.
+    BoolAndBatchOperator *prepare();
+
+    [[nodiscard]] const std::vector<int64_t> &openings() const;
+
+    [[nodiscard]] int openingTag() const;
+
+    void finish(const int64_t *efo);
+
 private:
-    void execute0();
+    void prepare0();
 
-    void executeForMutex();
+    void prepareForMutex();
 
     int prepareBmts(std::vector<BitwiseBmt> &bmts);
 };
@@ -2,14 +2,26 @@
 #ifndef BOOLEQUALBATCHOPERATOR_H
 #define BOOLEQUALBATCHOPERATOR_H
 
+#include "BoolAndBatchOperator.h"
 #include "BoolBatchOperator.h"
+#include "BoolRoundFusion.h"
 #include "intermediate/item/BitwiseBmt.h"
 
-class BoolEqualBatchOperator : public BoolBatchOperator {
+#include <memory>
+
+class BoolEqualBatchOperator : public BoolBatchOperator, public FusableRounds {
 private:
     std::vector<BitwiseBmt> *_bmts{};
     bool _dbIn{};
 
+    // State carried between rounds
+    bool _started{};
+    int _live{};
+    bool _gotBmt{};
+    std::vector<BitwiseBmt> _allBmts;
+    std::vector<int64_t> _eq;
+    std::unique_ptr<BoolAndBatchOperator> _foldAnd;
+
 public:
     inline static std::atomic_int64_t _totalTime = 0;
 
@@ -20,6 +32,10 @@ public:
 
     BoolEqualBatchOperator *execute() override;
 
+    bool addRound(BoolRoundFusion &fusion) override;
+
+    void endRound() override;
+
     BoolEqualBatchOperator *setBmts(std::vector<BitwiseBmt> *bmts);
 
     static int tagStride();
@@ -28,6 +44,8 @@ public:
 
 private:
     bool prepareBmts(std::vector<BitwiseBmt> &bmts);
+
+    void collect();
 };
 
 #endif
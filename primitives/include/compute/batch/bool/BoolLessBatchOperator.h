@@ -1,14 +1,26 @@
 
 #ifndef BOOLLESSBATCHEXECUTOR_H
 #define BOOLLESSBATCHEXECUTOR_H
+#include "BoolAndBatchOperator.h"
 #include "BoolBatchOperator.h"
+#include "BoolRoundFusion.h"
 #include "intermediate/item/BitwiseBmt.h"
 
+#include <memory>
 
-class BoolLessBatchOperator : public BoolBatchOperator {
+class BoolLessBatchOperator : public BoolBatchOperator, public FusableRounds {
 private:
     std::vector<BitwiseBmt> *_bmts{};
 
+    // State carried between rounds
+    int _round{};
+    bool _gotBmt{};
+    std::vector<BitwiseBmt> _allBmts;
+    std::vector<int64_t> _lbs;
+    std::vector<int64_t> _diag;
+    std::unique_ptr<BoolAndBatchOperator> _lbsAnd;
+    std::unique_ptr<BoolAndBatchOperator> _diagAnd;
+
 public:
     inline static std::atomic_int64_t _totalTime = 0;
 
@@ -19,6 +31,10 @@ public:
 
     BoolLessBatchOperator *execute() override;
 
+    bool addRound(BoolRoundFusion &fusion) override;
+
+    void endRound() override;
+
     BoolLessBatchOperator *setBmts(std::vector<BitwiseBmt> *bmts);
 
     static int tagStride();
@@ -29,6 +45,10 @@ private:
     std::vector<int64_t> shiftGreater(std::vector<int64_t> &in, int r) const;
 
     bool prepareBmts(std::vector<BitwiseBmt> &bmts);
+
+    std::vector<BitwiseBmt> takeBmts();
+
+    [[nodiscard]] int finalRound() const;
 };
 
 
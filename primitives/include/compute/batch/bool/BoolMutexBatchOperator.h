@@ -1,9 +1,12 @@
 
 #ifndef BOOLMUTEXBATCHEXECUTOR_H
 #define BOOLMUTEXBATCHEXECUTOR_H
+#include "./BoolAndBatchOperator.h"
 #include "./BoolBatchOperator.h"
 #include "../../../intermediate/item/BitwiseBmt.h"
 
+#include <memory>
+
 class BoolMutexBatchOperator : public BoolBatchOperator {
 public:
     std::vector<int64_t> *_conds_i{};
@@ -14,6 +17,9 @@ private:
 
     bool _bidir{};
 
+    std::vector<BitwiseBmt> _heldBmts;
+    std::unique_ptr<BoolAndBatchOperator> _and;
+
 public:
     BoolMutexBatchOperator(std::vector<int64_t> *xs, std::vector<int64_t> *ys, std::vector<int64_t> *conds, int width,
                            int taskTag,
@@ -32,12 +38,14 @@ public:
 
     static int bmtCount(int num, int width);
 
-private:
-    bool prepareBmts(std::vector<BitwiseBmt> &bmts);
+    // Split of execute() for BoolRoundFusion: prepare() returns the prepared inner AND, finish() builds
+    // _zis once that AND has been finished.
+    BoolAndBatchOperator *prepare();
 
-    void execute0();
+    void finish();
 
-    void executeBidirectionally();
+private:
+    BoolAndBatchOperator *buildAnd();
 };
 
 
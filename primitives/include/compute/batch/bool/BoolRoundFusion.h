@@ -0,0 +1,44 @@
+#ifndef BOOLROUNDFUSION_H
+#define BOOLROUNDFUSION_H
+
+#include <vector>
+
+class BoolAndBatchOperator;
+class BoolMutexBatchOperator;
+class BoolRoundFusion;
+
+// Operator made of several dependent AND rounds. It is stepped one round at a time so that independent
+// operators can share their rounds through BoolRoundFusion::run().
+class FusableRounds {
+public:
+    virtual ~FusableRounds() = default;
+
+    // Adds the ANDs of the next round. Returns false once the operator has finished.
+    virtual bool addRound(BoolRoundFusion &fusion) = 0;
+
+    // Picks up the results of the round after the fusion was executed.
+    virtual void endRound() = 0;
+};
+
+// Collects independent AND and mutex batches and opens all their e/f values in one exchange between the
+// servers, so they cost a single round instead of one each. Every batch keeps its own width on the wire.
+// Inputs are read when a batch is added, results are available after execute().
+class BoolRoundFusion {
+private:
+    std::vector<BoolAndBatchOperator *> _ands;
+    std::vector<BoolMutexBatchOperator *> _mutexes;
+    int _tag{};
+
+public:
+    BoolRoundFusion &add(BoolAndBatchOperator *op);
+
+    BoolRoundFusion &add(BoolMutexBatchOperator *op);
+
+    void execute();
+
+    // Steps all operators together until every one of them is done, one exchange per round.
+    static void run(const std::vector<FusableRounds *> &ops);
+};
+
+
+#endif
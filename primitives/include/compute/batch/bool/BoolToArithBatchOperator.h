@@ -1,19 +1,37 @@
-
 #ifndef BOOLTOARITHBATCHOPERATOR_H
 #define BOOLTOARITHBATCHOPERATOR_H
 #include "BoolBatchOperator.h"
 
+#include <algorithm>
+
 
 class BoolToArithBatchOperator : public BoolBatchOperator {
+private:
+    // Number of low input bits that may be set. Only these bits cost an OT each; the arithmetic
+    // result lives in the ring of _width bits.
+    int _inputWidth{};
+
 public:
     BoolToArithBatchOperator(std::vector<int64_t> *xs, int width, int taskTag,
+                             int msgTagOffset, int clientRank) : BoolToArithBatchOperator(
+        xs, width, width, taskTag, msgTagOffset, clientRank) {
+    };
+
+    // Lift inputWidth-bit boolean shares into width-bit arithmetic shares, e.g. a 1-bit flag into Z_2^64
+    BoolToArithBatchOperator(std::vector<int64_t> *xs, int inputWidth, int width, int taskTag,
                              int msgTagOffset, int clientRank) : BoolBatchOperator(
-        xs, nullptr, width, taskTag, msgTagOffset, clientRank) {
+        xs, nullptr, width, taskTag, msgTagOffset, clientRank), _inputWidth(std::min(inputWidth, width)) {
     };
 
     BoolToArithBatchOperator *execute() override;
 
     static int tagStride();
+
+private:
+    // Turns OTs from the offline store into correlated OTs in one round trip. Returns false (on both
+    // servers) when the store cannot cover the batch, and the caller runs IKNP instead.
+    bool transferPreprocessed(int sender, const std::vector<int64_t> &deltas, const std::vector<int> &choices,
+                              std::vector<int64_t> &results);
 };
 
 
@@ -16,6 +16,7 @@ public:
         TBB_POOL,
 #endif
         ASYNC,
+        WORK_STEALING_POOL,
     };
 
     enum QueueT {
@@ -25,14 +26,31 @@ public:
     };
 
     enum CommT {
-        MPI
+        MPI,
+        TCP
     };
 
     enum BmtT {
         BMT_BACKGROUND,
         BMT_JIT,
         BMT_FIXED,
-        BMT_PIPELINE
+        BMT_PIPELINE,
+        BMT_OFFLINE,
+        BMT_DEALER
+    };
+
+    enum BaseOtT {
+        BASE_OT_RSA,
+        BASE_OT_EC
+    };
+
+    // Upper bound for the runtime-dispatched SIMD kernels
+    enum SimdT {
+        SIMD_AUTO,
+        SIMD_SCALAR,
+        SIMD_SSE2,
+        SIMD_AVX2,
+        SIMD_AVX512
     };
 
 public:
@@ -46,6 +64,14 @@ public:
     inline static int BMT_QUEUE_NUM = 1;
     inline static bool DISABLE_ARITH = true;
     inline static int BMT_GEN_BATCH_SIZE = 10000;
+    // Triples per block handed from background/pipeline generators to consumers
+    inline static int BMT_BLOCK_SIZE = 1024;
+    // BMT_OFFLINE: server i maps <PREPROCESS_PATH>.i written by the preprocess tool
+    inline static std::string PREPROCESS_PATH;
+    // Base OTs run at startup (ROT correlations and the 2 x 128 IKNP seeds). BASE_OT_EC needs no RSA key pair.
+    inline static BaseOtT BASE_OT_TYPE = BASE_OT_EC;
+    // Non-empty: server i keeps its base OT results sealed in <SESSION_CACHE_PATH>.i and resumes them on restart
+    inline static std::string SESSION_CACHE_PATH;
 
     inline static int TASK_TAG_BITS = 6;
     inline static bool DISABLE_MULTI_THREAD = false;
@@ -54,6 +80,12 @@ public:
     inline static int THREAD_POOL_TYPE = ASYNC;
 
     inline static CommT COMM_TYPE = MPI;
+    // TCP comm: rank of this process (-1 takes it from the mpirun/PMI environment), one host or one
+    // host per rank, and the base port. Rank i listens on TCP_PORT + i.
+    inline static int PARTY = -1;
+    inline static std::string TCP_HOSTS = "127.0.0.1";
+    inline static int TCP_PORT = 23300;
+    inline static int TCP_STREAMS = 4;
     inline static int BATCH_SIZE = 1000;
     inline static bool ENABLE_TRANSFER_COMPRESSION = false;
     inline static bool ENABLE_REDUNDANT_OT = true;
@@ -61,6 +93,7 @@ public:
     inline static bool ENABLE_CLASS_WISE_TIMING = false;
 
     inline static bool ENABLE_SIMD = true;
+    inline static SimdT SIMD_LEVEL = SIMD_AUTO;
     inline static bool ENABLE_IKNP_MULTITHREAD = true;
 };
 
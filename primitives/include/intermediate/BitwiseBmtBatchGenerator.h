@@ -23,8 +23,6 @@ private:
 
     void computeC();
 
-    [[nodiscard]] int64_t corr(int bmtIdx, int64_t x) const;
-
 public:
     SecureOperator * reconstruct(int clientRank) override;
 
@@ -0,0 +1,63 @@
+#ifndef BMTDEALER_H
+#define BMTDEALER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "./item/BitwiseBmt.h"
+#include "./TagReservations.h"
+#include "../utils/Crypto.h"
+
+// Conf::BMT_METHOD == BMT_DEALER: the client deals bitwise BMTs and must not collude with either server.
+//
+// At startup the client sends each server a random 128-bit seed. Word i of server 0 is (a0, b0, c0) from
+// blocks 2i and 2i + 1 of the AES-CTR stream of seed0, and server 1 expands (a1, b1) from block i of seed1.
+// The only thing left is c1 = (a0 ^ a1) & (b0 ^ b1) ^ c0, which a client thread streams to server 1 in
+// chunks of Conf::BMT_GEN_BATCH_SIZE words, WINDOW chunks ahead.
+// Server 0 owns the word cursor. Words are reserved per operator tag as in IntermediateDataSupport::pollBlocks,
+// and when a tag's reservation runs out server 0 sends the new offset to server 1 on that tag.
+class BmtDealer {
+public:
+    static constexpr int WINDOW = 4;
+
+private:
+    struct Chunk {
+        std::vector<int64_t> _c;
+        int64_t _used = 0;
+    };
+
+    inline static U128 _seed{};
+    inline static std::atomic_int64_t _cursor = 0;
+    inline static TagReservations<BitwiseBmt> _reservations;
+
+    // Server 1: corrections received but not yet taken, by chunk index
+    inline static std::map<int64_t, Chunk> _chunks;
+    inline static int64_t _receivedChunks = 0;
+    inline static std::atomic_bool _receiving = false;
+
+    // Client
+    inline static std::thread _dealer;
+
+public:
+    static void init();
+
+    // Before Comm::finalize, so the client thread is done with the comm
+    static void finalize();
+
+    // Same contract as PreprocessingStore::takeBitwiseBmts, but never runs out
+    static std::vector<BitwiseBmt> takeBitwiseBmts(int count, int width, int tag);
+
+private:
+    static void deal(U128 seed0, U128 seed1);
+
+    // count new words at 64 bits, the same ones on both servers
+    static std::vector<BitwiseBmt> reserve(int count, int tag);
+
+    static void takeCorrections(int64_t offset, int count, std::vector<BitwiseBmt> &bmts);
+};
+
+
+#endif
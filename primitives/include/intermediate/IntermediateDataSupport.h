@@ -3,29 +3,63 @@
 
 #include <vector>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "./item/Bmt.h"
 #include "./item/SRot.h"
 #include "./item/RRot.h"
 #include "../conf/Conf.h"
 #include "./item/BitwiseBmt.h"
+#include "./TagReservations.h"
 #include "sync/AbstractBlockingQueue.h"
 
 
+// Triples of one queue in the order both servers generate them, each used Conf::BMT_USAGE_LIMIT
+// times. Position p is use p % limit of triple p / limit, so a range of positions names the same
+// triples on both servers.
+template<typename T>
+struct BmtStream {
+    // Next unreserved position. Only rank 0 advances it.
+    std::atomic_int64_t _cursor = 0;
+
+    // Guards everything below, but is never held while waiting for the generator: one consumer at a
+    // time polls the queue with _polling set, and the others yield until its block shows up
+    std::mutex _mutex;
+    bool _polling = false;
+    int64_t _polled = 0;
+    // Polled blocks by index, with the number of their positions served so far
+    std::map<int64_t, std::pair<std::unique_ptr<std::vector<T> >, int64_t> > _blocks;
+};
+
 class IntermediateDataSupport {
+public:
+    // Background and pipeline generators hand out triples in blocks of Conf::BMT_BLOCK_SIZE, so a
+    // consumer synchronizes once per block instead of once per triple
+    using BmtBlock = std::vector<Bmt>;
+    using BitwiseBmtBlock = std::vector<BitwiseBmt>;
+
 private:
-    inline static u_int _currentBmtQ = 0;
-    inline static u_int _currentBitwiseBmtQ = 0;
+    inline static std::unique_ptr<BmtStream<Bmt>[]> _bmtStreams;
+    inline static std::unique_ptr<BmtStream<BitwiseBmt>[]> _bitwiseBmtStreams;
+
+    inline static TagReservations<Bmt> _bmtReservations;
+    inline static TagReservations<BitwiseBmt> _bitwiseBmtReservations;
 
-    inline static Bmt *_currentBmt{};
-    inline static BitwiseBmt *_currentBitwiseBmt{};
-    inline static int _currentBmtLeftTimes = Conf::BMT_USAGE_LIMIT;
-    inline static int _currentBitwiseBmtLeftTimes = Conf::BMT_USAGE_LIMIT;
+    // Round-robin queue choice of rank 0
+    inline static std::atomic_uint _nextBmtQ = 0;
+    inline static std::atomic_uint _nextBitwiseBmtQ = 0;
+
+    // Tail of the last generated batch that did not fill a block, per queue (touched by its producer only)
+    inline static std::vector<std::unique_ptr<BmtBlock> > _pendingBmtBlocks;
+    inline static std::vector<std::unique_ptr<BitwiseBmtBlock> > _pendingBitwiseBmtBlocks;
 
 public:
-    inline static std::vector<AbstractBlockingQueue<Bmt> *> _bmtQs;
-    inline static std::vector<AbstractBlockingQueue<BitwiseBmt> *> _bitwiseBmtQs;
+    inline static std::vector<AbstractBlockingQueue<BmtBlock *> *> _bmtQs;
+    inline static std::vector<AbstractBlockingQueue<BitwiseBmtBlock *> *> _bitwiseBmtQs;
 
     inline static Bmt _fixedBmt;
     inline static BitwiseBmt _fixedBitwiseBmt;
@@ -45,7 +79,7 @@ public:
     inline static std::vector<bool> _iknpSenderChoices0;  // For sender=0 direction
     inline static std::vector<bool> _iknpSenderChoices1;  // For sender=1 direction
 
-    // RSA keys for BaseOT, pre-generated at initialization
+    // RSA keys for BaseOT, pre-generated at initialization when Conf::BASE_OT_TYPE is BASE_OT_RSA
     inline static std::string _baseOtSelfPub;
     inline static std::string _baseOtSelfPri;
     inline static std::string _baseOtOtherPub;
@@ -68,9 +102,51 @@ public:
 
     static void finalize();
 
-    static std::vector<Bmt> pollBmts(int count, int width);
+    // Both servers take the same triples whichever threads the operators run on. When the tag's
+    // reservation runs out, rank 0 reserves more and sends their position to rank 1 on tag.
+    static std::vector<Bmt> pollBmts(int count, int width, int tag);
+
+    static std::vector<BitwiseBmt> pollBitwiseBmts(int count, int width, int tag);
+
+    // Task tags of the background and pipeline generators of queue i: the first BMT_QUEUE_NUM tags are
+    // bitwise, the next BMT_QUEUE_NUM arithmetic (System reserves both ranges)
+    static int bitwiseBmtTaskTag(int queueIndex);
+
+    static int bmtTaskTag(int queueIndex);
+
+    // Called by the generator of queue i only
+    static void offerBmts(int queueIndex, const std::vector<Bmt> &bmts);
+
+    static void offerBitwiseBmts(int queueIndex, const std::vector<BitwiseBmt> &bmts);
+
+private:
+    // Batch base OT of the type selected by Conf::BASE_OT_TYPE, returns the receiver's results
+    static std::vector<int64_t> baseOt(int sender, std::vector<int64_t> *ms0, std::vector<int64_t> *ms1,
+                                       std::vector<int> *choices, int taskTag, int msgTagOffset);
+
+    // One random OT with the given party as sender, fills rRot->_rb on the receiver
+    static void rot(int sender, SRot *sRot, RRot *rRot);
+
+    template<typename T>
+    static std::vector<AbstractBlockingQueue<std::vector<T> *> *> createQueues();
+
+    template<typename T>
+    static void offerBlocks(AbstractBlockingQueue<std::vector<T> *> *queue, std::unique_ptr<std::vector<T> > &pending,
+                            const std::vector<T> &items);
+
+    template<typename T>
+    static std::vector<T> pollBlocks(const std::vector<AbstractBlockingQueue<std::vector<T> *> *> &queues,
+                                     BmtStream<T> *streams, std::atomic_uint &nextQueue,
+                                     TagReservations<T> &reservations, int count, int width, int tag);
+
+    template<typename T>
+    static std::vector<T> reserveBlocks(const std::vector<AbstractBlockingQueue<std::vector<T> *> *> &queues,
+                                        BmtStream<T> *streams, std::atomic_uint &nextQueue, int64_t count, int tag);
 
-    static std::vector<BitwiseBmt> pollBitwiseBmts(int count, int width);
+    // Block b of the stream, polled from the queue if nobody has yet
+    template<typename T>
+    static const std::vector<T> *blockOf(AbstractBlockingQueue<std::vector<T> *> *queue, BmtStream<T> &stream,
+                                         int64_t b);
 };
 
 
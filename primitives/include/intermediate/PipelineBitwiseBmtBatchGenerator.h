@@ -10,16 +10,9 @@ private:
     int64_t _totalBits{};
     int _index{};
     BoostSPSCQueue<std::vector<BitwiseBmt>, INT16_MAX> _bmts{};
-    BoostSPSCQueue<std::vector<int64_t>, INT16_MAX> _ssis{};
-
-    class HandleData {
-    public:
-        std::vector<int64_t> *_recv{};
-        std::vector<int64_t> *_choiceBits{};
-        AbstractRequest *_r{};
-    };
-
-    BoostSPSCQueue<HandleData, INT16_MAX> _handle{};
+    // Mix shares from the OTs where rank 0 and rank 1 are the sender
+    BoostSPSCQueue<std::vector<int64_t>, INT16_MAX> _usis{};
+    BoostSPSCQueue<std::vector<int64_t>, INT16_MAX> _vsis{};
 
 public:
     PipelineBitwiseBmtBatchGenerator(int index, int taskTag, int msgTagOffset) : AbstractBatchOperator(64, taskTag,
@@ -33,15 +26,10 @@ private:
 
     void compute(int sender, std::vector<int64_t> &as, std::vector<int64_t> &bs);
 
-    void otAsync(int sender, std::vector<int64_t> &bits0, std::vector<int64_t> &bits1,
-                 std::vector<int64_t> &choiceBits);
-
     void mainThreadHandle();
 
     void subThreadHandle();
 
-    [[nodiscard]] static int64_t corr(std::vector<int64_t> &as, int bmtIdx, int64_t x);
-
 public:
     PipelineBitwiseBmtBatchGenerator *reconstruct(int clientRank) override;
 };
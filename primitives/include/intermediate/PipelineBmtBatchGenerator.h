@@ -0,0 +1,30 @@
+
+#ifndef PIPELINEBMTBATCHGENERATOR_H
+#define PIPELINEBMTBATCHGENERATOR_H
+#include "BmtBatchGenerator.h"
+#include "item/Bmt.h"
+#include "sync/BoostSpscQueue.h"
+
+// Arithmetic counterpart of PipelineBitwiseBmtBatchGenerator. The calling thread runs the OTs of one batch
+// after another, and a pool thread finishes each batch's c shares and offers the triples to queue _index.
+class PipelineBmtBatchGenerator : public BmtBatchGenerator {
+private:
+    int _index{};
+    BoostSPSCQueue<std::vector<Bmt>, INT16_MAX> _readyBmts{};
+    // Mix shares from the OTs where rank 0 and rank 1 are the sender
+    BoostSPSCQueue<std::vector<int64_t>, INT16_MAX> _usis{};
+    BoostSPSCQueue<std::vector<int64_t>, INT16_MAX> _vsis{};
+
+public:
+    PipelineBmtBatchGenerator(int index, int taskTag, int msgTagOffset);
+
+    PipelineBmtBatchGenerator *execute() override;
+
+private:
+    void mainThreadHandle();
+
+    void subThreadHandle();
+};
+
+
+#endif
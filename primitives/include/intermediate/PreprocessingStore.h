@@ -0,0 +1,92 @@
+#ifndef PREPROCESSINGSTORE_H
+#define PREPROCESSINGSTORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "./item/BitwiseBmt.h"
+
+static_assert(std::is_trivially_copyable_v<BitwiseBmt>, "BitwiseBmt is written to disk as raw bytes");
+
+// Bitwise BMTs and random OTs generated ahead of time into one file per server
+// (<Conf::PREPROCESS_PATH>.<rank>) and memory-mapped by Conf::BMT_OFFLINE runs.
+//
+// Both servers must take the same records for the same operator. One party owns each cursor and
+// ships the reserved offset to the other with the first message of the operator, so operators
+// running in parallel still pair up. When the file is exhausted, callers fall back to JIT.
+//
+// Records are used once. Every claim writes the owner's cursors back into the file header before the
+// records are handed out, and the next open() resumes after them, even if this run never reached close().
+class PreprocessingStore {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    struct Header {
+        char _magic[8];
+        uint32_t _version;
+        int32_t _rank;
+        int64_t _session;
+        // 64-bit BitwiseBmt words
+        int64_t _bmts;
+        // Random OTs per direction, indexed by the sender rank
+        int64_t _ots[2];
+        // Records already handed out. Only the owner's values are current.
+        int64_t _takenBmts;
+        int64_t _takenOts[2];
+    };
+
+    // Random OT record. The sender holds (r0, r1), the receiver holds (choice, r_choice).
+    struct OtRecord {
+        int64_t _v0;
+        int64_t _v1;
+    };
+
+private:
+    inline static const uint8_t *_data = nullptr;
+    inline static size_t _size = 0;
+    inline static const Header *_header = nullptr;
+    inline static const BitwiseBmt *_bmts = nullptr;
+    inline static const OtRecord *_ots[2] = {nullptr, nullptr};
+
+    // Next unused record. Only the owning party advances each cursor.
+    inline static std::atomic_int64_t _bmtCursor = 0;
+    inline static std::atomic_int64_t _otCursors[2] = {0, 0};
+
+    // Writable descriptor of the mapped file, for the taken counts
+    inline static int _fd = -1;
+    inline static std::mutex _persisting;
+
+public:
+    // Runs on both servers; writes <path>.<rank>
+    static void generate(const std::string &path, int64_t bmts, int64_t ots, int taskTag);
+
+    // Maps this server's file and checks that the peer mapped the matching one
+    static void open(int taskTag);
+
+    static void close();
+
+    static bool available();
+
+    // Takes count words (a single word masked to width when width < 64). Rank 0 owns the cursor.
+    // Returns false on both servers if the store cannot serve the request.
+    static bool takeBitwiseBmts(int count, int width, std::vector<BitwiseBmt> &out, int tag);
+
+    // Reserves count OTs of the direction whose sender is `sender`. The receiver owns the cursor,
+    // so it calls this before sending and passes the offset along; the sender uses that offset.
+    static int64_t reserveOts(int sender, int64_t count);
+
+    static const OtRecord *ots(int sender, int64_t offset);
+
+private:
+    static std::string fileOf(const std::string &path);
+
+    // Writes the cursors into the header of the file
+    static void persist();
+};
+
+
+#endif
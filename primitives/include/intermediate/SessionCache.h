@@ -0,0 +1,33 @@
+#ifndef SESSIONCACHE_H
+#define SESSIONCACHE_H
+
+#include <cstdint>
+#include <string>
+
+// Opt-in cache of the base-OT results (ROT correlations, IKNP base seeds and sender choice bits),
+// so servers that restart together skip the public-key work. Enabled by Conf::SESSION_CACHE_PATH.
+//
+// Server i keeps <path>.i, sealed with AES-256-GCM under a local key in <path>.i.key that never leaves
+// the machine. On start both servers exchange a fingerprint of their cached session and only use it if
+// they match. Rank 0 then sends a fresh nonce and both sides rehash every cached seed with it, which keeps
+// the OT correlations while making sure no two runs expand the same seeds. RSA key pairs are not cached,
+// so --base_ot=rsa still generates and exchanges them on every start.
+class SessionCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    // Fills the IntermediateDataSupport base-OT state from the cache. False on both servers if either
+    // one has no usable cache, and then the caller runs base OT and calls store().
+    static bool load();
+
+    // Seals the current IntermediateDataSupport base-OT state under a new session shared by both servers
+    static void store();
+
+private:
+    static std::string fileOf();
+
+    static std::string keyFileOf();
+};
+
+
+#endif
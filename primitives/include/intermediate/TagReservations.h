@@ -0,0 +1,63 @@
+#ifndef TAGRESERVATIONS_H
+#define TAGRESERVATIONS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Triples that operators on one MPI tag reserved but have not used yet.
+//
+// Operators on one tag run one after another, in the same order and with the same counts on both
+// servers, otherwise their messages would not match. So the leftovers of a tag are the same on both
+// servers, and only a take that runs past them has to agree on new triples with a message. Each
+// reservation of a tag is twice the last one, up to MAX_RESERVE, so a tag used once wastes nothing and
+// a tag used by many small operators sends one message per MAX_RESERVE triples instead of one per
+// operator.
+template<typename T>
+class TagReservations {
+public:
+    static constexpr int64_t MAX_RESERVE = 4096;
+
+private:
+    struct Entry {
+        std::vector<T> _left;
+        int64_t _next = 0;
+    };
+
+    // Guards the map only. An entry is used by the one operator running on its tag.
+    std::mutex _mutex;
+    std::unordered_map<int, Entry> _byTag;
+
+public:
+    // fetch(n) reserves n new triples, the same ones on both servers
+    template<typename Fetch>
+    std::vector<T> take(int tag, int64_t count, Fetch &&fetch) {
+        Entry *entry;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            // References into an unordered_map stay valid when it rehashes
+            entry = &_byTag[tag];
+        }
+        auto &left = entry->_left;
+        auto have = static_cast<int64_t>(left.size());
+        if (have < count) {
+            int64_t n = std::max(count - have, entry->_next);
+            auto fresh = fetch(n);
+            left.insert(left.end(), fresh.begin(), fresh.end());
+            entry->_next = std::min(2 * n, MAX_RESERVE);
+        }
+        std::vector<T> out(left.begin(), left.begin() + count);
+        left.erase(left.begin(), left.begin() + count);
+        return out;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _byTag.clear();
+    }
+};
+
+
+#endif
@@ -16,15 +16,25 @@ public:
     }
 
     static BitwiseBmt extract(std::vector<BitwiseBmt> &bmts, int i, int width) {
-        int idx = i * width / 64;
-        int offset = i % 64 * width;
-        int64_t mask = (1ll << width) - 1;
+        // Element i occupies bits [i * width, (i + 1) * width) of the concatenated tuples and may straddle two words
+        int64_t bit = static_cast<int64_t>(i) * width;
+        int idx = static_cast<int>(bit / 64);
+        int offset = static_cast<int>(bit % 64);
         BitwiseBmt b;
-        b._a = (bmts[idx]._a & (mask << offset)) >> offset;
-        b._b = (bmts[idx]._b & (mask << offset)) >> offset;
-        b._c = (bmts[idx]._c & (mask << offset)) >> offset;
+        b._a = slice(bmts, idx, offset, width, &BitwiseBmt::_a);
+        b._b = slice(bmts, idx, offset, width, &BitwiseBmt::_b);
+        b._c = slice(bmts, idx, offset, width, &BitwiseBmt::_c);
         return b;
     }
+
+private:
+    static int64_t slice(std::vector<BitwiseBmt> &bmts, int idx, int offset, int width, int64_t Bmt::*field) {
+        uint64_t v = static_cast<uint64_t>(bmts[idx].*field) >> offset;
+        if (offset + width > 64) {
+            v |= static_cast<uint64_t>(bmts[idx + 1].*field) << (64 - offset);
+        }
+        return static_cast<int64_t>(v & ((1ull << width) - 1));
+    }
 };
 
 
@@ -0,0 +1,30 @@
+#ifndef ECBASEOTBATCHOPERATOR_H
+#define ECBASEOTBATCHOPERATOR_H
+
+#include "./base/AbstractOtBatchOperator.h"
+#include <string>
+
+// Chou-Orlandi "simplest OT" on P-256, a drop-in for BaseOtBatchOperator without any RSA key.
+//   Sender:   a, A = aG                               -> A
+//   Receiver: b_i, B_i = b_i G (+ A if choice is 1)   -> B_i
+//   Sender:   k0 = H(i, A, B_i, a B_i), k1 = H(i, A, B_i, a (B_i - A)), sends m0 ^ k0 and m1 ^ k1
+//   Receiver: k_choice = H(i, A, B_i, b_i A)
+class EcBaseOtBatchOperator : public AbstractOtBatchOperator {
+public:
+    inline static std::atomic_int64_t _totalTime = 0;
+
+    EcBaseOtBatchOperator(int sender, std::vector<int64_t> *ms0, std::vector<int64_t> *ms1,
+                          std::vector<int> *choices, int width, int taskTag, int msgTagOffset);
+
+    EcBaseOtBatchOperator *execute() override;
+
+    [[nodiscard]] static int tagStride();
+
+private:
+    void send();
+
+    void receive();
+};
+
+
+#endif
@@ -33,6 +33,9 @@ public:
     // Track which rank is the IKNP sender (0 or 1) to select correct base seeds
     int _senderRank{};
 
+    // Correlated OT: _ms0 holds the sender's deltas and _ms1 is unused
+    bool _correlated{};
+
 public:
     IknpOtBatchOperator(int sender,
                         std::vector<int64_t> *ms0,
@@ -51,6 +54,23 @@ public:
                         int taskTag,
                         int msgTagOffset);
 
+    // Correlated OT (COT). The sender only gives a delta per OT; its m0 comes out of the extension
+    // (in _results) and the receiver gets m0 + choice * delta in the ring of width. One correction per OT
+    // is sent instead of two masked messages.
+    IknpOtBatchOperator(int sender,
+                        std::vector<int64_t> *deltas,
+                        std::vector<int> *choices,
+                        int width,
+                        int taskTag,
+                        int msgTagOffset);
+
+    // Packed-bits COT: the receiver gets m0 ^ (choice & delta) for every bit.
+    IknpOtBatchOperator(int sender,
+                        std::vector<int64_t> *deltasPacked,
+                        std::vector<int64_t> *choiceBitsPacked,
+                        int taskTag,
+                        int msgTagOffset);
+
     IknpOtBatchOperator *execute() override;
 
     // Uses 2 tags: u + payload.
@@ -2,11 +2,13 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
+#include <algorithm>
 #include <future>
 
 #include "./CtplThreadPool.h"
 #include "./TbbThreadPool.h"
 #include "Async.h"
+#include "WorkStealingThreadPool.h"
 #include "../conf/Conf.h"
 
 
@@ -15,6 +17,7 @@ public:
     inline static CtplThreadPool *_ctplPool = nullptr;
     inline static TbbThreadPool *_tbbPool = nullptr;
     inline static Async *_async = nullptr;
+    inline static WorkStealingThreadPool *_workStealingPool = nullptr;
 
 public:
     static void init() {
@@ -29,6 +32,12 @@ public:
 #endif
         } else if (Conf::THREAD_POOL_TYPE == Conf::ASYNC) {
             _async = new Async();
+#ifdef PARSEC_HAS_FIBERS
+        } else if (Conf::THREAD_POOL_TYPE == Conf::WORK_STEALING_POOL) {
+            // Blocked tasks yield instead of parking a thread, so one worker per core is enough
+            int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            _workStealingPool = new WorkStealingThreadPool(std::min(Conf::LOCAL_THREADS, cores));
+#endif
         }
     }
 
@@ -36,6 +45,9 @@ public:
         delete _ctplPool;
         delete _tbbPool;
         delete _async;
+#ifdef PARSEC_HAS_FIBERS
+        delete _workStealingPool;
+#endif
     }
 
     template <typename F>
@@ -67,6 +79,11 @@ public:
         if (Conf::THREAD_POOL_TYPE == Conf::ASYNC) {
             return _async->submit(f);
         }
+#ifdef PARSEC_HAS_FIBERS
+        if (Conf::THREAD_POOL_TYPE == Conf::WORK_STEALING_POOL) {
+            return _workStealingPool->submit(f);
+        }
+#endif
         return callerRun(f);
     }
 };
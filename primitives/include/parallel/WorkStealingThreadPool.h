@@ -0,0 +1,78 @@
+
+#ifndef WORKSTEALINGTHREADPOOL_H
+#define WORKSTEALINGTHREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded pool with about one worker per core. Every task runs on its own fiber: when a task has to
+// wait for a message or for a nested task it suspends itself and the worker runs other batches meanwhile.
+// Fibers stay on the worker that started them, only tasks that have not started yet are stolen.
+//
+// Fibers need ucontext (PARSEC_HAS_FIBERS). Without it only yield() and inFiber() are built, and they
+// report that no fiber is running, so blocking code takes its thread-blocking path.
+class WorkStealingThreadPool {
+public:
+    explicit WorkStealingThreadPool(int numThreads);
+
+    ~WorkStealingThreadPool();
+
+    template<typename F>
+    auto submit(F &&f) -> std::future<decltype(f())> {
+        using ReturnType = decltype(f());
+
+        auto task = std::make_shared<std::packaged_task<ReturnType()> >(std::forward<F>(f));
+        auto fut = std::make_shared<std::future<ReturnType> >(task->get_future());
+        push([task] { (*task)(); });
+
+        // A fiber waiting for a nested task must not hold on to its worker, so the future handed out
+        // yields until the result is ready and only blocks outside the pool.
+        return std::async(std::launch::deferred, [fut]() -> ReturnType {
+            while (fut->wait_for(std::chrono::seconds(0)) != std::future_status::ready && yield()) {
+            }
+            return fut->get();
+        });
+    }
+
+    // Suspends the calling fiber and lets its worker run something else.
+    // Returns false without doing anything when not called from a pool fiber.
+    static bool yield();
+
+    static bool inFiber();
+
+private:
+    struct Fiber;
+    struct Worker;
+
+    std::vector<std::unique_ptr<Worker> > _workers;
+    std::deque<std::function<void()> > _globalTasks;
+    std::mutex _globalMutex;
+    std::condition_variable _hasTasks;
+    std::atomic<bool> _stop{false};
+
+    static thread_local Worker *_currentWorker;
+    static thread_local Fiber *_currentFiber;
+
+    void push(std::function<void()> task);
+
+    bool take(Worker *worker, bool shared, std::function<void()> &task);
+
+    void run(Worker *worker);
+
+    void start(Worker *worker, std::function<void()> task);
+
+    void resume(Worker *worker, Fiber *fiber);
+
+    static void entry();
+};
+
+
+#endif
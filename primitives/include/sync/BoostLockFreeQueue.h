@@ -6,6 +6,7 @@
 #include <boost/lockfree/queue.hpp>
 
 #include "../sync/AbstractBlockingQueue.h"
+#include "../parallel/WorkStealingThreadPool.h"
 
 template<typename T>
 class BoostLockFreeQueue : public AbstractBlockingQueue<T> {
@@ -19,14 +20,18 @@ public:
 
     void offer(T item) override {
         while (!queue.push(item)) {
-            std::this_thread::yield();
+            if (!WorkStealingThreadPool::yield()) {
+                std::this_thread::yield();
+            }
         }
     }
 
     T poll() override {
         T item;
         while (!queue.pop(item)) {
-            std::this_thread::yield();
+            if (!WorkStealingThreadPool::yield()) {
+                std::this_thread::yield();
+            }
         }
         return item;
     }
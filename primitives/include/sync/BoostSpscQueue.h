@@ -8,6 +8,7 @@
 #include "utils/Log.h"
 
 #include "AbstractBlockingQueue.h"
+#include "../parallel/WorkStealingThreadPool.h"
 
 template <typename T, size_t C>
 class BoostSPSCQueue : public AbstractBlockingQueue<T> {
@@ -19,14 +20,18 @@ public:
 
     void offer(T item) override {
         while (!_queue.push(item)) {
-            std::this_thread::yield();
+            if (!WorkStealingThreadPool::yield()) {
+                std::this_thread::yield();
+            }
         }
     }
 
     T poll() override {
         T item;
         while (!_queue.pop(item)) {
-            std::this_thread::yield();
+            if (!WorkStealingThreadPool::yield()) {
+                std::this_thread::yield();
+            }
         }
         return item;
     }
@@ -8,6 +8,7 @@
 
 #include "AbstractBlockingQueue.h"
 #include "../utils/Log.h"
+#include "../parallel/WorkStealingThreadPool.h"
 
 template<typename T>
 class LockBlockingQueue : public AbstractBlockingQueue<T> {
@@ -24,14 +25,14 @@ public:
 
     void offer(T item) override {
         std::unique_lock<std::mutex> lock(_mutex);
-        _notFull.wait(lock, [this]() { return _queue.size() < _maxSize; });
+        awaitUntil(lock, _notFull, [this]() { return _queue.size() < _maxSize; });
         _queue.push(item);
         _notEmpty.notify_one();
     }
 
     T poll() override {
         std::unique_lock<std::mutex> lock(_mutex);
-        _notEmpty.wait(lock, [this]() { return !_queue.empty(); });
+        awaitUntil(lock, _notEmpty, [this]() { return !_queue.empty(); });
         T item = _queue.front();
         _queue.pop();
         _notFull.notify_one();
@@ -45,5 +46,20 @@ public:
     [[nodiscard]] size_t capacity() const override {
         return _maxSize;
     }
+
+private:
+    // A pool fiber must not sleep on the condition variable, it would park every other fiber of its worker
+    template<typename P>
+    void awaitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, P ready) {
+        if (!WorkStealingThreadPool::inFiber()) {
+            cv.wait(lock, ready);
+            return;
+        }
+        while (!ready()) {
+            lock.unlock();
+            WorkStealingThreadPool::yield();
+            lock.lock();
+        }
+    }
 };
 #endif
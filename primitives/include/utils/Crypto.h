@@ -69,6 +69,18 @@ public:
     static void batchPrgGenerate(const uint64_t* seeds, size_t numSeeds,
                                   U128* out, size_t blocksPerSeed);
 
+    // Bulk randomness for share masks and BMT inputs: an AES-128-CTR stream per thread, keyed from the
+    // OS RNG on first use. Unlike Math::randInt every bit is random, including the top one.
+    static void randomFill(int64_t *out, size_t count);
+    static void randomFill(U128 *out, size_t count);
+
+    // Deterministic AES-128-CTR expansion of a 16-byte seed (key = seed, counter from 0). Both ends of a
+    // seed-compressed sharing call it to agree on the expanded share.
+    static void expandSeed(const U128 &seed, int64_t *out, size_t count);
+
+    // Blocks [offset, offset + count) of the same stream, without computing the blocks before them
+    static void expandSeed(const U128 &seed, uint64_t offset, U128 *out, size_t count);
+
     // Hash function for OT
     static uint64_t hash64(int index, uint64_t v);
 
@@ -21,6 +21,10 @@ public:
 
     static int nextTask();
 
+    // Highest task tag whose MPI tags stay positive. Kept out of the operators' range for the raw
+    // messages of BmtDealer (message tag 0) and SessionCache (message tag 1).
+    static int reservedTaskTag();
+
     static int64_t currentTimeMillis();
 };
 
@@ -0,0 +1,60 @@
+#include "accelerate/CpuFeatures.h"
+
+#include "conf/Conf.h"
+
+CpuFeatures::Level CpuFeatures::detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    // Also checks that the OS saves the wider register state
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SSE2;
+    }
+    return SCALAR;
+#elif defined(__ARM_NEON)
+    return NEON;
+#else
+    return SCALAR;
+#endif
+}
+
+CpuFeatures::Level CpuFeatures::level() {
+    static const Level resolved = [] {
+        Level detected = detect();
+        if (!Conf::ENABLE_SIMD || Conf::SIMD_LEVEL == Conf::SIMD_SCALAR) {
+            return SCALAR;
+        }
+        Level cap = AVX512;
+        if (Conf::SIMD_LEVEL == Conf::SIMD_SSE2) {
+            cap = SSE2;
+        } else if (Conf::SIMD_LEVEL == Conf::SIMD_AVX2) {
+            cap = AVX2;
+        }
+        // NEON is the only vector tier on ARM, any cap except scalar keeps it
+        if (detected == NEON) {
+            return NEON;
+        }
+        return detected < cap ? detected : cap;
+    }();
+    return resolved;
+}
+
+const char *CpuFeatures::name(Level level) {
+    switch (level) {
+        case SSE2:
+            return "sse2";
+        case NEON:
+            return "neon";
+        case AVX2:
+            return "avx2";
+        case AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
@@ -1,920 +1,472 @@
-
 #include "accelerate/SimdSupport.h"
 
+#include "accelerate/CpuFeatures.h"
 #include "comm/Comm.h"
 
-#ifdef __AVX512F__
-    #include <immintrin.h>
-    #define SIMD_AVX512
-#elif defined(__AVX2__)
+#include <algorithm>
+#include <cstring>
+
+// Every instruction set is compiled in and the widest one the CPU supports is picked at runtime,
+// so a default build (no -march) still gets AVX2/AVX-512 kernels.
+#if defined(__x86_64__) || defined(__i386__)
     #include <immintrin.h>
-    #define SIMD_AVX2
-#elif defined(__SSE2__)
-    #include <emmintrin.h>
-    #define SIMD_SSE2
+    #define SIMD_X86
 #elif defined(__ARM_NEON)
-#include <arm_neon.h>
-#define SIMD_NEON
-#else
-    #define NO_SIMD
+    #include <arm_neon.h>
+    #define SIMD_NEON
 #endif
 
-std::vector<int64_t> SimdSupport::xorV(const std::vector<int64_t> &arr0,
-                                       const std::vector<int64_t> &arr1) {
-    int num = static_cast<int>(arr0.size());
-    std::vector<int64_t> out(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i vec1 = _mm512_loadu_si512(&arr0[i]);
-        __m512i vec2 = _mm512_loadu_si512(&arr1[i]);
-        __m512i result = _mm512_xor_si512(vec1, vec2);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] ^ arr1[i];
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i vec1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr0[i]));
-        __m256i vec2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr1[i]));
-        __m256i result = _mm256_xor_si256(vec1, vec2);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] ^ arr1[i];
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i vec1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr0[i]));
-        __m128i vec2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr1[i]));
-        __m128i result = _mm_xor_si128(vec1, vec2);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] ^ arr1[i];
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t vec1 = vld1q_s64(&arr0[i]);
-        int64x2_t vec2 = vld1q_s64(&arr1[i]);
-        int64x2_t result = veorq_s64(vec1, vec2);
-        vst1q_s64(&out[i], result);
+namespace {
+    struct Kernels {
+        void (*xorV)(int64_t *out, const int64_t *a, const int64_t *b, size_t n);
+        void (*andV)(int64_t *out, const int64_t *a, const int64_t *b, size_t n);
+        void (*orV)(int64_t *out, const int64_t *a, const int64_t *b, size_t n);
+        void (*xorC)(int64_t *out, const int64_t *a, int64_t c, size_t n);
+        void (*andC)(int64_t *out, const int64_t *a, int64_t c, size_t n);
+        void (*xor3)(int64_t *out, const int64_t *a, const int64_t *b, const int64_t *c, size_t n);
+        void (*computeZ)(int64_t *out, const int64_t *e, const int64_t *f, int64_t ext, int64_t a, int64_t b,
+                         int64_t c, size_t n);
+        void (*computeDiag)(int64_t *out, const int64_t *y, const int64_t *xy, int64_t rank, size_t n);
+        void (*selectBits)(int64_t *out, const int64_t *y0, const int64_t *y1, const int64_t *choice,
+                           const int64_t *hash, size_t n);
+        void (*xorU128C)(U128 *out, const U128 *arr, U128 c, size_t count);
+        void (*transpose128)(U128 *v);
+        // Width-1 packing fast paths. They return how many leading values (a multiple of 8) they handled.
+        size_t (*packBits1)(uint8_t *out, const int64_t *values, size_t count);
+        size_t (*unpackBits1)(int64_t *out, const uint8_t *packed, size_t count);
+    };
+
+    namespace scalar {
+        void xorV(int64_t *out, const int64_t *a, const int64_t *b, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] ^ b[i];
+            }
+        }
+
+        void andV(int64_t *out, const int64_t *a, const int64_t *b, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] & b[i];
+            }
+        }
+
+        void orV(int64_t *out, const int64_t *a, const int64_t *b, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] | b[i];
+            }
+        }
+
+        void xorC(int64_t *out, const int64_t *a, int64_t c, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] ^ c;
+            }
+        }
+
+        void andC(int64_t *out, const int64_t *a, int64_t c, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] & c;
+            }
+        }
+
+        void xor3(int64_t *out, const int64_t *a, const int64_t *b, const int64_t *c, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = a[i] ^ b[i] ^ c[i];
+            }
+        }
+
+        void computeZ(int64_t *out, const int64_t *e, const int64_t *f, int64_t ext, int64_t a, int64_t b,
+                      int64_t c, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = (ext & e[i] & f[i]) ^ (f[i] & a) ^ (e[i] & b) ^ c;
+            }
+        }
+
+        void computeDiag(int64_t *out, const int64_t *y, const int64_t *xy, int64_t rank, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = (xy[i] & ~1ll) | ((y[i] & 1) ^ rank);
+            }
+        }
+
+        void selectBits(int64_t *out, const int64_t *y0, const int64_t *y1, const int64_t *choice,
+                        const int64_t *hash, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                uint64_t c = static_cast<uint64_t>(choice[i]);
+                uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
+                out[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hash[i]));
+            }
+        }
+
+        void xorU128C(U128 *out, const U128 *arr, U128 c, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                out[i].lo = arr[i].lo ^ c.lo;
+                out[i].hi = arr[i].hi ^ c.hi;
+            }
+        }
+
+        void transpose128(U128 *v) {
+            uint64_t x0[128];
+            uint64_t x1[128];
+            for (int i = 0; i < 128; ++i) {
+                x0[i] = v[i].lo;
+                x1[i] = v[i].hi;
+            }
+
+            auto transpose64 = [](uint64_t x[128]) {
+                static constexpr uint64_t m1 = 0x5555555555555555ULL;
+                static constexpr uint64_t m2 = 0x3333333333333333ULL;
+                static constexpr uint64_t m4 = 0x0f0f0f0f0f0f0f0fULL;
+                static constexpr uint64_t m8 = 0x00ff00ff00ff00ffULL;
+                static constexpr uint64_t m16 = 0x0000ffff0000ffffULL;
+                static constexpr uint64_t m32 = 0x00000000ffffffffULL;
+
+                auto swap_rows = [&](int shift, uint64_t mask) {
+                    for (int i = 0; i < 128; i += 2 * shift) {
+                        for (int j = 0; j < shift; ++j) {
+                            uint64_t a = x[i + j];
+                            uint64_t b = x[i + j + shift];
+                            uint64_t t = ((a >> shift) ^ b) & mask;
+                            b ^= t;
+                            a ^= (t << shift);
+                            x[i + j] = a;
+                            x[i + j + shift] = b;
+                        }
+                    }
+                };
+
+                swap_rows(1, m1);
+                swap_rows(2, m2);
+                swap_rows(4, m4);
+                swap_rows(8, m8);
+                swap_rows(16, m16);
+                swap_rows(32, m32);
+            };
+
+            transpose64(x0);
+            transpose64(x1);
+
+            for (int i = 0; i < 64; ++i) {
+                std::swap(x0[i + 64], x1[i]);
+            }
+
+            for (int i = 0; i < 128; ++i) {
+                v[i] = {x0[i], x1[i]};
+            }
+        }
+
+        size_t packBits1(uint8_t *, const int64_t *, size_t) {
+            return 0;
+        }
+
+        size_t unpackBits1(int64_t *, const uint8_t *, size_t) {
+            return 0;
+        }
     }
-    for (; i < num; i++) {
-        out[i] = arr0[i] ^ arr1[i];
+
+#ifdef SIMD_X86
+    namespace sse2 {
+#define SIMD_TARGET __attribute__((target("sse2")))
+        using V = __m128i;
+        constexpr size_t LANES = 2;
+
+        SIMD_TARGET inline V vload(const void *p) { return _mm_loadu_si128(static_cast<const __m128i *>(p)); }
+        SIMD_TARGET inline void vstore(void *p, V v) { _mm_storeu_si128(static_cast<__m128i *>(p), v); }
+        SIMD_TARGET inline V vxor(V a, V b) { return _mm_xor_si128(a, b); }
+        SIMD_TARGET inline V vand(V a, V b) { return _mm_and_si128(a, b); }
+        SIMD_TARGET inline V vor(V a, V b) { return _mm_or_si128(a, b); }
+        SIMD_TARGET inline V vset1(int64_t x) { return _mm_set1_epi64x(x); }
+        SIMD_TARGET inline V vset2(uint64_t lo, uint64_t hi) {
+            return _mm_set_epi64x(static_cast<int64_t>(hi), static_cast<int64_t>(lo));
+        }
+        SIMD_TARGET inline V vsrl(V v, int s) { return _mm_srl_epi64(v, _mm_cvtsi32_si128(s)); }
+        SIMD_TARGET inline V vsll(V v, int s) { return _mm_sll_epi64(v, _mm_cvtsi32_si128(s)); }
+
+#include "SimdKernels.inc"
+
+        SIMD_TARGET size_t packBits1(uint8_t *out, const int64_t *values, size_t count) {
+            // One output byte per 8 inputs: gather the lowest bit of every lane
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                int m = 0;
+                for (int j = 0; j < 8; j += 2) {
+                    __m128i v = _mm_slli_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i + j)), 63);
+                    m |= _mm_movemask_pd(_mm_castsi128_pd(v)) << j;
+                }
+                out[i >> 3] = static_cast<uint8_t>(m);
+            }
+            return i;
+        }
+
+        size_t unpackBits1(int64_t *, const uint8_t *, size_t) {
+            return 0;
+        }
+#undef SIMD_TARGET
+    }
+
+    namespace avx2 {
+#define SIMD_TARGET __attribute__((target("avx2")))
+        using V = __m256i;
+        constexpr size_t LANES = 4;
+
+        SIMD_TARGET inline V vload(const void *p) { return _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+        SIMD_TARGET inline void vstore(void *p, V v) { _mm256_storeu_si256(static_cast<__m256i *>(p), v); }
+        SIMD_TARGET inline V vxor(V a, V b) { return _mm256_xor_si256(a, b); }
+        SIMD_TARGET inline V vand(V a, V b) { return _mm256_and_si256(a, b); }
+        SIMD_TARGET inline V vor(V a, V b) { return _mm256_or_si256(a, b); }
+        SIMD_TARGET inline V vset1(int64_t x) { return _mm256_set1_epi64x(x); }
+        SIMD_TARGET inline V vset2(uint64_t lo, uint64_t hi) {
+            auto l = static_cast<int64_t>(lo), h = static_cast<int64_t>(hi);
+            return _mm256_set_epi64x(h, l, h, l);
+        }
+        SIMD_TARGET inline V vsrl(V v, int s) { return _mm256_srl_epi64(v, _mm_cvtsi32_si128(s)); }
+        SIMD_TARGET inline V vsll(V v, int s) { return _mm256_sll_epi64(v, _mm_cvtsi32_si128(s)); }
+
+#include "SimdKernels.inc"
+
+        SIMD_TARGET size_t packBits1(uint8_t *out, const int64_t *values, size_t count) {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256i lo = _mm256_slli_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)), 63);
+                __m256i hi = _mm256_slli_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + 4)),
+                                               63);
+                int m = _mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+                        (_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4);
+                out[i >> 3] = static_cast<uint8_t>(m);
+            }
+            return i;
+        }
+
+        SIMD_TARGET size_t unpackBits1(int64_t *out, const uint8_t *packed, size_t count) {
+            const __m256i selLo = _mm256_set_epi64x(8, 4, 2, 1);
+            const __m256i selHi = _mm256_set_epi64x(128, 64, 32, 16);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256i b = _mm256_set1_epi64x(packed[i >> 3]);
+                __m256i lo = _mm256_cmpeq_epi64(_mm256_and_si256(b, selLo), selLo);
+                __m256i hi = _mm256_cmpeq_epi64(_mm256_and_si256(b, selHi), selHi);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_srli_epi64(lo, 63));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 4), _mm256_srli_epi64(hi, 63));
+            }
+            return i;
+        }
+#undef SIMD_TARGET
+    }
+
+    namespace avx512 {
+#define SIMD_TARGET __attribute__((target("avx512f")))
+        using V = __m512i;
+        constexpr size_t LANES = 8;
+
+        SIMD_TARGET inline V vload(const void *p) { return _mm512_loadu_si512(p); }
+        SIMD_TARGET inline void vstore(void *p, V v) { _mm512_storeu_si512(p, v); }
+        SIMD_TARGET inline V vxor(V a, V b) { return _mm512_xor_si512(a, b); }
+        SIMD_TARGET inline V vand(V a, V b) { return _mm512_and_si512(a, b); }
+        SIMD_TARGET inline V vor(V a, V b) { return _mm512_or_si512(a, b); }
+        SIMD_TARGET inline V vset1(int64_t x) { return _mm512_set1_epi64(x); }
+        SIMD_TARGET inline V vset2(uint64_t lo, uint64_t hi) {
+            auto l = static_cast<int64_t>(lo), h = static_cast<int64_t>(hi);
+            return _mm512_set_epi64(h, l, h, l, h, l, h, l);
+        }
+        SIMD_TARGET inline V vsrl(V v, int s) { return _mm512_srl_epi64(v, _mm_cvtsi32_si128(s)); }
+        SIMD_TARGET inline V vsll(V v, int s) { return _mm512_sll_epi64(v, _mm_cvtsi32_si128(s)); }
+
+#include "SimdKernels.inc"
+
+        SIMD_TARGET size_t packBits1(uint8_t *out, const int64_t *values, size_t count) {
+            const __m512i one = _mm512_set1_epi64(1);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m512i v = _mm512_loadu_si512(values + i);
+                out[i >> 3] = static_cast<uint8_t>(_mm512_test_epi64_mask(v, one));
+            }
+            return i;
+        }
+
+        SIMD_TARGET size_t unpackBits1(int64_t *out, const uint8_t *packed, size_t count) {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm512_storeu_si512(out + i, _mm512_maskz_set1_epi64(packed[i >> 3], 1));
+            }
+            return i;
+        }
+#undef SIMD_TARGET
     }
-#else
-    for (int i = 0; i < num; i++) {
-        out[i] = arr0[i] ^ arr1[i];
+#endif
+
+#ifdef SIMD_NEON
+    namespace neon {
+#define SIMD_TARGET
+        using V = int64x2_t;
+        constexpr size_t LANES = 2;
+
+        inline V vload(const void *p) { return vld1q_s64(static_cast<const int64_t *>(p)); }
+        inline void vstore(void *p, V v) { vst1q_s64(static_cast<int64_t *>(p), v); }
+        inline V vxor(V a, V b) { return veorq_s64(a, b); }
+        inline V vand(V a, V b) { return vandq_s64(a, b); }
+        inline V vor(V a, V b) { return vorrq_s64(a, b); }
+        inline V vset1(int64_t x) { return vdupq_n_s64(x); }
+        inline V vset2(uint64_t lo, uint64_t hi) {
+            return vcombine_s64(vcreate_s64(lo), vcreate_s64(hi));
+        }
+        inline V vsrl(V v, int s) {
+            return vreinterpretq_s64_u64(vshlq_u64(vreinterpretq_u64_s64(v), vdupq_n_s64(-s)));
+        }
+        inline V vsll(V v, int s) { return vshlq_s64(v, vdupq_n_s64(s)); }
+
+#include "SimdKernels.inc"
+
+        size_t packBits1(uint8_t *out, const int64_t *values, size_t count) {
+            const uint64x2_t one = vdupq_n_u64(1);
+            const int64x2_t shifts = {0, 1};
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                uint64_t m = 0;
+                for (int j = 0; j < 8; j += 2) {
+                    uint64x2_t v = vandq_u64(vld1q_u64(reinterpret_cast<const uint64_t *>(values + i + j)), one);
+                    v = vshlq_u64(v, shifts);
+                    m |= (vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) << j;
+                }
+                out[i >> 3] = static_cast<uint8_t>(m);
+            }
+            return i;
+        }
+
+        size_t unpackBits1(int64_t *out, const uint8_t *packed, size_t count) {
+            const uint64x2_t one = vdupq_n_u64(1);
+            const int64x2_t shifts = {0, -1};
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                uint64_t b = packed[i >> 3];
+                for (int j = 0; j < 8; j += 2) {
+                    uint64x2_t v = vandq_u64(vshlq_u64(vdupq_n_u64(b >> j), shifts), one);
+                    vst1q_u64(reinterpret_cast<uint64_t *>(out + i + j), v);
+                }
+            }
+            return i;
+        }
+#undef SIMD_TARGET
     }
 #endif
 
+#define SIMD_KERNEL_TABLE(ns) Kernels{ \
+        ns::xorV, ns::andV, ns::orV, ns::xorC, ns::andC, ns::xor3, ns::computeZ, ns::computeDiag, \
+        ns::selectBits, ns::xorU128C, ns::transpose128, ns::packBits1, ns::unpackBits1 \
+    }
+
+    const Kernels &kernels() {
+        static const Kernels table = [] {
+            switch (CpuFeatures::level()) {
+#ifdef SIMD_X86
+                case CpuFeatures::AVX512:
+                    return SIMD_KERNEL_TABLE(avx512);
+                case CpuFeatures::AVX2:
+                    return SIMD_KERNEL_TABLE(avx2);
+                case CpuFeatures::SSE2:
+                    return SIMD_KERNEL_TABLE(sse2);
+#endif
+#ifdef SIMD_NEON
+                case CpuFeatures::NEON:
+                    return SIMD_KERNEL_TABLE(neon);
+#endif
+                default:
+                    return SIMD_KERNEL_TABLE(scalar);
+            }
+        }();
+        return table;
+    }
+
+#undef SIMD_KERNEL_TABLE
+}
+
+std::vector<int64_t> SimdSupport::xorV(const std::vector<int64_t> &arr0,
+                                       const std::vector<int64_t> &arr1) {
+    std::vector<int64_t> out(arr0.size());
+    kernels().xorV(out.data(), arr0.data(), arr1.data(), out.size());
     return out;
 }
 
+void SimdSupport::xorV(int64_t *out, const int64_t *arr0, const int64_t *arr1, size_t num) {
+    kernels().xorV(out, arr0, arr1, num);
+}
+
 std::vector<int64_t> SimdSupport::andV(const std::vector<int64_t> &arr0,
                                        const std::vector<int64_t> &arr1) {
-    int num = static_cast<int>(arr0.size());
-    std::vector<int64_t> out(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i vec1 = _mm512_loadu_si512(&arr0[i]);
-        __m512i vec2 = _mm512_loadu_si512(&arr1[i]);
-        __m512i result = _mm512_and_si512(vec1, vec2);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] & arr1[i];
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i vec1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr0[i]));
-        __m256i vec2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr1[i]));
-        __m256i result = _mm256_and_si256(vec1, vec2);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] & arr1[i];
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i vec1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr0[i]));
-        __m128i vec2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr1[i]));
-        __m128i result = _mm_and_si128(vec1, vec2);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] & arr1[i];
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t vec1 = vld1q_s64(&arr0[i]);
-        int64x2_t vec2 = vld1q_s64(&arr1[i]);
-        int64x2_t result = vandq_s64(vec1, vec2);
-        vst1q_s64(&out[i], result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] & arr1[i];
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        out[i] = arr0[i] & arr1[i];
-    }
-#endif
-
+    std::vector<int64_t> out(arr0.size());
+    kernels().andV(out.data(), arr0.data(), arr1.data(), out.size());
     return out;
 }
 
 std::vector<int64_t> SimdSupport::andVC(const std::vector<int64_t> &arr, int64_t constant) {
-    int num = static_cast<int>(arr.size());
-    std::vector<int64_t> output(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    __m512i const_vec = _mm512_set1_epi64(constant);
-    for (; i + 8 <= num; i += 8) {
-        __m512i vec = _mm512_loadu_si512(&arr[i]);
-        __m512i result = _mm512_and_si512(vec, const_vec);
-        _mm512_storeu_si512(&output[i], result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] & constant;
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    __m256i const_vec = _mm256_set1_epi64x(constant);
-    for (; i + 4 <= num; i += 4) {
-        __m256i vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr[i]));
-        __m256i result = _mm256_and_si256(vec, const_vec);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&output[i]), result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] & constant;
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    __m128i const_vec = _mm_set1_epi64x(constant);
-    for (; i + 2 <= num; i += 2) {
-        __m128i vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr[i]));
-        __m128i result = _mm_and_si128(vec, const_vec);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] & constant;
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    int64x2_t const_vec = vdupq_n_s64(constant);
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t vec = vld1q_s64(&arr[i]);
-        int64x2_t result = vandq_s64(vec, const_vec);
-        vst1q_s64(&output[i], result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] & constant;
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        output[i] = arr[i] & constant;
-    }
-#endif
-
+    std::vector<int64_t> output(arr.size());
+    kernels().andC(output.data(), arr.data(), constant, output.size());
     return output;
 }
 
 std::vector<int64_t> SimdSupport::orV(const std::vector<int64_t> &arr0,
                                       const std::vector<int64_t> &arr1) {
-    int num = static_cast<int>(arr0.size());
-    std::vector<int64_t> out(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i vec1 = _mm512_loadu_si512(&arr0[i]);
-        __m512i vec2 = _mm512_loadu_si512(&arr1[i]);
-        __m512i result = _mm512_or_si512(vec1, vec2);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] | arr1[i];
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i vec1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr0[i]));
-        __m256i vec2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr1[i]));
-        __m256i result = _mm256_or_si256(vec1, vec2);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] | arr1[i];
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i vec1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr0[i]));
-        __m128i vec2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr1[i]));
-        __m128i result = _mm_or_si128(vec1, vec2);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] | arr1[i];
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t vec1 = vld1q_s64(&arr0[i]);
-        int64x2_t vec2 = vld1q_s64(&arr1[i]);
-        int64x2_t result = vorrq_s64(vec1, vec2);
-        vst1q_s64(&out[i], result);
-    }
-    for (; i < num; i++) {
-        out[i] = arr0[i] | arr1[i];
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        out[i] = arr0[i] | arr1[i];
-    }
-#endif
-
+    std::vector<int64_t> out(arr0.size());
+    kernels().orV(out.data(), arr0.data(), arr1.data(), out.size());
     return out;
 }
 
 std::vector<int64_t> SimdSupport::xorVC(const std::vector<int64_t> &arr, int64_t constant) {
-    int num = static_cast<int>(arr.size());
-    std::vector<int64_t> output(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    __m512i const_vec = _mm512_set1_epi64(constant);
-    for (; i + 8 <= num; i += 8) {
-        __m512i vec = _mm512_loadu_si512(&arr[i]);
-        __m512i result = _mm512_xor_si512(vec, const_vec);
-        _mm512_storeu_si512(&output[i], result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] ^ constant;
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    __m256i const_vec = _mm256_set1_epi64x(constant);
-    for (; i + 4 <= num; i += 4) {
-        __m256i vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr[i]));
-        __m256i result = _mm256_xor_si256(vec, const_vec);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&output[i]), result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] ^ constant;
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    __m128i const_vec = _mm_set1_epi64x(constant);
-    for (; i + 2 <= num; i += 2) {
-        __m128i vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr[i]));
-        __m128i result = _mm_xor_si128(vec, const_vec);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] ^ constant;
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    int64x2_t const_vec = vdupq_n_s64(constant);
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t vec = vld1q_s64(&arr[i]);
-        int64x2_t result = veorq_s64(vec, const_vec);
-        vst1q_s64(&output[i], result);
-    }
-    for (; i < num; i++) {
-        output[i] = arr[i] ^ constant;
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        output[i] = arr[i] ^ constant;
-    }
-#endif
-
+    std::vector<int64_t> output(arr.size());
+    kernels().xorC(output.data(), arr.data(), constant, output.size());
     return output;
 }
 
 std::vector<int64_t> SimdSupport::xor2VC(const std::vector<int64_t> &xis, const std::vector<int64_t> &yis,
                                          int64_t a, int64_t b) {
-    int num = static_cast<int>(xis.size());
+    size_t num = xis.size();
     std::vector<int64_t> out(num * 2);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    __m512i a_vec = _mm512_set1_epi64(a);
-    __m512i b_vec = _mm512_set1_epi64(b);
-    for (; i + 8 <= num; i += 8) {
-        __m512i xis_vec = _mm512_loadu_si512(&xis[i]);
-        __m512i yis_vec = _mm512_loadu_si512(&yis[i]);
-        __m512i out_x = _mm512_xor_si512(xis_vec, a_vec);
-        __m512i out_y = _mm512_xor_si512(yis_vec, b_vec);
-        _mm512_storeu_si512(&out[i], out_x);
-        _mm512_storeu_si512(&out[num + i], out_y);
-    }
-    for (; i < num; i++) {
-        out[i] = xis[i] ^ a;
-        out[num + i] = yis[i] ^ b;
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    __m256i a_vec = _mm256_set1_epi64x(a);
-    __m256i b_vec = _mm256_set1_epi64x(b);
-    for (; i + 4 <= num; i += 4) {
-        __m256i xis_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&xis[i]));
-        __m256i yis_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&yis[i]));
-        __m256i out_x = _mm256_xor_si256(xis_vec, a_vec);
-        __m256i out_y = _mm256_xor_si256(yis_vec, b_vec);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), out_x);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[num + i]), out_y);
-    }
-    for (; i < num; i++) {
-        out[i] = xis[i] ^ a;
-        out[num + i] = yis[i] ^ b;
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    __m128i a_vec = _mm_set1_epi64x(a);
-    __m128i b_vec = _mm_set1_epi64x(b);
-    for (; i + 2 <= num; i += 2) {
-        __m128i xis_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&xis[i]));
-        __m128i yis_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&yis[i]));
-        __m128i out_x = _mm_xor_si128(xis_vec, a_vec);
-        __m128i out_y = _mm_xor_si128(yis_vec, b_vec);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), out_x);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[num + i]), out_y);
-    }
-    for (; i < num; i++) {
-        out[i] = xis[i] ^ a;
-        out[num + i] = yis[i] ^ b;
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    int64x2_t a_vec = vdupq_n_s64(a);
-    int64x2_t b_vec = vdupq_n_s64(b);
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t xis_vec = vld1q_s64(&xis[i]);
-        int64x2_t yis_vec = vld1q_s64(&yis[i]);
-        int64x2_t out_x = veorq_s64(xis_vec, a_vec);
-        int64x2_t out_y = veorq_s64(yis_vec, b_vec);
-        vst1q_s64(&out[i], out_x);
-        vst1q_s64(&out[num + i], out_y);
-    }
-    for (; i < num; i++) {
-        out[i] = xis[i] ^ a;
-        out[num + i] = yis[i] ^ b;
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        out[i] = xis[i] ^ a;
-        out[num + i] = yis[i] ^ b;
-    }
-#endif
-
+    kernels().xorC(out.data(), xis.data(), a, num);
+    kernels().xorC(out.data() + num, yis.data(), b, num);
     return out;
 }
 
 std::vector<int64_t> SimdSupport::xor3(const int64_t *a, const int64_t *b, const int64_t *c, int num) {
     std::vector<int64_t> output(num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i va = _mm512_loadu_si512(a + i);
-        __m512i vb = _mm512_loadu_si512(b + i);
-        __m512i vc = _mm512_loadu_si512(c + i);
-        __m512i res = _mm512_xor_si512(va, vb);
-        res = _mm512_xor_si512(res, vc);
-        _mm512_storeu_si512(output.data() + i, res);
-    }
-    for (; i < num; i++) {
-        output[i] = a[i] ^ b[i] ^ c[i];
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
-        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
-        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i));
-        __m256i res = _mm256_xor_si256(va, vb);
-        res = _mm256_xor_si256(res, vc);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output.data() + i), res);
-    }
-    for (; i < num; i++) {
-        output[i] = a[i] ^ b[i] ^ c[i];
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
-        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
-        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
-        __m128i res = _mm_xor_si128(va, vb);
-        res = _mm_xor_si128(res, vc);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(output.data() + i), res);
-    }
-    for (; i < num; i++) {
-        output[i] = a[i] ^ b[i] ^ c[i];
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t va = vld1q_s64(a + i);
-        int64x2_t vb = vld1q_s64(b + i);
-        int64x2_t vc = vld1q_s64(c + i);
-        int64x2_t res = veorq_s64(va, vb);
-        res = veorq_s64(res, vc);
-        vst1q_s64(output.data() + i, res);
-    }
-    for (; i < num; i++) {
-        output[i] = a[i] ^ b[i] ^ c[i];
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        output[i] = a[i] ^ b[i] ^ c[i];
-    }
-#endif
-
+    kernels().xor3(output.data(), a, b, c, output.size());
     return output;
 }
 
 std::vector<int64_t> SimdSupport::xor3Concat(const int64_t *commonA, const int64_t *arrB, const int64_t *arrD,
                                              const int64_t *commonC, int num) {
     std::vector<int64_t> output(2 * num);
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i va = _mm512_loadu_si512(commonA + i);
-        __m512i vb = _mm512_loadu_si512(arrB + i);
-        __m512i vc = _mm512_loadu_si512(commonC + i);
-        __m512i res = _mm512_xor_si512(va, vb);
-        res = _mm512_xor_si512(res, vc);
-        _mm512_storeu_si512(output.data() + i, res);
-    }
-    for (; i < num; i++) {
-        output[i] = commonA[i] ^ arrB[i] ^ commonC[i];
-    }
-    i = 0;
-    for (; i + 8 <= num; i += 8) {
-        __m512i va = _mm512_loadu_si512(commonA + i);
-        __m512i vd = _mm512_loadu_si512(arrD + i);
-        __m512i vc = _mm512_loadu_si512(commonC + i);
-        __m512i res = _mm512_xor_si512(va, vd);
-        res = _mm512_xor_si512(res, vc);
-        _mm512_storeu_si512(output.data() + num + i, res);
-    }
-    for (; i < num; i++) {
-        output[num + i] = commonA[i] ^ arrD[i] ^ commonC[i];
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(commonA + i));
-        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arrB + i));
-        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(commonC + i));
-        __m256i res = _mm256_xor_si256(va, vb);
-        res = _mm256_xor_si256(res, vc);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output.data() + i), res);
-    }
-    for (; i < num; i++) {
-        output[i] = commonA[i] ^ arrB[i] ^ commonC[i];
-    }
-    i = 0;
-    for (; i + 4 <= num; i += 4) {
-        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(commonA + i));
-        __m256i vd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arrD + i));
-        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(commonC + i));
-        __m256i res = _mm256_xor_si256(va, vd);
-        res = _mm256_xor_si256(res, vc);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output.data() + num + i), res);
-    }
-    for (; i < num; i++) {
-        output[num + i] = commonA[i] ^ arrD[i] ^ commonC[i];
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(commonA + i));
-        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(arrB + i));
-        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(commonC + i));
-        __m128i res = _mm_xor_si128(va, vb);
-        res = _mm_xor_si128(res, vc);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(output.data() + i), res);
-    }
-    for (; i < num; i++) {
-        output[i] = commonA[i] ^ arrB[i] ^ commonC[i];
-    }
-    i = 0;
-    for (; i + 2 <= num; i += 2) {
-        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(commonA + i));
-        __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(arrD + i));
-        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(commonC + i));
-        __m128i res = _mm_xor_si128(va, vd);
-        res = _mm_xor_si128(res, vc);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(output.data() + num + i), res);
-    }
-    for (; i < num; i++) {
-        output[num + i] = commonA[i] ^ arrD[i] ^ commonC[i];
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t va = vld1q_s64(commonA + i);
-        int64x2_t vb = vld1q_s64(arrB + i);
-        int64x2_t vc = vld1q_s64(commonC + i);
-        int64x2_t res = veorq_s64(va, vb);
-        res = veorq_s64(res, vc);
-        vst1q_s64(output.data() + i, res);
-    }
-    for (; i < num; i++) {
-        output[i] = commonA[i] ^ arrB[i] ^ commonC[i];
-    }
-    i = 0;
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t va = vld1q_s64(commonA + i);
-        int64x2_t vd = vld1q_s64(arrD + i);
-        int64x2_t vc = vld1q_s64(commonC + i);
-        int64x2_t res = veorq_s64(va, vd);
-        res = veorq_s64(res, vc);
-        vst1q_s64(output.data() + num + i, res);
-    }
-    for (; i < num; i++) {
-        output[num + i] = commonA[i] ^ arrD[i] ^ commonC[i];
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        output[i] = commonA[i] ^ arrB[i] ^ commonC[i];
-        output[num + i] = commonA[i] ^ arrD[i] ^ commonC[i];
-    }
-#endif
-
+    kernels().xor3(output.data(), commonA, arrB, commonC, num);
+    kernels().xor3(output.data() + num, commonA, arrD, commonC, num);
     return output;
 }
 
 std::vector<int64_t> SimdSupport::computeZ(const std::vector<int64_t> &efs, int64_t a, int64_t b,
                                            int64_t c) {
-    int num = static_cast<int>(efs.size() / 2);
+    size_t num = efs.size() / 2;
     std::vector<int64_t> zis(num);
     int64_t extendedRank = Comm::rank() ? -1ll : 0;
-
-#ifdef SIMD_AVX512
-    int i = 0;
-    __m512i ext_vec = _mm512_set1_epi64(extendedRank);
-    __m512i a_vec = _mm512_set1_epi64(a);
-    __m512i b_vec = _mm512_set1_epi64(b);
-    __m512i c_vec = _mm512_set1_epi64(c);
-    for (; i + 8 <= num; i += 8) {
-        __m512i e_vec = _mm512_loadu_si512(&efs[i]);
-        __m512i f_vec = _mm512_loadu_si512(&efs[num + i]);
-
-        __m512i ef = _mm512_and_si512(ext_vec, _mm512_and_si512(e_vec, f_vec));
-        __m512i fa = _mm512_and_si512(f_vec, a_vec);
-        __m512i eb = _mm512_and_si512(e_vec, b_vec);
-        __m512i result = _mm512_xor_si512(_mm512_xor_si512(ef, fa), _mm512_xor_si512(eb, c_vec));
-
-        _mm512_storeu_si512(&zis[i], result);
-    }
-    for (; i < num; i++) {
-        zis[i] = (extendedRank & efs[i] & efs[num + i]) ^ (efs[num + i] & a) ^ (efs[i] & b) ^ c;
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    __m256i ext_vec = _mm256_set1_epi64x(extendedRank);
-    __m256i a_vec = _mm256_set1_epi64x(a);
-    __m256i b_vec = _mm256_set1_epi64x(b);
-    __m256i c_vec = _mm256_set1_epi64x(c);
-    for (; i + 4 <= num; i += 4) {
-        __m256i e_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&efs[i]));
-        __m256i f_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&efs[num + i]));
-
-        __m256i ef = _mm256_and_si256(ext_vec, _mm256_and_si256(e_vec, f_vec));
-        __m256i fa = _mm256_and_si256(f_vec, a_vec);
-        __m256i eb = _mm256_and_si256(e_vec, b_vec);
-        __m256i result = _mm256_xor_si256(_mm256_xor_si256(ef, fa), _mm256_xor_si256(eb, c_vec));
-
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&zis[i]), result);
-    }
-    for (; i < num; i++) {
-        zis[i] = (extendedRank & efs[i] & efs[num + i]) ^ (efs[num + i] & a) ^ (efs[i] & b) ^ c;
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    __m128i ext_vec = _mm_set1_epi64x(extendedRank);
-    __m128i a_vec = _mm_set1_epi64x(a);
-    __m128i b_vec = _mm_set1_epi64x(b);
-    __m128i c_vec = _mm_set1_epi64x(c);
-    for (; i + 2 <= num; i += 2) {
-        __m128i e_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&efs[i]));
-        __m128i f_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&efs[num + i]));
-
-        __m128i ef = _mm_and_si128(ext_vec, _mm_and_si128(e_vec, f_vec));
-        __m128i fa = _mm_and_si128(f_vec, a_vec);
-        __m128i eb = _mm_and_si128(e_vec, b_vec);
-        __m128i result = _mm_xor_si128(_mm_xor_si128(ef, fa), _mm_xor_si128(eb, c_vec));
-
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&zis[i]), result);
-    }
-    for (; i < num; i++) {
-        zis[i] = (extendedRank & efs[i] & efs[num + i]) ^ (efs[num + i] & a) ^ (efs[i] & b) ^ c;
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    int64x2_t ext_vec = vdupq_n_s64(extendedRank);
-    int64x2_t a_vec = vdupq_n_s64(a);
-    int64x2_t b_vec = vdupq_n_s64(b);
-    int64x2_t c_vec = vdupq_n_s64(c);
-    for (; i + 2 <= num; i += 2) {
-        int64x2_t e_vec = vld1q_s64(&efs[i]);
-        int64x2_t f_vec = vld1q_s64(&efs[num + i]);
-
-        int64x2_t ef = vandq_s64(ext_vec, vandq_s64(e_vec, f_vec));
-        int64x2_t fa = vandq_s64(f_vec, a_vec);
-        int64x2_t eb = vandq_s64(e_vec, b_vec);
-        int64x2_t result = veorq_s64(veorq_s64(ef, fa), veorq_s64(eb, c_vec));
-
-        vst1q_s64(&zis[i], result);
-    }
-    for (; i < num; i++) {
-        zis[i] = (extendedRank & efs[i] & efs[num + i]) ^ (efs[num + i] & a) ^ (efs[i] & b) ^ c;
-    }
-#else
-    for (int i = 0; i < num; i++) {
-        zis[i] = (extendedRank & efs[i] & efs[num + i]) ^ (efs[num + i] & a) ^ (efs[i] & b) ^ c;
-    }
-#endif
-
+    kernels().computeZ(zis.data(), efs.data(), efs.data() + num, extendedRank, a, b, c, num);
     return zis;
 }
 
 std::vector<int64_t> SimdSupport::computeDiag(const std::vector<int64_t> &_yis,
                                               const std::vector<int64_t> &x_xor_y) {
-    int n = static_cast<int>(_yis.size());
-    std::vector<int64_t> diag(n);
-    int64_t rank = Comm::rank();
-#ifdef SIMD_AVX512
-    int i = 0;
-    __m512i one     = _mm512_set1_epi64(1);
-    __m512i not_one = _mm512_set1_epi64(~1ll);
-    __m512i rank_vec= _mm512_set1_epi64(rank);
-    for (; i + 8 <= n; i += 8) {
-        __m512i y_vec = _mm512_loadu_si512(&_yis[i]);
-        __m512i x_vec = _mm512_loadu_si512(&x_xor_y[i]);
-        __m512i yis_lsb = _mm512_and_si512(y_vec, one);
-        __m512i xor_result = _mm512_xor_si512(yis_lsb, rank_vec);
-        __m512i m = _mm512_and_si512(x_vec, not_one);
-        __m512i res = _mm512_or_si512(m, xor_result);
-        _mm512_storeu_si512(&diag[i], res);
-    }
-    for (; i < n; i++) {
-        int64_t yis_lsb = _yis[i] & 1;
-        int64_t xor_result = yis_lsb ^ rank;
-        int64_t m = x_xor_y[i] & (~1ll);
-        diag[i] = m | xor_result;
-    }
-#elif defined(SIMD_AVX2)
-    int i = 0;
-    __m256i one     = _mm256_set1_epi64x(1);
-    __m256i not_one = _mm256_set1_epi64x(~1ll);
-    __m256i rank_vec= _mm256_set1_epi64x(rank);
-    for (; i + 4 <= n; i += 4) {
-        __m256i y_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&_yis[i]));
-        __m256i x_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&x_xor_y[i]));
-        __m256i yis_lsb = _mm256_and_si256(y_vec, one);
-        __m256i xor_result = _mm256_xor_si256(yis_lsb, rank_vec);
-        __m256i m = _mm256_and_si256(x_vec, not_one);
-        __m256i res = _mm256_or_si256(m, xor_result);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&diag[i]), res);
-    }
-    for (; i < n; i++) {
-        int64_t yis_lsb = _yis[i] & 1;
-        int64_t xor_result = yis_lsb ^ rank;
-        int64_t m = x_xor_y[i] & (~1ll);
-        diag[i] = m | xor_result;
-    }
-#elif defined(SIMD_SSE2)
-    int i = 0;
-    __m128i one     = _mm_set1_epi64x(1);
-    __m128i not_one = _mm_set1_epi64x(~1ll);
-    __m128i rank_vec= _mm_set1_epi64x(rank);
-    for (; i + 2 <= n; i += 2) {
-        __m128i y_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_yis[i]));
-        __m128i x_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&x_xor_y[i]));
-        __m128i yis_lsb = _mm_and_si128(y_vec, one);
-        __m128i xor_result = _mm_xor_si128(yis_lsb, rank_vec);
-        __m128i m = _mm_and_si128(x_vec, not_one);
-        __m128i res = _mm_or_si128(m, xor_result);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&diag[i]), res);
-    }
-    for (; i < n; i++) {
-        int64_t yis_lsb = _yis[i] & 1;
-        int64_t xor_result = yis_lsb ^ rank;
-        int64_t m = x_xor_y[i] & (~1ll);
-        diag[i] = m | xor_result;
-    }
-#elif defined(SIMD_NEON)
-    int i = 0;
-    int64x2_t one = vdupq_n_s64(1);
-    int64x2_t not_one = vdupq_n_s64(~1ll);
-    int64x2_t rank_vec = vdupq_n_s64(rank);
-    for (; i + 2 <= n; i += 2) {
-        int64x2_t y_vec = vld1q_s64(&_yis[i]);
-        int64x2_t x_vec = vld1q_s64(&x_xor_y[i]);
-        int64x2_t yis_lsb = vandq_s64(y_vec, one);
-        int64x2_t xor_result = veorq_s64(yis_lsb, rank_vec);
-        int64x2_t m = vandq_s64(x_vec, not_one);
-        int64x2_t res = vorrq_s64(m, xor_result);
-        vst1q_s64(&diag[i], res);
-    }
-    for (; i < n; i++) {
-        int64_t yis_lsb = _yis[i] & 1;
-        int64_t xor_result = yis_lsb ^ rank;
-        int64_t m = x_xor_y[i] & (~1ll);
-        diag[i] = m | xor_result;
-    }
-#else
-    for (int i = 0; i < n; i++) {
-        int64_t yis_lsb = _yis[i] & 1;
-        int64_t xor_result = yis_lsb ^ rank;
-        int64_t m = x_xor_y[i] & (~1ll);
-        diag[i] = m | xor_result;
-    }
-#endif
-
+    std::vector<int64_t> diag(_yis.size());
+    kernels().computeDiag(diag.data(), _yis.data(), x_xor_y.data(), Comm::rank(), diag.size());
     return diag;
 }
 
 // ============== U128 SIMD Operations for IKNP ==============
+// U128 is two packed 64-bit words, so the plain XOR kernels run over 2 * count words
 
 void SimdSupport::xorU128ArrayWithConstant(U128* out, const U128* arr, const U128& constant, size_t count) {
-    // XOR each element of arr with constant, store in out
-    // U128 is 16 bytes = 128 bits, perfect for SSE/NEON
-
-#ifdef SIMD_AVX512
-    // AVX-512: process 4 U128 (512 bits) at a time
-    const __m512i const_vec = _mm512_set_epi64(
-        constant.hi, constant.lo, constant.hi, constant.lo,
-        constant.hi, constant.lo, constant.hi, constant.lo
-    );
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m512i data = _mm512_loadu_si512(&arr[i]);
-        __m512i result = _mm512_xor_si512(data, const_vec);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr[i].lo ^ constant.lo;
-        out[i].hi = arr[i].hi ^ constant.hi;
-    }
-#elif defined(SIMD_AVX2)
-    // AVX2: process 2 U128 (256 bits) at a time
-    const __m256i const_vec = _mm256_set_epi64x(constant.hi, constant.lo, constant.hi, constant.lo);
-    size_t i = 0;
-    for (; i + 2 <= count; i += 2) {
-        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr[i]));
-        __m256i result = _mm256_xor_si256(data, const_vec);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr[i].lo ^ constant.lo;
-        out[i].hi = arr[i].hi ^ constant.hi;
-    }
-#elif defined(SIMD_SSE2)
-    // SSE2: process 1 U128 (128 bits) at a time
-    const __m128i const_vec = _mm_set_epi64x(constant.hi, constant.lo);
-    for (size_t i = 0; i < count; ++i) {
-        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr[i]));
-        __m128i result = _mm_xor_si128(data, const_vec);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-#elif defined(SIMD_NEON)
-    // NEON: process 1 U128 at a time
-    const uint64x2_t const_vec = {constant.lo, constant.hi};
-    for (size_t i = 0; i < count; ++i) {
-        uint64x2_t data = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr[i]));
-        uint64x2_t result = veorq_u64(data, const_vec);
-        vst1q_u64(reinterpret_cast<uint64_t*>(&out[i]), result);
-    }
-#else
-    for (size_t i = 0; i < count; ++i) {
-        out[i].lo = arr[i].lo ^ constant.lo;
-        out[i].hi = arr[i].hi ^ constant.hi;
-    }
-#endif
+    kernels().xorU128C(out, arr, constant, count);
 }
 
 void SimdSupport::xorU128Arrays(U128* out, const U128* arr0, const U128* arr1, size_t count) {
-    // XOR two U128 arrays element-wise
-
-#ifdef SIMD_AVX512
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m512i data0 = _mm512_loadu_si512(&arr0[i]);
-        __m512i data1 = _mm512_loadu_si512(&arr1[i]);
-        __m512i result = _mm512_xor_si512(data0, data1);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi;
-    }
-#elif defined(SIMD_AVX2)
-    size_t i = 0;
-    for (; i + 2 <= count; i += 2) {
-        __m256i data0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr0[i]));
-        __m256i data1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr1[i]));
-        __m256i result = _mm256_xor_si256(data0, data1);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi;
-    }
-#elif defined(SIMD_SSE2)
-    for (size_t i = 0; i < count; ++i) {
-        __m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr0[i]));
-        __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr1[i]));
-        __m128i result = _mm_xor_si128(data0, data1);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-#elif defined(SIMD_NEON)
-    for (size_t i = 0; i < count; ++i) {
-        uint64x2_t data0 = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr0[i]));
-        uint64x2_t data1 = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr1[i]));
-        uint64x2_t result = veorq_u64(data0, data1);
-        vst1q_u64(reinterpret_cast<uint64_t*>(&out[i]), result);
-    }
-#else
-    for (size_t i = 0; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi;
-    }
-#endif
+    kernels().xorV(reinterpret_cast<int64_t *>(out), reinterpret_cast<const int64_t *>(arr0),
+                   reinterpret_cast<const int64_t *>(arr1), 2 * count);
 }
 
 void SimdSupport::xor3U128Arrays(U128* out, const U128* arr0, const U128* arr1, const U128* arr2, size_t count) {
-    // XOR three U128 arrays element-wise: out[i] = arr0[i] ^ arr1[i] ^ arr2[i]
-
-#ifdef SIMD_AVX512
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m512i data0 = _mm512_loadu_si512(&arr0[i]);
-        __m512i data1 = _mm512_loadu_si512(&arr1[i]);
-        __m512i data2 = _mm512_loadu_si512(&arr2[i]);
-        __m512i result = _mm512_xor_si512(_mm512_xor_si512(data0, data1), data2);
-        _mm512_storeu_si512(&out[i], result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo ^ arr2[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi ^ arr2[i].hi;
-    }
-#elif defined(SIMD_AVX2)
-    size_t i = 0;
-    for (; i + 2 <= count; i += 2) {
-        __m256i data0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr0[i]));
-        __m256i data1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr1[i]));
-        __m256i data2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&arr2[i]));
-        __m256i result = _mm256_xor_si256(_mm256_xor_si256(data0, data1), data2);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), result);
-    }
-    for (; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo ^ arr2[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi ^ arr2[i].hi;
-    }
-#elif defined(SIMD_SSE2)
-    for (size_t i = 0; i < count; ++i) {
-        __m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr0[i]));
-        __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr1[i]));
-        __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr2[i]));
-        __m128i result = _mm_xor_si128(_mm_xor_si128(data0, data1), data2);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), result);
-    }
-#elif defined(SIMD_NEON)
-    for (size_t i = 0; i < count; ++i) {
-        uint64x2_t data0 = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr0[i]));
-        uint64x2_t data1 = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr1[i]));
-        uint64x2_t data2 = vld1q_u64(reinterpret_cast<const uint64_t*>(&arr2[i]));
-        uint64x2_t result = veorq_u64(veorq_u64(data0, data1), data2);
-        vst1q_u64(reinterpret_cast<uint64_t*>(&out[i]), result);
-    }
-#else
-    for (size_t i = 0; i < count; ++i) {
-        out[i].lo = arr0[i].lo ^ arr1[i].lo ^ arr2[i].lo;
-        out[i].hi = arr0[i].hi ^ arr1[i].hi ^ arr2[i].hi;
-    }
-#endif
+    kernels().xor3(reinterpret_cast<int64_t *>(out), reinterpret_cast<const int64_t *>(arr0),
+                   reinterpret_cast<const int64_t *>(arr1), reinterpret_cast<const int64_t *>(arr2), 2 * count);
 }
 
 void SimdSupport::conditionalXorU128(U128* out, const U128* src, const bool* mask, size_t count) {
@@ -933,95 +485,69 @@ void SimdSupport::selectBits(int64_t* result, const int64_t* y0, const int64_t*
                              const int64_t* choice, const int64_t* hashValues, size_t count) {
     // Optimized bit selection for IKNP receiver:
     // result[i] = ((y0[i] & ~choice[i]) | (y1[i] & choice[i])) ^ hashValues[i]
+    kernels().selectBits(result, y0, y1, choice, hashValues, count);
+}
 
-#ifdef SIMD_AVX512
-    size_t i = 0;
-    for (; i + 8 <= count; i += 8) {
-        __m512i v_y0 = _mm512_loadu_si512(&y0[i]);
-        __m512i v_y1 = _mm512_loadu_si512(&y1[i]);
-        __m512i v_choice = _mm512_loadu_si512(&choice[i]);
-        __m512i v_hash = _mm512_loadu_si512(&hashValues[i]);
-
-        // (y0 & ~choice) | (y1 & choice) = y0 ^ ((y0 ^ y1) & choice)
-        __m512i xor_y = _mm512_xor_si512(v_y0, v_y1);
-        __m512i masked = _mm512_and_si512(xor_y, v_choice);
-        __m512i selected = _mm512_xor_si512(v_y0, masked);
-        __m512i final = _mm512_xor_si512(selected, v_hash);
-
-        _mm512_storeu_si512(&result[i], final);
-    }
-    for (; i < count; ++i) {
-        uint64_t c = static_cast<uint64_t>(choice[i]);
-        uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
-        result[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hashValues[i]));
-    }
-#elif defined(SIMD_AVX2)
-    size_t i = 0;
-    for (; i + 4 <= count; i += 4) {
-        __m256i v_y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&y0[i]));
-        __m256i v_y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&y1[i]));
-        __m256i v_choice = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&choice[i]));
-        __m256i v_hash = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&hashValues[i]));
-
-        // (y0 & ~choice) | (y1 & choice) = y0 ^ ((y0 ^ y1) & choice)
-        __m256i xor_y = _mm256_xor_si256(v_y0, v_y1);
-        __m256i masked = _mm256_and_si256(xor_y, v_choice);
-        __m256i selected = _mm256_xor_si256(v_y0, masked);
-        __m256i final = _mm256_xor_si256(selected, v_hash);
-
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&result[i]), final);
+void SimdSupport::transpose128x128(U128 v[128]) {
+    kernels().transpose128(v);
+}
+
+
+size_t SimdSupport::packedBytes(size_t count, int width) {
+    return (count * static_cast<size_t>(width) + 7) / 8;
+}
+
+// Generic bit-stream writer. Values are appended LSB first into 64-bit little-endian words.
+static void packBitsScalar(uint8_t *out, const int64_t *values, size_t count, int width) {
+    const uint64_t mask = width >= 64 ? ~0ULL : (1ULL << width) - 1;
+    uint64_t acc = 0;
+    int filled = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t v = static_cast<uint64_t>(values[i]) & mask;
+        acc |= v << filled;
+        filled += width;
+        if (filled >= 64) {
+            std::memcpy(out, &acc, sizeof(acc));
+            out += sizeof(acc);
+            filled -= 64;
+            // Bits of v that did not fit into the flushed word
+            acc = filled == 0 ? 0 : v >> (width - filled);
+        }
     }
-    for (; i < count; ++i) {
-        uint64_t c = static_cast<uint64_t>(choice[i]);
-        uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
-        result[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hashValues[i]));
+    std::memcpy(out, &acc, (filled + 7) / 8);
+}
+
+static void unpackBitsScalar(int64_t *out, const uint8_t *packed, size_t count, int width) {
+    const uint64_t mask = width >= 64 ? ~0ULL : (1ULL << width) - 1;
+    const size_t total = SimdSupport::packedBytes(count, width);
+    for (size_t i = 0; i < count; ++i) {
+        size_t bit = i * static_cast<size_t>(width);
+        size_t byte = bit >> 3;
+        int shift = static_cast<int>(bit & 7);
+
+        uint64_t word = 0;
+        std::memcpy(&word, packed + byte, std::min<size_t>(sizeof(word), total - byte));
+        uint64_t v = word >> shift;
+        if (shift + width > 64) {
+            v |= static_cast<uint64_t>(packed[byte + 8]) << (64 - shift);
+        }
+        out[i] = static_cast<int64_t>(v & mask);
     }
-#elif defined(SIMD_SSE2)
+}
+
+void SimdSupport::packBits(uint8_t *out, const int64_t *values, size_t count, int width) {
     size_t i = 0;
-    for (; i + 2 <= count; i += 2) {
-        __m128i v_y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&y0[i]));
-        __m128i v_y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&y1[i]));
-        __m128i v_choice = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&choice[i]));
-        __m128i v_hash = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&hashValues[i]));
-
-        __m128i xor_y = _mm_xor_si128(v_y0, v_y1);
-        __m128i masked = _mm_and_si128(xor_y, v_choice);
-        __m128i selected = _mm_xor_si128(v_y0, masked);
-        __m128i final = _mm_xor_si128(selected, v_hash);
-
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[i]), final);
-    }
-    for (; i < count; ++i) {
-        uint64_t c = static_cast<uint64_t>(choice[i]);
-        uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
-        result[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hashValues[i]));
+    if (width == 1) {
+        i = kernels().packBits1(out, values, count);
     }
-#elif defined(SIMD_NEON)
+    // i is a multiple of 8 here, so the remainder starts on a byte boundary
+    packBitsScalar(out + i * width / 8, values + i, count - i, width);
+}
+
+void SimdSupport::unpackBits(int64_t *out, const uint8_t *packed, size_t count, int width) {
     size_t i = 0;
-    for (; i + 2 <= count; i += 2) {
-        int64x2_t v_y0 = vld1q_s64(&y0[i]);
-        int64x2_t v_y1 = vld1q_s64(&y1[i]);
-        int64x2_t v_choice = vld1q_s64(&choice[i]);
-        int64x2_t v_hash = vld1q_s64(&hashValues[i]);
-
-        int64x2_t xor_y = veorq_s64(v_y0, v_y1);
-        int64x2_t masked = vandq_s64(xor_y, v_choice);
-        int64x2_t selected = veorq_s64(v_y0, masked);
-        int64x2_t final = veorq_s64(selected, v_hash);
-
-        vst1q_s64(&result[i], final);
+    if (width == 1) {
+        i = kernels().unpackBits1(out, packed, count);
     }
-    for (; i < count; ++i) {
-        uint64_t c = static_cast<uint64_t>(choice[i]);
-        uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
-        result[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hashValues[i]));
-    }
-#else
-    for (size_t i = 0; i < count; ++i) {
-        uint64_t c = static_cast<uint64_t>(choice[i]);
-        uint64_t selected = (static_cast<uint64_t>(y0[i]) & ~c) | (static_cast<uint64_t>(y1[i]) & c);
-        result[i] = static_cast<int64_t>(selected ^ static_cast<uint64_t>(hashValues[i]));
-    }
-#endif
+    unpackBitsScalar(out + i, packed + i * width / 8, count - i, width);
 }
-
@@ -0,0 +1,40 @@
+#include "base/AbstractBatchOperator.h"
+
+#include "comm/Comm.h"
+#include "utils/Crypto.h"
+
+void AbstractBatchOperator::sendSeededShares(const std::vector<int64_t> &values, bool xorShares, int clientRank) {
+    U128 seed{};
+    Crypto::randomFill(&seed, 1);
+    std::vector<int64_t> share1(values.size());
+    Crypto::expandSeed(seed, share1.data(), share1.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        int64_t share0 = ring(share1[i]);
+        share1[i] = ring(xorShares ? values[i] ^ share0 : values[i] - share0);
+    }
+
+    std::vector<int64_t> header = {
+        static_cast<int64_t>(values.size()), static_cast<int64_t>(seed.lo), static_cast<int64_t>(seed.hi)
+    };
+    auto r = Comm::sendAsync(header, 64, 0, buildTag(_currentMsgTag));
+    Comm::send(share1, _width, 1, buildTag(_currentMsgTag));
+    Comm::wait(r);
+}
+
+std::vector<int64_t> AbstractBatchOperator::receiveSeededShares(int clientRank) {
+    std::vector<int64_t> shares;
+    if (Comm::rank() == 1) {
+        Comm::receive(shares, _width, clientRank, buildTag(_currentMsgTag));
+        return shares;
+    }
+
+    std::vector<int64_t> header;
+    Comm::receive(header, 64, clientRank, buildTag(_currentMsgTag));
+    U128 seed{static_cast<uint64_t>(header[1]), static_cast<uint64_t>(header[2])};
+    shares.resize(header[0]);
+    Crypto::expandSeed(seed, shares.data(), shares.size());
+    for (auto &s: shares) {
+        s = ring(s);
+    }
+    return shares;
+}
@@ -8,8 +8,12 @@
 #include "utils/Math.h"
 
 int SecureOperator::buildTag(int msgTag) const {
+    return buildTag(_taskTag, msgTag);
+}
+
+int SecureOperator::buildTag(int taskTag, int msgTag) {
     int bits = 32 - Conf::TASK_TAG_BITS;
-    return (static_cast<unsigned int>(_taskTag) << bits) | static_cast<unsigned int>(msgTag & ((1 << bits) - 1));
+    return (static_cast<unsigned int>(taskTag) << bits) | static_cast<unsigned int>(msgTag & ((1 << bits) - 1));
 }
 
 
@@ -5,10 +5,15 @@
 
 #include <vector>
 
+#include "accelerate/SimdSupport.h"
 #include "comm/MpiComm.h"
+#include "comm/TcpComm.h"
 #include "conf/Conf.h"
+#include "parallel/WorkStealingThreadPool.h"
 #include "utils/System.h"
 
+#include <cstring>
+#include <stdexcept>
 #include <string>
 #define MEASURE_EXECUTION_TIME(statement) \
 int64_t start = 0; \
@@ -27,6 +32,8 @@ int Comm::rank() {
 void Comm::init(int argc, char **argv) {
     if (Conf::COMM_TYPE == Conf::MPI) {
         impl = new MpiComm();
+    } else if (Conf::COMM_TYPE == Conf::TCP) {
+        impl = new TcpComm();
     }
     impl->init_(argc, argv);
 }
@@ -213,7 +220,49 @@ AbstractRequest *Comm::serverReceiveAsync(std::string &target, int length, int t
 
 void Comm::wait(AbstractRequest *request) {
     try {
+        // Inside a pool fiber, let the worker run other batches until the request completes
+        while (WorkStealingThreadPool::inFiber() && !request->test()) {
+            WorkStealingThreadPool::yield();
+        }
         request->wait();
         delete request;
     } catch (...) {}
 }
+
+bool Comm::packable(int width) {
+    return Conf::ENABLE_TRANSFER_COMPRESSION && width > 0 && width < 64;
+}
+
+void Comm::packScalar(std::vector<uint8_t> &out, int64_t source, int width) {
+    out.assign(SimdSupport::packedBytes(1, width), 0);
+    SimdSupport::packBits(out.data(), &source, 1, width);
+}
+
+int64_t Comm::unpackScalar(const uint8_t *packed, int width) {
+    int64_t target;
+    SimdSupport::unpackBits(&target, packed, 1, width);
+    return target;
+}
+
+size_t Comm::packedVectorBytes(size_t count, int width) {
+    return sizeof(uint32_t) + SimdSupport::packedBytes(count, width);
+}
+
+void Comm::packVector(std::vector<uint8_t> &out, const std::vector<int64_t> &source, int width) {
+    auto count = static_cast<uint32_t>(source.size());
+    out.assign(packedVectorBytes(count, width), 0);
+    std::memcpy(out.data(), &count, sizeof(count));
+    SimdSupport::packBits(out.data() + sizeof(count), source.data(), count, width);
+}
+
+void Comm::unpackVector(std::vector<int64_t> &target, const uint8_t *packed, size_t bytes, int width) {
+    uint32_t count = 0;
+    if (bytes >= sizeof(count)) {
+        std::memcpy(&count, packed, sizeof(count));
+    }
+    if (bytes < packedVectorBytes(count, width)) {
+        throw std::runtime_error("Truncated packed vector.");
+    }
+    target.resize(count);
+    SimdSupport::unpackBits(target.data(), packed + sizeof(count), count, width);
+}
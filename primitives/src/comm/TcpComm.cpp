@@ -0,0 +1,439 @@
+#include "comm/TcpComm.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "conf/Conf.h"
+#include "utils/Log.h"
+
+namespace {
+    struct FrameHeader {
+        int32_t _tag;
+        uint32_t _length;
+    };
+
+    // Sent on every stream by finalize, after the last frame of this party
+    constexpr int32_t CLOSE_TAG = INT32_MIN;
+    constexpr int CONNECT_TIMEOUT_SECONDS = 60;
+
+    int launcherRank() {
+        for (const char *name: {"OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK"}) {
+            if (const char *value = std::getenv(name)) {
+                return std::atoi(value);
+            }
+        }
+        return -1;
+    }
+
+    std::vector<std::string> hostsOf(const std::string &list) {
+        std::vector<std::string> hosts;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+            hosts.push_back(list.substr(start, end - start));
+            start = end + 1;
+        }
+        if (hosts.size() == 1) {
+            hosts.resize(TcpComm::PARTIES, hosts[0]);
+        }
+        if (hosts.size() != TcpComm::PARTIES) {
+            throw std::runtime_error("tcp_hosts needs one host or one host per party.");
+        }
+        return hosts;
+    }
+
+    void setNoDelay(int fd) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    // Scatter/gather write of the whole iovec array. MSG_NOSIGNAL turns a closed peer into an
+    // error instead of SIGPIPE.
+    void writeFully(int fd, iovec *iov, int count) {
+        while (count > 0) {
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("TCP send failed: " + std::string(std::strerror(errno)));
+            }
+            auto left = static_cast<size_t>(n);
+            while (count > 0 && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+    }
+
+    bool readFully(int fd, void *buf, size_t length) {
+        auto *p = static_cast<char *>(buf);
+        while (length > 0) {
+            ssize_t n = recv(fd, p, length, 0);
+            if (n == 0) {
+                return false;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            p += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int listenOn(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create socket.");
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+            close(fd);
+            throw std::runtime_error("Failed to listen on port " + std::to_string(port) + ".");
+        }
+        return fd;
+    }
+
+    // Peers start in any order, so keep retrying until the listener is up
+    int connectTo(const std::string &host, int port) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(CONNECT_TIMEOUT_SECONDS);
+        while (true) {
+            addrinfo *result = nullptr;
+            if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) == 0) {
+                for (addrinfo *ai = result; ai != nullptr; ai = ai->ai_next) {
+                    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+                    if (fd < 0) {
+                        continue;
+                    }
+                    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+                        freeaddrinfo(result);
+                        return fd;
+                    }
+                    close(fd);
+                }
+                freeaddrinfo(result);
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("Failed to connect to " + host + ":" + std::to_string(port) + ".");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+void TcpComm::init_(int argc, char **argv) {
+    _rank = Conf::PARTY >= 0 ? Conf::PARTY : launcherRank();
+    if (_rank < 0 || _rank >= PARTIES) {
+        throw std::runtime_error("TCP comm needs --party=0, 1 or 2.");
+    }
+    auto hosts = hostsOf(Conf::TCP_HOSTS);
+    int streams = Conf::TCP_STREAMS > 0 ? Conf::TCP_STREAMS : 1;
+
+    _streams.resize(PARTIES);
+    _closed.assign(PARTIES, 0);
+    for (int peer = 0; peer < PARTIES; peer++) {
+        if (peer == _rank) {
+            continue;
+        }
+        for (int i = 0; i < streams; i++) {
+            _streams[peer].push_back(std::make_unique<Stream>());
+        }
+    }
+
+    // Lower ranks listen, higher ranks connect, and every connection opens with [rank][stream index]
+    int listener = _rank < PARTIES - 1 ? listenOn(Conf::TCP_PORT + _rank) : -1;
+    for (int peer = 0; peer < _rank; peer++) {
+        for (int i = 0; i < streams; i++) {
+            int fd = connectTo(hosts[peer], Conf::TCP_PORT + peer);
+            int32_t hello[2] = {_rank, i};
+            iovec iov{hello, sizeof(hello)};
+            writeFully(fd, &iov, 1);
+            setNoDelay(fd);
+            _streams[peer][i]->_fd = fd;
+        }
+    }
+    for (int accepted = 0; accepted < (PARTIES - 1 - _rank) * streams; accepted++) {
+        int fd = accept(listener, nullptr, nullptr);
+        int32_t hello[2];
+        if (fd < 0 || !readFully(fd, hello, sizeof(hello))) {
+            throw std::runtime_error("Failed to accept TCP peer.");
+        }
+        if (hello[0] <= _rank || hello[0] >= PARTIES || hello[1] < 0 || hello[1] >= streams
+            || _streams[hello[0]][hello[1]]->_fd >= 0) {
+            throw std::runtime_error("Unexpected TCP peer handshake.");
+        }
+        setNoDelay(fd);
+        _streams[hello[0]][hello[1]]->_fd = fd;
+    }
+    if (listener >= 0) {
+        close(listener);
+    }
+
+    for (int peer = 0; peer < PARTIES; peer++) {
+        for (auto &stream: _streams[peer]) {
+            int fd = stream->_fd;
+            _readers.emplace_back([this, peer, fd] { readLoop(peer, fd); });
+        }
+    }
+}
+
+void TcpComm::finalize_() {
+    // Acts as the barrier: nobody closes before every peer has sent its last frame
+    FrameHeader header{CLOSE_TAG, 0};
+    for (auto &peerStreams: _streams) {
+        for (auto &stream: peerStreams) {
+            iovec iov{&header, sizeof(header)};
+            std::lock_guard<std::mutex> lock(stream->_sendMutex);
+            try {
+                writeFully(stream->_fd, &iov, 1);
+            } catch (...) {}
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(_mailMutex);
+        _finished.wait(lock, [this] {
+            for (int peer = 0; peer < PARTIES; peer++) {
+                if (_closed[peer] < static_cast<int>(_streams[peer].size()) && !_lost) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+    for (auto &reader: _readers) {
+        reader.join();
+    }
+    for (auto &peerStreams: _streams) {
+        for (auto &stream: peerStreams) {
+            close(stream->_fd);
+        }
+    }
+}
+
+int TcpComm::rank_() {
+    return _rank;
+}
+
+bool TcpComm::isServer_() {
+    return _rank == 0 || _rank == 1;
+}
+
+bool TcpComm::isClient_() {
+    return !isServer_();
+}
+
+TcpComm::Stream &TcpComm::streamFor(int peer, int tag) {
+    if (peer < 0 || peer >= PARTIES || _streams[peer].empty()) {
+        throw std::runtime_error("No TCP stream to rank " + std::to_string(peer) + ".");
+    }
+    auto &streams = _streams[peer];
+    return *streams[static_cast<uint32_t>(tag) % streams.size()];
+}
+
+void TcpComm::sendFrame(int receiverRank, int tag, const void *data, size_t length) {
+    if (length > UINT32_MAX) {
+        throw std::runtime_error("TCP frame too large.");
+    }
+    FrameHeader header{tag, static_cast<uint32_t>(length)};
+    iovec iov[2] = {{&header, sizeof(header)}, {const_cast<void *>(data), length}};
+    Stream &stream = streamFor(receiverRank, tag);
+    std::lock_guard<std::mutex> lock(stream._sendMutex);
+    writeFully(stream._fd, iov, length > 0 ? 2 : 1);
+}
+
+void TcpComm::readLoop(int peer, int fd) {
+    while (true) {
+        FrameHeader header{};
+        if (!readFully(fd, &header, sizeof(header))) {
+            Log::e("TCP connection to rank {} lost.", peer);
+            fail();
+            return;
+        }
+        if (header._tag == CLOSE_TAG) {
+            std::lock_guard<std::mutex> lock(_mailMutex);
+            _closed[peer]++;
+            _finished.notify_all();
+            return;
+        }
+        std::string data(header._length, '\0');
+        if (!readFully(fd, data.data(), data.size())) {
+            Log::e("TCP connection to rank {} lost.", peer);
+            fail();
+            return;
+        }
+        deliver(peer, header._tag, std::move(data));
+    }
+}
+
+void TcpComm::deliver(int senderRank, int tag, std::string &&data) {
+    std::shared_ptr<TcpRequest::Slot> slot;
+    {
+        std::lock_guard<std::mutex> lock(_mailMutex);
+        auto it = _posted.find({senderRank, tag});
+        if (it == _posted.end()) {
+            _unexpected[{senderRank, tag}].push_back(std::move(data));
+            return;
+        }
+        slot = std::move(it->second.front());
+        it->second.pop_front();
+        if (it->second.empty()) {
+            _posted.erase(it);
+        }
+    }
+    std::lock_guard<std::mutex> lock(slot->_mutex);
+    slot->_data = std::move(data);
+    slot->_done = true;
+    slot->_cv.notify_all();
+}
+
+std::shared_ptr<TcpRequest::Slot> TcpComm::post(int senderRank, int tag) {
+    auto slot = std::make_shared<TcpRequest::Slot>();
+    std::lock_guard<std::mutex> lock(_mailMutex);
+    auto it = _unexpected.find({senderRank, tag});
+    if (it != _unexpected.end()) {
+        slot->_data = std::move(it->second.front());
+        slot->_done = true;
+        it->second.pop_front();
+        if (it->second.empty()) {
+            _unexpected.erase(it);
+        }
+    } else if (_lost) {
+        slot->_failed = true;
+        slot->_done = true;
+    } else {
+        _posted[{senderRank, tag}].push_back(slot);
+    }
+    return slot;
+}
+
+void TcpComm::fail() {
+    std::map<std::pair<int, int>, std::deque<std::shared_ptr<TcpRequest::Slot> > > posted;
+    {
+        std::lock_guard<std::mutex> lock(_mailMutex);
+        _lost = true;
+        posted.swap(_posted);
+        _finished.notify_all();
+    }
+    for (auto &[key, slots]: posted) {
+        for (auto &slot: slots) {
+            std::lock_guard<std::mutex> lock(slot->_mutex);
+            slot->_failed = true;
+            slot->_done = true;
+            slot->_cv.notify_all();
+        }
+    }
+}
+
+void TcpComm::send_(int64_t source, int width, int receiverRank, int tag) {
+    if (packable(width)) {
+        std::vector<uint8_t> packed;
+        packScalar(packed, source, width);
+        sendFrame(receiverRank, tag, packed.data(), packed.size());
+    } else {
+        sendFrame(receiverRank, tag, &source, sizeof(source));
+    }
+}
+
+void TcpComm::send_(const std::vector<int64_t> &source, int width, int receiverRank, int tag) {
+    if (packable(width)) {
+        std::vector<uint8_t> packed;
+        packVector(packed, source, width);
+        sendFrame(receiverRank, tag, packed.data(), packed.size());
+    } else {
+        sendFrame(receiverRank, tag, source.data(), source.size() * sizeof(int64_t));
+    }
+}
+
+void TcpComm::send_(const std::string &source, int receiverRank, int tag) {
+    sendFrame(receiverRank, tag, source.data(), source.size());
+}
+
+void TcpComm::receive_(int64_t &source, int width, int senderRank, int tag) {
+    std::unique_ptr<TcpRequest> request(receiveAsync_(source, width, senderRank, tag));
+    request->wait();
+}
+
+void TcpComm::receive_(std::vector<int64_t> &source, int width, int senderRank, int tag) {
+    std::unique_ptr<TcpRequest> request(receiveAsync_(source, 0, width, senderRank, tag));
+    request->wait();
+}
+
+void TcpComm::receive_(std::string &target, int senderRank, int tag) {
+    std::unique_ptr<TcpRequest> request(receiveAsync_(target, 0, senderRank, tag));
+    request->wait();
+}
+
+// The reader threads keep draining every socket, so a send only blocks until the kernel takes the
+// bytes and the request is already complete when it is returned.
+TcpRequest *TcpComm::sendAsync_(const std::vector<int64_t> &source, int width, int receiverRank, int tag) {
+    send_(source, width, receiverRank, tag);
+    return new TcpRequest();
+}
+
+TcpRequest *TcpComm::sendAsync_(const int64_t &source, int width, int receiverRank, int tag) {
+    send_(source, width, receiverRank, tag);
+    return new TcpRequest();
+}
+
+TcpRequest *TcpComm::sendAsync_(const std::string &source, int receiverRank, int tag) {
+    send_(source, receiverRank, tag);
+    return new TcpRequest();
+}
+
+TcpRequest *TcpComm::receiveAsync_(int64_t &target, int width, int senderRank, int tag) {
+    auto *request = new TcpRequest(post(senderRank, tag));
+    request->_mode = TcpRequest::SCALAR;
+    request->_width = width;
+    request->_targetInt = &target;
+    return request;
+}
+
+TcpRequest *TcpComm::receiveAsync_(std::vector<int64_t> &target, int count, int width, int senderRank, int tag) {
+    auto *request = new TcpRequest(post(senderRank, tag));
+    request->_mode = TcpRequest::VECTOR;
+    request->_width = width;
+    request->_targetIntVec = &target;
+    return request;
+}
+
+TcpRequest *TcpComm::receiveAsync_(std::string &target, int length, int senderRank, int tag) {
+    auto *request = new TcpRequest(post(senderRank, tag));
+    request->_mode = TcpRequest::STRING;
+    request->_targetStr = &target;
+    return request;
+}
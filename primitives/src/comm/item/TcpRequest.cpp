@@ -0,0 +1,64 @@
+#include "comm/item/TcpRequest.h"
+
+#include "comm/Comm.h"
+#include "parallel/WorkStealingThreadPool.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+TcpRequest::TcpRequest(std::shared_ptr<Slot> slot) : _slot(std::move(slot)) {
+}
+
+void TcpRequest::wait() {
+    if (_completed) {
+        return;
+    }
+    if (_slot != nullptr) {
+        if (WorkStealingThreadPool::inFiber()) {
+            while (!_slot->_done) {
+                WorkStealingThreadPool::yield();
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(_slot->_mutex);
+            _slot->_cv.wait(lock, [this] { return _slot->_done.load(); });
+        }
+    }
+    complete();
+}
+
+bool TcpRequest::test() {
+    if (!_completed && (_slot == nullptr || _slot->_done)) {
+        complete();
+    }
+    return _completed;
+}
+
+void TcpRequest::complete() {
+    _completed = true;
+    if (_slot == nullptr || _mode == NO_CALLBACK) {
+        return;
+    }
+    if (_slot->_failed) {
+        throw std::runtime_error("TCP connection lost.");
+    }
+
+    const std::string &data = _slot->_data;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    if (_mode == STRING) {
+        *_targetStr = std::move(_slot->_data);
+    } else if (_mode == SCALAR) {
+        if (Comm::packable(_width)) {
+            *_targetInt = Comm::unpackScalar(bytes, _width);
+        } else if (data.size() == sizeof(int64_t)) {
+            std::memcpy(_targetInt, bytes, sizeof(int64_t));
+        } else {
+            throw std::runtime_error("Unexpected scalar frame size.");
+        }
+    } else if (Comm::packable(_width)) {
+        Comm::unpackVector(*_targetIntVec, bytes, data.size(), _width);
+    } else {
+        _targetIntVec->resize(data.size() / sizeof(int64_t));
+        std::memcpy(_targetIntVec->data(), bytes, _targetIntVec->size() * sizeof(int64_t));
+    }
+}
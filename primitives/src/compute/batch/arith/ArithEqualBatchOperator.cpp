@@ -20,8 +20,8 @@ ArithEqualBatchOperator *ArithEqualBatchOperator::execute() {
         return this;
     }
 
-    if (Conf::BMT_METHOD != Conf::BMT_JIT) {
-        throw std::runtime_error("Temporarily only support BMT JIT generation for experiment.");
+    if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
+        throw std::runtime_error("Fixed BMTs are not supported by arithmetic batch operators.");
     }
 
     int64_t start;
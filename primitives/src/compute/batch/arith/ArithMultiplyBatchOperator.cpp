@@ -21,14 +21,20 @@ ArithMultiplyBatchOperator *ArithMultiplyBatchOperator::execute() {
         return this;
     }
 
-    if (Conf::BMT_METHOD != Conf::BMT_JIT) {
-        throw std::runtime_error("Temporarily only support BMT JIT generation for experiment.");
+    if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
+        throw std::runtime_error("Fixed BMTs are not supported by arithmetic batch operators.");
     }
 
     int num = static_cast<int>(_xis->size());
     _zis.resize(num);
 
-    std::vector<Bmt> bmts = BmtBatchGenerator(num, _width, _taskTag, _currentMsgTag).execute()->_bmts;
+    // The arithmetic queues only exist when arithmetic is enabled, otherwise the triples are made here
+    std::vector<Bmt> bmts;
+    if ((Conf::BMT_METHOD == Conf::BMT_BACKGROUND || Conf::BMT_METHOD == Conf::BMT_PIPELINE) && !Conf::DISABLE_ARITH) {
+        bmts = IntermediateDataSupport::pollBmts(num, _width, buildTag(_currentMsgTag));
+    } else {
+        bmts = BmtBatchGenerator(num, _width, _taskTag, _currentMsgTag).execute()->_bmts;
+    }
 
     std::vector<int64_t> eis(num), fis(num);
     for (int i = 0; i < num; i++) {
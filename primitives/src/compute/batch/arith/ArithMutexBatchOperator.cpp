@@ -17,7 +17,7 @@ ArithMutexBatchOperator::ArithMutexBatchOperator(std::vector<int64_t> *xs, std::
                                                  int msgTagOffset, int clientRank)
     : ArithBatchOperator(xs, ys, width, taskTag, msgTagOffset, clientRank) {
     if (clientRank < 0 && _width > 1) {
-        _conds_i = BoolToArithBatchOperator(conds, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).execute()->_zis;
+        _conds_i = BoolToArithBatchOperator(conds, 1, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).execute()->_zis;
     } else {
         _conds_i = ArithBatchOperator(*conds, _width, _taskTag, _currentMsgTag, clientRank)._zis;
     }
@@ -12,6 +12,7 @@
 #include "parallel/ThreadPoolSupport.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
+#include "utils/Crypto.h"
 #include "utils/System.h"
 
 ArithToBoolBatchOperator::ArithToBoolBatchOperator(std::vector<int64_t> *xs, int width, int taskTag, int msgTagOffset,
@@ -32,10 +33,6 @@ ArithToBoolBatchOperator *ArithToBoolBatchOperator::execute() {
         return this;
     }
 
-    if (Conf::BMT_METHOD != Conf::BMT_JIT) {
-        throw std::runtime_error("Temporarily only support BMT JIT generation for experiment.");
-    }
-
     int64_t start;
     if (Conf::ENABLE_CLASS_WISE_TIMING) {
         start = System::currentTimeMillis();
@@ -43,100 +40,68 @@ ArithToBoolBatchOperator *ArithToBoolBatchOperator::execute() {
 
     int num = static_cast<int>(_xis->size());
     _zis.resize(num, 0);
+    if (num == 0) {
+        return this;
+    }
 
-    std::vector<int64_t> xi_i_vec(num), xi_o_vec(num);
+    // Boolean-share both arithmetic shares in one exchange: each party keeps a random mask and
+    // hands the masked value to the other, so a = x0 and b = x1 are each XOR-shared.
+    std::vector<int64_t> self_i(num), self_o(num), other_o;
+    Crypto::randomFill(self_i.data(), num);
     for (int i = 0; i < num; i++) {
-        xi_i_vec[i] = Math::randInt();
-        xi_o_vec[i] = xi_i_vec[i] ^ (*_xis)[i];
+        self_i[i] = ring(self_i[i]);
+        self_o[i] = self_i[i] ^ ring((*_xis)[i]);
     }
+    auto r0 = Comm::serverSendAsync(self_o, _width, buildTag(_currentMsgTag));
+    auto r1 = Comm::serverReceiveAsync(other_o, num, _width, buildTag(_currentMsgTag));
+    Comm::wait(r0);
+    Comm::wait(r1);
 
-    std::vector<bool> carry_i_vec(num, false);
-
-    for (int bitPos = 0; bitPos < _width; bitPos++) {
-        std::vector<bool> ai_vec(num), ao_vec(num), bi_vec(num), bo_vec(num);
+    std::vector<int64_t> &a = Comm::rank() == 0 ? self_i : other_o;
+    std::vector<int64_t> &b = Comm::rank() == 0 ? other_o : self_i;
 
+    // Kogge-Stone prefix over (generate, propagate) pairs
+    std::vector<int64_t> p0(num);
+    for (int i = 0; i < num; i++) {
+        p0[i] = a[i] ^ b[i];
+    }
+    auto g = BoolAndBatchOperator(&a, &b, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).execute()->_zis;
+    std::vector<int64_t> p = p0;
+
+    for (int d = 1; d < _width; d <<= 1) {
+        // Group span doubles each round. P is not needed after the last one.
+        bool lastRound = d << 1 >= _width;
+        int batch = lastRound ? num : num * 2;
+        std::vector<int64_t> lhs(batch), rhs(batch);
         for (int i = 0; i < num; i++) {
-            if (Comm::rank() == 0) {
-                ai_vec[i] = (xi_i_vec[i] >> bitPos) & 1;
-                ao_vec[i] = (xi_o_vec[i] >> bitPos) & 1;
-            } else {
-                bi_vec[i] = (xi_i_vec[i] >> bitPos) & 1;
-                bo_vec[i] = (xi_o_vec[i] >> bitPos) & 1;
-            }
-        }
-
-        std::vector<int64_t> self_ov(num), other_iv(num);
-        for (int i = 0; i < num; i++) {
-            if (Comm::rank() == 0) {
-                self_ov[i] = static_cast<int64_t>(ao_vec[i]);
-            } else {
-                self_ov[i] = static_cast<int64_t>(bo_vec[i]);
-            }
+            lhs[i] = p[i];
+            rhs[i] = ring(g[i] << d);
         }
-
-        auto r0 = Comm::serverSendAsync(self_ov, _width, buildTag(_currentMsgTag));
-        auto r1 = Comm::serverReceiveAsync(other_iv, num, _width, buildTag(_currentMsgTag));
-        Comm::wait(r0);
-        Comm::wait(r1);
-
-        for (int i = 0; i < num; i++) {
-            if (Comm::rank() == 0) {
-                bi_vec[i] = other_iv[i];
-            } else {
-                ai_vec[i] = other_iv[i];
+        if (!lastRound) {
+            for (int i = 0; i < num; i++) {
+                lhs[num + i] = p[i];
+                rhs[num + i] = ring(p[i] << d);
             }
         }
 
+        auto z = BoolAndBatchOperator(&lhs, &rhs, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
+                .execute()->_zis;
+        // G and P of one group are never both set, so OR is XOR
         for (int i = 0; i < num; i++) {
-            _zis[i] += static_cast<int64_t>((ai_vec[i] ^ bi_vec[i]) ^ carry_i_vec[i]) << bitPos;
+            g[i] ^= z[i];
         }
-
-        if (bitPos < _width - 1) {
-            std::vector<bool> propagate_i_vec(num), generate_i_vec(num), tempCarry_i_vec(num);
-
+        if (!lastRound) {
             for (int i = 0; i < num; i++) {
-                propagate_i_vec[i] = ai_vec[i] ^ bi_vec[i];
-            }
-
-            std::vector<int64_t> ai_int(num), bi_int(num);
-            for (int i = 0; i < num; i++) {
-                ai_int[i] = static_cast<int64_t>(ai_vec[i]);
-                bi_int[i] = static_cast<int64_t>(bi_vec[i]);
-            }
-
-            BoolAndBatchOperator generateOp(&ai_int, &bi_int, 1, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE);
-            generateOp.execute();
-
-            std::vector<int64_t> propagate_int(num), carry_int(num);
-            for (int i = 0; i < num; i++) {
-                propagate_int[i] = static_cast<int64_t>(propagate_i_vec[i]);
-                carry_int[i] = static_cast<int64_t>(carry_i_vec[i]);
-            }
-
-            BoolAndBatchOperator propagateOp(&propagate_int, &carry_int, 1, _taskTag, _currentMsgTag,
-                                             NO_CLIENT_COMPUTE);
-            propagateOp.execute();
-
-            std::vector<int64_t> generate_results = generateOp._zis;
-            std::vector<int64_t> tempCarry_results = propagateOp._zis;
-            std::vector<int64_t> sum_int(num);
-
-            for (int i = 0; i < num; i++) {
-                generate_i_vec[i] = generate_results[i];
-                tempCarry_i_vec[i] = tempCarry_results[i];
-                sum_int[i] = generate_results[i] ^ tempCarry_results[i];
-            }
-
-            BoolAndBatchOperator finalOp(&generate_results, &tempCarry_results, 1, _taskTag, _currentMsgTag,
-                                         NO_CLIENT_COMPUTE);
-            finalOp.execute();
-
-            for (int i = 0; i < num; i++) {
-                carry_i_vec[i] = sum_int[i] ^ finalOp._zis[i];
+                p[i] = z[num + i];
             }
         }
     }
 
+    // g now holds the carry out of every prefix, so bit j of the sum is p0_j ^ carry_{j-1}
+    for (int i = 0; i < num; i++) {
+        _zis[i] = p0[i] ^ (g[i] << 1);
+    }
+
     for (int i = 0; i < num; i++) {
         _zis[i] = ring(_zis[i]);
     }
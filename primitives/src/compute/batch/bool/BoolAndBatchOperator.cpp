@@ -5,7 +5,9 @@
 #include "conf/Conf.h"
 #include "intermediate/BitwiseBmtBatchGenerator.h"
 #include "intermediate/BitwiseBmtGenerator.h"
+#include "intermediate/BmtDealer.h"
 #include "intermediate/IntermediateDataSupport.h"
+#include "intermediate/PreprocessingStore.h"
 #include "utils/Log.h"
 #include <mpi.h>
 
@@ -22,11 +24,19 @@ int BoolAndBatchOperator::prepareBmts(std::vector<BitwiseBmt> &bmts) {
     }
     if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND || Conf::BMT_METHOD == Conf::BMT_PIPELINE) {
         if (bc == -1) {
-            bmts = IntermediateDataSupport::pollBitwiseBmts(1, totalBits);
+            bmts = IntermediateDataSupport::pollBitwiseBmts(1, totalBits, buildTag(_currentMsgTag));
         } else {
-            bmts = IntermediateDataSupport::pollBitwiseBmts(bc, 64);
+            bmts = IntermediateDataSupport::pollBitwiseBmts(bc, 64, buildTag(_currentMsgTag));
+        }
+    } else if (Conf::BMT_METHOD == Conf::BMT_DEALER) {
+        bmts = BmtDealer::takeBitwiseBmts(bc == -1 ? 1 : bc, bc == -1 ? static_cast<int>(totalBits) : 64,
+                                          buildTag(_currentMsgTag));
+    } else if (Conf::BMT_METHOD == Conf::BMT_JIT || Conf::BMT_METHOD == Conf::BMT_OFFLINE) {
+        if (Conf::BMT_METHOD == Conf::BMT_OFFLINE &&
+            PreprocessingStore::takeBitwiseBmts(bc == -1 ? 1 : bc, bc == -1 ? static_cast<int>(totalBits) : 64, bmts,
+                                                buildTag(_currentMsgTag))) {
+            return bc;
         }
-    } else if (Conf::BMT_METHOD == Conf::BMT_JIT) {
         if (bc == -1) {
             bmts = BitwiseBmtBatchGenerator(1, totalBits, _taskTag, _currentMsgTag).execute()->_bmts;
         } else {
@@ -56,11 +66,15 @@ BoolAndBatchOperator *BoolAndBatchOperator::execute() {
         start = System::currentTimeMillis();
     }
 
-    if (_doWithConditions) {
-        executeForMutex();
-    } else {
-        execute0();
-    }
+    prepare();
+
+    std::vector<int64_t> efo;
+    auto r0 = Comm::serverSendAsync(_efi, _width, buildTag(_currentMsgTag));
+    auto r1 = Comm::serverReceiveAsync(efo, static_cast<int>(_efi.size()), _width, buildTag(_currentMsgTag));
+    Comm::wait(r0);
+    Comm::wait(r1);
+
+    finish(efo.data());
 
     if (Conf::ENABLE_CLASS_WISE_TIMING) {
         _totalTime += System::currentTimeMillis() - start;
@@ -85,12 +99,30 @@ int BoolAndBatchOperator::bmtCount(int num, int width) {
     return (num * width + 63) / 64;
 }
 
-void BoolAndBatchOperator::execute0() {
-    std::vector<BitwiseBmt> bmts;
-    int bc = prepareBmts(bmts);
+BoolAndBatchOperator *BoolAndBatchOperator::prepare() {
+    if (_doWithConditions) {
+        prepareForMutex();
+    } else {
+        prepare0();
+    }
+    return this;
+}
+
+const std::vector<int64_t> &BoolAndBatchOperator::openings() const {
+    return _efi;
+}
+
+int BoolAndBatchOperator::openingTag() const {
+    return buildTag(_currentMsgTag);
+}
+
+void BoolAndBatchOperator::prepare0() {
+    _bc = prepareBmts(_heldBmts);
+    auto &bmts = _heldBmts;
     int num = static_cast<int>(_xis->size());
 
-    std::vector<int64_t> efi(num * 2);
+    _efi.resize(num * 2);
+    auto &efi = _efi;
 
     if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
         for (int i = 0; i < num; i++) {
@@ -111,68 +143,18 @@ void BoolAndBatchOperator::execute0() {
             }
         }
     }
-
-    std::vector<int64_t> efo;
-    auto r0 = Comm::serverSendAsync(efi, _width, buildTag(_currentMsgTag));
-    auto r1 = Comm::serverReceiveAsync(efo, efi.size(), _width, buildTag(_currentMsgTag));
-    Comm::wait(r0);
-    Comm::wait(r1);
-
-    std::vector<int64_t> efs;
-
-    if (Conf::ENABLE_SIMD) {
-        efs = SimdSupport::xorV(efi, efo);
-    } else {
-        efs = std::vector<int64_t>(num * 2);
-        for (int i = 0; i < num * 2; i++) {
-            efs[i] = efi[i] ^ efo[i];
-        }
-    }
-
-    _zis.resize(num);
-    int64_t extendedRank = Comm::rank() ? ring(-1ll) : 0;
-
-    if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
-        for (int i = 0; i < num; i++) {
-            int64_t e = efs[i];
-            int64_t f = efs[num + i];
-            _zis[i] = Math::ring((extendedRank & e & f) ^ (
-                                     f & IntermediateDataSupport::_fixedBitwiseBmt._a) ^ (
-                                     e & IntermediateDataSupport::_fixedBitwiseBmt._b) ^
-                                 IntermediateDataSupport::_fixedBitwiseBmt._c, _width);
-        }
-    } else {
-        if (_width < 64 && bc != -2) {
-            for (int i = 0; i < num; i++) {
-                int64_t e = efs[i];
-                int64_t f = efs[num + i];
-                auto bmt = BitwiseBmt::extract(bmts, i, _width);
-
-                _zis[i] = Math::ring((extendedRank & e & f) ^ (f & bmt._a) ^ (e & bmt._b) ^ bmt._c, _width);
-            }
-        } else {
-            for (int i = 0; i < num; i++) {
-                int64_t e = efs[i];
-                int64_t f = efs[num + i];
-                auto bmt = bmts[i];
-                int64_t a = bmt._a;
-                int64_t b = bmt._b;
-                int64_t c = bmt._c;
-                _zis[i] = Math::ring((extendedRank & e & f) ^ (f & a) ^ (e & b) ^ c, _width);
-            }
-        }
-    }
 }
 
-void BoolAndBatchOperator::executeForMutex() {
-    std::vector<BitwiseBmt> bmts;
+void BoolAndBatchOperator::prepareForMutex() {
+    auto &bmts = _heldBmts;
     auto num = _xis->size();
     auto condNum = _conds_i->size();
-    int bc;
 
-    std::vector<int64_t> efi(num * 4);
+    _efi.resize(num * 4);
+    auto &efi = _efi;
 
     if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
+        _bc = -1;
         for (int i = 0; i < num; i++) {
             efi[i] = (*_xis)[i] ^ IntermediateDataSupport::_fixedBitwiseBmt._a;
             efi[num + i] = (*_yis)[i] ^ IntermediateDataSupport::_fixedBitwiseBmt._a;
@@ -182,8 +164,8 @@ void BoolAndBatchOperator::executeForMutex() {
             efi[3 * num + i] = fi;
         }
     } else {
-        bc = prepareBmts(bmts);
-        if (_width < 64 && bc != -2) {
+        _bc = prepareBmts(bmts);
+        if (_width < 64 && _bc != -2) {
             for (int i = 0; i < num; i++) {
                 auto bmt = BitwiseBmt::extract(bmts, i, _width);
                 efi[i] = (*_xis)[i] ^ bmt._a;
@@ -205,50 +187,52 @@ void BoolAndBatchOperator::executeForMutex() {
             }
         }
     }
+}
 
-    std::vector<int64_t> efo;
-    auto r0 = Comm::serverSendAsync(efi, _width, buildTag(_currentMsgTag));
-    auto r1 = Comm::serverReceiveAsync(efo, efi.size(), _width, buildTag(_currentMsgTag));
-    Comm::wait(r0);
-    Comm::wait(r1);
-
-    std::vector<int64_t> efs;
+void BoolAndBatchOperator::finish(const int64_t *efo) {
+    // Both layouts hold all e values first and the matching f values after them
+    size_t num = _efi.size() / 2;
+    auto &bmts = _heldBmts;
 
+    std::vector<int64_t> efs(num * 2);
     if (Conf::ENABLE_SIMD) {
-        efs = SimdSupport::xorV(efi, efo);
+        SimdSupport::xorV(efs.data(), _efi.data(), efo, num * 2);
     } else {
-        efs = std::vector<int64_t>(num * 4);
-        for (int i = 0; i < num * 4; i++) {
-            efs[i] = efi[i] ^ efo[i];
+        for (size_t i = 0; i < num * 2; i++) {
+            efs[i] = _efi[i] ^ efo[i];
         }
     }
 
-    _zis.resize(num * 2);
+    _zis.resize(num);
     int64_t extendedRank = Comm::rank() ? ring(-1ll) : 0;
 
     if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
-        for (int i = 0; i < num * 2; i++) {
+        for (size_t i = 0; i < num; i++) {
             int64_t e = efs[i];
-            int64_t f = efs[num * 2 + i];
+            int64_t f = efs[num + i];
             _zis[i] = Math::ring((extendedRank & e & f) ^ (
                                      f & IntermediateDataSupport::_fixedBitwiseBmt._a) ^ (
                                      e & IntermediateDataSupport::_fixedBitwiseBmt._b) ^
                                  IntermediateDataSupport::_fixedBitwiseBmt._c, _width);
         }
     } else {
-        if (_width < 64 && bc != -2) {
-            for (int i = 0; i < num * 2; i++) {
+        if (_width < 64 && _bc != -2) {
+            for (size_t i = 0; i < num; i++) {
                 int64_t e = efs[i];
-                int64_t f = efs[num * 2 + i];
-                auto bmt = BitwiseBmt::extract(bmts, i, _width);
+                int64_t f = efs[num + i];
+                auto bmt = BitwiseBmt::extract(bmts, static_cast<int>(i), _width);
                 _zis[i] = Math::ring((extendedRank & e & f) ^ (f & bmt._a) ^ (e & bmt._b) ^ bmt._c, _width);
             }
         } else {
-            for (int i = 0; i < num * 2; i++) {
+            for (size_t i = 0; i < num; i++) {
                 int64_t e = efs[i];
-                int64_t f = efs[num * 2 + i];
-                _zis[i] = Math::ring((extendedRank & e & f) ^ (f & bmts[i]._a) ^ (e & bmts[i]._b) ^ bmts[i]._c, _width);
+                int64_t f = efs[num + i];
+                _zis[i] = Math::ring((extendedRank & e & f) ^ (f & bmts[i]._a) ^ (e & bmts[i]._b) ^ bmts[i]._c,
+                                     _width);
             }
         }
     }
+
+    _heldBmts.clear();
+    _efi.clear();
 }
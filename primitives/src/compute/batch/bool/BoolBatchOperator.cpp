@@ -12,22 +12,9 @@ BoolBatchOperator::BoolBatchOperator(std::vector<int64_t> &zs, int width, int ta
         _zis = zs;
     } else {
         if (Comm::rank() == clientRank) {
-            std::vector<int64_t> zv0, zv1;
-            zv0.reserve(zs.size());
-            zv1.reserve(zs.size());
-            for (auto z: zs) {
-                int64_t z1 = ring(Math::randInt());
-                int64_t z0 = ring(z ^ z1);
-                zv0.push_back(z0);
-                zv1.push_back(z1);
-            }
-            auto r = Comm::sendAsync(zv0, _width, 0, buildTag(_currentMsgTag));
-            auto r1 = Comm::sendAsync(zv1, _width, 1, buildTag(_currentMsgTag));
-            Comm::wait(r);
-            Comm::wait(r1);
+            sendSeededShares(zs, true, clientRank);
         } else if (Comm::isServer()) {
-            _zis.clear();
-            Comm::receive(_zis, _width, clientRank, buildTag(_currentMsgTag));
+            _zis = receiveSeededShares(clientRank);
         }
     }
 }
@@ -40,30 +27,11 @@ BoolBatchOperator::BoolBatchOperator(std::vector<int64_t> *xs, std::vector<int64
         _yis = ys;
     } else {
         if (Comm::rank() == clientRank) {
-            std::vector<int64_t> v0, v1;
-            size_t size = xs->size();
-            v0.reserve(2 * size);
-            v1.reserve(2 * size);
-
-            for (auto x: *xs) {
-                int64_t x1 = ring(Math::randInt());
-                int64_t x0 = ring(x ^ x1);
-                v0.push_back(x0);
-                v1.push_back(x1);
-            }
-            for (auto y: *ys) {
-                int64_t y1 = ring(Math::randInt());
-                int64_t y0 = ring(y ^ y1);
-                v0.push_back(y0);
-                v1.push_back(y1);
-            }
-            auto r = Comm::sendAsync(v0, _width, 0, buildTag(_currentMsgTag));
-            auto r1 = Comm::sendAsync(v1, _width, 1, buildTag(_currentMsgTag));
-            Comm::wait(r);
-            Comm::wait(r1);
+            std::vector<int64_t> values = *xs;
+            values.insert(values.end(), ys->begin(), ys->end());
+            sendSeededShares(values, true, clientRank);
         } else if (Comm::isServer()) {
-            std::vector<int64_t> temp;
-            Comm::receive(temp, _width, clientRank, buildTag(_currentMsgTag));
+            std::vector<int64_t> temp = receiveSeededShares(clientRank);
             size_t size = temp.size() / 2;
             _xis = new std::vector<int64_t>(size);
             _yis = new std::vector<int64_t>(size);
@@ -1,55 +1,120 @@
 #include "../../../../include/compute/batch/bool/BoolEqualBatchOperator.h"
 
 #include "compute/batch/bool/BoolAndBatchOperator.h"
-#include "compute/batch/bool/BoolLessBatchOperator.h"
-#include "compute/batch/bool/BoolXorBatchOperator.h"
+#include "conf/Conf.h"
 
 BoolEqualBatchOperator *BoolEqualBatchOperator::execute() {
+    _currentMsgTag = _startMsgTag;
     if (Comm::isClient()) {
         return this;
     }
 
-    std::vector<BitwiseBmt> allBmts;
-    bool gotBmt = prepareBmts(allBmts);
+    int64_t start;
+    if (Conf::ENABLE_CLASS_WISE_TIMING) {
+        start = System::currentTimeMillis();
+    }
+
+    _started = false;
+    BoolRoundFusion::run({this});
 
-    const int lessBmtCount = BoolLessBatchOperator::bmtCount(_xis->size(), _width);
-    std::vector<BitwiseBmt> bmtsLessXy;
-    std::vector<BitwiseBmt> bmtsLessYx;
-    if (gotBmt) {
-        bmtsLessYx = std::vector(allBmts.end() - lessBmtCount, allBmts.end());
-        allBmts.resize(allBmts.size() - lessBmtCount);
-        bmtsLessXy = std::vector(allBmts.end() - lessBmtCount, allBmts.end());
-        allBmts.resize(allBmts.size() - lessBmtCount);
+    if (Conf::ENABLE_CLASS_WISE_TIMING) {
+        _totalTime += System::currentTimeMillis() - start;
     }
+    return this;
+}
 
-    auto gtv = BoolLessBatchOperator(_xis, _yis, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
-            .setBmts(gotBmt ? &bmtsLessXy : nullptr)->execute()->_zis;
-    auto ltv = BoolLessBatchOperator(_yis, _xis, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
-            .setBmts(gotBmt ? &bmtsLessYx : nullptr)->execute()->_zis;
+bool BoolEqualBatchOperator::addRound(BoolRoundFusion &fusion) {
+    int num = static_cast<int>(_xis->size());
+    if (!_started) {
+        _started = true;
+        _gotBmt = prepareBmts(_allBmts);
 
-    for (auto &v: gtv) {
-        v = v ^ Comm::rank();
+        // XNOR locally: bit j of eq is a share of (x_j == y_j)
+        int64_t mask = Comm::rank() == 0 ? 0 : ring(-1ll);
+        _eq.resize(num);
+        for (int i = 0; i < num; i++) {
+            _eq[i] = (*_xis)[i] ^ (*_yis)[i] ^ mask;
+        }
+        _live = _width;
+        if (_live <= 1) {
+            collect();
+        }
     }
-    for (auto &v: ltv) {
-        v = v ^ Comm::rank();
+    if (_live <= 1) {
+        return false;
     }
 
-    _zis = BoolAndBatchOperator(&gtv, &ltv, 1, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
-            .setBmts(gotBmt ? &allBmts : nullptr)->execute()->_zis;
-    return this;
+    // AND-tree: fold the upper half of the live bits onto the lower half until one bit is left.
+    // An odd top bit is carried to the next level untouched.
+    int half = _live / 2;
+    int64_t halfMask = (1ll << half) - 1;
+    std::vector<int64_t> lo(num), hi(num);
+    for (int i = 0; i < num; i++) {
+        lo[i] = _eq[i] & halfMask;
+        hi[i] = (_eq[i] >> half) & halfMask;
+    }
+
+    std::vector<BitwiseBmt> bmts;
+    if (_gotBmt) {
+        int bc = BoolAndBatchOperator::bmtCount(num, half);
+        bmts = std::vector(_allBmts.end() - bc, _allBmts.end());
+        _allBmts.resize(_allBmts.size() - bc);
+    }
+    _foldAnd = std::make_unique<BoolAndBatchOperator>(&lo, &hi, half, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE);
+    _foldAnd->setBmts(_gotBmt ? &bmts : nullptr);
+    fusion.add(_foldAnd.get());
+    return true;
+}
+
+void BoolEqualBatchOperator::endRound() {
+    int half = _live / 2;
+    auto &folded = _foldAnd->_zis;
+    for (int i = 0; i < _eq.size(); i++) {
+        _eq[i] = (_live & 1) ? folded[i] | (static_cast<int64_t>(Math::getBit(_eq[i], _live - 1)) << half) : folded[i];
+    }
+    _foldAnd.reset();
+
+    _live = (_live + 1) / 2;
+    if (_live <= 1) {
+        collect();
+    }
+}
+
+void BoolEqualBatchOperator::collect() {
+    _zis.resize(_eq.size());
+    for (int i = 0; i < _eq.size(); i++) {
+        _zis[i] = _eq[i] & 1;
+    }
+    _eq.clear();
+    _allBmts.clear();
 }
 
 BoolEqualBatchOperator *BoolEqualBatchOperator::setBmts(std::vector<BitwiseBmt> *bmts) {
+    if (bmts == nullptr) {
+        return this;
+    }
+    if (bmts->size() != bmtCount(_xis->size(), _width)) {
+        throw std::runtime_error(
+            "Invalid BMT size for BoolEqualBatchOperator. Given: " + std::to_string(bmts->size()) + ", expected: " +
+            std::to_string(bmtCount(_xis->size(), _width)) + ".");
+    }
     this->_bmts = bmts;
     return this;
 }
 
 int BoolEqualBatchOperator::tagStride() {
-    return std::max(BoolLessBatchOperator::tagStride(), BoolAndBatchOperator::tagStride());
+    return BoolAndBatchOperator::tagStride();
 }
 
 int BoolEqualBatchOperator::bmtCount(int num, int width) {
-    return 2 * BoolLessBatchOperator::bmtCount(num, width) + BoolAndBatchOperator::bmtCount(num, width);
+    if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
+        return 0;
+    }
+    int count = 0;
+    for (int live = width; live > 1; live = (live + 1) / 2) {
+        count += BoolAndBatchOperator::bmtCount(num, live / 2);
+    }
+    return count;
 }
 
 bool BoolEqualBatchOperator::prepareBmts(std::vector<BitwiseBmt> &bmts) {
@@ -21,90 +21,122 @@ BoolLessBatchOperator *BoolLessBatchOperator::execute() {
         start = System::currentTimeMillis();
     }
 
-    std::vector<BitwiseBmt> allBmts;
-    bool gotBmt = prepareBmts(allBmts);
+    _round = 0;
+    BoolRoundFusion::run({this});
 
-    std::vector<int64_t> x_xor_y, lbs;
-    int64_t mask = Math::ring(-1ll, _width);
-
-    x_xor_y.resize(_xis->size());
-    for (int i = 0; i < _xis->size(); i++) {
-        x_xor_y[i] = (*_xis)[i] ^ (*_yis)[i];
-    }
-    if (Comm::rank() == 0) {
-        lbs = x_xor_y;
-    } else {
-        lbs.reserve(x_xor_y.size());
-        for (int64_t e: x_xor_y) {
-            lbs.push_back(e ^ mask);
-        }
+    if (Conf::ENABLE_CLASS_WISE_TIMING) {
+        _totalTime += System::currentTimeMillis() - start;
     }
 
-    auto shifted_1 = shiftGreater(lbs, 1);
+    return this;
+}
+
+// Round 0 runs lbs & shifted_1 and diag & x together, rounds 1 .. finalRound() - 1 combine lbs with
+// shiftGreater(lbs, round + 1), and the final round ANDs the shifted prefix with diag.
+int BoolLessBatchOperator::finalRound() const {
+    return std::max(static_cast<int>(std::ceil(std::log2(_width))), 1);
+}
 
+std::vector<BitwiseBmt> BoolLessBatchOperator::takeBmts() {
     std::vector<BitwiseBmt> bmts;
-    int bmtCount = BoolAndBatchOperator::bmtCount(_xis->size(), _width);
-    if (gotBmt) {
-        bmts = std::vector(allBmts.end() - bmtCount, allBmts.end());
-        allBmts.resize(allBmts.size() - bmtCount);
+    if (_gotBmt) {
+        int bmtCount = BoolAndBatchOperator::bmtCount(_xis->size(), _width);
+        bmts = std::vector(_allBmts.end() - bmtCount, _allBmts.end());
+        _allBmts.resize(_allBmts.size() - bmtCount);
     }
-    lbs = BoolAndBatchOperator(&lbs, &shifted_1, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
-            .setBmts(gotBmt ? &bmts : nullptr)->execute()->_zis;
-
-    std::vector<int64_t> diag;
+    return bmts;
+}
 
-    if (Conf::ENABLE_SIMD) {
-        diag = SimdSupport::computeDiag(*_yis, x_xor_y);
-    } else {
-        diag.resize(x_xor_y.size());
-        for (int i = 0; i < x_xor_y.size(); i++) {
-            diag[i] = Math::changeBit(x_xor_y[i], 0, Math::getBit((*_yis)[i], 0) ^ Comm::rank());
-        }
+bool BoolLessBatchOperator::addRound(BoolRoundFusion &fusion) {
+    if (_round > finalRound()) {
+        return false;
     }
 
-    if (gotBmt) {
-        bmts = std::vector(allBmts.end() - bmtCount, allBmts.end());
-        allBmts.resize(allBmts.size() - bmtCount);
-    }
-    diag = BoolAndBatchOperator(&diag, _xis, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).setBmts(
-        gotBmt ? &bmts : nullptr)->execute()->_zis;
+    if (_round == 0) {
+        _gotBmt = prepareBmts(_allBmts);
 
-    int rounds = static_cast<int>(std::floor(std::log2(_width)));
-    for (int r = 2; r <= rounds; r++) {
-        auto shifted_r = shiftGreater(lbs, r);
+        std::vector<int64_t> x_xor_y;
+        int64_t mask = Math::ring(-1ll, _width);
 
-        if (gotBmt) {
-            bmts = std::vector(allBmts.end() - bmtCount, allBmts.end());
-            allBmts.resize(allBmts.size() - bmtCount);
+        x_xor_y.resize(_xis->size());
+        for (int i = 0; i < _xis->size(); i++) {
+            x_xor_y[i] = (*_xis)[i] ^ (*_yis)[i];
+        }
+        if (Comm::rank() == 0) {
+            _lbs = x_xor_y;
+        } else {
+            _lbs.clear();
+            _lbs.reserve(x_xor_y.size());
+            for (int64_t e: x_xor_y) {
+                _lbs.push_back(e ^ mask);
+            }
         }
-        lbs = BoolAndBatchOperator(&lbs, &shifted_r, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).
-                setBmts(gotBmt ? &bmts : nullptr)->execute()->_zis;
-    }
-
-    std::vector<int64_t> shifted_accum;
-    shifted_accum.reserve(lbs.size());
-    for (int i = 0; i < lbs.size(); i++) {
-        shifted_accum.push_back(Math::changeBit(lbs[i] >> 1, _width - 1, Comm::rank()));
-    }
 
-    auto final_accum = BoolAndBatchOperator(&shifted_accum, &diag, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE)
-            .setBmts(gotBmt ? &allBmts : nullptr)->execute()->_zis;
+        if (Conf::ENABLE_SIMD) {
+            _diag = SimdSupport::computeDiag(*_yis, x_xor_y);
+        } else {
+            _diag.resize(x_xor_y.size());
+            for (int i = 0; i < x_xor_y.size(); i++) {
+                _diag[i] = Math::changeBit(x_xor_y[i], 0, Math::getBit((*_yis)[i], 0) ^ Comm::rank());
+            }
+        }
 
-    int fn = static_cast<int>(final_accum.size());
-    _zis.resize(fn);
-    for (int i = 0; i < fn; i++) {
-        bool result = false;
-        for (int j = 0; j < _width; j++) {
-            result = result ^ Math::getBit(final_accum[i], j);
+        // Neither AND depends on the other, so both are opened in the same exchange
+        auto shifted_1 = shiftGreater(_lbs, 1);
+        auto lbsBmts = takeBmts();
+        auto diagBmts = takeBmts();
+        _lbsAnd = std::make_unique<BoolAndBatchOperator>(&_lbs, &shifted_1, _width, _taskTag, _currentMsgTag,
+                                                         NO_CLIENT_COMPUTE);
+        _lbsAnd->setBmts(_gotBmt ? &lbsBmts : nullptr);
+        _diagAnd = std::make_unique<BoolAndBatchOperator>(&_diag, _xis, _width, _taskTag, _currentMsgTag,
+                                                          NO_CLIENT_COMPUTE);
+        _diagAnd->setBmts(_gotBmt ? &diagBmts : nullptr);
+        fusion.add(_lbsAnd.get()).add(_diagAnd.get());
+    } else if (_round < finalRound()) {
+        auto shifted_r = shiftGreater(_lbs, _round + 1);
+        auto bmts = takeBmts();
+        _lbsAnd = std::make_unique<BoolAndBatchOperator>(&_lbs, &shifted_r, _width, _taskTag, _currentMsgTag,
+                                                         NO_CLIENT_COMPUTE);
+        _lbsAnd->setBmts(_gotBmt ? &bmts : nullptr);
+        fusion.add(_lbsAnd.get());
+    } else {
+        std::vector<int64_t> shifted_accum;
+        shifted_accum.reserve(_lbs.size());
+        for (int i = 0; i < _lbs.size(); i++) {
+            shifted_accum.push_back(Math::changeBit(_lbs[i] >> 1, _width - 1, Comm::rank()));
         }
-        _zis[i] = result;
+        _lbsAnd = std::make_unique<BoolAndBatchOperator>(&shifted_accum, &_diag, _width, _taskTag, _currentMsgTag,
+                                                         NO_CLIENT_COMPUTE);
+        _lbsAnd->setBmts(_gotBmt ? &_allBmts : nullptr);
+        fusion.add(_lbsAnd.get());
     }
+    return true;
+}
 
-    if (Conf::ENABLE_CLASS_WISE_TIMING) {
-        _totalTime += System::currentTimeMillis() - start;
+void BoolLessBatchOperator::endRound() {
+    if (_round == finalRound()) {
+        auto &final_accum = _lbsAnd->_zis;
+        int fn = static_cast<int>(final_accum.size());
+        _zis.resize(fn);
+        for (int i = 0; i < fn; i++) {
+            bool result = false;
+            for (int j = 0; j < _width; j++) {
+                result = result ^ Math::getBit(final_accum[i], j);
+            }
+            _zis[i] = result;
+        }
+        _lbs.clear();
+        _diag.clear();
+        _allBmts.clear();
+    } else {
+        _lbs = std::move(_lbsAnd->_zis);
+        if (_round == 0) {
+            _diag = std::move(_diagAnd->_zis);
+            _diagAnd.reset();
+        }
     }
-
-    return this;
+    _lbsAnd.reset();
+    _round++;
 }
 
 BoolLessBatchOperator *BoolLessBatchOperator::setBmts(std::vector<BitwiseBmt> *bmts) {
@@ -128,12 +160,12 @@ int BoolLessBatchOperator::bmtCount(int num, int width) {
     if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
         return 0;
     }
-    return ((std::floor(std::log2(width))) + 3) * BoolAndBatchOperator::bmtCount(num, width);
+    return ((std::ceil(std::log2(width))) + 3) * BoolAndBatchOperator::bmtCount(num, width);
 }
 
 std::vector<int64_t> BoolLessBatchOperator::shiftGreater(std::vector<int64_t> &in, int r) const {
     int part_size = 1 << r;
-    if (part_size > _width) {
+    if ((part_size >> 1) >= _width) {
         return in;
     }
     int offset = part_size >> 1;
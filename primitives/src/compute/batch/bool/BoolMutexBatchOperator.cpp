@@ -47,58 +47,51 @@ BoolMutexBatchOperator::~BoolMutexBatchOperator() {
     delete _conds_i;
 }
 
-bool BoolMutexBatchOperator::prepareBmts(std::vector<BitwiseBmt> &bmts) {
-    bool gotBmt = false;
-    if (_bmts != nullptr) {
-        gotBmt = true;
-        bmts = std::move(*_bmts);
+BoolAndBatchOperator *BoolMutexBatchOperator::buildAnd() {
+    bool gotBmt = _bmts != nullptr;
+    if (gotBmt) {
+        _heldBmts = std::move(*_bmts);
     }
-    return gotBmt;
+    _and = std::make_unique<BoolAndBatchOperator>(_xis, _yis, _conds_i, _width, _taskTag, _currentMsgTag);
+    _and->setBmts(gotBmt ? &_heldBmts : nullptr);
+    return _and.get();
 }
 
-void BoolMutexBatchOperator::execute0() {
-    std::vector<BitwiseBmt> bmts;
-    bool gotBmt = prepareBmts(bmts);
-
-    auto num = _conds_i->size();
-
-    auto zis = BoolAndBatchOperator(_xis, _yis, _conds_i, _width, _taskTag, _currentMsgTag).setBmts(
-        gotBmt ? &bmts : nullptr)->execute()->_zis;
-
-    if (Conf::ENABLE_SIMD) {
-        _zis = SimdSupport::xor3(zis.data(), _yis->data(), zis.data() + num, num);
-        for (auto &zi: _zis) {
-            zi = ring(zi);
-        }
-    } else {
-        _zis.resize(num);
-        for (int i = 0; i < num; i++) {
-            _zis[i] = ring(zis[i] ^ (*_yis)[i] ^ zis[num + i]);
-        }
-    }
+BoolAndBatchOperator *BoolMutexBatchOperator::prepare() {
+    return buildAnd()->prepare();
 }
 
-void BoolMutexBatchOperator::executeBidirectionally() {
-    std::vector<BitwiseBmt> bmts;
-    bool gotBmt = prepareBmts(bmts);
-
+void BoolMutexBatchOperator::finish() {
+    auto &zis = _and->_zis;
     auto num = _xis->size();
 
-    auto zis = BoolAndBatchOperator(_xis, _yis, _conds_i, _width, _taskTag, _currentMsgTag).setBmts(
-        gotBmt ? &bmts : nullptr)->execute()->_zis;
-
-    if (Conf::ENABLE_SIMD) {
-        _zis = SimdSupport::xor3Concat(zis.data(), _yis->data(), _xis->data(), zis.data() + num, num);
-        for (auto &zi: _zis) {
-            zi = ring(zi);
+    if (_bidir) {
+        if (Conf::ENABLE_SIMD) {
+            _zis = SimdSupport::xor3Concat(zis.data(), _yis->data(), _xis->data(), zis.data() + num, num);
+            for (auto &zi: _zis) {
+                zi = ring(zi);
+            }
+        } else {
+            _zis.resize(num * 2);
+            for (int i = 0; i < num; i++) {
+                _zis[i] = ring(zis[i] ^ (*_yis)[i] ^ zis[num + i]);
+                _zis[num + i] = ring(zis[i] ^ (*_xis)[i] ^ zis[num + i]);
+            }
         }
     } else {
-        _zis.resize(num * 2);
-        for (int i = 0; i < num; i++) {
-            _zis[i] = ring(zis[i] ^ (*_yis)[i] ^ zis[num + i]);
-            _zis[num + i] = ring(zis[i] ^ (*_xis)[i] ^ zis[num + i]);
+        if (Conf::ENABLE_SIMD) {
+            _zis = SimdSupport::xor3(zis.data(), _yis->data(), zis.data() + num, num);
+            for (auto &zi: _zis) {
+                zi = ring(zi);
+            }
+        } else {
+            _zis.resize(num);
+            for (int i = 0; i < num; i++) {
+                _zis[i] = ring(zis[i] ^ (*_yis)[i] ^ zis[num + i]);
+            }
         }
     }
+    _and.reset();
 }
 
 BoolMutexBatchOperator *BoolMutexBatchOperator::execute() {
@@ -113,11 +106,8 @@ BoolMutexBatchOperator *BoolMutexBatchOperator::execute() {
         start = System::currentTimeMillis();
     }
 
-    if (_bidir) {
-        executeBidirectionally();
-    } else {
-        execute0();
-    }
+    buildAnd()->execute();
+    finish();
 
     if (Conf::ENABLE_CLASS_WISE_TIMING) {
         _totalTime += System::currentTimeMillis() - start;
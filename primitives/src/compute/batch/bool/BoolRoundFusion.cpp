@@ -0,0 +1,96 @@
+#include "compute/batch/bool/BoolRoundFusion.h"
+
+#include "accelerate/SimdSupport.h"
+#include "comm/Comm.h"
+#include "compute/batch/bool/BoolAndBatchOperator.h"
+#include "compute/batch/bool/BoolMutexBatchOperator.h"
+
+BoolRoundFusion &BoolRoundFusion::add(BoolAndBatchOperator *op) {
+    if (Comm::isClient()) {
+        return *this;
+    }
+    op->prepare();
+    if (_ands.empty()) {
+        _tag = op->openingTag();
+    }
+    _ands.push_back(op);
+    return *this;
+}
+
+BoolRoundFusion &BoolRoundFusion::add(BoolMutexBatchOperator *op) {
+    if (Comm::isClient()) {
+        return *this;
+    }
+    auto inner = op->prepare();
+    if (_ands.empty()) {
+        _tag = inner->openingTag();
+    }
+    _ands.push_back(inner);
+    _mutexes.push_back(op);
+    return *this;
+}
+
+void BoolRoundFusion::execute() {
+    if (Comm::isClient() || _ands.empty()) {
+        return;
+    }
+
+    // Each batch is packed at its own width, starting on a byte boundary
+    std::vector<size_t> offsets;
+    offsets.reserve(_ands.size() + 1);
+    size_t total = 0;
+    for (auto op: _ands) {
+        offsets.push_back(total);
+        total += SimdSupport::packedBytes(op->openings().size(), op->_width);
+    }
+
+    std::string out(total, '\0');
+    for (size_t k = 0; k < _ands.size(); k++) {
+        auto &efi = _ands[k]->openings();
+        SimdSupport::packBits(reinterpret_cast<uint8_t *>(&out[offsets[k]]), efi.data(), efi.size(),
+                              _ands[k]->_width);
+    }
+
+    std::string in;
+    auto r0 = Comm::serverSendAsync(out, _tag);
+    auto r1 = Comm::serverReceiveAsync(in, static_cast<int>(total), _tag);
+    Comm::wait(r0);
+    Comm::wait(r1);
+
+    std::vector<int64_t> efo;
+    for (size_t k = 0; k < _ands.size(); k++) {
+        efo.resize(_ands[k]->openings().size());
+        SimdSupport::unpackBits(efo.data(), reinterpret_cast<const uint8_t *>(&in[offsets[k]]), efo.size(),
+                                _ands[k]->_width);
+        _ands[k]->finish(efo.data());
+    }
+    for (auto op: _mutexes) {
+        op->finish();
+    }
+
+    _ands.clear();
+    _mutexes.clear();
+}
+
+void BoolRoundFusion::run(const std::vector<FusableRounds *> &ops) {
+    if (Comm::isClient()) {
+        return;
+    }
+    std::vector<FusableRounds *> active;
+    while (true) {
+        BoolRoundFusion fusion;
+        active.clear();
+        for (auto op: ops) {
+            if (op->addRound(fusion)) {
+                active.push_back(op);
+            }
+        }
+        if (active.empty()) {
+            break;
+        }
+        fusion.execute();
+        for (auto op: active) {
+            op->endRound();
+        }
+    }
+}
@@ -1,7 +1,7 @@
 #include "compute/batch/bool/BoolToArithBatchOperator.h"
 
+#include "intermediate/PreprocessingStore.h"
 #include "ot/IknpOtBatchOperator.h"
-#include "ot/RandOtBatchOperator.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
 
@@ -14,50 +14,43 @@ BoolToArithBatchOperator *BoolToArithBatchOperator::execute() {
     const int sender = (_startMsgTag / IknpOtBatchOperator::tagStride()) & 1;
     const bool isSender = Comm::rank() == sender;
 
-    std::vector<int64_t> ss0, ss1;
+    // Correlated OT per bit: m_c = ((xs ^ c) << j) - r with r = (xs << j) - m0, so delta = ((1 - xs) - xs) << j
+    std::vector<int64_t> deltas;
     std::vector<int> choices;
-    std::vector<int64_t> rs;
 
-    size_t n = _width * _xis->size();
+    size_t n = _inputWidth * _xis->size();
     if (isSender) {
-        ss0.reserve(n);
-        ss1.reserve(n);
-        rs.reserve(n);
+        deltas.reserve(n);
     } else {
         choices.reserve(n);
     }
 
     for (int i = 0; i < _xis->size(); i++) {
-        for (int j = 0; j < _width; j++) {
+        for (int j = 0; j < _inputWidth; j++) {
             int xb = static_cast<int>(((*_xis)[i] >> j) & 1);
             if (isSender) {
-                int64_t r = Math::randInt();
-                rs.push_back(r);
-                int64_t s0 = (static_cast<int64_t>(xb) << j) - r;
-                int64_t s1 = (static_cast<int64_t>(1 - xb) << j) - r;
-                ss0.push_back(s0);
-                ss1.push_back(s1);
+                deltas.push_back((static_cast<int64_t>(1 - xb) << j) - (static_cast<int64_t>(xb) << j));
             } else {
                 choices.push_back(xb);
             }
         }
     }
-    // RandOtBatchOperator e(0, &ss0, &ss1, &choices, _width, _taskTag, _currentMsgTag);
-    IknpOtBatchOperator e(sender, &ss0, &ss1, &choices, _width, _taskTag, _currentMsgTag);
-    e.execute();
+    std::vector<int64_t> results;
+    if (Conf::BMT_METHOD != Conf::BMT_OFFLINE || !transferPreprocessed(sender, deltas, choices, results)) {
+        IknpOtBatchOperator e(sender, &deltas, &choices, _width, _taskTag, _currentMsgTag);
+        e.execute();
+        results = std::move(e._results);
+    }
 
     _zis.resize(_xis->size(), 0);
-    if (isSender) {
-        for (int i = 0; i < _xis->size(); i++) {
-            for (int j = 0; j < _width; j++) {
-                _zis[i] = ring(_zis[i] + rs[i * _width + j]);
-            }
-        }
-    } else {
-        for (int i = 0; i < _xis->size(); i++) {
-            for (int j = 0; j < _width; ++j) {
-                _zis[i] = ring(_zis[i] + e._results[i * _width + j]);
+    for (int i = 0; i < _xis->size(); i++) {
+        for (int j = 0; j < _inputWidth; j++) {
+            int64_t m = results[i * _inputWidth + j];
+            if (isSender) {
+                // r = (xs << j) - m0
+                m = (static_cast<int64_t>(((*_xis)[i] >> j) & 1) << j) - m;
             }
+            _zis[i] = ring(_zis[i] + m);
         }
     }
     return this;
@@ -66,3 +59,54 @@ BoolToArithBatchOperator *BoolToArithBatchOperator::execute() {
 int BoolToArithBatchOperator::tagStride() {
     return IknpOtBatchOperator::tagStride();
 }
+
+bool BoolToArithBatchOperator::transferPreprocessed(int sender, const std::vector<int64_t> &deltas,
+                                                    const std::vector<int> &choices, std::vector<int64_t> &results) {
+    if (!PreprocessingStore::available()) {
+        return false;
+    }
+    const int tag = buildTag(_currentMsgTag);
+
+    if (Comm::rank() != sender) {
+        // Receiver owns the cursor: send [offset, packed d = b ^ c] and get one correction per OT back
+        size_t n = choices.size();
+        int64_t offset = PreprocessingStore::reserveOts(sender, static_cast<int64_t>(n));
+        std::vector<int64_t> ds(1 + (offset < 0 ? 0 : (n + 63) / 64), 0);
+        ds[0] = offset;
+        if (offset < 0) {
+            Comm::serverSend(ds, 64, tag);
+            return false;
+        }
+        const auto *ots = PreprocessingStore::ots(sender, offset);
+        for (size_t i = 0; i < n; i++) {
+            ds[1 + i / 64] |= static_cast<int64_t>((choices[i] ^ ots[i]._v0) & 1) << (i % 64);
+        }
+        Comm::serverSend(ds, 64, tag);
+
+        std::vector<int64_t> taus;
+        Comm::serverReceive(taus, _width, tag);
+        results.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            results[i] = ring(choices[i] ? ots[i]._v1 + taus[i] : ots[i]._v1);
+        }
+        return true;
+    }
+
+    std::vector<int64_t> ds;
+    Comm::serverReceive(ds, 64, tag);
+    if (ds[0] < 0) {
+        return false;
+    }
+    const auto *ots = PreprocessingStore::ots(sender, ds[0]);
+    size_t n = deltas.size();
+    // m0 = r_d, and m0 + delta = r_(1-d) + tau
+    std::vector<int64_t> taus(n);
+    results.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        bool d = (ds[1 + i / 64] >> (i % 64)) & 1;
+        results[i] = ring(d ? ots[i]._v1 : ots[i]._v0);
+        taus[i] = ring(results[i] + deltas[i] - (d ? ots[i]._v0 : ots[i]._v1));
+    }
+    Comm::serverSend(taus, _width, tag);
+    return true;
+}
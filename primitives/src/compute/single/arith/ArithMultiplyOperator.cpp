@@ -13,7 +13,7 @@ ArithMultiplyOperator *ArithMultiplyOperator::execute() {
         if (_bmt != nullptr) {
             bmt = *_bmt;
         } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-            bmt = IntermediateDataSupport::pollBmts(1, _width)[0];
+            bmt = IntermediateDataSupport::pollBmts(1, _width, buildTag(_currentMsgTag))[0];
         } else {
             bmt = BmtGenerator(_width, _taskTag, _currentMsgTag).execute()->_bmt;
         }
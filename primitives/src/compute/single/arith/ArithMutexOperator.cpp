@@ -29,14 +29,17 @@ ArithMutexOperator *ArithMutexOperator::execute() {
             bmt0 = _bmts->at(0);
             bmt1 = _bmts->at(1);
         } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-            auto bs = IntermediateDataSupport::pollBitwiseBmts(2, _width);
+            auto bs = IntermediateDataSupport::pollBitwiseBmts(2, _width, buildTag(_currentMsgTag));
             bmt0 = bs[0];
             bmt1 = bs[1];
         }
         int64_t cx, cy;
         std::future<int64_t> f;
-        auto bp0 = _bmts == nullptr && Conf::BMT_METHOD == Conf::BMT_JIT ? nullptr : &bmt0;
-        auto bp1 = _bmts == nullptr && Conf::BMT_METHOD == Conf::BMT_JIT ? nullptr : &bmt1;
+        // Offline and dealer modes only provide bitwise triples, arithmetic ones are generated JIT
+        bool jit = Conf::BMT_METHOD == Conf::BMT_JIT || Conf::BMT_METHOD == Conf::BMT_OFFLINE ||
+                   Conf::BMT_METHOD == Conf::BMT_DEALER;
+        auto bp0 = _bmts == nullptr && jit ? nullptr : &bmt0;
+        auto bp1 = _bmts == nullptr && jit ? nullptr : &bmt1;
 
         if (Conf::ENABLE_INTRA_OPERATOR_PARALLELISM) {
             f = ThreadPoolSupport::submit([&] {
@@ -17,7 +17,7 @@ void ArithToBoolOperator::prepareBmts(BitwiseBmt &b0, BitwiseBmt &b1, BitwiseBmt
         b1 = _bmts->at(1);
         b2 = _bmts->at(2);
     } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-        auto bs = IntermediateDataSupport::pollBitwiseBmts(3, _width);
+        auto bs = IntermediateDataSupport::pollBitwiseBmts(3, _width, buildTag(_currentMsgTag));
         b0 = bs[0];
         b1 = bs[1];
         b2 = bs[2];
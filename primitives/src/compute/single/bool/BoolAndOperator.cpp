@@ -20,7 +20,7 @@ BoolAndOperator *BoolAndOperator::execute() {
         if (Conf::BMT_METHOD == Conf::BMT_FIXED) {
             _bmt = &IntermediateDataSupport::_fixedBitwiseBmt;
         } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-            auto bmt = IntermediateDataSupport::pollBitwiseBmts(1, _width)[0];
+            auto bmt = IntermediateDataSupport::pollBitwiseBmts(1, _width, buildTag(_currentMsgTag))[0];
             _bmt = &bmt;
         } else {
             auto bmt = BitwiseBmtGenerator(_width, _taskTag, _currentMsgTag).execute()->_bmt;
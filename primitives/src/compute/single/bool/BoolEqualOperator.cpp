@@ -12,11 +12,11 @@ BoolEqualOperator *BoolEqualOperator::execute() {
             diff = ~diff;
         }
         _zi = diff & 1;
-        auto bmt = _bmt == nullptr ? IntermediateDataSupport::pollBitwiseBmts(1, _width)[0] : *_bmt;
+        BitwiseBmt bmt;
         if (_bmt != nullptr) {
             bmt = *_bmt;
         } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-            bmt = IntermediateDataSupport::pollBitwiseBmts(1, _width)[0];
+            bmt = IntermediateDataSupport::pollBitwiseBmts(1, _width, buildTag(_currentMsgTag))[0];
         }
         for (int i = 0; i < _width - 1; i++) {
             _zi = BoolAndOperator(_zi, (diff >> (i + 1)) & 1, 1, _taskTag, 0, NO_CLIENT_COMPUTE).setBmt(_bmt != nullptr || Conf::BMT_METHOD == Conf::BMT_BACKGROUND ? &bmt : nullptr)->execute()->_zi;
@@ -45,7 +45,7 @@ BoolLessOperator *BoolLessOperator::execute() {
     diag = BoolAndOperator(diag, _xi, _width, _taskTag, _currentMsgTag, NO_CLIENT_COMPUTE).setBmt(
         gotBmt ? &bmts[bmtI++] : nullptr)->execute()->_zi;
 
-    int rounds = static_cast<int>(std::floor(std::log2(_width)));
+    int rounds = static_cast<int>(std::ceil(std::log2(_width)));
     for (int r = 2; r <= rounds; r++) {
         int64_t shifted_r = shiftGreater(lbs, r);
 
@@ -85,12 +85,12 @@ int BoolLessOperator::tagStride(int width) {
 }
 
 int BoolLessOperator::bmtCount(int width) {
-    return static_cast<int>(std::floor(std::log2(width))) + 3;
+    return static_cast<int>(std::ceil(std::log2(width))) + 3;
 }
 
 int64_t BoolLessOperator::shiftGreater(int64_t in, int r) const {
     int part_size = 1 << r;
-    if (part_size > _width) {
+    if ((part_size >> 1) >= _width) {
         return in;
     }
 
@@ -13,6 +13,8 @@ void Conf::init(int argc, char **argv) {
         std::string bmt_queue_type;
         std::string thread_pool;
         std::string comm_type;
+        std::string simd_level;
+        std::string base_ot;
 
         if (BMT_METHOD == BMT_FIXED) {
             bmt_method = "bmt_fixed";
@@ -22,6 +24,16 @@ void Conf::init(int argc, char **argv) {
             bmt_method = "bmt_background";
         } else if (BMT_METHOD == BMT_PIPELINE) {
             bmt_method = "bmt_pipeline";
+        } else if (BMT_METHOD == BMT_OFFLINE) {
+            bmt_method = "bmt_offline";
+        } else if (BMT_METHOD == BMT_DEALER) {
+            bmt_method = "bmt_dealer";
+        }
+
+        if (BASE_OT_TYPE == BASE_OT_RSA) {
+            base_ot = "rsa";
+        } else if (BASE_OT_TYPE == BASE_OT_EC) {
+            base_ot = "ec";
         }
 
         if (BMT_QUEUE_TYPE == LOCK_QUEUE) {
@@ -36,6 +48,8 @@ void Conf::init(int argc, char **argv) {
             thread_pool = "async";
         } else if (THREAD_POOL_TYPE == CTPL_POOL) {
             thread_pool = "ctpl_pool";
+        } else if (THREAD_POOL_TYPE == WORK_STEALING_POOL) {
+            thread_pool = "work_stealing_pool";
         }
 #ifdef PARSEC_HAS_TBB
         else if (THREAD_POOL_TYPE == TBB_POOL) {
@@ -45,12 +59,26 @@ void Conf::init(int argc, char **argv) {
 
         if (COMM_TYPE == MPI) {
             comm_type = "mpi";
+        } else if (COMM_TYPE == TCP) {
+            comm_type = "tcp";
+        }
+
+        if (SIMD_LEVEL == SIMD_AUTO) {
+            simd_level = "auto";
+        } else if (SIMD_LEVEL == SIMD_SCALAR) {
+            simd_level = "scalar";
+        } else if (SIMD_LEVEL == SIMD_SSE2) {
+            simd_level = "sse2";
+        } else if (SIMD_LEVEL == SIMD_AVX2) {
+            simd_level = "avx2";
+        } else if (SIMD_LEVEL == SIMD_AVX512) {
+            simd_level = "avx512";
         }
 
         desc.add_options()
                 ("help", "Display help message")
                 ("bmt_method", po::value<std::string>(&bmt_method)->default_value(bmt_method),
-                 "Set bmt_method (bmt_background, bmt_jit, bmt_fixed, bmt_batch_background)")
+                 "Set bmt_method (bmt_background, bmt_jit, bmt_fixed, bmt_pipeline, bmt_offline, bmt_dealer)")
                 ("bmt_pre_gen_seconds", po::value<int>(&BMT_PRE_GEN_SECONDS)->default_value(BMT_PRE_GEN_SECONDS),
                  "Set bmt_pre_gen_seconds")
                 ("max_bmts", po::value<int>(&MAX_BMTS)->default_value(MAX_BMTS),
@@ -63,6 +91,14 @@ void Conf::init(int argc, char **argv) {
                 ("disable_arith", po::value<bool>(&DISABLE_ARITH)->default_value(DISABLE_ARITH), "Set disable_arith")
                 ("bmt_gen_batch_size", po::value<int>(&BMT_GEN_BATCH_SIZE)->default_value(BMT_GEN_BATCH_SIZE),
                  "Set bmt_gen_batch_size")
+                ("bmt_block_size", po::value<int>(&BMT_BLOCK_SIZE)->default_value(BMT_BLOCK_SIZE),
+                 "Set bmt_block_size")
+                ("preprocess_path", po::value<std::string>(&PREPROCESS_PATH)->default_value(PREPROCESS_PATH),
+                 "Set preprocess_path, the prefix of the per-server preprocessing files for bmt_offline")
+                ("base_ot", po::value<std::string>(&base_ot)->default_value(base_ot),
+                 "Set base_ot (ec, rsa)")
+                ("session_cache_path", po::value<std::string>(&SESSION_CACHE_PATH)->default_value(SESSION_CACHE_PATH),
+                 "Set session_cache_path, the prefix of the per-server base OT session cache (empty disables it)")
                 ("task_tag_bits", po::value<int>(&TASK_TAG_BITS)->default_value(TASK_TAG_BITS),
                  "Set task_tag_bits")
                 ("disable_multi_thread", po::value<bool>(&DISABLE_MULTI_THREAD)->default_value(DISABLE_MULTI_THREAD),
@@ -73,9 +109,17 @@ void Conf::init(int argc, char **argv) {
                 ("local_threads", po::value<int>(&LOCAL_THREADS)->default_value(LOCAL_THREADS),
                  "Set local_threads")
                 ("thread_pool", po::value<std::string>(&thread_pool)->default_value(thread_pool),
-                 "Set thread_pool (ctpl_pool, tbb_pool)")
+                 "Set thread_pool (ctpl_pool, tbb_pool, async, work_stealing_pool)")
                 ("comm_type", po::value<std::string>(&comm_type)->default_value(comm_type),
-                 "Set comm_type (mpi)")
+                 "Set comm_type (mpi, tcp)")
+                ("party", po::value<int>(&PARTY)->default_value(PARTY),
+                 "Set party, the rank of this process for comm_type=tcp")
+                ("tcp_hosts", po::value<std::string>(&TCP_HOSTS)->default_value(TCP_HOSTS),
+                 "Set tcp_hosts (one host, or comma-separated hosts of rank 0, 1 and 2)")
+                ("tcp_port", po::value<int>(&TCP_PORT)->default_value(TCP_PORT),
+                 "Set tcp_port, the base listening port")
+                ("tcp_streams", po::value<int>(&TCP_STREAMS)->default_value(TCP_STREAMS),
+                 "Set tcp_streams, the connections per pair of parties")
                 ("batch_size", po::value<int>(&BATCH_SIZE)->default_value(BATCH_SIZE),
                  "Set batch_size")
                 ("enable_transfer_compression",
@@ -88,6 +132,8 @@ void Conf::init(int argc, char **argv) {
                  "Set enable_class_wise_timing (true/false)")
                 ("enable_simd", po::value<bool>(&ENABLE_SIMD)->default_value(ENABLE_SIMD),
                  "Set enable_simd (true/false)")
+                ("simd_level", po::value<std::string>(&simd_level)->default_value(simd_level),
+                 "Set simd_level (auto, avx512, avx2, sse2, scalar)")
                 ("enable_iknp_multithread",
                  po::value<bool>(&ENABLE_IKNP_MULTITHREAD)->default_value(ENABLE_IKNP_MULTITHREAD),
                  "Set enable_iknp_multithread (true/false)");
@@ -114,11 +160,25 @@ void Conf::init(int argc, char **argv) {
                 BMT_METHOD = BMT_FIXED;
             } else if (bmt_method == "bmt_pipeline") {
                 BMT_METHOD = BMT_PIPELINE;
+            } else if (bmt_method == "bmt_offline") {
+                BMT_METHOD = BMT_OFFLINE;
+            } else if (bmt_method == "bmt_dealer") {
+                BMT_METHOD = BMT_DEALER;
             } else {
                 throw std::runtime_error("Unknown bmt_method value.");
             }
         }
 
+        if (vm.count("base_ot")) {
+            if (base_ot == "rsa") {
+                BASE_OT_TYPE = BASE_OT_RSA;
+            } else if (base_ot == "ec") {
+                BASE_OT_TYPE = BASE_OT_EC;
+            } else {
+                throw std::runtime_error("Unknown base_ot value.");
+            }
+        }
+
         if (vm.count("bmt_queue_type")) {
             if (bmt_queue_type == "cas_queue") {
                 BMT_QUEUE_TYPE = LOCK_FREE_QUEUE;
@@ -143,14 +203,39 @@ void Conf::init(int argc, char **argv) {
 #endif
             } else if (thread_pool == "async") {
                 THREAD_POOL_TYPE = ASYNC;
+            } else if (thread_pool == "work_stealing_pool") {
+#ifdef PARSEC_HAS_FIBERS
+                THREAD_POOL_TYPE = WORK_STEALING_POOL;
+#else
+                std::cerr << "Warning: fibers are not available, falling back to ctpl_pool" << std::endl;
+                THREAD_POOL_TYPE = CTPL_POOL;
+#endif
             } else {
                 throw std::runtime_error("Unknown thread_pool value.");
             }
         }
 
+        if (vm.count("simd_level")) {
+            if (simd_level == "auto") {
+                SIMD_LEVEL = SIMD_AUTO;
+            } else if (simd_level == "scalar") {
+                SIMD_LEVEL = SIMD_SCALAR;
+            } else if (simd_level == "sse2") {
+                SIMD_LEVEL = SIMD_SSE2;
+            } else if (simd_level == "avx2") {
+                SIMD_LEVEL = SIMD_AVX2;
+            } else if (simd_level == "avx512") {
+                SIMD_LEVEL = SIMD_AVX512;
+            } else {
+                throw std::runtime_error("Unknown simd_level value.");
+            }
+        }
+
         if (vm.count("comm_type")) {
             if (comm_type == "mpi") {
                 COMM_TYPE = MPI;
+            } else if (comm_type == "tcp") {
+                COMM_TYPE = TCP;
             } else {
                 throw std::runtime_error("Unknown comm_type value.");
             }
@@ -4,6 +4,7 @@
 #include "ot/IknpOtBatchOperator.h"
 #include "ot/RandOtOperator.h"
 #include "parallel/ThreadPoolSupport.h"
+#include "utils/Crypto.h"
 
 BitwiseBmtBatchGenerator::BitwiseBmtBatchGenerator(int count, int width, int taskTag,
                                                    int msgTagOffset) : AbstractBmtBatchGenerator(count,
@@ -48,25 +49,25 @@ BitwiseBmtBatchGenerator *BitwiseBmtBatchGenerator::execute() {
 }
 
 void BitwiseBmtBatchGenerator::generateRandomAB() {
-    for (auto &b: _bmts) {
-        b._a = Math::randInt();
-        b._b = Math::randInt();
+    std::vector<int64_t> ab(2 * _bmts.size());
+    Crypto::randomFill(ab.data(), ab.size());
+    for (size_t i = 0; i < _bmts.size(); i++) {
+        _bmts[i]._a = ab[2 * i];
+        _bmts[i]._b = ab[2 * i + 1];
     }
 }
 
 void BitwiseBmtBatchGenerator::computeMix(int sender) {
     bool isSender = Comm::rank() == sender;
 
-    std::vector<int64_t> ss0, ss1;
+    // Correlated OT with delta a: the sender's random m0 is its share of the mix, the receiver gets m0 ^ (a & b)
+    std::vector<int64_t> deltas;
     std::vector<int64_t> choices;
 
     if (isSender) {
-        ss0.resize(_bc);
-        ss1.resize(_bc);
+        deltas.resize(_bc);
         for (int i = 0; i < _bc; i++) {
-            int64_t random = Math::randInt();
-            ss0[i] = random;
-            ss1[i] = corr(i, random);
+            deltas[i] = _bmts[i]._a;
         }
     } else {
         choices.resize(_bc);
@@ -75,16 +76,9 @@ void BitwiseBmtBatchGenerator::computeMix(int sender) {
         }
     }
 
-    auto results = IknpOtBatchOperator(sender, &ss0, &ss1, &choices, _taskTag,
-                                       _currentMsgTag + sender * IknpOtBatchOperator::tagStride()).execute()->_results;
-    // auto results = RandOtBatchOperator(sender, &ss0, &ss1, &choices, _taskTag,
-    //                                    _currentMsgTag + sender * RandOtBatchOperator::tagStride()).execute()->_results;
-
     std::vector<int64_t> *mix = sender == 0 ? &_usi : &_vsi;
-    mix->resize(_bc);
-    for (int i = 0; i < _bc; i++) {
-        (*mix)[i] = isSender ? ss0[i] : results[i];
-    }
+    *mix = IknpOtBatchOperator(sender, &deltas, &choices, _taskTag,
+                               _currentMsgTag + sender * IknpOtBatchOperator::tagStride()).execute()->_results;
 }
 
 void BitwiseBmtBatchGenerator::computeC() {
@@ -94,10 +88,6 @@ void BitwiseBmtBatchGenerator::computeC() {
     }
 }
 
-int64_t BitwiseBmtBatchGenerator::corr(int bmtIdx, int64_t x) const {
-    return _bmts[bmtIdx]._a ^ x;
-}
-
 SecureOperator *BitwiseBmtBatchGenerator::reconstruct(int clientRank) {
     throw std::runtime_error("Not support.");
 }
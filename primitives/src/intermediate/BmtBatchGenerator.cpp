@@ -5,15 +5,18 @@
 #include "ot/IknpOtBatchOperator.h"
 #include "parallel/ThreadPoolSupport.h"
 #include "utils/Math.h"
+#include "utils/Crypto.h"
 
 BmtBatchGenerator::BmtBatchGenerator(int count, int l, int taskTag, int msgTagOffset) : AbstractBmtBatchGenerator(
     count, l, taskTag, msgTagOffset) {
 }
 
 void BmtBatchGenerator::generateRandomAB() {
-    for (auto &b: _bmts) {
-        b._a = ring(Math::randInt());
-        b._b = ring(Math::randInt());
+    std::vector<int64_t> ab(2 * _bmts.size());
+    Crypto::randomFill(ab.data(), ab.size());
+    for (size_t i = 0; i < _bmts.size(); i++) {
+        _bmts[i]._a = ring(ab[2 * i]);
+        _bmts[i]._b = ring(ab[2 * i + 1]);
     }
 }
 
@@ -38,11 +41,11 @@ void BmtBatchGenerator::computeMix(int sender) {
     size_t bmtCount = _bmts.size();
     size_t all = _width * bmtCount;
     if (isSender) {
-        ss0.reserve(all);
+        ss0.resize(all);
         ss1.reserve(all);
+        Crypto::randomFill(ss0.data(), all);
         for (int i = 0; i < bmtCount; i++) {
             for (int j = 0; j < _width; ++j) {
-                ss0.push_back(Math::randInt());
                 ss1.push_back(corr(i, j, ss0[i * _width + j]));
             }
         }
@@ -0,0 +1,176 @@
+#include "intermediate/BmtDealer.h"
+
+#include "base/SecureOperator.h"
+#include "comm/Comm.h"
+#include "conf/Conf.h"
+#include "parallel/WorkStealingThreadPool.h"
+#include "utils/Crypto.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Seeds and the client <-> server 1 correction stream, under the reserved task tag
+    constexpr int DEALER_MSG_TAG = 0;
+    constexpr int64_t STOP = -1;
+
+    int dealerTag() {
+        return SecureOperator::buildTag(System::reservedTaskTag(), DEALER_MSG_TAG);
+    }
+
+    int64_t chunkWords() {
+        return std::max(1, Conf::BMT_GEN_BATCH_SIZE);
+    }
+
+    // Word i takes blocks [i * blocksPerWord, (i + 1) * blocksPerWord) of the seed's stream: (a, b) in the first
+    // one, c in the low half of the second
+    void expand(const U128 &seed, int64_t offset, int count, int blocksPerWord, std::vector<U128> &out) {
+        out.resize(static_cast<size_t>(count) * blocksPerWord);
+        Crypto::expandSeed(seed, static_cast<uint64_t>(offset) * blocksPerWord, out.data(), out.size());
+    }
+
+    std::vector<int64_t> pack(const U128 &seed) {
+        return {static_cast<int64_t>(seed.lo), static_cast<int64_t>(seed.hi)};
+    }
+}
+
+void BmtDealer::init() {
+    if (Conf::DISABLE_MULTI_THREAD) {
+        throw std::runtime_error("bmt_dealer needs multi-threading for the client dealer.");
+    }
+
+    if (Comm::isClient()) {
+        U128 seed0{}, seed1{};
+        Crypto::randomFill(&seed0, 1);
+        Crypto::randomFill(&seed1, 1);
+        Comm::send(pack(seed0), 64, 0, dealerTag());
+        Comm::send(pack(seed1), 64, 1, dealerTag());
+        _dealer = std::thread(deal, seed0, seed1);
+        return;
+    }
+
+    std::vector<int64_t> seed;
+    Comm::receive(seed, 64, 2, dealerTag());
+    _seed = {static_cast<uint64_t>(seed[0]), static_cast<uint64_t>(seed[1])};
+    if (Comm::rank() == 1) {
+        const int64_t credit = 1;
+        for (int i = 0; i < WINDOW; i++) {
+            Comm::send(credit, 64, 2, dealerTag());
+        }
+    }
+}
+
+void BmtDealer::finalize() {
+    if (Comm::isClient()) {
+        if (_dealer.joinable()) {
+            _dealer.join();
+        }
+    } else if (Comm::rank() == 1) {
+        // Every received chunk was answered with a credit, so exactly WINDOW chunks are in flight
+        for (int i = 0; i < WINDOW; i++) {
+            std::vector<int64_t> discard;
+            Comm::receive(discard, 64, 2, dealerTag());
+        }
+        Comm::send(STOP, 64, 2, dealerTag());
+        _chunks.clear();
+    }
+    _reservations.clear();
+}
+
+void BmtDealer::deal(U128 seed0, U128 seed1) {
+    const int64_t words = chunkWords();
+    std::vector<U128> s0, s1;
+    std::vector<int64_t> c(words);
+    for (int64_t k = 0;; k++) {
+        int64_t credit;
+        Comm::receive(credit, 64, 1, dealerTag());
+        if (credit == STOP) {
+            return;
+        }
+        expand(seed0, k * words, static_cast<int>(words), 2, s0);
+        expand(seed1, k * words, static_cast<int>(words), 1, s1);
+        for (int64_t i = 0; i < words; i++) {
+            uint64_t a = s0[2 * i].lo ^ s1[i].lo;
+            uint64_t b = s0[2 * i].hi ^ s1[i].hi;
+            c[i] = static_cast<int64_t>((a & b) ^ s0[2 * i + 1].lo);
+        }
+        Comm::send(c, 64, 1, dealerTag());
+    }
+}
+
+std::vector<BitwiseBmt> BmtDealer::takeBitwiseBmts(int count, int width, int tag) {
+    auto bmts = _reservations.take(tag, count, [tag](int64_t n) {
+        return reserve(static_cast<int>(n), tag);
+    });
+    if (width < 64) {
+        for (auto &bmt: bmts) {
+            bmt._a = Math::ring(bmt._a, width);
+            bmt._b = Math::ring(bmt._b, width);
+            bmt._c = Math::ring(bmt._c, width);
+        }
+    }
+    return bmts;
+}
+
+std::vector<BitwiseBmt> BmtDealer::reserve(int count, int tag) {
+    std::vector<BitwiseBmt> bmts(count);
+    int64_t offset;
+    if (Comm::rank() == 0) {
+        offset = _cursor.fetch_add(count);
+        Comm::serverSend(offset, 64, tag);
+    } else {
+        Comm::serverReceive(offset, 64, tag);
+    }
+
+    const bool first = Comm::rank() == 0;
+    const int blocksPerWord = first ? 2 : 1;
+    std::vector<U128> blocks;
+    expand(_seed, offset, count, blocksPerWord, blocks);
+    for (int i = 0; i < count; i++) {
+        bmts[i]._a = static_cast<int64_t>(blocks[i * blocksPerWord].lo);
+        bmts[i]._b = static_cast<int64_t>(blocks[i * blocksPerWord].hi);
+        if (first) {
+            bmts[i]._c = static_cast<int64_t>(blocks[i * blocksPerWord + 1].lo);
+        }
+    }
+    if (!first) {
+        takeCorrections(offset, count, bmts);
+    }
+    return bmts;
+}
+
+void BmtDealer::takeCorrections(int64_t offset, int count, std::vector<BitwiseBmt> &bmts) {
+    const int64_t words = chunkWords();
+    while (_receiving.exchange(true, std::memory_order_acquire)) {
+        if (!WorkStealingThreadPool::yield()) {
+            std::this_thread::yield();
+        }
+    }
+
+    int64_t last = (offset + count - 1) / words;
+    const int64_t credit = 1;
+    while (_receivedChunks <= last) {
+        Comm::receive(_chunks[_receivedChunks++]._c, 64, 2, dealerTag());
+        Comm::send(credit, 64, 2, dealerTag());
+    }
+
+    // Offsets are handed out once, so a chunk is dropped as soon as all of its words were taken
+    for (int64_t w = offset; w < offset + count;) {
+        int64_t k = w / words;
+        auto it = _chunks.find(k);
+        int64_t from = w - k * words;
+        int64_t n = std::min(words - from, offset + count - w);
+        for (int64_t j = 0; j < n; j++) {
+            bmts[w - offset + j]._c = it->second._c[from + j];
+        }
+        it->second._used += n;
+        if (it->second._used == words) {
+            _chunks.erase(it);
+        }
+        w += n;
+    }
+
+    _receiving.store(false, std::memory_order_release);
+}
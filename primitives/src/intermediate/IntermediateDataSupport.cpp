@@ -3,19 +3,29 @@
 #include "comm/Comm.h"
 #include "intermediate/BitwiseBmtBatchGenerator.h"
 #include "intermediate/BitwiseBmtGenerator.h"
+#include "intermediate/BmtBatchGenerator.h"
+#include "intermediate/BmtDealer.h"
 #include "intermediate/BmtGenerator.h"
 #include "ot/BaseOtOperator.h"
 #include "parallel/ThreadPoolSupport.h"
+#include "parallel/WorkStealingThreadPool.h"
 #include "sync/BoostLockFreeQueue.h"
 #include "sync/BoostSpscQueue.h"
 #include "sync/LockBlockingQueue.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
+#include "utils/System.h"
+#include <algorithm>
 #include <climits>
 #include <stdexcept>
+#include <thread>
 
 #include "intermediate/PipelineBitwiseBmtBatchGenerator.h"
+#include "intermediate/PipelineBmtBatchGenerator.h"
+#include "intermediate/PreprocessingStore.h"
+#include "intermediate/SessionCache.h"
 #include "ot/BaseOtBatchOperator.h"
+#include "ot/EcBaseOtBatchOperator.h"
 #include "utils/Crypto.h"
 
 void IntermediateDataSupport::prepareBmt() {
@@ -23,20 +33,9 @@ void IntermediateDataSupport::prepareBmt() {
         _fixedBmt = BmtGenerator(64, 0, 0).execute()->_bmt;
         _fixedBitwiseBmt = BitwiseBmtGenerator(64, 0, 0).execute()->_bmt;
     } else if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND || Conf::BMT_METHOD == Conf::BMT_PIPELINE) {
-        _bitwiseBmtQs.resize(Conf::BMT_QUEUE_NUM);
-        if (Conf::BMT_QUEUE_TYPE == Conf::LOCK_QUEUE) {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bitwiseBmtQs[i] = new LockBlockingQueue<BitwiseBmt>(Conf::MAX_BMTS);
-            }
-        } else if (Conf::BMT_QUEUE_TYPE == Conf::LOCK_FREE_QUEUE) {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bitwiseBmtQs[i] = new BoostLockFreeQueue<BitwiseBmt>(Conf::MAX_BMTS);
-            }
-        } else {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bitwiseBmtQs[i] = new BoostSPSCQueue<BitwiseBmt, 10000000>();
-            }
-        }
+        _bitwiseBmtQs = createQueues<BitwiseBmt>();
+        _bitwiseBmtStreams = std::make_unique<BmtStream<BitwiseBmt>[]>(Conf::BMT_QUEUE_NUM);
+        _pendingBitwiseBmtBlocks.resize(Conf::BMT_QUEUE_NUM);
 
         startGenerateBitwiseBmtsAsync();
 
@@ -44,35 +43,60 @@ void IntermediateDataSupport::prepareBmt() {
             return;
         }
 
-        _bmtQs.resize(Conf::BMT_QUEUE_NUM);
+        _bmtQs = createQueues<Bmt>();
+        _bmtStreams = std::make_unique<BmtStream<Bmt>[]>(Conf::BMT_QUEUE_NUM);
+        _pendingBmtBlocks.resize(Conf::BMT_QUEUE_NUM);
+
+        startGenerateBmtsAsync();
+    } else if (Conf::BMT_METHOD == Conf::BMT_OFFLINE) {
+        PreprocessingStore::open(System::nextTask());
+    }
+}
+
+template<typename T>
+std::vector<AbstractBlockingQueue<std::vector<T> *> *> IntermediateDataSupport::createQueues() {
+    using Block = std::vector<T>;
+    // Fixed-size boost lock-free queues index their nodes with 16 bits
+    constexpr size_t LOCK_FREE_MAX_BLOCKS = 65534;
+    constexpr size_t SPSC_BLOCKS = 16384;
+
+    // MAX_BMTS counts triples, the queues hold blocks
+    size_t blocks = std::max<size_t>(1, Conf::MAX_BMTS / std::max(1, Conf::BMT_BLOCK_SIZE));
+    std::vector<AbstractBlockingQueue<Block *> *> queues(Conf::BMT_QUEUE_NUM);
+    for (auto &queue: queues) {
         if (Conf::BMT_QUEUE_TYPE == Conf::LOCK_QUEUE) {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bmtQs[i] = new LockBlockingQueue<Bmt>(Conf::MAX_BMTS);
-            }
+            queue = new LockBlockingQueue<Block *>(blocks);
         } else if (Conf::BMT_QUEUE_TYPE == Conf::LOCK_FREE_QUEUE) {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bmtQs[i] = new BoostLockFreeQueue<Bmt>(Conf::MAX_BMTS);
-            }
+            queue = new BoostLockFreeQueue<Block *>(std::min(blocks, LOCK_FREE_MAX_BLOCKS));
         } else {
-            for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
-                _bmtQs[i] = new BoostSPSCQueue<Bmt, 10000000>();
-            }
+            queue = new BoostSPSCQueue<Block *, SPSC_BLOCKS>();
         }
-        startGenerateBmtsAsync();
     }
+    return queues;
 }
 
-
 void IntermediateDataSupport::init() {
+    // The client takes part as the dealer
+    if (Conf::BMT_METHOD == Conf::BMT_DEALER) {
+        BmtDealer::init();
+    }
+
     if (Comm::isClient()) {
         return;
     }
 
-    prepareBaseOtRsaKeys();
+    // The cache holds no RSA keys, and the ROT refreshes and base OT operators still need them after a resume
+    if (Conf::BASE_OT_TYPE == Conf::BASE_OT_RSA) {
+        prepareBaseOtRsaKeys();
+    }
+
+    if (!SessionCache::load()) {
+        prepareRot();
 
-    prepareRot();
+        prepareIknp();
 
-    prepareIknp();
+        SessionCache::store();
+    }
 
     prepareBmt();
 
@@ -82,8 +106,9 @@ void IntermediateDataSupport::init() {
 }
 
 void IntermediateDataSupport::finalize() {
-    delete _currentBmt;
-    delete _currentBitwiseBmt;
+    _bmtReservations.clear();
+    _bitwiseBmtReservations.clear();
+    PreprocessingStore::close();
     delete _sRot0;
     delete _rRot0;
     delete _sRot1;
@@ -130,12 +155,7 @@ void IntermediateDataSupport::prepareRot() {
             _rRot0 = new RRot();
             _rRot0->_b = static_cast<int>(Math::randInt(0, 1));
         }
-        BaseOtOperator e(i, isSender ? _sRot0->_r0 : -1, isSender ? _sRot0->_r1 : -1, !isSender ? _rRot0->_b : -1,
-                         64, 2, i * BaseOtOperator::tagStride());
-        e.execute();
-        if (!isSender) {
-            _rRot0->_rb = e._result;
-        }
+        rot(i, _sRot0, _rRot0);
     }
 
     for (int i = 0; i < 2; i++) {
@@ -148,97 +168,188 @@ void IntermediateDataSupport::prepareRot() {
             _rRot1 = new RRot();
             _rRot1->_b = 1 - _rRot0->_b;
         }
-        BaseOtOperator e(i, isSender ? _sRot1->_r0 : -1, isSender ? _sRot1->_r1 : -1, !isSender ? _rRot1->_b : -1,
-                         64, 2, i * BaseOtOperator::tagStride());
-        e.execute();
+        rot(i, _sRot1, _rRot1);
+    }
+}
+
+void IntermediateDataSupport::rot(int sender, SRot *sRot, RRot *rRot) {
+    bool isSender = Comm::rank() == sender;
+    if (Conf::BASE_OT_TYPE == Conf::BASE_OT_EC) {
+        std::vector<int64_t> ms0, ms1;
+        std::vector<int> choices;
+        if (isSender) {
+            ms0 = {sRot->_r0};
+            ms1 = {sRot->_r1};
+        } else {
+            choices = {rRot->_b};
+        }
+        auto results = baseOt(sender, &ms0, &ms1, &choices, 2, sender * EcBaseOtBatchOperator::tagStride());
         if (!isSender) {
-            _rRot1->_rb = e._result;
+            rRot->_rb = results[0];
         }
+        return;
+    }
+
+    BaseOtOperator e(sender, isSender ? sRot->_r0 : -1, isSender ? sRot->_r1 : -1, !isSender ? rRot->_b : -1,
+                     64, 2, sender * BaseOtOperator::tagStride());
+    e.execute();
+    if (!isSender) {
+        rRot->_rb = e._result;
     }
 }
 
-std::vector<Bmt> IntermediateDataSupport::pollBmts(int count, int width) {
-    std::vector<Bmt> result;
+template<typename T>
+std::vector<T> IntermediateDataSupport::pollBlocks(const std::vector<AbstractBlockingQueue<std::vector<T> *> *> &queues,
+                                                   BmtStream<T> *streams, std::atomic_uint &nextQueue,
+                                                   TagReservations<T> &reservations, int count, int width, int tag) {
     if (Comm::isClient()) {
-        return result;
+        return {};
     }
+    auto result = reservations.take(tag, count, [&](int64_t n) {
+        return reserveBlocks(queues, streams, nextQueue, n, tag);
+    });
+    for (auto &bmt: result) {
+        bmt._a = Math::ring(bmt._a, width);
+        bmt._b = Math::ring(bmt._b, width);
+        bmt._c = Math::ring(bmt._c, width);
+    }
+    return result;
+}
 
-    result.reserve(count);
-
-    while (count > 0) {
-        int left = _currentBmtLeftTimes;
-
-        if (_currentBmt == nullptr || left == 0) {
-            delete _currentBmt;
-            Bmt newBmt = _bmtQs[_currentBmtQ++ % Conf::BMT_QUEUE_NUM]->poll();
-            newBmt._a = Math::ring(newBmt._a, width);
-            newBmt._b = Math::ring(newBmt._b, width);
-            newBmt._c = Math::ring(newBmt._c, width);
-            _currentBmt = new Bmt(newBmt);
-            _currentBmtLeftTimes = Conf::BMT_USAGE_LIMIT;
-            left = Conf::BMT_USAGE_LIMIT;
-        }
+template<typename T>
+std::vector<T> IntermediateDataSupport::reserveBlocks(
+    const std::vector<AbstractBlockingQueue<std::vector<T> *> *> &queues, BmtStream<T> *streams,
+    std::atomic_uint &nextQueue, int64_t count, int tag) {
+    // (queue, first position)
+    std::vector<int64_t> range(2);
+    if (Comm::rank() == 0) {
+        range[0] = nextQueue++ % queues.size();
+        range[1] = streams[range[0]]._cursor.fetch_add(count);
+        Comm::serverSend(range, 64, tag);
+    } else {
+        Comm::serverReceive(range, 64, tag);
+    }
 
-        int useCount = std::min(count, left);
+    auto &stream = streams[range[0]];
+    auto *queue = queues[range[0]];
+    const int64_t uses = std::max(1, Conf::BMT_USAGE_LIMIT);
+    const int64_t blockPositions = std::max(1, Conf::BMT_BLOCK_SIZE) * uses;
 
-        for (int i = 0; i < useCount; ++i) {
-            result.push_back(*_currentBmt);
+    std::vector<T> result;
+    result.reserve(count);
+    for (int64_t pos = range[1], end = range[1] + count; pos < end;) {
+        // Blocks are only ever offered full, so block b holds positions [b, b + 1) * blockPositions
+        int64_t b = pos / blockPositions;
+        const auto *block = blockOf(queue, stream, b);
+        int64_t take = std::min(end, (b + 1) * blockPositions) - pos;
+        for (int64_t p = pos; p < pos + take; p++) {
+            result.push_back((*block)[(p - b * blockPositions) / uses]);
         }
-
-        _currentBmtLeftTimes -= useCount;
-        count -= useCount;
+        {
+            std::lock_guard<std::mutex> lock(stream._mutex);
+            auto it = stream._blocks.find(b);
+            it->second.second += take;
+            if (it->second.second == blockPositions) {
+                stream._blocks.erase(it);
+            }
+        }
+        pos += take;
     }
-
     return result;
 }
 
-std::vector<BitwiseBmt> IntermediateDataSupport::pollBitwiseBmts(int count, int width) {
-    std::vector<BitwiseBmt> result;
-    if (Comm::isClient()) {
-        return result;
+template<typename T>
+const std::vector<T> *IntermediateDataSupport::blockOf(AbstractBlockingQueue<std::vector<T> *> *queue,
+                                                       BmtStream<T> &stream, int64_t b) {
+    std::unique_lock<std::mutex> lock(stream._mutex);
+    while (stream._polled <= b) {
+        if (stream._polling) {
+            lock.unlock();
+            if (!WorkStealingThreadPool::yield()) {
+                std::this_thread::yield();
+            }
+            lock.lock();
+            continue;
+        }
+        stream._polling = true;
+        lock.unlock();
+        std::unique_ptr<std::vector<T> > block(queue->poll());
+        lock.lock();
+        stream._blocks[stream._polled++] = {std::move(block), 0};
+        stream._polling = false;
     }
+    // Not erased before this consumer has counted its positions as served
+    return stream._blocks[b].first.get();
+}
 
-    result.reserve(count);
+std::vector<Bmt> IntermediateDataSupport::pollBmts(int count, int width, int tag) {
+    return pollBlocks(_bmtQs, _bmtStreams.get(), _nextBmtQ, _bmtReservations, count, width, tag);
+}
 
-    while (count > 0) {
-        int left = _currentBitwiseBmtLeftTimes;
-
-        if (_currentBitwiseBmt == nullptr || left == 0) {
-            delete _currentBitwiseBmt;
-            BitwiseBmt newBmt = _bitwiseBmtQs[_currentBitwiseBmtQ++ % Conf::BMT_QUEUE_NUM]->poll();
-            newBmt._a = Math::ring(newBmt._a, width);
-            newBmt._b = Math::ring(newBmt._b, width);
-            newBmt._c = Math::ring(newBmt._c, width);
-            _currentBitwiseBmt = new BitwiseBmt(newBmt);
-            _currentBitwiseBmtLeftTimes = Conf::BMT_USAGE_LIMIT;
-            left = Conf::BMT_USAGE_LIMIT;
+std::vector<BitwiseBmt> IntermediateDataSupport::pollBitwiseBmts(int count, int width, int tag) {
+    return pollBlocks(_bitwiseBmtQs, _bitwiseBmtStreams.get(), _nextBitwiseBmtQ, _bitwiseBmtReservations, count, width,
+                      tag);
+}
+
+template<typename T>
+void IntermediateDataSupport::offerBlocks(AbstractBlockingQueue<std::vector<T> *> *queue,
+                                          std::unique_ptr<std::vector<T> > &pending, const std::vector<T> &items) {
+    size_t blockSize = std::max(1, Conf::BMT_BLOCK_SIZE);
+    size_t i = 0;
+    while (i < items.size()) {
+        if (pending == nullptr) {
+            pending = std::make_unique<std::vector<T> >();
+            pending->reserve(blockSize);
+        }
+        size_t take = std::min(blockSize - pending->size(), items.size() - i);
+        pending->insert(pending->end(), items.begin() + i, items.begin() + i + take);
+        i += take;
+        if (pending->size() == blockSize) {
+            queue->offer(pending.release());
         }
+    }
+}
 
-        int useCount = std::min(count, left);
+void IntermediateDataSupport::offerBmts(int queueIndex, const std::vector<Bmt> &bmts) {
+    offerBlocks(_bmtQs[queueIndex], _pendingBmtBlocks[queueIndex], bmts);
+}
 
-        for (int i = 0; i < useCount; ++i) {
-            result.push_back(*_currentBitwiseBmt);
-        }
+void IntermediateDataSupport::offerBitwiseBmts(int queueIndex, const std::vector<BitwiseBmt> &bmts) {
+    offerBlocks(_bitwiseBmtQs[queueIndex], _pendingBitwiseBmtBlocks[queueIndex], bmts);
+}
 
-        _currentBitwiseBmtLeftTimes -= useCount;
-        count -= useCount;
-    }
+int IntermediateDataSupport::bitwiseBmtTaskTag(int queueIndex) {
+    return queueIndex;
+}
 
-    return result;
+int IntermediateDataSupport::bmtTaskTag(int queueIndex) {
+    return Conf::BMT_QUEUE_NUM + queueIndex;
 }
 
 void IntermediateDataSupport::startGenerateBmtsAsync() {
-    if (Comm::isServer() && Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
+    if (Comm::isClient()) {
+        return;
+    }
+    if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
         for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
             ThreadPoolSupport::submit([i] {
                 try {
-                    auto q = _bmtQs[i];
                     while (!System::_shutdown.load()) {
-                        q->offer(BmtGenerator(64, Conf::BMT_QUEUE_NUM + i, 0).execute()->_bmt);
+                        offerBmts(i, BmtBatchGenerator(Conf::BMT_GEN_BATCH_SIZE, 64, bmtTaskTag(i), 0).execute()->_bmts);
                     }
                 } catch (...) {}
             });
         }
+    } else if (Conf::BMT_METHOD == Conf::BMT_PIPELINE) {
+        for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
+            ThreadPoolSupport::submit([i] {
+                try {
+                    auto g = new PipelineBmtBatchGenerator(i, bmtTaskTag(i), 0);
+                    g->execute();
+                    delete g;
+                } catch (...) {}
+            });
+        }
     }
 }
 
@@ -247,12 +358,8 @@ void IntermediateDataSupport::startGenerateBitwiseBmtsAsync() {
         for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
             ThreadPoolSupport::submit([i] {
                 try {
-                    auto q = _bitwiseBmtQs[i];
                     while (!System::_shutdown.load()) {
-                        auto bitwiseBmts = BitwiseBmtBatchGenerator(Conf::BMT_GEN_BATCH_SIZE, 64, i, 0).execute()->_bmts;
-                        for (auto b: bitwiseBmts) {
-                            q->offer(b);
-                        }
+                        offerBitwiseBmts(i, BitwiseBmtBatchGenerator(Conf::BMT_GEN_BATCH_SIZE, 64, bitwiseBmtTaskTag(i), 0).execute()->_bmts);
                     }
                 } catch (...) {}
             });
@@ -261,7 +368,7 @@ void IntermediateDataSupport::startGenerateBitwiseBmtsAsync() {
         for (int i = 0; i < Conf::BMT_QUEUE_NUM; i++) {
             ThreadPoolSupport::submit([i] {
                 try {
-                    auto g = new PipelineBitwiseBmtBatchGenerator(i, i, 0);
+                    auto g = new PipelineBitwiseBmtBatchGenerator(i, bitwiseBmtTaskTag(i), 0);
                     g->execute();
                     delete g;
                 } catch (...) {}
@@ -270,6 +377,18 @@ void IntermediateDataSupport::startGenerateBitwiseBmtsAsync() {
     }
 }
 
+std::vector<int64_t> IntermediateDataSupport::baseOt(int sender, std::vector<int64_t> *ms0, std::vector<int64_t> *ms1,
+                                                     std::vector<int> *choices, int taskTag, int msgTagOffset) {
+    if (Conf::BASE_OT_TYPE == Conf::BASE_OT_EC) {
+        EcBaseOtBatchOperator e(sender, ms0, ms1, choices, 64, taskTag, msgTagOffset);
+        e.execute();
+        return std::move(e._results);
+    }
+    BaseOtBatchOperator e(sender, ms0, ms1, choices, 64, taskTag, msgTagOffset);
+    e.execute();
+    return std::move(e._results);
+}
+
 void IntermediateDataSupport::prepareIknp() {
     if (Comm::isClient()) {
         return;
@@ -322,8 +441,7 @@ void IntermediateDataSupport::prepareIknp() {
             }
         }
 
-        BaseOtBatchOperator baseOt(baseOtSender, &ms0, &ms1, &choices, 64, taskTag, msgTagOffset);
-        baseOt.execute();
+        auto results = baseOt(baseOtSender, &ms0, &ms1, &choices, taskTag, msgTagOffset);
 
         if (isBaseOtSender) {
             // rank 1 is IKNP Receiver for direction 0, stores both seeds
@@ -333,7 +451,7 @@ void IntermediateDataSupport::prepareIknp() {
         } else {
             // rank 0 is IKNP Sender for direction 0, stores chosen seed
             for (int i = 0; i < 128; ++i) {
-                _iknpBaseSeeds0[i] = {baseOt._results[i], baseOt._results[i]};
+                _iknpBaseSeeds0[i] = {results[i], results[i]};
                 _iknpSenderChoices0[i] = (choices[i] != 0);
             }
         }
@@ -383,8 +501,7 @@ void IntermediateDataSupport::prepareIknp() {
             }
         }
 
-        BaseOtBatchOperator baseOt(baseOtSender, &ms0, &ms1, &choices, 64, taskTag, msgTagOffset);
-        baseOt.execute();
+        auto results = baseOt(baseOtSender, &ms0, &ms1, &choices, taskTag, msgTagOffset);
 
         if (isBaseOtSender) {
             // rank 0 is IKNP Receiver for direction 1, stores both seeds
@@ -394,7 +511,7 @@ void IntermediateDataSupport::prepareIknp() {
         } else {
             // rank 1 is IKNP Sender for direction 1, stores chosen seed
             for (int i = 0; i < 128; ++i) {
-                _iknpBaseSeeds1[i] = {baseOt._results[i], baseOt._results[i]};
+                _iknpBaseSeeds1[i] = {results[i], results[i]};
                 _iknpSenderChoices1[i] = (choices[i] != 0);
             }
         }
@@ -2,7 +2,9 @@
 #include "../../include/intermediate/PipelineBitwiseBmtBatchGenerator.h"
 
 #include "../../include/intermediate/IntermediateDataSupport.h"
+#include "ot/IknpOtBatchOperator.h"
 #include "parallel/ThreadPoolSupport.h"
+#include "utils/Crypto.h"
 
 PipelineBitwiseBmtBatchGenerator *PipelineBitwiseBmtBatchGenerator::execute() {
     _currentMsgTag = _startMsgTag;
@@ -23,70 +25,22 @@ void PipelineBitwiseBmtBatchGenerator::generateRandomAB(std::vector<int64_t> &as
     bs.resize(size);
     auto bmts = std::vector<BitwiseBmt>(size);
 
+    Crypto::randomFill(as.data(), size);
+    Crypto::randomFill(bs.data(), size);
     for (int i = 0; i < size; i++) {
-        auto &bmt = bmts[i];
-        bmt._a = Math::randInt();
-        bmt._b = Math::randInt();
-        as[i] = bmt._a;
-        bs[i] = bmt._b;
+        bmts[i]._a = as[i];
+        bmts[i]._b = bs[i];
     }
     _bmts.offer(std::move(bmts));
 }
 
 void PipelineBitwiseBmtBatchGenerator::compute(int sender, std::vector<int64_t> &as, std::vector<int64_t> &bs) {
-    std::vector<int64_t> ssi, sso;
-    std::vector<int64_t> choices;
-
-    int bc = Conf::BMT_GEN_BATCH_SIZE;
-    if (Comm::rank() == sender) {
-        ssi.resize(bc);
-        sso.resize(bc);
-        for (int i = 0; i < bc; i++) {
-            int64_t random = Math::randInt();
-            ssi[i] = random;
-            sso[i] = corr(as, i, random);
-        }
-
-        otAsync(sender, ssi, sso, choices);
-        _ssis.offer(std::move(ssi));
-    } else {
-        choices.resize(bc);
-        for (int i = 0; i < bc; i++) {
-            choices[i] = bs[i];
-        }
-        otAsync(sender, ssi, sso, choices);
-    }
-}
-
-void PipelineBitwiseBmtBatchGenerator::otAsync(int sender, std::vector<int64_t> &bits0,
-                                               std::vector<int64_t> &bits1,
-                                               std::vector<int64_t> &choiceBits) {
-    if (Comm::rank() == sender) {
-        int size = static_cast<int>(bits0.size());
-        auto send = std::make_unique<std::vector<int64_t> >(size * 4);
-
-        int64_t ir00 = IntermediateDataSupport::_sRot0->_r0;
-        int64_t ir01 = IntermediateDataSupport::_sRot0->_r1;
-        int64_t ir10 = IntermediateDataSupport::_sRot1->_r0;
-        int64_t ir11 = IntermediateDataSupport::_sRot1->_r1;
-
-        for (int i = 0; i < size; ++i) {
-            (*send)[i * 4] = bits0[i] ^ ir00;
-            (*send)[i * 4 + 1] = bits1[i] ^ ir01;
-            (*send)[i * 4 + 2] = bits0[i] ^ ir10;
-            (*send)[i * 4 + 3] = bits1[i] ^ ir11;
-        }
-
-        Comm::serverSendAsync(*send, _width, buildTag(_currentMsgTag));
-    } else {
-        int size = static_cast<int>(choiceBits.size());
-
-        HandleData hd;
-        hd._recv = new std::vector<int64_t>();
-        hd._r = Comm::serverReceiveAsync(*hd._recv, size * 4, _width, buildTag(_currentMsgTag));
-        hd._choiceBits = new std::vector(std::move(choiceBits));
-        _handle.offer(hd);
-    }
+    // Correlated OT with delta a: the sender keeps its random m0, the receiver gets m0 ^ (a & b)
+    std::vector<int64_t> *deltas = Comm::rank() == sender ? &as : nullptr;
+    std::vector<int64_t> *choices = Comm::rank() == sender ? nullptr : &bs;
+    auto mix = IknpOtBatchOperator(sender, deltas, choices, _taskTag,
+                                   _currentMsgTag + sender * IknpOtBatchOperator::tagStride()).execute()->_results;
+    (sender == 0 ? _usis : _vsis).offer(std::move(mix));
 }
 
 void PipelineBitwiseBmtBatchGenerator::mainThreadHandle() {
@@ -95,64 +49,26 @@ void PipelineBitwiseBmtBatchGenerator::mainThreadHandle() {
         generateRandomAB(as, bs);
         compute(0, as, bs);
         compute(1, as, bs);
-        ++_currentMsgTag;
+        _currentMsgTag += 2 * IknpOtBatchOperator::tagStride();
     }
 }
 
 void PipelineBitwiseBmtBatchGenerator::subThreadHandle() {
     ThreadPoolSupport::submit([this] {
-        bool ib0 = IntermediateDataSupport::_rRot0->_b;
-        int64_t ir0b = IntermediateDataSupport::_rRot0->_rb;
-        int64_t ir1b = IntermediateDataSupport::_rRot1->_rb;
         while (!System::_shutdown) {
             int size = Conf::BMT_GEN_BATCH_SIZE;
-            std::vector<int64_t> ssbs(size);
-
-            auto hd = _handle.poll();
-            Comm::wait(hd._r);
-            auto recv = hd._recv;
-            auto choiceBits = hd._choiceBits;
-
-            for (int i = 0; i < size; ++i) {
-                int64_t choice_bits = (*choiceBits)[i];
-
-                int64_t mask_sel0 = ib0 ? choice_bits : ~choice_bits;
-
-                int64_t yb00 = (*recv)[i * 4 + 0];
-                int64_t yb01 = (*recv)[i * 4 + 1];
-                int64_t yb10 = (*recv)[i * 4 + 2];
-                int64_t yb11 = (*recv)[i * 4 + 3];
-
-                int64_t yb_sel0 = (yb00 & ~choice_bits) | (yb01 & choice_bits);
-                int64_t yb_sel1 = (yb10 & ~choice_bits) | (yb11 & choice_bits);
-
-                int64_t yb_combined = (yb_sel0 & mask_sel0) | (yb_sel1 & ~mask_sel0);
-
-                int64_t xor_val = (ir0b & mask_sel0) | (ir1b & ~mask_sel0);
-
-                ssbs[i] = yb_combined ^ xor_val;
-            }
-
-            delete recv;
-            delete choiceBits;
-
-            auto ssi = _ssis.poll();
+            auto usi = _usis.poll();
+            auto vsi = _vsis.poll();
             auto bmts = _bmts.poll();
             for (int i = 0; i < size; ++i) {
-                int64_t ui = ssi[i];
-                int64_t vi = ssbs[i];
                 auto &bmt = bmts[i];
-                bmt._c = bmt._a & bmt._b ^ ui ^ vi;
-                IntermediateDataSupport::_bitwiseBmtQs[_index]->offer(bmt);
+                bmt._c = bmt._a & bmt._b ^ usi[i] ^ vsi[i];
             }
+            IntermediateDataSupport::offerBitwiseBmts(_index, bmts);
         }
     });
 }
 
-int64_t PipelineBitwiseBmtBatchGenerator::corr(std::vector<int64_t> &as, int bmtIdx, int64_t x) {
-    return as[bmtIdx] ^ x;
-}
-
 PipelineBitwiseBmtBatchGenerator *PipelineBitwiseBmtBatchGenerator::reconstruct(int clientRank) {
     throw std::runtime_error("reconstruct not implemented");
 }
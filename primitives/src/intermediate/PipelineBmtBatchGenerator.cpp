@@ -0,0 +1,55 @@
+
+#include "intermediate/PipelineBmtBatchGenerator.h"
+
+#include "intermediate/IntermediateDataSupport.h"
+#include "parallel/ThreadPoolSupport.h"
+#include "utils/System.h"
+
+PipelineBmtBatchGenerator::PipelineBmtBatchGenerator(int index, int taskTag, int msgTagOffset) : BmtBatchGenerator(
+    0, 64, taskTag, msgTagOffset), _index(index) {
+}
+
+PipelineBmtBatchGenerator *PipelineBmtBatchGenerator::execute() {
+    _currentMsgTag = _startMsgTag;
+    if (Comm::isClient()) {
+        return this;
+    }
+
+    subThreadHandle();
+
+    mainThreadHandle();
+
+    return this;
+}
+
+void PipelineBmtBatchGenerator::mainThreadHandle() {
+    while (!System::_shutdown) {
+        _bmts.resize(Conf::BMT_GEN_BATCH_SIZE);
+        generateRandomAB();
+        computeMix(0);
+        computeMix(1);
+
+        _readyBmts.offer(std::move(_bmts));
+        _usis.offer(std::move(_usi));
+        _vsis.offer(std::move(_vsi));
+        _bmts.clear();
+        _usi.clear();
+        _vsi.clear();
+        _currentMsgTag += tagStride();
+    }
+}
+
+void PipelineBmtBatchGenerator::subThreadHandle() {
+    ThreadPoolSupport::submit([this] {
+        while (!System::_shutdown) {
+            auto bmts = _readyBmts.poll();
+            auto usi = _usis.poll();
+            auto vsi = _vsis.poll();
+            for (size_t i = 0; i < bmts.size(); ++i) {
+                auto &bmt = bmts[i];
+                bmt._c = bmt._a * bmt._b + usi[i] + vsi[i];
+            }
+            IntermediateDataSupport::offerBmts(_index, bmts);
+        }
+    });
+}
@@ -0,0 +1,262 @@
+#include "intermediate/PreprocessingStore.h"
+
+#include "base/SecureOperator.h"
+#include "comm/Comm.h"
+#include "conf/Conf.h"
+#include "intermediate/BitwiseBmtBatchGenerator.h"
+#include "ot/IknpOtBatchOperator.h"
+#include "utils/Crypto.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIC[8] = {'P', 'A', 'R', 'S', 'E', 'C', 'P', 'P'};
+    // The handshake finishes before any record is generated or taken on the task
+    constexpr int SYNC_MSG_TAG = 0;
+
+    static_assert(offsetof(PreprocessingStore::Header, _takenOts) ==
+                  offsetof(PreprocessingStore::Header, _takenBmts) + sizeof(int64_t),
+                  "Taken counts are written to the header in one piece");
+
+    size_t expectedSize(const PreprocessingStore::Header &h) {
+        return sizeof(PreprocessingStore::Header) + h._bmts * sizeof(BitwiseBmt) +
+               (h._ots[0] + h._ots[1]) * sizeof(PreprocessingStore::OtRecord);
+    }
+
+    // Advances cursor by count only if the whole range fits
+    int64_t claim(std::atomic_int64_t &cursor, int64_t count, int64_t total) {
+        int64_t start = cursor.load();
+        do {
+            if (start + count > total) {
+                return -1;
+            }
+        } while (!cursor.compare_exchange_weak(start, start + count));
+        return start;
+    }
+}
+
+std::string PreprocessingStore::fileOf(const std::string &path) {
+    return path + "." + std::to_string(Comm::rank());
+}
+
+void PreprocessingStore::generate(const std::string &path, int64_t bmts, int64_t ots, int taskTag) {
+    if (Comm::isClient()) {
+        return;
+    }
+
+    Header header{};
+    std::memcpy(header._magic, MAGIC, sizeof(MAGIC));
+    header._version = VERSION;
+    header._rank = Comm::rank();
+    header._bmts = bmts;
+    header._ots[0] = ots;
+    header._ots[1] = ots;
+    // Both files carry the same session so a stale file on one server is detected on open()
+    const int syncTag = SecureOperator::buildTag(taskTag, SYNC_MSG_TAG);
+    if (Comm::rank() == 0) {
+        Crypto::randomFill(&header._session, 1);
+        Comm::serverSend(header._session, 64, syncTag);
+    } else {
+        Comm::serverReceive(header._session, 64, syncTag);
+    }
+
+    std::string file = fileOf(path);
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write preprocessing file " + file);
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    int64_t chunk = std::max(1, Conf::BMT_GEN_BATCH_SIZE);
+    for (int64_t done = 0; done < bmts; done += chunk) {
+        int n = static_cast<int>(std::min(chunk, bmts - done));
+        auto generated = BitwiseBmtBatchGenerator(n, 64, taskTag, 0).execute()->_bmts;
+        out.write(reinterpret_cast<const char *>(generated.data()), n * sizeof(BitwiseBmt));
+    }
+
+    for (int sender = 0; sender < 2; sender++) {
+        bool isSender = Comm::rank() == sender;
+        for (int64_t done = 0; done < ots; done += chunk) {
+            int n = static_cast<int>(std::min(chunk, ots - done));
+            std::vector<int64_t> ms0, ms1;
+            std::vector<int> choices;
+            if (isSender) {
+                // Full 64-bit messages: B2A derandomizes them into COTs, so a fixed top bit would leak
+                ms0.resize(n);
+                ms1.resize(n);
+                Crypto::randomFill(ms0.data(), ms0.size());
+                Crypto::randomFill(ms1.data(), ms1.size());
+            } else {
+                std::vector<int64_t> bits(n);
+                Crypto::randomFill(bits.data(), bits.size());
+                choices.resize(n);
+                for (int i = 0; i < n; i++) {
+                    choices[i] = static_cast<int>(bits[i] & 1);
+                }
+            }
+            IknpOtBatchOperator e(sender, &ms0, &ms1, &choices, 64, taskTag, 0);
+            e.execute();
+
+            std::vector<OtRecord> records(n);
+            for (int i = 0; i < n; i++) {
+                records[i] = isSender ? OtRecord{ms0[i], ms1[i]} : OtRecord{choices[i], e._results[i]};
+            }
+            out.write(reinterpret_cast<const char *>(records.data()), n * sizeof(OtRecord));
+        }
+    }
+
+    if (!out.flush()) {
+        throw std::runtime_error("Failed writing preprocessing file " + file);
+    }
+    Log::i("Preprocessed {} bitwise BMT words and {} OTs per direction into {}", bmts, ots, file);
+}
+
+void PreprocessingStore::open(int taskTag) {
+    if (Comm::isClient()) {
+        return;
+    }
+
+    std::string file = fileOf(Conf::PREPROCESS_PATH);
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    // Opened for writing as well, since a store whose cursors cannot be saved would replay its records
+    int fd = Conf::PREPROCESS_PATH.empty() ? -1 : ::open(file.c_str(), O_RDWR);
+    struct stat st{};
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header))) {
+        size = st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data = static_cast<const uint8_t *>(p);
+            madvise(p, size, MADV_SEQUENTIAL);
+        }
+    }
+
+    const auto *header = reinterpret_cast<const Header *>(data);
+    bool valid = header != nullptr && std::memcmp(header->_magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->_version == VERSION && header->_rank == Comm::rank() && expectedSize(*header) == size;
+
+    // Both servers must agree, otherwise neither uses the store. The taken counts follow and may differ.
+    constexpr size_t agreed = 5;
+    std::vector<int64_t> mine = {valid};
+    if (valid) {
+        mine.insert(mine.end(), {
+                        header->_session, header->_bmts, header->_ots[0], header->_ots[1], header->_takenBmts,
+                        header->_takenOts[0], header->_takenOts[1]
+                    });
+    }
+    std::vector<int64_t> theirs;
+    const int syncTag = SecureOperator::buildTag(taskTag, SYNC_MSG_TAG);
+    if (Comm::rank() == 0) {
+        Comm::serverSend(mine, 64, syncTag);
+        Comm::serverReceive(theirs, 64, syncTag);
+    } else {
+        Comm::serverReceive(theirs, 64, syncTag);
+        Comm::serverSend(mine, 64, syncTag);
+    }
+    if (!valid || theirs.size() != mine.size() || !std::equal(mine.begin(), mine.begin() + agreed, theirs.begin())) {
+        if (data != nullptr) {
+            munmap(const_cast<uint8_t *>(data), size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        Log::w("Preprocessing file {} is missing or does not match the other server, using JIT BMTs.", file);
+        return;
+    }
+
+    _data = data;
+    _size = size;
+    _header = header;
+    _bmts = reinterpret_cast<const BitwiseBmt *>(data + sizeof(Header));
+    _ots[0] = reinterpret_cast<const OtRecord *>(_bmts + header->_bmts);
+    _ots[1] = _ots[0] + header->_ots[0];
+    _fd = fd;
+    // Each cursor is current only on its owner, and counts never go back
+    _bmtCursor = std::max(mine[agreed], theirs[agreed]);
+    _otCursors[0] = std::max(mine[agreed + 1], theirs[agreed + 1]);
+    _otCursors[1] = std::max(mine[agreed + 2], theirs[agreed + 2]);
+    persist();
+    Log::i("Mapped {} with {} of {} bitwise BMT words and {}/{} OTs left.", file, header->_bmts - _bmtCursor,
+           header->_bmts, header->_ots[0] - _otCursors[0], header->_ots[1] - _otCursors[1]);
+}
+
+void PreprocessingStore::persist() {
+    std::lock_guard lock(_persisting);
+    const int64_t taken[3] = {_bmtCursor.load(), _otCursors[0].load(), _otCursors[1].load()};
+    if (pwrite(_fd, taken, sizeof(taken), offsetof(Header, _takenBmts)) != static_cast<ssize_t>(sizeof(taken))) {
+        throw std::runtime_error("Failed to save the preprocessing cursors.");
+    }
+}
+
+void PreprocessingStore::close() {
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t *>(_data), _size);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    _fd = -1;
+    _data = nullptr;
+    _size = 0;
+    _header = nullptr;
+    _bmts = nullptr;
+    _ots[0] = _ots[1] = nullptr;
+}
+
+bool PreprocessingStore::available() {
+    return _header != nullptr;
+}
+
+bool PreprocessingStore::takeBitwiseBmts(int count, int width, std::vector<BitwiseBmt> &out, int tag) {
+    if (!available()) {
+        return false;
+    }
+    int64_t offset;
+    if (Comm::rank() == 0) {
+        offset = claim(_bmtCursor, count, _header->_bmts);
+        if (offset >= 0) {
+            persist();
+        }
+        Comm::serverSend(offset, 64, tag);
+    } else {
+        Comm::serverReceive(offset, 64, tag);
+    }
+    if (offset < 0) {
+        return false;
+    }
+
+    out.assign(_bmts + offset, _bmts + offset + count);
+    if (width < 64) {
+        for (auto &bmt: out) {
+            bmt._a = Math::ring(bmt._a, width);
+            bmt._b = Math::ring(bmt._b, width);
+            bmt._c = Math::ring(bmt._c, width);
+        }
+    }
+    return true;
+}
+
+int64_t PreprocessingStore::reserveOts(int sender, int64_t count) {
+    if (!available()) {
+        return -1;
+    }
+    int64_t offset = claim(_otCursors[sender], count, _header->_ots[sender]);
+    if (offset >= 0) {
+        persist();
+    }
+    return offset;
+}
+
+const PreprocessingStore::OtRecord *PreprocessingStore::ots(int sender, int64_t offset) {
+    return _ots[sender] + offset;
+}
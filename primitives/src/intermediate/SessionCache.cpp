@@ -0,0 +1,290 @@
+#include "intermediate/SessionCache.h"
+
+#include "base/SecureOperator.h"
+#include "comm/Comm.h"
+#include "conf/Conf.h"
+#include "intermediate/IntermediateDataSupport.h"
+#include "utils/Log.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIC[8] = {'P', 'A', 'R', 'S', 'E', 'C', 'S', 'C'};
+    // Session handshake, under the reserved task tag
+    constexpr int SYNC_MSG_TAG = 1;
+    constexpr int ROWS = 128;
+    constexpr int KEY_BYTES = 32;
+    constexpr int IV_BYTES = 12;
+    constexpr int GCM_TAG_BYTES = 16;
+
+    // Authenticated (not encrypted) part of the file
+    struct FileHeader {
+        char _magic[8];
+        uint32_t _version;
+        int32_t _rank;
+    };
+
+    // Sealed part of the file
+    struct State {
+        int64_t _session;
+        int64_t _check;
+        // [direction][row]: both seeds on the IKNP receiver, the chosen one twice on the IKNP sender
+        int64_t _seeds[2][ROWS][2];
+        uint8_t _choices[2][ROWS];
+        // [rot]: (r0, r1) of the ROT this server sends, (rb, b) of the one it receives
+        int64_t _sRots[2][2];
+        int64_t _rRots[2][2];
+    };
+
+    using CipherCtx = std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>;
+
+    int64_t fingerprint(const State &s) {
+        std::string in = "parsec-session";
+        in.append(reinterpret_cast<const char *>(&s._session), sizeof(s._session));
+        in.append(reinterpret_cast<const char *>(&s._check), sizeof(s._check));
+        return static_cast<int64_t>(Math::kdfSha256To8Bytes(in));
+    }
+
+    // Same function on both servers, so a seed and its copy on the other side stay equal
+    int64_t rehash(int64_t nonce, int64_t label, int64_t v) {
+        int64_t in[3] = {nonce, label, v};
+        return static_cast<int64_t>(Math::kdfSha256To8Bytes(std::string(reinterpret_cast<const char *>(in),
+                                                                         sizeof(in))));
+    }
+
+    int64_t seedLabel(int direction, int row) {
+        return static_cast<int64_t>(direction) << 8 | row;
+    }
+
+    int64_t rotLabel(int rot, int sender) {
+        return 1LL << 16 | rot << 1 | sender;
+    }
+
+    bool readFile(const std::string &file, std::string &out) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Written to a temporary file and renamed, so a crash never leaves a torn file behind
+    void writePrivateFile(const std::string &file, const std::string &data) {
+        std::string tmp = file + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot write session cache file " + tmp);
+        }
+        bool ok = ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok || std::rename(tmp.c_str(), file.c_str()) != 0) {
+            throw std::runtime_error("Failed writing session cache file " + file);
+        }
+    }
+
+    bool seal(const std::string &key, const FileHeader &header, const State &state, std::string &out) {
+        unsigned char iv[IV_BYTES];
+        if (RAND_bytes(iv, IV_BYTES) != 1) {
+            return false;
+        }
+        std::string cipher(sizeof(State), '\0');
+        unsigned char tag[GCM_TAG_BYTES];
+        CipherCtx ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+        int len = 0;
+        bool ok = ctx != nullptr &&
+                  EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr,
+                                     reinterpret_cast<const unsigned char *>(key.data()), iv) == 1 &&
+                  EVP_EncryptUpdate(ctx.get(), nullptr, &len, reinterpret_cast<const unsigned char *>(&header),
+                                    sizeof(header)) == 1 &&
+                  EVP_EncryptUpdate(ctx.get(), reinterpret_cast<unsigned char *>(cipher.data()), &len,
+                                    reinterpret_cast<const unsigned char *>(&state), sizeof(state)) == 1 &&
+                  EVP_EncryptFinal_ex(ctx.get(), nullptr, &len) == 1 &&
+                  EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, GCM_TAG_BYTES, tag) == 1;
+        if (!ok) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.append(reinterpret_cast<const char *>(iv), IV_BYTES);
+        out.append(reinterpret_cast<const char *>(tag), GCM_TAG_BYTES);
+        out += cipher;
+        return true;
+    }
+
+    // False if the file is malformed, belongs to another rank or version, or fails authentication
+    bool unseal(const std::string &key, const std::string &data, State &state) {
+        if (data.size() != sizeof(FileHeader) + IV_BYTES + GCM_TAG_BYTES + sizeof(State)) {
+            return false;
+        }
+        FileHeader header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header._magic, MAGIC, sizeof(MAGIC)) != 0 || header._version != SessionCache::VERSION ||
+            header._rank != Comm::rank()) {
+            return false;
+        }
+        const auto *iv = reinterpret_cast<const unsigned char *>(data.data()) + sizeof(header);
+        std::string tag = data.substr(sizeof(header) + IV_BYTES, GCM_TAG_BYTES);
+        const auto *cipher = iv + IV_BYTES + GCM_TAG_BYTES;
+
+        CipherCtx ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+        int len = 0;
+        return ctx != nullptr &&
+               EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr,
+                                  reinterpret_cast<const unsigned char *>(key.data()), iv) == 1 &&
+               EVP_DecryptUpdate(ctx.get(), nullptr, &len, reinterpret_cast<const unsigned char *>(&header),
+                                 sizeof(header)) == 1 &&
+               EVP_DecryptUpdate(ctx.get(), reinterpret_cast<unsigned char *>(&state), &len, cipher,
+                                 sizeof(State)) == 1 &&
+               EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, GCM_TAG_BYTES, tag.data()) == 1 &&
+               EVP_DecryptFinal_ex(ctx.get(), nullptr, &len) == 1;
+    }
+}
+
+std::string SessionCache::fileOf() {
+    return Conf::SESSION_CACHE_PATH + "." + std::to_string(Comm::rank());
+}
+
+std::string SessionCache::keyFileOf() {
+    return fileOf() + ".key";
+}
+
+bool SessionCache::load() {
+    if (Conf::SESSION_CACHE_PATH.empty() || Comm::isClient()) {
+        return false;
+    }
+
+    const int syncTag = SecureOperator::buildTag(System::reservedTaskTag(), SYNC_MSG_TAG);
+    std::string file = fileOf();
+    std::string key, data;
+    State state{};
+    bool valid = readFile(keyFileOf(), key) && key.size() == KEY_BYTES && readFile(file, data) &&
+                 unseal(key, data, state);
+
+    // Both servers must resume the same session, otherwise both run base OT again
+    std::vector<int64_t> mine = {valid};
+    if (valid) {
+        mine.insert(mine.end(), {state._session, fingerprint(state)});
+    }
+    std::vector<int64_t> theirs;
+    if (Comm::rank() == 0) {
+        Comm::serverSend(mine, 64, syncTag);
+        Comm::serverReceive(theirs, 64, syncTag);
+    } else {
+        Comm::serverReceive(theirs, 64, syncTag);
+        Comm::serverSend(mine, 64, syncTag);
+    }
+    if (!valid || mine != theirs) {
+        Log::i("Session cache {} is missing or does not match the other server, running base OT.", file);
+        return false;
+    }
+
+    int64_t nonce;
+    if (Comm::rank() == 0) {
+        nonce = Math::randInt();
+        Comm::serverSend(nonce, 64, syncTag);
+    } else {
+        Comm::serverReceive(nonce, 64, syncTag);
+    }
+
+    using IDS = IntermediateDataSupport;
+    for (int d = 0; d < 2; d++) {
+        auto &seeds = d == 0 ? IDS::_iknpBaseSeeds0 : IDS::_iknpBaseSeeds1;
+        auto &choices = d == 0 ? IDS::_iknpSenderChoices0 : IDS::_iknpSenderChoices1;
+        seeds.resize(ROWS);
+        choices.resize(ROWS);
+        for (int i = 0; i < ROWS; i++) {
+            seeds[i] = {
+                rehash(nonce, seedLabel(d, i), state._seeds[d][i][0]),
+                rehash(nonce, seedLabel(d, i), state._seeds[d][i][1])
+            };
+            choices[i] = state._choices[d][i] != 0;
+        }
+    }
+
+    SRot **sRots[2] = {&IDS::_sRot0, &IDS::_sRot1};
+    RRot **rRots[2] = {&IDS::_rRot0, &IDS::_rRot1};
+    const int self = Comm::rank();
+    for (int k = 0; k < 2; k++) {
+        *sRots[k] = new SRot();
+        (*sRots[k])->_r0 = rehash(nonce, rotLabel(k, self), state._sRots[k][0]);
+        (*sRots[k])->_r1 = rehash(nonce, rotLabel(k, self), state._sRots[k][1]);
+        *rRots[k] = new RRot();
+        (*rRots[k])->_rb = rehash(nonce, rotLabel(k, 1 - self), state._rRots[k][0]);
+        (*rRots[k])->_b = static_cast<int>(state._rRots[k][1]);
+    }
+    std::memset(&state, 0, sizeof(state));
+
+    Log::i("Resumed base OT session from {}.", file);
+    return true;
+}
+
+void SessionCache::store() {
+    if (Conf::SESSION_CACHE_PATH.empty() || Comm::isClient()) {
+        return;
+    }
+
+    const int syncTag = SecureOperator::buildTag(System::reservedTaskTag(), SYNC_MSG_TAG);
+    State state{};
+    std::vector<int64_t> ids;
+    if (Comm::rank() == 0) {
+        ids = {Math::randInt(), Math::randInt()};
+        Comm::serverSend(ids, 64, syncTag);
+    } else {
+        Comm::serverReceive(ids, 64, syncTag);
+    }
+    state._session = ids[0];
+    state._check = ids[1];
+
+    using IDS = IntermediateDataSupport;
+    for (int d = 0; d < 2; d++) {
+        const auto &seeds = d == 0 ? IDS::_iknpBaseSeeds0 : IDS::_iknpBaseSeeds1;
+        const auto &choices = d == 0 ? IDS::_iknpSenderChoices0 : IDS::_iknpSenderChoices1;
+        for (int i = 0; i < ROWS; i++) {
+            state._seeds[d][i][0] = seeds[i][0];
+            state._seeds[d][i][1] = seeds[i][1];
+            state._choices[d][i] = choices[i];
+        }
+    }
+    const SRot *sRots[2] = {IDS::_sRot0, IDS::_sRot1};
+    const RRot *rRots[2] = {IDS::_rRot0, IDS::_rRot1};
+    for (int k = 0; k < 2; k++) {
+        state._sRots[k][0] = sRots[k]->_r0;
+        state._sRots[k][1] = sRots[k]->_r1;
+        state._rRots[k][0] = rRots[k]->_rb;
+        state._rRots[k][1] = rRots[k]->_b;
+    }
+
+    // The local key is created once and reused, so the cache survives any number of restarts
+    std::string key;
+    if (!readFile(keyFileOf(), key) || key.size() != KEY_BYTES) {
+        key.assign(KEY_BYTES, '\0');
+        if (RAND_bytes(reinterpret_cast<unsigned char *>(key.data()), KEY_BYTES) != 1) {
+            throw std::runtime_error("Cannot generate the session cache key");
+        }
+        writePrivateFile(keyFileOf(), key);
+    }
+
+    FileHeader header{};
+    std::memcpy(header._magic, MAGIC, sizeof(MAGIC));
+    header._version = VERSION;
+    header._rank = Comm::rank();
+    std::string data;
+    if (!seal(key, header, state, data)) {
+        throw std::runtime_error("Cannot seal the session cache");
+    }
+    writePrivateFile(fileOf(), data);
+    std::memset(&state, 0, sizeof(state));
+    Log::i("Saved base OT session to {}.", fileOf());
+}
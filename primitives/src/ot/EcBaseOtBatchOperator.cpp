@@ -0,0 +1,182 @@
+#include "ot/EcBaseOtBatchOperator.h"
+
+#include "comm/Comm.h"
+#include "conf/Conf.h"
+#include "utils/Math.h"
+#include "utils/System.h"
+
+#include <memory>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <stdexcept>
+
+namespace {
+    // Compressed P-256 point
+    constexpr size_t POINT_BYTES = 33;
+
+    using Group = std::unique_ptr<EC_GROUP, decltype(&EC_GROUP_free)>;
+    using Point = std::unique_ptr<EC_POINT, decltype(&EC_POINT_free)>;
+    using Bn = std::unique_ptr<BIGNUM, decltype(&BN_clear_free)>;
+    using BnCtx = std::unique_ptr<BN_CTX, decltype(&BN_CTX_free)>;
+
+    Group newGroup() {
+        Group g(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1), &EC_GROUP_free);
+        if (g == nullptr) {
+            throw std::runtime_error("EC base OT: cannot create P-256 group");
+        }
+        return g;
+    }
+
+    Point newPoint(const EC_GROUP *g) {
+        Point p(EC_POINT_new(g), &EC_POINT_free);
+        if (p == nullptr) {
+            throw std::runtime_error("EC base OT: EC_POINT_new failed");
+        }
+        return p;
+    }
+
+    // Uniform non-zero scalar
+    Bn randomScalar(const EC_GROUP *g) {
+        Bn k(BN_new(), &BN_clear_free);
+        do {
+            if (k == nullptr || BN_rand_range(k.get(), EC_GROUP_get0_order(g)) != 1) {
+                throw std::runtime_error("EC base OT: BN_rand_range failed");
+            }
+        } while (BN_is_zero(k.get()));
+        return k;
+    }
+
+    std::string encode(const EC_GROUP *g, const EC_POINT *p, BN_CTX *ctx) {
+        std::string out(POINT_BYTES, '\0');
+        if (EC_POINT_point2oct(g, p, POINT_CONVERSION_COMPRESSED, reinterpret_cast<unsigned char *>(out.data()),
+                               POINT_BYTES, ctx) != POINT_BYTES) {
+            throw std::runtime_error("EC base OT: cannot encode point");
+        }
+        return out;
+    }
+
+    // Rejects anything that is not a point on the curve, and the point at infinity
+    Point decode(const EC_GROUP *g, const std::string &bytes, size_t offset, BN_CTX *ctx) {
+        Point p = newPoint(g);
+        if (offset + POINT_BYTES > bytes.size() ||
+            EC_POINT_oct2point(g, p.get(), reinterpret_cast<const unsigned char *>(bytes.data()) + offset,
+                               POINT_BYTES, ctx) != 1 || EC_POINT_is_at_infinity(g, p.get())) {
+            throw std::runtime_error("EC base OT: bad point from peer");
+        }
+        return p;
+    }
+
+    int64_t kdf(int i, const std::string &a, const std::string &b, const std::string &shared) {
+        std::string input(reinterpret_cast<const char *>(&i), sizeof(i));
+        input += a;
+        input += b;
+        input += shared;
+        return static_cast<int64_t>(Math::kdfSha256To8Bytes(input));
+    }
+}
+
+EcBaseOtBatchOperator::EcBaseOtBatchOperator(int sender, std::vector<int64_t> *ms0, std::vector<int64_t> *ms1,
+                                             std::vector<int> *choices, int width, int taskTag, int msgTagOffset)
+    : AbstractOtBatchOperator(sender, ms0, ms1, choices, width, taskTag, msgTagOffset) {
+}
+
+EcBaseOtBatchOperator *EcBaseOtBatchOperator::execute() {
+    _currentMsgTag = _startMsgTag;
+    if (Comm::isClient()) {
+        return this;
+    }
+
+    int64_t start = 0;
+    if (Conf::ENABLE_CLASS_WISE_TIMING) {
+        start = System::currentTimeMillis();
+    }
+
+    if (_isSender) {
+        send();
+    } else {
+        receive();
+    }
+
+    if (Conf::ENABLE_CLASS_WISE_TIMING) {
+        _totalTime += System::currentTimeMillis() - start;
+    }
+    return this;
+}
+
+void EcBaseOtBatchOperator::send() {
+    Group group = newGroup();
+    const EC_GROUP *g = group.get();
+    BnCtx ctx(BN_CTX_new(), &BN_CTX_free);
+    int size = static_cast<int>(_ms0->size());
+
+    Bn a = randomScalar(g);
+    Point bigA = newPoint(g);
+    EC_POINT_mul(g, bigA.get(), a.get(), nullptr, nullptr, ctx.get());
+    std::string aBytes = encode(g, bigA.get(), ctx.get());
+    Comm::serverSend(aBytes, buildTag(_currentMsgTag));
+
+    // -aA, so that a (B - A) = aB - aA costs one addition
+    Point negAA = newPoint(g);
+    EC_POINT_mul(g, negAA.get(), nullptr, bigA.get(), a.get(), ctx.get());
+    EC_POINT_invert(g, negAA.get(), ctx.get());
+
+    std::string allB;
+    Comm::serverReceive(allB, buildTag(_currentMsgTag));
+    if (allB.size() != POINT_BYTES * size) {
+        throw std::runtime_error("EC base OT: unexpected number of points");
+    }
+
+    std::vector<int64_t> masked(2 * size);
+    Point aB = newPoint(g);
+    Point aBMinusAA = newPoint(g);
+    for (int i = 0; i < size; i++) {
+        Point bigB = decode(g, allB, i * POINT_BYTES, ctx.get());
+        std::string bBytes = allB.substr(i * POINT_BYTES, POINT_BYTES);
+        EC_POINT_mul(g, aB.get(), nullptr, bigB.get(), a.get(), ctx.get());
+        EC_POINT_add(g, aBMinusAA.get(), aB.get(), negAA.get(), ctx.get());
+        masked[2 * i] = (*_ms0)[i] ^ kdf(i, aBytes, bBytes, encode(g, aB.get(), ctx.get()));
+        masked[2 * i + 1] = (*_ms1)[i] ^ kdf(i, aBytes, bBytes, encode(g, aBMinusAA.get(), ctx.get()));
+    }
+    Comm::serverSend(masked, 64, buildTag(_currentMsgTag));
+}
+
+void EcBaseOtBatchOperator::receive() {
+    Group group = newGroup();
+    const EC_GROUP *g = group.get();
+    BnCtx ctx(BN_CTX_new(), &BN_CTX_free);
+    int size = static_cast<int>(_choices->size());
+
+    std::string aBytes;
+    Comm::serverReceive(aBytes, buildTag(_currentMsgTag));
+    Point bigA = decode(g, aBytes, 0, ctx.get());
+
+    std::string allB;
+    allB.reserve(POINT_BYTES * size);
+    std::vector<int64_t> keys(size);
+    Point bigB = newPoint(g);
+    Point bA = newPoint(g);
+    for (int i = 0; i < size; i++) {
+        Bn b = randomScalar(g);
+        EC_POINT_mul(g, bigB.get(), b.get(), nullptr, nullptr, ctx.get());
+        if ((*_choices)[i] & 1) {
+            EC_POINT_add(g, bigB.get(), bigB.get(), bigA.get(), ctx.get());
+        }
+        std::string bBytes = encode(g, bigB.get(), ctx.get());
+        EC_POINT_mul(g, bA.get(), nullptr, bigA.get(), b.get(), ctx.get());
+        keys[i] = kdf(i, aBytes, bBytes, encode(g, bA.get(), ctx.get()));
+        allB += bBytes;
+    }
+    Comm::serverSend(allB, buildTag(_currentMsgTag));
+
+    std::vector<int64_t> masked;
+    Comm::serverReceive(masked, 64, buildTag(_currentMsgTag));
+    _results.resize(size);
+    for (int i = 0; i < size; i++) {
+        _results[i] = masked[2 * i + ((*_choices)[i] & 1)] ^ keys[i];
+    }
+}
+
+int EcBaseOtBatchOperator::tagStride() {
+    return 1;
+}
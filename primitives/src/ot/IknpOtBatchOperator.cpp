@@ -57,6 +57,25 @@ IknpOtBatchOperator::IknpOtBatchOperator(int sender,
     _choiceBitsPacked = nullptr;
 }
 
+IknpOtBatchOperator::IknpOtBatchOperator(int sender,
+                                         std::vector<int64_t> *deltas,
+                                         std::vector<int> *choices,
+                                         int width,
+                                         int taskTag,
+                                         int msgTagOffset)
+    : IknpOtBatchOperator(sender, deltas, nullptr, choices, width, taskTag, msgTagOffset) {
+    _correlated = true;
+}
+
+IknpOtBatchOperator::IknpOtBatchOperator(int sender,
+                                         std::vector<int64_t> *deltasPacked,
+                                         std::vector<int64_t> *choiceBitsPacked,
+                                         int taskTag,
+                                         int msgTagOffset)
+    : IknpOtBatchOperator(sender, deltasPacked, nullptr, choiceBitsPacked, taskTag, msgTagOffset) {
+    _correlated = true;
+}
+
 int IknpOtBatchOperator::tagStride() {
     // Both ForBits and Scalar modes use batched communication:
     // - Tag 1: All U matrices (receiver -> sender)
@@ -132,8 +151,10 @@ void IknpOtBatchOperator::senderExtendForBits() {
     const size_t totalBits = n * 64;
 
     // Each limb contains 64 independent 1-bit OTs
-    _results.resize(n * 2); // Store [m0_limb, m1_limb] pairs
+    _results.resize(_correlated ? n : n * 2); // [m0_limb, m1_limb] pairs, or m0 limbs for COT
     std::fill(_results.begin(), _results.end(), 0); // Initialize to zero
+    // COT: m0 ^ delta ^ H(q ^ s) per bit
+    std::vector<int64_t> corrections(_correlated ? n : 0, 0);
 
     constexpr size_t W = MAX_TILE_WIDTH;
 
@@ -271,10 +292,16 @@ void IknpOtBatchOperator::senderExtendForBits() {
                             if (offset_ + pos >= totalBits) continue;
                             const size_t limbIdx = (offset_ + pos) / 64;
                             const size_t bitPos = (offset_ + pos) % 64;
-                            const uint64_t m0_bit = ((*_ms0)[limbIdx] >> bitPos) & 1;
-                            const uint64_t m1_bit = ((*_ms1)[limbIdx] >> bitPos) & 1;
                             const uint64_t h0_bit = (k < 64) ? ((h0Bits[0] >> k) & 1) : ((h0Bits[1] >> (k - 64)) & 1);
                             const uint64_t h1_bit = (k < 64) ? ((h1Bits[0] >> k) & 1) : ((h1Bits[1] >> (k - 64)) & 1);
+                            if (_correlated) {
+                                const uint64_t d_bit = ((*_ms0)[limbIdx] >> bitPos) & 1;
+                                _results[limbIdx] |= static_cast<int64_t>(h0_bit << bitPos);
+                                corrections[limbIdx] |= static_cast<int64_t>((h0_bit ^ d_bit ^ h1_bit) << bitPos);
+                                continue;
+                            }
+                            const uint64_t m0_bit = ((*_ms0)[limbIdx] >> bitPos) & 1;
+                            const uint64_t m1_bit = ((*_ms1)[limbIdx] >> bitPos) & 1;
                             // Atomic OR into _results (different tiles write to different limbs — no overlap)
                             _results[limbIdx * 2] |= static_cast<int64_t>((m0_bit ^ h0_bit) << bitPos);
                             _results[limbIdx * 2 + 1] |= static_cast<int64_t>((m1_bit ^ h1_bit) << bitPos);
@@ -303,9 +330,10 @@ void IknpOtBatchOperator::senderExtendForBits() {
         }
     }
 
-    // Phase 3: Send masked messages to receiver
+    // Phase 3: Send masked messages (or COT corrections) to receiver
     {
-        AbstractRequest *sendReq = Comm::serverSendAsync(_results, 64, buildTag(_currentMsgTag.load()));
+        AbstractRequest *sendReq = Comm::serverSendAsync(_correlated ? corrections : _results, 64,
+                                                         buildTag(_currentMsgTag.load()));
         Comm::wait(sendReq);
     }
     _currentMsgTag.fetch_add(1, std::memory_order_relaxed);
@@ -522,14 +550,23 @@ void IknpOtBatchOperator::receiverExtendForBits() {
     }
 
     // Phase 4: Post async receive of masked messages, then do Unmask prep while waiting
-    std::vector<int64_t> maskedMessages(n * 2); {
+    const size_t messages = _correlated ? n : n * 2;
+    std::vector<int64_t> maskedMessages(messages); {
         const int64_t tc = System::currentTimeMillis();
         AbstractRequest *recvReq = Comm::serverReceiveAsync(
-            maskedMessages, static_cast<int>(n * 2), 64, buildTag(_currentMsgTag.load()));
+            maskedMessages, static_cast<int>(messages), 64, buildTag(_currentMsgTag.load()));
         Comm::wait(recvReq);
     }
     _currentMsgTag.fetch_add(1, std::memory_order_relaxed);
 
+    // COT: H(t) is already m0 where the choice is 0, the correction turns it into m0 ^ delta elsewhere
+    if (_correlated) {
+        for (size_t limb = 0; limb < n; ++limb) {
+            _results[limb] ^= maskedMessages[limb] & (*_choiceBitsPacked)[limb];
+        }
+        return;
+    }
+
     // Unmask using choice bits
     {
         const int64_t tu = System::currentTimeMillis();
@@ -561,8 +598,10 @@ void IknpOtBatchOperator::receiverExtendForBits() {
 
 void IknpOtBatchOperator::senderExtend() {
     const size_t n = _ms0->size();
-    _results.resize(n * 2); // y0, y1 pairs
+    _results.resize(_correlated ? n : n * 2); // y0, y1 pairs, or m0 for COT
     std::fill(_results.begin(), _results.end(), 0);
+    // COT: m0 + delta - H(q ^ s)
+    std::vector<int64_t> corrections(_correlated ? n : 0);
 
     constexpr size_t OTS_PER_TILE = TILE_ROWS;
     const size_t numTiles   = (n + OTS_PER_TILE - 1) / OTS_PER_TILE;
@@ -629,6 +668,11 @@ void IknpOtBatchOperator::senderExtend() {
                     const U128   col_xor_s = {col.lo ^ sBlock.lo, col.hi ^ sBlock.hi};
                     const uint64_t h0 = Crypto::hash64(static_cast<int>(idx), col);
                     const uint64_t h1 = Crypto::hash64(static_cast<int>(idx), col_xor_s);
+                    if (_correlated) {
+                        _results[idx] = ring(static_cast<int64_t>(h0));
+                        corrections[idx] = ring(_results[idx] + (*_ms0)[idx] - static_cast<int64_t>(h1));
+                        continue;
+                    }
                     _results[idx * 2]     = ring((*_ms0)[idx]) ^ ring(static_cast<int64_t>(h0));
                     _results[idx * 2 + 1] = ring((*_ms1)[idx]) ^ ring(static_cast<int64_t>(h1));
                 }
@@ -653,9 +697,11 @@ void IknpOtBatchOperator::senderExtend() {
         }
     }
 
-    // Phase 3: send ALL masked messages at once (tag +1)
+    // Phase 3: send ALL masked messages at once (tag +1). COT corrections live in the ring.
     {
-        AbstractRequest *sendReq = Comm::serverSendAsync(_results, 64, buildTag(_currentMsgTag.load()));
+        AbstractRequest *sendReq = _correlated
+                                       ? Comm::serverSendAsync(corrections, _width, buildTag(_currentMsgTag.load()))
+                                       : Comm::serverSendAsync(_results, 64, buildTag(_currentMsgTag.load()));
         Comm::wait(sendReq);
     }
     _currentMsgTag.fetch_add(1, std::memory_order_relaxed);
@@ -790,14 +836,24 @@ void IknpOtBatchOperator::receiverExtend() {
     Comm::wait(sendReq);
 
     // Phase 4: receive ALL masked messages at once (tag +1)
-    std::vector<int64_t> maskedMessages(n * 2);
+    const size_t messages = _correlated ? n : n * 2;
+    std::vector<int64_t> maskedMessages(messages);
     {
         AbstractRequest *recvReq = Comm::serverReceiveAsync(
-            maskedMessages, static_cast<int>(n * 2), 64, buildTag(_currentMsgTag.load()));
+            maskedMessages, static_cast<int>(messages), _correlated ? _width : 64, buildTag(_currentMsgTag.load()));
         Comm::wait(recvReq);
     }
     _currentMsgTag.fetch_add(1, std::memory_order_relaxed);
 
+    // COT: result[i] = H(T[i]) + choice[i] * correction[i]
+    if (_correlated) {
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t h = static_cast<int64_t>(hashValues[i]);
+            _results[i] = ring((*_choices)[i] & 1 ? h + maskedMessages[i] : h);
+        }
+        return;
+    }
+
     // Unmask: result[i] = y_{choice[i]} XOR H(T[i])
     for (size_t i = 0; i < n; ++i) {
         const int     choice = (*_choices)[i] & 1;
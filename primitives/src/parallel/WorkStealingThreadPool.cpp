@@ -0,0 +1,254 @@
+
+#include "parallel/WorkStealingThreadPool.h"
+
+#ifdef PARSEC_HAS_FIBERS
+
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <stdexcept>
+
+namespace {
+    // IKNP keeps a few hundred KB of tiles on the stack. Pages are only committed when touched.
+    constexpr size_t FIBER_STACK_SIZE = 8 << 20;
+    // Stacks kept per worker for reuse
+    constexpr size_t MAX_CACHED_STACKS = 16;
+    // Live fibers per worker before it stops picking up shared tasks. Tasks pushed by its own
+    // fibers are still started, so a fiber waiting for nested work never starves it.
+    constexpr size_t MAX_LIVE_FIBERS = 128;
+    // Rounds in which nothing starts or finishes before a worker with waiting fibers sleeps between rounds.
+    // Fibers wait for messages nobody signals, so the sleep is short and a new task cuts it off.
+    constexpr int IDLE_ROUNDS = 64;
+    constexpr auto IDLE_WAIT = std::chrono::microseconds(50);
+}
+
+struct WorkStealingThreadPool::Fiber {
+    ucontext_t _context{};
+    std::function<void()> _task;
+    void *_stack = nullptr;
+    bool _done = false;
+};
+
+struct WorkStealingThreadPool::Worker {
+    WorkStealingThreadPool *_pool = nullptr;
+    // Owner pops from the back, thieves take from the front
+    std::deque<std::function<void()> > _tasks;
+    std::mutex _mutex;
+
+    // Touched by the owning thread only
+    ucontext_t _scheduler{};
+    std::deque<Fiber *> _suspended;
+    std::vector<void *> _stacks;
+    size_t _live = 0;
+
+    std::thread _thread;
+};
+
+thread_local WorkStealingThreadPool::Worker *WorkStealingThreadPool::_currentWorker = nullptr;
+thread_local WorkStealingThreadPool::Fiber *WorkStealingThreadPool::_currentFiber = nullptr;
+
+WorkStealingThreadPool::WorkStealingThreadPool(int numThreads) {
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    for (int i = 0; i < numThreads; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->_pool = this;
+        _workers.push_back(std::move(worker));
+    }
+    for (auto &worker: _workers) {
+        Worker *w = worker.get();
+        w->_thread = std::thread([this, w] { run(w); });
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_globalMutex);
+        _stop = true;
+    }
+    _hasTasks.notify_all();
+    for (auto &worker: _workers) {
+        if (worker->_thread.joinable()) {
+            worker->_thread.join();
+        }
+    }
+    // Fibers still suspended here are daemon loops that were never going to return. Their stacks
+    // are released without unwinding them.
+    for (auto &worker: _workers) {
+        for (auto *fiber: worker->_suspended) {
+            munmap(fiber->_stack, FIBER_STACK_SIZE);
+            delete fiber;
+        }
+        for (auto *stack: worker->_stacks) {
+            munmap(stack, FIBER_STACK_SIZE);
+        }
+    }
+}
+
+bool WorkStealingThreadPool::yield() {
+    Fiber *fiber = _currentFiber;
+    if (fiber == nullptr) {
+        return false;
+    }
+    swapcontext(&fiber->_context, &_currentWorker->_scheduler);
+    return true;
+}
+
+bool WorkStealingThreadPool::inFiber() {
+    return _currentFiber != nullptr;
+}
+
+void WorkStealingThreadPool::push(std::function<void()> task) {
+    Worker *worker = _currentWorker;
+    if (worker != nullptr && worker->_pool == this) {
+        std::lock_guard<std::mutex> lock(worker->_mutex);
+        worker->_tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(_globalMutex);
+        _globalTasks.push_back(std::move(task));
+    }
+    _hasTasks.notify_one();
+}
+
+bool WorkStealingThreadPool::take(Worker *worker, bool shared, std::function<void()> &task) {
+    {
+        std::lock_guard<std::mutex> lock(worker->_mutex);
+        if (!worker->_tasks.empty()) {
+            task = std::move(worker->_tasks.back());
+            worker->_tasks.pop_back();
+            return true;
+        }
+    }
+    if (!shared) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_globalMutex);
+        if (!_globalTasks.empty()) {
+            task = std::move(_globalTasks.front());
+            _globalTasks.pop_front();
+            return true;
+        }
+    }
+    for (auto &victim: _workers) {
+        if (victim.get() == worker) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(victim->_mutex);
+        if (!victim->_tasks.empty()) {
+            task = std::move(victim->_tasks.front());
+            victim->_tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::run(Worker *worker) {
+    _currentWorker = worker;
+    int idleRounds = 0;
+    while (!_stop) {
+        bool started = false;
+        std::function<void()> task;
+        if (take(worker, worker->_live < MAX_LIVE_FIBERS, task)) {
+            start(worker, std::move(task));
+            started = true;
+        }
+
+        // Give every fiber that was waiting one more chance
+        size_t live = worker->_live;
+        size_t waiting = worker->_suspended.size();
+        for (size_t i = 0; i < waiting && !_stop; i++) {
+            Fiber *fiber = worker->_suspended.front();
+            worker->_suspended.pop_front();
+            resume(worker, fiber);
+        }
+
+        if (started || worker->_live < live) {
+            idleRounds = 0;
+            continue;
+        }
+        if (!worker->_suspended.empty() && idleRounds < IDLE_ROUNDS) {
+            idleRounds++;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_globalMutex);
+        if (_globalTasks.empty() && !_stop) {
+            if (worker->_suspended.empty()) {
+                _hasTasks.wait_for(lock, std::chrono::milliseconds(1));
+            } else {
+                _hasTasks.wait_for(lock, IDLE_WAIT);
+            }
+        }
+    }
+    _currentWorker = nullptr;
+}
+
+void WorkStealingThreadPool::start(Worker *worker, std::function<void()> task) {
+    auto *fiber = new Fiber;
+    fiber->_task = std::move(task);
+    if (!worker->_stacks.empty()) {
+        fiber->_stack = worker->_stacks.back();
+        worker->_stacks.pop_back();
+    } else {
+        fiber->_stack = mmap(nullptr, FIBER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (fiber->_stack == MAP_FAILED) {
+            delete fiber;
+            throw std::runtime_error("Failed to allocate fiber stack.");
+        }
+        // Guard page so an overflow faults instead of corrupting a neighbour
+        mprotect(fiber->_stack, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE);
+    }
+
+    getcontext(&fiber->_context);
+    fiber->_context.uc_stack.ss_sp = fiber->_stack;
+    fiber->_context.uc_stack.ss_size = FIBER_STACK_SIZE;
+    fiber->_context.uc_link = &worker->_scheduler;
+    makecontext(&fiber->_context, &WorkStealingThreadPool::entry, 0);
+
+    worker->_live++;
+    resume(worker, fiber);
+}
+
+void WorkStealingThreadPool::resume(Worker *worker, Fiber *fiber) {
+    _currentFiber = fiber;
+    swapcontext(&worker->_scheduler, &fiber->_context);
+    _currentFiber = nullptr;
+
+    if (!fiber->_done) {
+        worker->_suspended.push_back(fiber);
+        return;
+    }
+    if (worker->_stacks.size() < MAX_CACHED_STACKS) {
+        worker->_stacks.push_back(fiber->_stack);
+    } else {
+        munmap(fiber->_stack, FIBER_STACK_SIZE);
+    }
+    delete fiber;
+    worker->_live--;
+}
+
+void WorkStealingThreadPool::entry() {
+    Fiber *fiber = _currentFiber;
+    try {
+        fiber->_task();
+    } catch (...) {
+    }
+    fiber->_task = nullptr;
+    fiber->_done = true;
+    // Returning switches to uc_link, the scheduler of the owning worker
+}
+
+#else
+
+bool WorkStealingThreadPool::yield() {
+    return false;
+}
+
+bool WorkStealingThreadPool::inFiber() {
+    return false;
+}
+
+#endif
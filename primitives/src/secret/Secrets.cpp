@@ -10,7 +10,6 @@
 #include "compute/batch/bool/BoolMutexBatchOperator.h"
 #include "compute/single/bool/BoolMutexOperator.h"
 #include "conf/Conf.h"
-#include "intermediate/IntermediateDataSupport.h"
 #include "parallel/ThreadPoolSupport.h"
 #include "utils/Log.h"
 
@@ -135,17 +134,8 @@ void bitonicSortBoolSplittedBatches(std::vector<BoolSecret> &secrets, bool asc,
             futures.reserve(numBatches);
 
             for (int b = 0; b < numBatches; ++b) {
-                std::shared_ptr<std::vector<BitwiseBmt>> bmtLessB, bmtMuxB;
-
-                if (Conf::BMT_METHOD == Conf::BMT_BACKGROUND) {
-                    bmtLessB = std::make_shared<std::vector<BitwiseBmt>>(IntermediateDataSupport::pollBitwiseBmts(
-                        BoolLessBatchOperator::bmtCount(xsBatches[b].size(), secrets[0]._width), 64));
-                    bmtMuxB = std::make_shared<std::vector<BitwiseBmt>>(IntermediateDataSupport::pollBitwiseBmts(
-                        2 * BoolMutexBatchOperator::bmtCount(xsBatches[b].size(), secrets[0]._width), 64));
-                }
-
                 futures.emplace_back(
-                    ThreadPoolSupport::submit([&, b, bmtLessB, bmtMuxB]() -> BatchOutput {
+                    ThreadPoolSupport::submit([&, b]() -> BatchOutput {
                         auto &xsB = xsBatches[b];
                         auto &ysB = ysBatches[b];
                         auto &iB = xIdxBatches[b];
@@ -160,7 +150,7 @@ void bitonicSortBoolSplittedBatches(std::vector<BoolSecret> &secrets, bool asc,
                             secrets[0]._width,
                             taskTag, msgTagOffset + offset * b,
                             SecureOperator::NO_CLIENT_COMPUTE
-                        ).setBmts(Conf::BMT_METHOD == Conf::BMT_BACKGROUND ? bmtLessB.get() : nullptr)->execute()->_zis;
+                        ).execute()->_zis;
 
                         for (int t = 0; t < sz; ++t) {
                             if (!ascB[t]) {
@@ -172,7 +162,7 @@ void bitonicSortBoolSplittedBatches(std::vector<BoolSecret> &secrets, bool asc,
                             &xsB, &ysB, &zs1,
                             secrets[0]._width,
                             taskTag, msgTagOffset + offset * b
-                        ).setBmts(Conf::BMT_METHOD == Conf::BMT_BACKGROUND ? bmtMuxB.get() : nullptr)->execute()->_zis;
+                        ).execute()->_zis;
 
                         return std::make_tuple(iB, jB, zs2);
                     })
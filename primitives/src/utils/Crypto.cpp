@@ -92,10 +92,14 @@
 
 
 #include "utils/Crypto.h"
+#include "accelerate/SimdSupport.h"
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <climits>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -246,6 +250,87 @@ void Crypto::AesCtrPrg::generateBlocks(U128 *out, size_t blocks) const {
     }
 }
 
+namespace {
+    // Encrypts zeros in place, chunked to EVP's int lengths
+    void ctrStream(EVP_CIPHER_CTX *ctx, unsigned char *bytes, size_t n) {
+        std::memset(bytes, 0, n);
+        while (n > 0) {
+            int len = static_cast<int>(std::min<size_t>(n, INT_MAX & ~15));
+            int outLen = 0;
+            if (EVP_EncryptUpdate(ctx, bytes, &outLen, bytes, len) != 1) {
+                throw std::runtime_error("EVP_EncryptUpdate failed");
+            }
+            bytes += len;
+            n -= len;
+        }
+    }
+
+    // AesCtrPrg restarts its stream on every call, this one keeps the CTR state across calls
+    class ThreadPrg {
+    public:
+        ThreadPrg() : _ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free) {
+            unsigned char key[16], iv[16];
+            if (!_ctx || RAND_bytes(key, sizeof(key)) != 1 || RAND_bytes(iv, sizeof(iv)) != 1 ||
+                EVP_EncryptInit_ex(_ctx.get(), EVP_aes_128_ctr(), nullptr, key, iv) != 1) {
+                throw std::runtime_error("Cannot initialize the thread PRG");
+            }
+            OPENSSL_cleanse(key, sizeof(key));
+        }
+
+        void fill(unsigned char *bytes, size_t n) {
+            ctrStream(_ctx.get(), bytes, n);
+        }
+
+    private:
+        std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> _ctx;
+    };
+
+    ThreadPrg &threadPrg() {
+        thread_local ThreadPrg prg;
+        return prg;
+    }
+}
+
+void Crypto::randomFill(int64_t *out, size_t count) {
+    threadPrg().fill(reinterpret_cast<unsigned char *>(out), count * sizeof(int64_t));
+}
+
+void Crypto::randomFill(U128 *out, size_t count) {
+    threadPrg().fill(reinterpret_cast<unsigned char *>(out), count * sizeof(U128));
+}
+
+namespace {
+    // n bytes of the AES-128-CTR stream keyed by seed, starting at counter block
+    void seedStream(const U128 &seed, uint64_t block, unsigned char *bytes, size_t n) {
+        std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(EVP_CIPHER_CTX_new(),
+                                                                            &EVP_CIPHER_CTX_free);
+        // OpenSSL increments the IV as a big-endian counter
+        unsigned char iv[16] = {};
+        for (int i = 0; i < 8; i++) {
+            iv[15 - i] = static_cast<unsigned char>(block >> (8 * i));
+        }
+        if (!ctx || EVP_EncryptInit_ex(ctx.get(), EVP_aes_128_ctr(), nullptr,
+                                       reinterpret_cast<const unsigned char *>(&seed), iv) != 1) {
+            throw std::runtime_error("EVP_EncryptInit_ex failed");
+        }
+        ctrStream(ctx.get(), bytes, n);
+    }
+}
+
+void Crypto::expandSeed(const U128 &seed, int64_t *out, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    seedStream(seed, 0, reinterpret_cast<unsigned char *>(out), count * sizeof(int64_t));
+}
+
+void Crypto::expandSeed(const U128 &seed, uint64_t offset, U128 *out, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    seedStream(seed, offset, reinterpret_cast<unsigned char *>(out), count * sizeof(U128));
+}
+
 void Crypto::batchPrgGenerate(const uint64_t* seeds, size_t numSeeds,
                                U128* out, size_t blocksPerSeed) {
     if (numSeeds == 0 || blocksPerSeed == 0) return;
@@ -636,53 +721,7 @@ void Crypto::hashTileBatchPair(int baseIndex, const U128 *tile, const U128 *tile
 
 
 void Crypto::transpose128x128_inplace(U128 v[128]) {
-    uint64_t x0[128];
-    uint64_t x1[128];
-    for (int i = 0; i < 128; ++i) {
-        x0[i] = v[i].lo;
-        x1[i] = v[i].hi;
-    }
-
-    auto transpose64 = [](uint64_t x[128]) {
-        static constexpr uint64_t m1 = 0x5555555555555555ULL;
-        static constexpr uint64_t m2 = 0x3333333333333333ULL;
-        static constexpr uint64_t m4 = 0x0f0f0f0f0f0f0f0fULL;
-        static constexpr uint64_t m8 = 0x00ff00ff00ff00ffULL;
-        static constexpr uint64_t m16 = 0x0000ffff0000ffffULL;
-        static constexpr uint64_t m32 = 0x00000000ffffffffULL;
-
-        auto swap_rows = [&](int shift, uint64_t mask) {
-            for (int i = 0; i < 128; i += 2 * shift) {
-                for (int j = 0; j < shift; ++j) {
-                    uint64_t a = x[i + j];
-                    uint64_t b = x[i + j + shift];
-                    uint64_t t = ((a >> shift) ^ b) & mask;
-                    b ^= t;
-                    a ^= (t << shift);
-                    x[i + j] = a;
-                    x[i + j + shift] = b;
-                }
-            }
-        };
-
-        swap_rows(1, m1);
-        swap_rows(2, m2);
-        swap_rows(4, m4);
-        swap_rows(8, m8);
-        swap_rows(16, m16);
-        swap_rows(32, m32);
-    };
-
-    transpose64(x0);
-    transpose64(x1);
-
-    for (int i = 0; i < 64; ++i) {
-        std::swap(x0[i + 64], x1[i]);
-    }
-
-    for (int i = 0; i < 128; ++i) {
-        v[i] = {x0[i], x1[i]};
-    }
+    SimdSupport::transpose128x128(v);
 }
 
 void Crypto::transpose128xNBlocks_full(const std::array<std::vector<U128>, 128> &rows,
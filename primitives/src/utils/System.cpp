@@ -5,11 +5,14 @@
 #include "comm/Comm.h"
 #include "comm/MpiComm.h"
 #include "conf/Conf.h"
+#include "intermediate/BmtDealer.h"
 #include "intermediate/IntermediateDataSupport.h"
 #include "parallel/ThreadPoolSupport.h"
 #include "utils/Log.h"
 #include "utils/Math.h"
 
+#include <stdexcept>
+
 void System::init(int argc, char **argv) {
     Conf::init(argc, argv);
 
@@ -19,6 +22,9 @@ void System::init(int argc, char **argv) {
             PRESERVED_TASK_TAGS *= 2;
         }
     }
+    if (PRESERVED_TASK_TAGS >= reservedTaskTag()) {
+        throw std::runtime_error("Too many bmt queues for task_tag_bits.");
+    }
 
     ThreadPoolSupport::init();
 
@@ -32,6 +38,9 @@ void System::finalize() {
     Log::i("Prepare to shutdown... (if not finalized please press Ctrl + C)");
     _shutdown = true;
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    if (Conf::BMT_METHOD == Conf::BMT_DEALER) {
+        BmtDealer::finalize();
+    }
     Comm::finalize();
     ThreadPoolSupport::finalize();
     IntermediateDataSupport::finalize();
@@ -50,6 +59,10 @@ int System::nextTask() {
     return _currentTaskTag;
 }
 
+int System::reservedTaskTag() {
+    return (1 << (Conf::TASK_TAG_BITS - 1)) - 1;
+}
+
 int64_t System::currentTimeMillis() {
     auto now = std::chrono::system_clock::now();
 